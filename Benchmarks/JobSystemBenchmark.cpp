@@ -0,0 +1,228 @@
+#include <LumosEngine.h>
+#include <Core/JobSystem.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+
+// Measures the overhead of dispatching parallel-for jobs.
+// The legacy implementation below is the previous ring buffer + std::function job system,
+// kept here so both can be compared in the same process.
+
+namespace Legacy
+{
+	template <typename T, size_t capacity>
+	class ThreadSafeRingBuffer
+	{
+	public:
+		bool push_back(const T& item)
+		{
+			bool result = false;
+			lock.lock();
+			size_t next = (head + 1) % capacity;
+			if(next != tail)
+			{
+				data[head] = item;
+				head = next;
+				result = true;
+			}
+			lock.unlock();
+			return result;
+		}
+
+		bool pop_front(T& item)
+		{
+			bool result = false;
+			lock.lock();
+			if(tail != head)
+			{
+				item = data[tail];
+				tail = (tail + 1) % capacity;
+				result = true;
+			}
+			lock.unlock();
+			return result;
+		}
+
+	private:
+		T data[capacity];
+		size_t head = 0;
+		size_t tail = 0;
+		std::mutex lock;
+	};
+
+	ThreadSafeRingBuffer<std::function<void()>, 256> jobPool;
+	std::condition_variable wakeCondition;
+	std::mutex wakeMutex;
+	uint64_t currentLabel = 0;
+	std::atomic<uint64_t> finishedLabel;
+	std::atomic<bool> running;
+	std::vector<std::thread> workers;
+
+	void OnInit()
+	{
+		finishedLabel.store(0);
+		running.store(true);
+		const uint32_t numThreads = std::max(1U, std::thread::hardware_concurrency());
+
+		for(uint32_t threadID = 0; threadID < numThreads; ++threadID)
+		{
+			workers.emplace_back([] {
+				std::function<void()> job;
+				while(running.load())
+				{
+					if(jobPool.pop_front(job))
+					{
+						job();
+						finishedLabel.fetch_add(1);
+					}
+					else
+					{
+						std::unique_lock<std::mutex> lock(wakeMutex);
+						if(running.load())
+							wakeCondition.wait(lock);
+					}
+				}
+			});
+		}
+	}
+
+	void OnShutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			running.store(false);
+		}
+		wakeCondition.notify_all();
+
+		for(auto& worker : workers)
+			worker.join();
+	}
+
+	void poll()
+	{
+		wakeCondition.notify_one();
+		std::this_thread::yield();
+	}
+
+	void Dispatch(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job)
+	{
+		if(jobCount == 0 || groupSize == 0)
+			return;
+
+		const uint32_t groupCount = (jobCount + groupSize - 1) / groupSize;
+		currentLabel += groupCount;
+
+		for(uint32_t groupIndex = 0; groupIndex < groupCount; ++groupIndex)
+		{
+			const auto& jobGroup = [jobCount, groupSize, job, groupIndex]() {
+				const uint32_t groupJobOffset = groupIndex * groupSize;
+				const uint32_t groupJobEnd = std::min(groupJobOffset + groupSize, jobCount);
+
+				JobDispatchArgs args;
+				args.groupIndex = groupIndex;
+				for(uint32_t i = groupJobOffset; i < groupJobEnd; ++i)
+				{
+					args.jobIndex = i;
+					job(args);
+				}
+			};
+
+			while(!jobPool.push_back(jobGroup))
+			{
+				poll();
+			}
+
+			wakeCondition.notify_one();
+		}
+	}
+
+	bool IsBusy()
+	{
+		return finishedLabel.load() < currentLabel;
+	}
+
+	void Wait()
+	{
+		while(IsBusy())
+		{
+			poll();
+		}
+	}
+}
+
+struct BenchmarkCase
+{
+	uint32_t jobCount;
+	uint32_t groupSize;
+};
+
+template <typename F>
+double TimeIterations(uint32_t iterations, F&& func)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	for(uint32_t i = 0; i < iterations; ++i)
+		func();
+	auto end = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration<double, std::micro>(end - start).count() / double(iterations);
+}
+
+int main(int argc, char** argv)
+{
+	using namespace Lumos;
+
+	Debug::Log::OnInit();
+	System::JobSystem::OnInit();
+	Legacy::OnInit();
+
+	const uint32_t iterations = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 200;
+
+	const BenchmarkCase cases[] = {
+		{ 1000, 4 },
+		{ 10000, 4 },
+		{ 10000, 64 },
+		{ 100000, 256 }
+	};
+
+	std::vector<float> positions(100000, 0.0f);
+	std::vector<float> velocities(100000, 1.0f);
+	const float timeStep = 1.0f / 60.0f;
+	const float damping = 0.999f;
+	float* gravity = &velocities[0];
+
+	printf("{\n\t\"iterations\" : %u,\n\t\"threads\" : %u,\n\t\"results\" : [\n", iterations, System::JobSystem::GetThreadCount());
+
+	for(size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c)
+	{
+		const BenchmarkCase& bc = cases[c];
+
+		// Capture several references so the callable does not fit std::function's small buffer
+		auto kernel = [&positions, &velocities, &timeStep, &damping, gravity](JobDispatchArgs args) {
+			velocities[args.jobIndex] = (velocities[args.jobIndex] + *gravity * timeStep) * damping;
+			positions[args.jobIndex] += velocities[args.jobIndex] * timeStep;
+		};
+
+		const double legacyTime = TimeIterations(iterations, [&]() {
+			Legacy::Dispatch(bc.jobCount, bc.groupSize, kernel);
+			Legacy::Wait();
+		});
+
+		const double newTime = TimeIterations(iterations, [&]() {
+			System::JobSystem::Dispatch(bc.jobCount, bc.groupSize, kernel);
+			System::JobSystem::Wait();
+		});
+
+		printf("\t\t{ \"jobCount\" : %u, \"groupSize\" : %u, \"legacyUs\" : %.3f, \"jobSystemUs\" : %.3f, \"speedup\" : %.2f }%s\n",
+			bc.jobCount, bc.groupSize, legacyTime, newTime, legacyTime / newTime, c + 1 < sizeof(cases) / sizeof(cases[0]) ? "," : "");
+	}
+
+	printf("\t]\n}\n");
+
+	Legacy::OnShutdown();
+	System::JobSystem::OnShutdown();
+	Debug::Log::OnRelease();
+	return 0;
+}
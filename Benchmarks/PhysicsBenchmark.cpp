@@ -0,0 +1,411 @@
+#include <LumosEngine.h>
+#include <Core/JobSystem.h>
+#include <Physics/LumosPhysicsEngine/LumosPhysicsEngine.h>
+#include <Physics/LumosPhysicsEngine/CapsuleCollisionShape.h>
+#include <Physics/LumosPhysicsEngine/CollisionDetection.h>
+#include <Physics/LumosPhysicsEngine/DynamicTreeBroadphase.h>
+#include <Physics/LumosPhysicsEngine/SortAndSweepBroadphase.h>
+#include <Physics/LumosPhysicsEngine/BruteForceBroadphase.h>
+#include <Scene/Component/Physics3DComponent.h>
+#include <Utilities/Timer.h>
+#include <Utilities/TimeStep.h>
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+// Steps LumosPhysicsEngine on a scene without a window or graphics context and reports
+// per-phase timings, pair counts and steps per second as JSON.
+//
+//	--scenario=stack|pile|rain	: layout of the spawned bodies (default pile)
+//	--bodies=N			: number of dynamic bodies (default 1000)
+//	--steps=N			: measured steps (default 600)
+//	--warmup=N			: steps run before measuring (default 60)
+//	--shapes=a,b,...		: shapes to cycle through, any of sphere, cuboid, pyramid, capsule (default all)
+//	--broadphase=tree|sap|bruteforce	: broadphase used (default tree)
+//	--integration=euler|semi|rk2|rk4	: integration type (default rk4)
+//	--narrowphase=sat|gjk		: sat uses the dedicated test per shape pair, gjk routes every pair through GJK/EPA (default sat)
+//	--ccd=on|off			: continuous collision detection on every dynamic body (default off)
+//	--iterations=N			: solver iterations (default 10)
+//	--seed=N			: random seed used for spawn positions (default 1)
+
+using namespace Lumos;
+
+enum class Scenario
+{
+	Stack,
+	Pile,
+	Rain
+};
+
+struct BenchmarkSettings
+{
+	Scenario scenario = Scenario::Pile;
+	const char* scenarioName = "pile";
+	u32 bodyCount = 1000;
+	u32 stepCount = 600;
+	u32 warmupCount = 60;
+	std::vector<CollisionShapeType> shapes = { CollisionShapeType::CollisionSphere, CollisionShapeType::CollisionCuboid, CollisionShapeType::CollisionPyramid, CollisionShapeType::CollisionCapsule };
+	const char* broadphaseName = "tree";
+	IntegrationType integrationType = IntegrationType::RUNGE_KUTTA_4;
+	const char* integrationName = "rk4";
+	bool convexNarrowphase = false;
+	const char* narrowphaseName = "sat";
+	bool continuousCollision = false;
+	u32 solverIterations = 10;
+	u32 seed = 1;
+};
+
+static const char* ShapeName(CollisionShapeType type)
+{
+	switch(type)
+	{
+	case CollisionShapeType::CollisionSphere:
+		return "sphere";
+	case CollisionShapeType::CollisionCuboid:
+		return "cuboid";
+	case CollisionShapeType::CollisionPyramid:
+		return "pyramid";
+	case CollisionShapeType::CollisionCapsule:
+		return "capsule";
+	default:
+		return "unknown";
+	}
+}
+
+static bool ParseArgument(const char* arg, const char* name, const char*& value)
+{
+	const size_t length = strlen(name);
+	if(strncmp(arg, name, length) != 0 || arg[length] != '=')
+		return false;
+
+	value = arg + length + 1;
+	return true;
+}
+
+static bool ParseSettings(int argc, char** argv, BenchmarkSettings& settings)
+{
+	for(int i = 1; i < argc; ++i)
+	{
+		const char* value = nullptr;
+
+		if(ParseArgument(argv[i], "--scenario", value))
+		{
+			if(strcmp(value, "stack") == 0)
+				settings.scenario = Scenario::Stack;
+			else if(strcmp(value, "pile") == 0)
+				settings.scenario = Scenario::Pile;
+			else if(strcmp(value, "rain") == 0)
+				settings.scenario = Scenario::Rain;
+			else
+				return false;
+
+			settings.scenarioName = value;
+		}
+		else if(ParseArgument(argv[i], "--bodies", value))
+			settings.bodyCount = static_cast<u32>(atoi(value));
+		else if(ParseArgument(argv[i], "--steps", value))
+			settings.stepCount = static_cast<u32>(atoi(value));
+		else if(ParseArgument(argv[i], "--warmup", value))
+			settings.warmupCount = static_cast<u32>(atoi(value));
+		else if(ParseArgument(argv[i], "--iterations", value))
+			settings.solverIterations = static_cast<u32>(atoi(value));
+		else if(ParseArgument(argv[i], "--seed", value))
+			settings.seed = static_cast<u32>(atoi(value));
+		else if(ParseArgument(argv[i], "--shapes", value))
+		{
+			settings.shapes.clear();
+
+			std::string list = value;
+			size_t start = 0;
+			while(start <= list.size())
+			{
+				size_t end = list.find(',', start);
+				if(end == std::string::npos)
+					end = list.size();
+
+				const std::string name = list.substr(start, end - start);
+				if(name == "sphere")
+					settings.shapes.push_back(CollisionShapeType::CollisionSphere);
+				else if(name == "cuboid")
+					settings.shapes.push_back(CollisionShapeType::CollisionCuboid);
+				else if(name == "pyramid")
+					settings.shapes.push_back(CollisionShapeType::CollisionPyramid);
+				else if(name == "capsule")
+					settings.shapes.push_back(CollisionShapeType::CollisionCapsule);
+				else
+					return false;
+
+				start = end + 1;
+			}
+		}
+		else if(ParseArgument(argv[i], "--broadphase", value))
+		{
+			if(strcmp(value, "tree") != 0 && strcmp(value, "sap") != 0 && strcmp(value, "bruteforce") != 0)
+				return false;
+
+			settings.broadphaseName = value;
+		}
+		else if(ParseArgument(argv[i], "--integration", value))
+		{
+			if(strcmp(value, "euler") == 0)
+				settings.integrationType = IntegrationType::EXPLICIT_EULER;
+			else if(strcmp(value, "semi") == 0)
+				settings.integrationType = IntegrationType::SEMI_IMPLICIT_EULER;
+			else if(strcmp(value, "rk2") == 0)
+				settings.integrationType = IntegrationType::RUNGE_KUTTA_2;
+			else if(strcmp(value, "rk4") == 0)
+				settings.integrationType = IntegrationType::RUNGE_KUTTA_4;
+			else
+				return false;
+
+			settings.integrationName = value;
+		}
+		else if(ParseArgument(argv[i], "--ccd", value))
+		{
+			if(strcmp(value, "on") != 0 && strcmp(value, "off") != 0)
+				return false;
+
+			settings.continuousCollision = strcmp(value, "on") == 0;
+		}
+		else if(ParseArgument(argv[i], "--narrowphase", value))
+		{
+			if(strcmp(value, "sat") != 0 && strcmp(value, "gjk") != 0)
+				return false;
+
+			settings.convexNarrowphase = strcmp(value, "gjk") == 0;
+			settings.narrowphaseName = value;
+		}
+		else
+			return false;
+	}
+
+	return !settings.shapes.empty();
+}
+
+static Ref<Broadphase> CreateBroadphase(const char* name)
+{
+	if(strcmp(name, "sap") == 0)
+		return CreateRef<SortAndSweepBroadphase>();
+	if(strcmp(name, "bruteforce") == 0)
+		return CreateRef<BruteForceBroadphase>();
+
+	return CreateRef<DynamicTreeBroadphase>();
+}
+
+static Ref<CollisionShape> CreateShape(CollisionShapeType type)
+{
+	switch(type)
+	{
+	case CollisionShapeType::CollisionSphere:
+		return CreateRef<SphereCollisionShape>(0.5f);
+	case CollisionShapeType::CollisionPyramid:
+		return CreateRef<PyramidCollisionShape>(Maths::Vector3(0.5f));
+	case CollisionShapeType::CollisionCapsule:
+		return CreateRef<CapsuleCollisionShape>(0.25f, 1.0f);
+	case CollisionShapeType::CollisionCuboid:
+	default:
+		return CreateRef<CuboidCollisionShape>(Maths::Vector3(0.5f));
+	}
+}
+
+static void AddBody(Scene& scene, const Ref<CollisionShape>& shape, const Maths::Vector3& position, const Maths::Vector3& velocity, bool isStatic, bool continuous)
+{
+	RigidBody3DProperties properties;
+	properties.Position = position;
+	properties.LinearVelocity = velocity;
+	properties.Static = isStatic;
+	properties.ContinuousCollision = continuous;
+	properties.Shape = shape;
+
+	Ref<RigidBody3D> body = CreateRef<RigidBody3D>(properties);
+	if(isStatic)
+		body->SetInverseMass(0.0f);
+	body->SetInverseInertia(shape->BuildInverseInertia(body->GetInverseMass()));
+
+	auto entity = scene.GetEntityManager()->Create();
+	entity.AddComponent<Physics3DComponent>(body);
+}
+
+static void BuildScenario(Scene& scene, const BenchmarkSettings& settings)
+{
+	std::mt19937 random(settings.seed);
+	std::uniform_real_distribution<float> jitter(-0.05f, 0.05f);
+
+	// Ground
+	AddBody(scene, CreateRef<CuboidCollisionShape>(Maths::Vector3(500.0f, 1.0f, 500.0f)), Maths::Vector3(0.0f, -1.0f, 0.0f), Maths::Vector3(0.0f), true, false);
+
+	std::vector<Ref<CollisionShape>> shapes;
+	for(CollisionShapeType type : settings.shapes)
+		shapes.push_back(CreateShape(type));
+
+	const u32 count = settings.bodyCount;
+
+	switch(settings.scenario)
+	{
+	case Scenario::Stack:
+	{
+		// Towers of 10 bodies resting on top of each other
+		const u32 height = 10;
+		const u32 towers = (count + height - 1) / height;
+		const u32 side = static_cast<u32>(ceilf(sqrtf(static_cast<float>(towers))));
+
+		for(u32 i = 0; i < count; ++i)
+		{
+			const u32 tower = i / height;
+			const float x = (static_cast<float>(tower % side) - side * 0.5f) * 3.0f;
+			const float z = (static_cast<float>(tower / side) - side * 0.5f) * 3.0f;
+			const float y = 0.5f + static_cast<float>(i % height) * 1.01f;
+			AddBody(scene, shapes[i % shapes.size()], Maths::Vector3(x, y, z), Maths::Vector3(0.0f), false, settings.continuousCollision);
+		}
+		break;
+	}
+	case Scenario::Pile:
+	{
+		// Dense block dropped onto a small area
+		const u32 side = Maths::Max(1u, static_cast<u32>(cbrtf(static_cast<float>(count))));
+
+		for(u32 i = 0; i < count; ++i)
+		{
+			const float x = (static_cast<float>(i % side) - side * 0.5f) * 1.1f + jitter(random);
+			const float z = (static_cast<float>((i / side) % side) - side * 0.5f) * 1.1f + jitter(random);
+			const float y = 2.0f + static_cast<float>(i / (side * side)) * 1.1f;
+			AddBody(scene, shapes[i % shapes.size()], Maths::Vector3(x, y, z), Maths::Vector3(0.0f), false, settings.continuousCollision);
+		}
+		break;
+	}
+	case Scenario::Rain:
+	{
+		// Bodies scattered over a wide area falling at different speeds
+		const float extent = Maths::Max(10.0f, sqrtf(static_cast<float>(count)) * 2.0f);
+		std::uniform_real_distribution<float> horizontal(-extent, extent);
+		std::uniform_real_distribution<float> vertical(5.0f, 5.0f + extent);
+		std::uniform_real_distribution<float> speed(-10.0f, 0.0f);
+
+		for(u32 i = 0; i < count; ++i)
+		{
+			const Maths::Vector3 position(horizontal(random), vertical(random), horizontal(random));
+			AddBody(scene, shapes[i % shapes.size()], position, Maths::Vector3(0.0f, speed(random), 0.0f), false, settings.continuousCollision);
+		}
+		break;
+	}
+	}
+}
+
+struct PhaseTotals
+{
+	double stepMs = 0.0;
+	double maxStepMs = 0.0;
+	double broadphaseMs = 0.0;
+	double narrowphaseMs = 0.0;
+	double solverMs = 0.0;
+	double integrationMs = 0.0;
+	u64 broadphasePairs = 0;
+	u32 maxBroadphasePairs = 0;
+	u64 manifolds = 0;
+	u64 contacts = 0;
+	u64 islands = 0;
+	u64 awakeBodies = 0;
+	u64 timeOfImpactHits = 0;
+};
+
+int main(int argc, char** argv)
+{
+	BenchmarkSettings settings;
+	if(!ParseSettings(argc, argv, settings))
+	{
+		fprintf(stderr, "usage: %s [--scenario=stack|pile|rain] [--bodies=N] [--steps=N] [--warmup=N] [--shapes=sphere,cuboid,pyramid,capsule] [--broadphase=tree|sap|bruteforce] [--integration=euler|semi|rk2|rk4] [--narrowphase=sat|gjk] [--ccd=on|off] [--iterations=N] [--seed=N]\n", argv[0]);
+		return 1;
+	}
+
+	Debug::Log::OnInit();
+	System::JobSystem::OnInit();
+
+	{
+		Scene scene("PhysicsBenchmark");
+		BuildScenario(scene, settings);
+
+		LumosPhysicsEngine physics;
+		physics.SetBroadphase(CreateBroadphase(settings.broadphaseName));
+		physics.SetIntegrationType(settings.integrationType);
+		physics.SetSolverIterations(settings.solverIterations);
+		physics.SetPaused(false);
+
+		for(u32 type1 = CollisionCuboid; type1 < CollisionShapeTypeMax; ++type1)
+		{
+			for(u32 type2 = type1; type2 < CollisionShapeTypeMax; ++type2)
+				CollisionDetection::Get().SetConvexCollision(CollisionShapeType(type1), CollisionShapeType(type2), settings.convexNarrowphase);
+		}
+
+		// Single update per call, the time step is used as the physics step directly
+		TimeStep timeStep(0.0f);
+		timeStep.Update(1.0f / 60.0f);
+
+		for(u32 i = 0; i < settings.warmupCount; ++i)
+			physics.OnUpdate(timeStep, &scene);
+
+		PhaseTotals totals;
+
+		for(u32 i = 0; i < settings.stepCount; ++i)
+		{
+			const TimeStamp start = Timer::Now();
+			physics.OnUpdate(timeStep, &scene);
+			const double stepMs = Timer::Duration(start, Timer::Now(), 1000.0);
+
+			const PhysicsStepStats& stats = physics.GetStepStats();
+			totals.stepMs += stepMs;
+			totals.maxStepMs = Maths::Max(totals.maxStepMs, stepMs);
+			totals.broadphaseMs += stats.broadphaseMs;
+			totals.narrowphaseMs += stats.narrowphaseMs;
+			totals.solverMs += stats.solverMs;
+			totals.integrationMs += stats.integrationMs;
+			totals.broadphasePairs += stats.broadphasePairs;
+			totals.maxBroadphasePairs = Maths::Max(totals.maxBroadphasePairs, stats.broadphasePairs);
+			totals.manifolds += stats.manifolds;
+			totals.contacts += stats.contacts;
+			totals.islands += stats.islands;
+			totals.awakeBodies += stats.awakeBodies;
+			totals.timeOfImpactHits += stats.timeOfImpactHits;
+		}
+
+		const double steps = static_cast<double>(Maths::Max(1u, settings.stepCount));
+
+		std::string shapeList;
+		for(size_t i = 0; i < settings.shapes.size(); ++i)
+		{
+			shapeList += i > 0 ? ", \"" : "\"";
+			shapeList += ShapeName(settings.shapes[i]);
+			shapeList += "\"";
+		}
+
+		printf("{\n");
+		printf("\t\"scenario\" : \"%s\",\n", settings.scenarioName);
+		printf("\t\"bodies\" : %u,\n", settings.bodyCount);
+		printf("\t\"shapes\" : [ %s ],\n", shapeList.c_str());
+		printf("\t\"broadphase\" : \"%s\",\n", settings.broadphaseName);
+		printf("\t\"integration\" : \"%s\",\n", settings.integrationName);
+		printf("\t\"narrowphase\" : \"%s\",\n", settings.narrowphaseName);
+		printf("\t\"continuousCollision\" : %s,\n", settings.continuousCollision ? "true" : "false");
+		printf("\t\"solverIterations\" : %u,\n", settings.solverIterations);
+		printf("\t\"threads\" : %u,\n", System::JobSystem::GetThreadCount());
+		printf("\t\"warmupSteps\" : %u,\n", settings.warmupCount);
+		printf("\t\"steps\" : %u,\n", settings.stepCount);
+		printf("\t\"stepsPerSecond\" : %.2f,\n", totals.stepMs > 0.0 ? 1000.0 * settings.stepCount / totals.stepMs : 0.0);
+		printf("\t\"averageStepMs\" : %.4f,\n", totals.stepMs / steps);
+		printf("\t\"maxStepMs\" : %.4f,\n", totals.maxStepMs);
+		printf("\t\"phasesMs\" : { \"broadphase\" : %.4f, \"narrowphase\" : %.4f, \"solver\" : %.4f, \"integration\" : %.4f },\n",
+			totals.broadphaseMs / steps, totals.narrowphaseMs / steps, totals.solverMs / steps, totals.integrationMs / steps);
+		printf("\t\"averageBroadphasePairs\" : %.1f,\n", totals.broadphasePairs / steps);
+		printf("\t\"maxBroadphasePairs\" : %u,\n", totals.maxBroadphasePairs);
+		printf("\t\"averageManifolds\" : %.1f,\n", totals.manifolds / steps);
+		printf("\t\"averageContacts\" : %.1f,\n", totals.contacts / steps);
+		printf("\t\"averageIslands\" : %.1f,\n", totals.islands / steps);
+		printf("\t\"averageAwakeBodies\" : %.1f,\n", totals.awakeBodies / steps);
+		printf("\t\"averageTimeOfImpactHits\" : %.1f\n", totals.timeOfImpactHits / steps);
+		printf("}\n");
+	}
+
+	System::JobSystem::OnShutdown();
+	Debug::Log::OnRelease();
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include <LumosEngine.h>
+#include <Maths/MatrixBatch.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// Compares building world matrices from translation, rotation and scale with the previous
+// Transform::UpdateMatrices path (Translation * RotationMatrix4 * Scale, then parent * local)
+// against composing 3x4 affine matrices one at a time and with the batched kernels the scene graph uses.
+
+using namespace Lumos;
+
+template <typename F>
+double TimeIterations(uint32_t iterations, F&& func)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	for(uint32_t i = 0; i < iterations; ++i)
+		func();
+	auto end = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration<double, std::micro>(end - start).count() / double(iterations);
+}
+
+static float MaxDifference(const std::vector<Maths::Matrix4>& a, const std::vector<Maths::Matrix3x4>& b)
+{
+	float result = 0.0f;
+	for(size_t i = 0; i < a.size(); ++i)
+	{
+		const float* lhs = a[i].Data();
+		const float* rhs = b[i].Data();
+		for(int j = 0; j < 12; ++j)
+			result = Maths::Max(result, Maths::Abs(lhs[j] - rhs[j]));
+	}
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+
+	const uint32_t iterations = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 200;
+	const uint32_t counts[] = { 1000, 10000, 100000 };
+
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+	std::uniform_real_distribution<float> scale(0.1f, 4.0f);
+
+	printf("{\n\t\"iterations\" : %u,\n\t\"results\" : [\n", iterations);
+
+	for(size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+	{
+		const uint32_t count = counts[c];
+
+		std::vector<Maths::Vector3> translations(count);
+		std::vector<Maths::Quaternion> rotations(count);
+		std::vector<Maths::Vector3> scales(count);
+		std::vector<Maths::Matrix4> parents(count);
+		std::vector<Maths::Matrix3x4> affineParents(count);
+
+		for(uint32_t i = 0; i < count; ++i)
+		{
+			translations[i] = Maths::Vector3(position(rng), position(rng), position(rng));
+			rotations[i] = Maths::Quaternion::EulerAnglesToQuaternion(angle(rng), angle(rng), angle(rng));
+			scales[i] = Maths::Vector3(scale(rng), scale(rng), scale(rng));
+			parents[i] = Maths::Matrix4::Translation(Maths::Vector3(position(rng), position(rng), position(rng))) * Maths::Quaternion::EulerAnglesToQuaternion(angle(rng), angle(rng), angle(rng)).RotationMatrix4();
+			affineParents[i] = Maths::Matrix3x4(parents[i]);
+		}
+
+		std::vector<Maths::Matrix4> legacyWorld(count);
+		std::vector<Maths::Matrix3x4> singleWorld(count);
+		std::vector<Maths::Matrix3x4> batchWorld(count);
+
+		const double legacyTime = TimeIterations(iterations, [&]() {
+			for(uint32_t i = 0; i < count; ++i)
+			{
+				const Maths::Matrix4 local = Maths::Matrix4::Translation(translations[i]) * rotations[i].RotationMatrix4() * Maths::Matrix4::Scale(scales[i]);
+				legacyWorld[i] = parents[i] * local;
+			}
+		});
+
+		const double singleTime = TimeIterations(iterations, [&]() {
+			for(uint32_t i = 0; i < count; ++i)
+				singleWorld[i] = affineParents[i] * Maths::ComposeAffineTRS(translations[i], rotations[i], scales[i]);
+		});
+
+		const double batchTime = TimeIterations(iterations, [&]() {
+			Maths::ComposeTRS(translations.data(), rotations.data(), scales.data(), batchWorld.data(), count);
+			Maths::MultiplyAffine(affineParents.data(), batchWorld.data(), batchWorld.data(), count);
+		});
+
+		const float error = Maths::Max(MaxDifference(legacyWorld, singleWorld), MaxDifference(legacyWorld, batchWorld));
+
+		printf("\t\t{ \"count\" : %u, \"legacyUs\" : %.3f, \"singleUs\" : %.3f, \"batchUs\" : %.3f, \"speedup\" : %.2f, \"maxError\" : %g }%s\n",
+			count, legacyTime, singleTime, batchTime, legacyTime / batchTime, error, c + 1 < sizeof(counts) / sizeof(counts[0]) ? "," : "");
+	}
+
+	printf("\t]\n}\n");
+
+	Debug::Log::OnRelease();
+	return 0;
+}
@@ -0,0 +1,210 @@
+IncludeDir = {}
+IncludeDir["GLFW"] = "../Lumos/external/glfw/include/"
+IncludeDir["Glad"] = "../Lumos/external/glad/include/"
+IncludeDir["lua"] = "../Lumos/external/lua/src/"
+IncludeDir["stb"] = "../Lumos/external/stb/"
+IncludeDir["OpenAL"] = "../Lumos/external/OpenAL/include/"
+IncludeDir["Box2D"] = "../Lumos/external/box2d/include/"
+IncludeDir["vulkan"] = "../Lumos/external/vulkan/"
+IncludeDir["Lumos"] = "../Lumos/src"
+IncludeDir["External"] = "../Lumos/external/"
+IncludeDir["ImGui"] = "../Lumos/external/imgui/"
+IncludeDir["freetype"] = "../Lumos/external/freetype/include"
+IncludeDir["SpirvCross"] = "../Lumos/external/SPIRV-Cross"
+IncludeDir["cereal"] = "../Lumos/external/cereal/include"
+IncludeDir["spdlog"] = "../Lumos/external/spdlog/include"
+
+-- Shared settings for the command line benchmark and test executables
+function SetBenchmarkSettings()
+	kind "ConsoleApp"
+	language "C++"
+
+	sysincludedirs
+	{
+		"%{IncludeDir.GLFW}",
+		"%{IncludeDir.Glad}",
+		"%{IncludeDir.lua}",
+		"%{IncludeDir.stb}",
+		"%{IncludeDir.ImGui}",
+		"%{IncludeDir.OpenAL}",
+		"%{IncludeDir.Box2D}",
+		"%{IncludeDir.vulkan}",
+		"%{IncludeDir.External}",
+		"%{IncludeDir.spdlog}",
+		"%{IncludeDir.freetype}",
+		"%{IncludeDir.SpirvCross}",
+		"%{IncludeDir.cereal}",
+		"%{IncludeDir.Lumos}",
+	}
+
+	links
+	{
+		"Lumos",
+		"lua",
+		"box2d",
+		"imgui",
+		"freetype",
+		"SpirvCross"
+	}
+
+	defines
+	{
+		"LUMOS_PROFILE",
+		"TRACY_ENABLE",
+	}
+
+	filter "system:windows"
+		cppdialect "C++17"
+		staticruntime "On"
+		systemversion "latest"
+
+		defines
+		{
+			"LUMOS_PLATFORM_WINDOWS",
+			"LUMOS_RENDER_API_OPENGL",
+			"LUMOS_RENDER_API_VULKAN",
+			"VK_USE_PLATFORM_WIN32_KHR",
+			"WIN32_LEAN_AND_MEAN",
+			"_CRT_SECURE_NO_WARNINGS",
+			"_DISABLE_EXTENDED_ALIGNED_STORAGE",
+			"_SILENCE_CXX17_ITERATOR_BASE_CLASS_DEPRECATION_WARNING",
+			"LUMOS_ROOT_DIR="  .. root_dir,
+			"LUMOS_VOLK",
+			"LUMOS_SSE",
+		}
+
+		libdirs
+		{
+			"../Lumos/external/OpenAL/libs/Win32"
+		}
+
+		links
+		{
+			"glfw",
+			"OpenGL32",
+			"OpenAL32"
+		}
+
+		disablewarnings { 4307 }
+
+	filter "system:macosx"
+		cppdialect "C++17"
+		staticruntime "On"
+		systemversion "latest"
+
+		defines
+		{
+			"LUMOS_PLATFORM_MACOS",
+			"LUMOS_PLATFORM_UNIX",
+			"LUMOS_RENDER_API_OPENGL",
+			"LUMOS_RENDER_API_VULKAN",
+			"LUMOS_IMGUI",
+			"LUMOS_ROOT_DIR="  .. root_dir,
+			"LUMOS_VOLK",
+			"LUMOS_SSE"
+		}
+
+		linkoptions
+		{
+			"-framework OpenGL",
+			"-framework Cocoa",
+			"-framework IOKit",
+			"-framework CoreVideo",
+			"-framework OpenAL",
+			"-framework QuartzCore"
+		}
+
+		links
+		{
+			"glfw",
+		}
+
+		SetRecommendedXcodeSettings()
+
+	filter "system:linux"
+		cppdialect "C++17"
+		staticruntime "On"
+		systemversion "latest"
+
+		defines
+		{
+			"LUMOS_PLATFORM_LINUX",
+			"LUMOS_PLATFORM_UNIX",
+			"LUMOS_RENDER_API_OPENGL",
+			"LUMOS_RENDER_API_VULKAN",
+			"VK_USE_PLATFORM_XCB_KHR",
+			"LUMOS_IMGUI",
+			"LUMOS_ROOT_DIR="  .. root_dir,
+			"LUMOS_VOLK"
+		}
+
+		buildoptions
+		{
+			"-fpermissive",
+			"-fPIC",
+			"-Wignored-attributes",
+			"-Wno-psabi"
+		}
+
+		links
+		{
+			"glfw",
+		}
+
+		links { "X11", "pthread", "dl", "atomic", "stdc++fs"}
+
+		linkoptions { "-L%{cfg.targetdir}", "-Wl,-rpath=\\$$ORIGIN" }
+
+		if _OPTIONS["arch"] ~= "arm" then
+			buildoptions
+			{
+				"-msse4.1",
+			}
+
+			defines { "LUMOS_SSE" ,"USE_VMA_ALLOCATOR"}
+		end
+
+	filter "configurations:Debug"
+		defines "LUMOS_DEBUG"
+		optimize "Off"
+		symbols "On"
+		runtime "Debug"
+
+	filter "configurations:Release"
+		defines "LUMOS_RELEASE"
+		optimize "On"
+		symbols "On"
+		runtime "Release"
+
+	filter "configurations:Production"
+		defines "LUMOS_PRODUCTION"
+		symbols "Off"
+		optimize "Full"
+		runtime "Release"
+
+	filter()
+end
+
+project "JobSystemBenchmark"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"JobSystemBenchmark.cpp"
+	}
+
+project "PhysicsBenchmark"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"PhysicsBenchmark.cpp"
+	}
+
+project "TransformBenchmark"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"TransformBenchmark.cpp"
+	}
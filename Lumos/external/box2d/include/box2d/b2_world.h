@@ -65,6 +65,12 @@ public:
 	/// remain in scope.
 	void SetContactListener(b2ContactListener* listener);
 
+	/// Register a task executor to solve independent islands in parallel. Islands with joints
+	/// and continuous collision are still solved on the calling thread, and PostSolve is called
+	/// from the calling thread once every island has been solved. The executor is owned by you
+	/// and must remain in scope. Pass nullptr (the default) to solve every island serially.
+	void SetTaskExecutor(b2TaskExecutor* executor);
+
 	/// Register a routine for debug drawing. The debug draw functions are called
 	/// inside with b2World::DebugDraw method. The debug draw object is owned
 	/// by you and must remain in scope.
@@ -221,6 +227,8 @@ private:
 	friend class b2Controller;
 
 	void Solve(const b2TimeStep& step);
+	void SolveParallel(const b2TimeStep& step);
+	void SynchronizeSolvedBodies();
 	void SolveTOI(const b2TimeStep& step);
 
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
@@ -241,6 +249,7 @@ private:
 
 	b2DestructionListener* m_destructionListener;
 	b2Draw* m_debugDraw;
+	b2TaskExecutor* m_taskExecutor;
 
 	// This is used to compute the time step ratio to
 	// support a variable time step.
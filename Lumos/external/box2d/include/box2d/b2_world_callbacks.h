@@ -157,4 +157,16 @@ public:
 									const b2Vec2& normal, float fraction) = 0;
 };
 
+/// Implement this class to let the world solve its islands in parallel, e.g. on a job system.
+/// See b2World::SetTaskExecutor
+class b2TaskExecutor
+{
+public:
+	virtual ~b2TaskExecutor() {}
+
+	/// Call task(index, context) once for every index in [0, count), from any thread.
+	/// Only return once every call has finished.
+	virtual void Execute(int32 count, void (*task)(int32 index, void* context), void* context) = 0;
+};
+
 #endif
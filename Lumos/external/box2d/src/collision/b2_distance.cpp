@@ -27,7 +27,12 @@
 #include "box2d/b2_polygon_shape.h"
 
 // GJK using Voronoi regions (Christer Ericson) and Barycentric coordinates.
+
+// Statistics are plain globals, which race when worlds are stepped on several threads,
+// so they are only gathered when B2_STATISTICS is defined.
+#ifdef B2_STATISTICS
 int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
+#endif
 
 void b2DistanceProxy::Set(const b2Shape* shape, int32 index)
 {
@@ -455,7 +460,9 @@ void b2Distance(b2DistanceOutput* output,
 				b2SimplexCache* cache,
 				const b2DistanceInput* input)
 {
+#ifdef B2_STATISTICS
 	++b2_gjkCalls;
+#endif
 
 	const b2DistanceProxy* proxyA = &input->proxyA;
 	const b2DistanceProxy* proxyB = &input->proxyB;
@@ -536,7 +543,9 @@ void b2Distance(b2DistanceOutput* output,
 
 		// Iteration count is equated to the number of support point calls.
 		++iter;
+#ifdef B2_STATISTICS
 		++b2_gjkIters;
+#endif
 
 		// Check for duplicate support points. This is the main termination criteria.
 		bool duplicate = false;
@@ -559,7 +568,9 @@ void b2Distance(b2DistanceOutput* output,
 		++simplex.m_count;
 	}
 
+#ifdef B2_STATISTICS
 	b2_gjkMaxIters = b2Max(b2_gjkMaxIters, iter);
+#endif
 
 	// Prepare output.
 	simplex.GetWitnessPoints(&output->pointA, &output->pointB);
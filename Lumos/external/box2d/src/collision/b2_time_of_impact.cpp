@@ -29,9 +29,13 @@
 
 #include <stdio.h>
 
+// Statistics are plain globals, which race when worlds are stepped on several threads,
+// so they are only gathered when B2_STATISTICS is defined.
+#ifdef B2_STATISTICS
 float b2_toiTime, b2_toiMaxTime;
 int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
 int32 b2_toiRootIters, b2_toiMaxRootIters;
+#endif
 
 //
 struct b2SeparationFunction
@@ -257,9 +261,11 @@ struct b2SeparationFunction
 // by computing the largest time at which separation is maintained.
 void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 {
+#ifdef B2_STATISTICS
 	b2Timer timer;
 
 	++b2_toiCalls;
+#endif
 
 	output->state = b2TOIOutput::e_unknown;
 	output->t = input->tMax;
@@ -426,7 +432,9 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 				}
 
 				++rootIterCount;
+#ifdef B2_STATISTICS
 				++b2_toiRootIters;
+#endif
 
 				float s = fcn.Evaluate(indexA, indexB, t);
 
@@ -455,7 +463,9 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 				}
 			}
 
+#ifdef B2_STATISTICS
 			b2_toiMaxRootIters = b2Max(b2_toiMaxRootIters, rootIterCount);
+#endif
 
 			++pushBackIter;
 
@@ -466,7 +476,9 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 
 		++iter;
+#ifdef B2_STATISTICS
 		++b2_toiIters;
+#endif
 
 		if (done)
 		{
@@ -482,9 +494,11 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 	}
 
+#ifdef B2_STATISTICS
 	b2_toiMaxIters = b2Max(b2_toiMaxIters, iter);
 
 	float time = timer.GetMilliseconds();
 	b2_toiMaxTime = b2Max(b2_toiMaxTime, time);
 	b2_toiTime += time;
+#endif
 }
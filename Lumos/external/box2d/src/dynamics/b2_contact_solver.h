@@ -68,6 +68,7 @@ struct b2ContactSolverDef
 	b2Position* positions;
 	b2Velocity* velocities;
 	b2StackAllocator* allocator;
+	const int32* indices;	///< island indices of each contact's bodies (A, B pairs), taken from the bodies if null
 };
 
 class b2ContactSolver
@@ -31,6 +31,7 @@ class b2Contact;
 class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
+struct b2ContactImpulse;
 struct b2ContactVelocityConstraint;
 struct b2Profile;
 
@@ -40,6 +41,14 @@ class b2Island
 public:
 	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
 			b2StackAllocator* allocator, b2ContactListener* listener);
+
+	/// Island over bodies and contacts already gathered by b2World::SolveParallel. A static body
+	/// may be part of several islands solved at the same time, so the bodies' island indices are
+	/// not written and the contact solver reads contactIndices (A, B pairs) instead. Contact
+	/// impulses are stored in impulses, if not null, for the world to report later.
+	b2Island(b2Body** bodies, int32 bodyCount, b2Contact** contacts, const int32* contactIndices,
+			int32 contactCount, b2StackAllocator* allocator, b2ContactImpulse* impulses);
+
 	~b2Island();
 
 	void Clear()
@@ -77,6 +86,9 @@ public:
 
 	b2StackAllocator* m_allocator;
 	b2ContactListener* m_listener;
+	b2ContactImpulse* m_impulses;
+	const int32* m_contactIndices;
+	bool m_ownsArrays;
 
 	b2Body** m_bodies;
 	b2Contact** m_contacts;
@@ -44,6 +44,7 @@ b2World::b2World(const b2Vec2& gravity)
 {
 	m_destructionListener = nullptr;
 	m_debugDraw = nullptr;
+	m_taskExecutor = nullptr;
 
 	m_bodyList = nullptr;
 	m_jointList = nullptr;
@@ -107,6 +108,11 @@ void b2World::SetContactListener(b2ContactListener* listener)
 	m_contactManager.m_contactListener = listener;
 }
 
+void b2World::SetTaskExecutor(b2TaskExecutor* executor)
+{
+	m_taskExecutor = executor;
+}
+
 void b2World::SetDebugDraw(b2Draw* debugDraw)
 {
 	m_debugDraw = debugDraw;
@@ -555,30 +561,359 @@ void b2World::Solve(const b2TimeStep& step)
 
 	m_stackAllocator.Free(stack);
 
+	SynchronizeSolvedBodies();
+}
+
+void b2World::SynchronizeSolvedBodies()
+{
+	b2Timer timer;
+	// Synchronize fixtures, check for out of range bodies.
+	for (b2Body* b = m_bodyList; b; b = b->GetNext())
 	{
-		b2Timer timer;
-		// Synchronize fixtures, check for out of range bodies.
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		// If a body was not in an island then it did not move.
+		if ((b->m_flags & b2Body::e_islandFlag) == 0)
+		{
+			continue;
+		}
+
+		if (b->GetType() == b2_staticBody)
 		{
-			// If a body was not in an island then it did not move.
-			if ((b->m_flags & b2Body::e_islandFlag) == 0)
+			continue;
+		}
+
+		// Update fixtures (for broad-phase).
+		b->SynchronizeFixtures();
+	}
+
+	// Look for new contacts.
+	m_contactManager.FindNewContacts();
+	m_profile.broadphase = timer.GetMilliseconds();
+}
+
+// Range of one island in the arrays gathered by b2World::SolveParallel.
+struct b2IslandRange
+{
+	int32 bodyStart;
+	int32 bodyCount;
+	int32 contactStart;
+	int32 contactCount;
+	int32 jointStart;
+	int32 jointCount;
+};
+
+struct b2IslandTaskContext
+{
+	b2TimeStep step;
+	b2Vec2 gravity;
+	bool allowSleep;
+	const b2IslandRange* islands;
+	const int32* taskIslands;
+	b2Body** bodies;
+	b2Contact** contacts;
+	const int32* contactIndices;
+	b2ContactImpulse* impulses;
+	b2Profile* profiles;
+};
+
+// Solves one island without joints, on any thread. The world's stack allocator is only
+// used from the stepping thread, so every task has its own.
+static void b2SolveIslandTask(int32 index, void* context)
+{
+	b2IslandTaskContext* taskContext = (b2IslandTaskContext*)context;
+	const b2IslandRange& range = taskContext->islands[taskContext->taskIslands[index]];
+
+	b2StackAllocator allocator;
+	b2Island island(taskContext->bodies + range.bodyStart, range.bodyCount,
+					taskContext->contacts + range.contactStart,
+					taskContext->contactIndices + 2 * range.contactStart, range.contactCount,
+					&allocator, taskContext->impulses ? taskContext->impulses + range.contactStart : nullptr);
+
+	island.Solve(taskContext->profiles + index, taskContext->step, taskContext->gravity, taskContext->allowSleep);
+}
+
+// Same as Solve, but every island is gathered first. Islands without joints are then solved
+// through the task executor. They only share static bodies, which the island solver doesn't
+// write, and their contact callbacks are buffered and reported from this thread afterwards.
+void b2World::SolveParallel(const b2TimeStep& step)
+{
+	m_profile.solveInit = 0.0f;
+	m_profile.solveVelocity = 0.0f;
+	m_profile.solvePosition = 0.0f;
+
+	// Clear all the island flags.
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b->m_flags &= ~b2Body::e_islandFlag;
+	}
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		c->m_flags &= ~b2Contact::e_islandFlag;
+	}
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->m_islandFlag = false;
+	}
+
+	// A static body is stored once for every island it is part of. It only joins an island
+	// through a contact or a joint, so there are at most that many extra entries.
+	int32 contactCapacity = m_contactManager.m_contactCount;
+	int32 bodyCapacity = m_bodyCount + contactCapacity + m_jointCount;
+
+	b2Body** bodies = (b2Body**)m_stackAllocator.Allocate(bodyCapacity * sizeof(b2Body*));
+	b2Contact** contacts = (b2Contact**)m_stackAllocator.Allocate(contactCapacity * sizeof(b2Contact*));
+	int32* contactIndices = (int32*)m_stackAllocator.Allocate(2 * contactCapacity * sizeof(int32));
+	b2Joint** joints = (b2Joint**)m_stackAllocator.Allocate(m_jointCount * sizeof(b2Joint*));
+	b2IslandRange* islands = (b2IslandRange*)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2IslandRange));
+
+	int32 bodyCount = 0;
+	int32 contactCount = 0;
+	int32 jointCount = 0;
+	int32 islandCount = 0;
+
+	// Gather all awake islands. Bodies get their island index as soon as they are found, so
+	// the contacts reaching them can store it. A static body's index is overwritten by the
+	// next island it joins.
+	int32 stackSize = m_bodyCount;
+	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	{
+		if (seed->m_flags & b2Body::e_islandFlag)
+		{
+			continue;
+		}
+
+		if (seed->IsAwake() == false || seed->IsEnabled() == false)
+		{
+			continue;
+		}
+
+		// The seed can be dynamic or kinematic.
+		if (seed->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		b2IslandRange* range = islands + islandCount++;
+		range->bodyStart = bodyCount;
+		range->contactStart = contactCount;
+		range->jointStart = jointCount;
+
+		int32 stackCount = 0;
+		stack[stackCount++] = seed;
+		seed->m_flags |= b2Body::e_islandFlag;
+		seed->m_islandIndex = bodyCount - range->bodyStart;
+		bodies[bodyCount++] = seed;
+
+		// Perform a depth first search (DFS) on the constraint graph.
+		while (stackCount > 0)
+		{
+			b2Body* b = stack[--stackCount];
+			b2Assert(b->IsEnabled() == true);
+
+			// To keep islands as small as possible, we don't
+			// propagate islands across static bodies.
+			if (b->GetType() == b2_staticBody)
 			{
 				continue;
 			}
 
-			if (b->GetType() == b2_staticBody)
+			// Make sure the body is awake (without resetting sleep timer).
+			b->m_flags |= b2Body::e_awakeFlag;
+
+			// Search all contacts connected to this body.
+			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
 			{
-				continue;
+				b2Contact* contact = ce->contact;
+
+				// Has this contact already been added to an island?
+				if (contact->m_flags & b2Contact::e_islandFlag)
+				{
+					continue;
+				}
+
+				// Is this contact solid and touching?
+				if (contact->IsEnabled() == false ||
+					contact->IsTouching() == false)
+				{
+					continue;
+				}
+
+				// Skip sensors.
+				bool sensorA = contact->m_fixtureA->m_isSensor;
+				bool sensorB = contact->m_fixtureB->m_isSensor;
+				if (sensorA || sensorB)
+				{
+					continue;
+				}
+
+				contact->m_flags |= b2Contact::e_islandFlag;
+
+				b2Body* other = ce->other;
+
+				// Add the other body unless it is already part of this island.
+				if ((other->m_flags & b2Body::e_islandFlag) == 0)
+				{
+					b2Assert(stackCount < stackSize);
+					stack[stackCount++] = other;
+					other->m_flags |= b2Body::e_islandFlag;
+					other->m_islandIndex = bodyCount - range->bodyStart;
+					bodies[bodyCount++] = other;
+				}
+
+				contacts[contactCount] = contact;
+				contactIndices[2 * contactCount] = contact->m_fixtureA->m_body->m_islandIndex;
+				contactIndices[2 * contactCount + 1] = contact->m_fixtureB->m_body->m_islandIndex;
+				++contactCount;
 			}
 
-			// Update fixtures (for broad-phase).
-			b->SynchronizeFixtures();
+			// Search all joints connect to this body.
+			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+			{
+				if (je->joint->m_islandFlag == true)
+				{
+					continue;
+				}
+
+				b2Body* other = je->other;
+
+				// Don't simulate joints connected to diabled bodies.
+				if (other->IsEnabled() == false)
+				{
+					continue;
+				}
+
+				joints[jointCount++] = je->joint;
+				je->joint->m_islandFlag = true;
+
+				if ((other->m_flags & b2Body::e_islandFlag) == 0)
+				{
+					b2Assert(stackCount < stackSize);
+					stack[stackCount++] = other;
+					other->m_flags |= b2Body::e_islandFlag;
+					other->m_islandIndex = bodyCount - range->bodyStart;
+					bodies[bodyCount++] = other;
+				}
+			}
 		}
 
-		// Look for new contacts.
-		m_contactManager.FindNewContacts();
-		m_profile.broadphase = timer.GetMilliseconds();
+		range->bodyCount = bodyCount - range->bodyStart;
+		range->contactCount = contactCount - range->contactStart;
+		range->jointCount = jointCount - range->jointStart;
+		b2Assert(bodyCount <= bodyCapacity);
+
+		// Allow static bodies to participate in other islands.
+		for (int32 i = range->bodyStart; i < bodyCount; ++i)
+		{
+			if (bodies[i]->GetType() == b2_staticBody)
+			{
+				bodies[i]->m_flags &= ~b2Body::e_islandFlag;
+			}
+		}
+	}
+
+	m_stackAllocator.Free(stack);
+
+	// Joints read their bodies' island indices, so only islands without joints can be solved
+	// while a static body is part of several of them.
+	int32* taskIslands = (int32*)m_stackAllocator.Allocate(islandCount * sizeof(int32));
+	int32 taskCount = 0;
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		if (islands[i].jointCount == 0)
+		{
+			taskIslands[taskCount++] = i;
+		}
+	}
+
+	b2ContactListener* listener = m_contactManager.m_contactListener;
+	b2ContactImpulse* impulses = nullptr;
+	if (listener)
+	{
+		impulses = (b2ContactImpulse*)m_stackAllocator.Allocate(contactCount * sizeof(b2ContactImpulse));
+	}
+	b2Profile* profiles = (b2Profile*)m_stackAllocator.Allocate(taskCount * sizeof(b2Profile));
+
+	b2IslandTaskContext taskContext;
+	taskContext.step = step;
+	taskContext.gravity = m_gravity;
+	taskContext.allowSleep = m_allowSleep;
+	taskContext.islands = islands;
+	taskContext.taskIslands = taskIslands;
+	taskContext.bodies = bodies;
+	taskContext.contacts = contacts;
+	taskContext.contactIndices = contactIndices;
+	taskContext.impulses = impulses;
+	taskContext.profiles = profiles;
+
+	if (taskCount > 1)
+	{
+		m_taskExecutor->Execute(taskCount, b2SolveIslandTask, &taskContext);
 	}
+	else if (taskCount == 1)
+	{
+		b2SolveIslandTask(0, &taskContext);
+	}
+
+	for (int32 i = 0; i < taskCount; ++i)
+	{
+		m_profile.solveInit += profiles[i].solveInit;
+		m_profile.solveVelocity += profiles[i].solveVelocity;
+		m_profile.solvePosition += profiles[i].solvePosition;
+
+		if (listener)
+		{
+			const b2IslandRange& range = islands[taskIslands[i]];
+			for (int32 j = range.contactStart; j < range.contactStart + range.contactCount; ++j)
+			{
+				listener->PostSolve(contacts[j], impulses + j);
+			}
+		}
+	}
+
+	// Islands with joints are solved one after the other, each one setting the island indices
+	// of its bodies again.
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		const b2IslandRange& range = islands[i];
+		if (range.jointCount == 0)
+		{
+			continue;
+		}
+
+		b2Island island(range.bodyCount, range.contactCount, range.jointCount, &m_stackAllocator, listener);
+		for (int32 j = 0; j < range.bodyCount; ++j)
+		{
+			island.Add(bodies[range.bodyStart + j]);
+		}
+		for (int32 j = 0; j < range.contactCount; ++j)
+		{
+			island.Add(contacts[range.contactStart + j]);
+		}
+		for (int32 j = 0; j < range.jointCount; ++j)
+		{
+			island.Add(joints[range.jointStart + j]);
+		}
+
+		b2Profile profile;
+		island.Solve(&profile, step, m_gravity, m_allowSleep);
+		m_profile.solveInit += profile.solveInit;
+		m_profile.solveVelocity += profile.solveVelocity;
+		m_profile.solvePosition += profile.solvePosition;
+	}
+
+	m_stackAllocator.Free(profiles);
+	if (impulses)
+	{
+		m_stackAllocator.Free(impulses);
+	}
+	m_stackAllocator.Free(taskIslands);
+	m_stackAllocator.Free(islands);
+	m_stackAllocator.Free(joints);
+	m_stackAllocator.Free(contactIndices);
+	m_stackAllocator.Free(contacts);
+	m_stackAllocator.Free(bodies);
+
+	SynchronizeSolvedBodies();
 }
 
 // Find TOI contacts and solve them.
@@ -943,7 +1278,14 @@ void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
 	if (m_stepComplete && step.dt > 0.0f)
 	{
 		b2Timer timer;
-		Solve(step);
+		if (m_taskExecutor)
+		{
+			SolveParallel(step);
+		}
+		else
+		{
+			Solve(step);
+		}
 		m_profile.solve = timer.GetMilliseconds();
 	}
 
@@ -343,6 +343,15 @@ pchsource "../Lumos/src/Precompiled.cpp"
 
 		links { "X11", "pthread"}
 
+		if _OPTIONS["arch"] ~= "arm" then
+			buildoptions
+			{
+				"-msse4.1",
+			}
+
+			defines { "LUMOS_SSE" ,"USE_VMA_ALLOCATOR"}
+		end
+
 		pchheader "../Lumos/src/Precompiled.h"
 		pchsource "../Lumos/src/Precompiled.cpp"
 
@@ -353,15 +362,6 @@ pchsource "../Lumos/src/Precompiled.cpp"
 		filter 'files:src/**.c'
 			flags  { 'NoPCH' }
 
-		if _OPTIONS["arch"] ~= "arm" then
-			buildoptions
-			{
-				"-msse4.1",
-			}
-
-			defines { "LUMOS_SSE" ,"USE_VMA_ALLOCATOR"}
-		end
-
 	filter "configurations:Debug"
 		defines { "LUMOS_DEBUG", "_DEBUG" }
 		symbols "On"
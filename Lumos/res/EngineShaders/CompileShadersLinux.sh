@@ -1,14 +1,48 @@
+#!/bin/sh
+# Compiles every shader in this folder to CompiledSPV. Pass -f to recompile shaders whose binary is up to date.
+echo "Compiling shaders"
 cd "$(dirname "$0")"
 
-/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V shader.vert -o /CompiledSPV/shader.vert.spv
-/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V shader.frag -o /CompiledSPV/shader.frag.spv
+if [ -n "$VULKAN_SDK" ]
+then
+    COMPILER="$VULKAN_SDK/bin/glslangValidator"
+else
+    COMPILER="glslangValidator"
+fi
 
-/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V Skybox.vert -o /CompiledSPV/Skybox.vert.spv
-/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V Skybox.frag -o /CompiledSPV/Skybox.frag.spv
+echo $COMPILER
 
-/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V DeferredColour.vert -o /CompiledSPV/DeferredColour.vert.spv
-/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V DeferredColour.frag -o /CompiledSPV/DeferredColour.frag.spv
+DSTDIR=CompiledSPV
+mkdir -p $DSTDIR
 
-/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V DeferredLight.vert -o /CompiledSPV/DeferredLight.vert.spv
-/VulkanSDK/1.1.85.0/x86_64/bin/glslangValidator -V DeferredLight.frag -o /CompiledSPV/DeferredLight.frag.spv
+FORCE=0
+if [ "$1" = "-f" ]
+then
+    FORCE=1
+fi
 
+for SRC in *.vert *.frag *.comp; do
+
+    if [ -e $SRC ]
+    then
+        OUT="$DSTDIR/$SRC.spv"
+
+        if [ -e $OUT ] && [ $FORCE -eq 0 ]
+        then
+            # don't re-compile if existing binary is newer than source file
+            NEWER="$(ls -t1 "$SRC" "$OUT" | head -1)"
+
+            if [ "$SRC" = "$NEWER" ]; then
+                echo "Compiling $OUT from:"
+                $COMPILER -V "$SRC" -o "$OUT" || exit 1
+            else
+                echo "(Unchanged $SRC)"
+            fi
+        else
+            echo "Compiling $OUT from:"
+            $COMPILER -V "$SRC" -o "$OUT" || exit 1
+        fi
+    fi
+done
+
+echo "Finished Compiling Shaders"
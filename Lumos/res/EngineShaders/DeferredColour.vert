@@ -9,7 +9,7 @@ layout(set = 0,binding = 0) uniform UniformBufferObject
 
 layout(set = 0,binding = 1) uniform UniformBufferObject2 
 {
-    mat4 model;
+    mat3x4 model[256]; // MAX_INSTANCES_PER_DRAW affine rows, indexed by gl_InstanceIndex
 } ubo2;
 
 layout(location = 0) in vec3 inPosition;
@@ -31,11 +31,11 @@ out gl_PerVertex
 
 void main() 
 {
-	fragPosition = vec4(inPosition, 1.0) * ubo2.model;
+	fragPosition = vec4(vec4(inPosition, 1.0) * ubo2.model[gl_InstanceIndex], 1.0);
     gl_Position = fragPosition * ubo.projView;
     
     fragColor = inColor;
 	fragTexCoord = inTexCoord;
-    fragNormal = normalize(inNormal) * transpose(inverse(mat3(ubo2.model)));
+    fragNormal = normalize(inNormal) * transpose(inverse(mat3(ubo2.model[gl_InstanceIndex])));
     fragTangent = inTangent;
 }
\ No newline at end of file
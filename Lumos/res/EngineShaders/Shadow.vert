@@ -14,7 +14,7 @@ layout(set = 0,binding = 0) uniform UniformBufferObject
 
 layout(set = 0,binding = 1) uniform UniformBufferObject2
 {
-    mat4 model;
+    mat3x4 model[256]; // MAX_INSTANCES_PER_DRAW affine rows, indexed by gl_InstanceIndex
 } ubo2;
 
 out gl_PerVertex
@@ -42,5 +42,5 @@ void main()
             proj = ubo.projView[3];
             break;
     }
-    gl_Position = vec4(position, 1.0) * ubo2.model * proj; 
+    gl_Position = vec4(vec4(position, 1.0) * ubo2.model[gl_InstanceIndex], 1.0) * proj; 
 }
\ No newline at end of file
@@ -11,7 +11,7 @@ layout(set = 0,binding = 0) uniform UniformBufferObject
 
 layout(set = 0,binding = 1) uniform UniformBufferObject2 
 {
-    mat4 model;
+    mat3x4 model[256]; // MAX_INSTANCES_PER_DRAW affine rows, indexed by gl_InstanceIndex
 } ubo2;
 
 layout(location = 0) in vec3 inPosition;
@@ -28,7 +28,7 @@ out gl_PerVertex
 
 void main() 
 {
-    gl_Position =vec4(inPosition, 1.0) * ubo2.model * ubo.view * ubo.proj;
+    gl_Position = vec4(vec4(inPosition, 1.0) * ubo2.model[gl_InstanceIndex], 1.0) * ubo.view * ubo.proj;
     fragColor = inColor;
 	fragTexCoord = inTexCoord;
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "Precompiled.h"
 #include "Sound.h"
 #include "Core/VFS.h"
+#include "WavLoader.h"
+#include "OggLoader.h"
 
 #ifdef LUMOS_OPENAL
 #	include "Platform/OpenAL/ALSound.h"
@@ -28,6 +30,26 @@ namespace Lumos
 #endif
 	}
 
+	Sound* Sound::CreateFromData(const std::string& name, const AudioData& data)
+	{
+#ifdef LUMOS_OPENAL
+		return new ALSound(name, data);
+#else
+		delete[] data.Data;
+		return nullptr;
+#endif
+	}
+
+	AudioData Sound::LoadData(const std::string& name, const std::string& extension)
+	{
+		if(extension == "wav")
+			return LoadWav(name);
+		else if(extension == "ogg")
+			return LoadOgg(name);
+
+		return AudioData();
+	}
+
 	double Sound::GetLength() const
 	{
 		return m_Data.Length;
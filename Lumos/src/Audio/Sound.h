@@ -11,6 +11,12 @@ namespace Lumos
 
 	public:
 		static Sound* Create(const std::string& name, const std::string& extension);
+
+		// Creates a sound from already decoded data, taking ownership of data.Data
+		static Sound* CreateFromData(const std::string& name, const AudioData& data);
+
+		// Reads and decodes a wav or ogg file without touching the audio device, safe to call from any thread
+		static AudioData LoadData(const std::string& name, const std::string& extension);
 		virtual ~Sound();
 
 		unsigned char* GetData() const
@@ -1,5 +1,6 @@
 #include "Precompiled.h"
 #include "SoundNode.h"
+#include "Core/Application.h"
 
 #ifdef LUMOS_OPENAL
 #include "Platform/OpenAL/ALSoundNode.h"
@@ -55,4 +56,34 @@ namespace Lumos
 			m_TimeLeft = m_Sound->GetLength();
 		}
 	}
+
+	void SoundNode::LoadSoundStreamed(const std::string& filePath)
+	{
+		const std::string extension = StringUtilities::GetFilePathExtension(filePath);
+
+		AssetStreamer* streamer = Application::Get().GetAssetStreamer();
+		if(!streamer || streamer->IsSynchronous())
+		{
+			m_Sound = Sound::Create(filePath, extension);
+			return;
+		}
+
+		m_StreamedSound = streamer->LoadSound(filePath, extension);
+	}
+
+	bool SoundNode::ResolveStreamedLoad()
+	{
+		if(!m_StreamedSound || m_StreamedSound->IsLoading())
+			return false;
+
+		// Assigned directly like a synchronous load, the time left was deserialised with the node
+		if(m_StreamedSound->IsReady())
+		{
+			m_StreamedSoundResource = m_StreamedSound->Get();
+			m_Sound = m_StreamedSoundResource.get();
+		}
+
+		m_StreamedSound.reset();
+		return true;
+	}
 }
@@ -3,6 +3,7 @@
 #include "Sound.h"
 #include "Maths/Maths.h"
 #include "Core/StringUtilities.h"
+#include "Utilities/AssetStreamer.h"
 
 #include <cereal/cereal.hpp>
 
@@ -57,12 +58,19 @@ namespace Lumos
 		virtual void Resume() = 0;
 		virtual void Stop() = 0;
 		virtual void SetSound(Sound *s);
+
+		// Loads the sound on the asset streamer, the node stays silent until it arrives
+		void LoadSoundStreamed(const std::string& filePath);
+
+		// Takes the sound of a finished streamed load, returns false while it is still loading
+		bool ResolveStreamedLoad();
+		const Ref<StreamedAsset<Sound>>& GetStreamedSound() const { return m_StreamedSound; }
 		
 		template<typename Archive>
 			void save(Archive& archive) const
 		{
 			archive(cereal::make_nvp("Position", m_Position), cereal::make_nvp("Radius", m_Radius), cereal::make_nvp("Pitch", m_Pitch), cereal::make_nvp("Volume", m_Volume), cereal::make_nvp("Velocity", m_Velocity), cereal::make_nvp("Looping", m_IsLooping), cereal::make_nvp("Paused", m_Paused), cereal::make_nvp("ReferenceDistance", m_ReferenceDistance), cereal::make_nvp("Global", m_IsGlobal), cereal::make_nvp("TimeLeft", m_TimeLeft), cereal::make_nvp("Stationary", m_Stationary),
-						cereal::make_nvp("SoundNodePath", m_Sound ? m_Sound->GetFilePath() : ""));
+						cereal::make_nvp("SoundNodePath", m_Sound ? m_Sound->GetFilePath() : m_StreamedSound ? m_StreamedSound->GetPath() : ""));
 			}
 		
 		template<typename Archive>
@@ -75,7 +83,7 @@ namespace Lumos
 			
 			if(!soundFilePath.empty())
 			{
-				m_Sound = Sound::Create(soundFilePath, StringUtilities::GetFilePathExtension(soundFilePath));
+				LoadSoundStreamed(soundFilePath);
 			}
 		}
 
@@ -94,6 +102,9 @@ namespace Lumos
 		float m_ReferenceDistance;
 		bool m_Stationary;
 		double m_StreamPos;
+
+		Ref<StreamedAsset<Sound>> m_StreamedSound;
+		Ref<Sound> m_StreamedSoundResource; // Keeps a streamed sound alive, m_Sound points to it
 	};
 
 }
@@ -28,6 +28,7 @@
 
 #include "Scene/EntityFactory.h"
 #include "Utilities/LoadImage.h"
+#include "Utilities/AssetStreamer.h"
 #include "Core/OS/Input.h"
 #include "Core/OS/Window.h"
 #include "Core/OS/OS.h"
@@ -160,6 +161,9 @@ namespace Lumos
 		m_SystemManager->RegisterSystem<B2PhysicsEngine>();
         
 		Graphics::Material::InitDefaultTexture();
+
+		// Needs the default texture for its placeholders
+		m_AssetStreamer = CreateUniqueRef<AssetStreamer>();
         
         m_SceneManager->LoadCurrentList();
 
@@ -205,6 +209,7 @@ namespace Lumos
 #endif
 
 		m_SceneManager.reset();
+		m_AssetStreamer.reset();
 		m_RenderManager.reset();
 		m_SystemManager.reset();
 
@@ -308,6 +313,8 @@ namespace Lumos
 		if(m_LayerStack->GetCount() > 0 || m_LayerStack->GetCount() > 0)
 		{
 			Graphics::Renderer::GetRenderer()->Begin();
+			m_AssetStreamer->Update(m_SceneManager->GetCurrentScene());
+			m_RenderManager->BeginFrame(m_SceneManager->GetCurrentScene());
 			DebugRenderer::Reset();
 
 			m_SystemManager->OnDebugDraw();
@@ -22,6 +22,7 @@ namespace Lumos
 	class ISystem;
 	class Scene;
 	class Event;
+	class AssetStreamer;
 	class WindowCloseEvent;
 	class WindowResizeEvent;
 
@@ -96,6 +97,11 @@ namespace Lumos
 		{
 			return m_RenderManager.get();
 		}
+
+		AssetStreamer* GetAssetStreamer() const
+		{
+			return m_AssetStreamer.get();
+		}
     
 		Window* GetWindow() const
 		{
@@ -291,6 +297,7 @@ namespace Lumos
 		UniqueRef<SceneManager> m_SceneManager;
 		UniqueRef<SystemManager> m_SystemManager;
 		UniqueRef<Graphics::RenderManager> m_RenderManager;
+		UniqueRef<AssetStreamer> m_AssetStreamer;
 
 		LayerStack* m_LayerStack = nullptr;
 
@@ -52,6 +52,8 @@
 #endif
 
 #define MAX_OBJECTS 2048
+// Model matrices per instanced draw, 256 3x4 matrices fit in the minimum 16KB uniform block
+#define MAX_INSTANCES_PER_DRAW 256
 
 #define STRINGIZE2(s) #s
 #define STRINGIZE(s) STRINGIZE2(s)
@@ -27,6 +27,7 @@ namespace Lumos
 	{
 		LUMOS_LOG_INFO("Shutting down System");
 		LuaManager::Release();
+		System::JobSystem::OnShutdown();
 		VFS::OnShutdown();
 		Lumos::Memory::LogMemoryInformation();
 
@@ -11,105 +11,465 @@
 #define NOMINMAX
 #include <Windows.h>
 #endif
-namespace Lumos 
+
+#define JOB_POOL_SIZE 4096
+#define JOB_POOL_MASK (JOB_POOL_SIZE - 1)
+#define JOB_FRAME_ARENA_SIZE (64 * 1024)
+#define INVALID_THREAD_INDEX 0xFFFFFFFF
+
+namespace Lumos
 {
-    namespace System 
+    namespace System
     {
-        // Fixed size very simple thread safe ring buffer
-        template <typename T, size_t capacity>
-        class ThreadSafeRingBuffer
+        // Chase-Lev work stealing deque.
+        // Only the owning thread may Push/Pop (LIFO at the bottom), any thread may Steal (FIFO from the top).
+        template <size_t capacity>
+        class WorkStealingQueue
         {
+            static_assert((capacity & (capacity - 1)) == 0, "Capacity must be a power of two");
+
         public:
-            // Push an item to the end if there is free space
-            //	Returns true if succesful
-            //	Returns false if there is not enough space
-            _FORCE_INLINE_ bool push_back(const T& item)
+            using Job = JobSystem::Job;
+
+            // Returns false if the queue is full
+            _FORCE_INLINE_ bool Push(Job* job)
+            {
+                const int64_t b = m_Bottom.load(std::memory_order_relaxed);
+                const int64_t t = m_Top.load(std::memory_order_acquire);
+
+                if (b - t >= static_cast<int64_t>(capacity))
+                    return false;
+
+                m_Jobs[b & (capacity - 1)].store(job, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                m_Bottom.store(b + 1, std::memory_order_relaxed);
+                return true;
+            }
+
+            _FORCE_INLINE_ Job* Pop()
             {
-                bool result = false;
-                lock.lock();
-                size_t next = (head + 1) % capacity;
-                if (next != tail)
+                const int64_t b = m_Bottom.load(std::memory_order_relaxed) - 1;
+                m_Bottom.store(b, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                int64_t t = m_Top.load(std::memory_order_relaxed);
+
+                if (t <= b)
                 {
-                    data[head] = item;
-                    head = next;
-                    result = true;
+                    Job* job = m_Jobs[b & (capacity - 1)].load(std::memory_order_relaxed);
+                    if (t == b)
+                    {
+                        // Last item in the queue, race against thieves
+                        if (!m_Top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                            job = nullptr;
+
+                        m_Bottom.store(b + 1, std::memory_order_relaxed);
+                    }
+                    return job;
                 }
-                lock.unlock();
-                return result;
+
+                m_Bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
             }
 
-            // Get an item if there are any
-            //	Returns true if succesful
-            //	Returns false if there are no items
-            _FORCE_INLINE_ bool pop_front(T& item)
+            _FORCE_INLINE_ Job* Steal()
             {
-                bool result = false;
-                lock.lock();
-                if (tail != head)
+                int64_t t = m_Top.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                const int64_t b = m_Bottom.load(std::memory_order_acquire);
+
+                if (t < b)
                 {
-                    item = data[tail];
-                    tail = (tail + 1) % capacity;
-                    result = true;
+                    Job* job = m_Jobs[t & (capacity - 1)].load(std::memory_order_relaxed);
+                    if (!m_Top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                        return nullptr;
+
+                    return job;
                 }
-                lock.unlock();
-                return result;
+
+                return nullptr;
             }
 
         private:
-            T data[capacity];
-            size_t head = 0;
-            size_t tail = 0;
-            std::mutex lock; // this just works better than a spinlock here (on windows)
+            alignas(64) std::atomic<int64_t> m_Top { 0 };
+            alignas(64) std::atomic<int64_t> m_Bottom { 0 };
+            std::atomic<Job*> m_Jobs[capacity];
         };
 
         namespace JobSystem
         {
+            struct JobPool
+            {
+                Job jobs[JOB_POOL_SIZE];
+                uint32_t allocated = 0;
+            };
+
+            struct FrameArena;
+
+            // Stored in front of every payload allocation
+            struct PayloadHeader
+            {
+                FrameArena* arena; // nullptr for heap allocations
+                void* block;
+            };
+
+            _FORCE_INLINE_ size_t AlignUp(size_t value, size_t alignment)
+            {
+                return (value + alignment - 1) & ~(alignment - 1);
+            }
+
+            // Linear allocator for large job payloads. Only the owning thread allocates, payloads are released
+            // out of order by whichever thread finishes their job. The ring goes back to the start once nothing
+            // in it is live, and returns nullptr instead of wrapping over payloads that are still in use.
+            struct FrameArena
+            {
+                alignas(16) uint8_t data[JOB_FRAME_ARENA_SIZE];
+                size_t offset = 0;
+                std::atomic<uint32_t> liveAllocations { 0 };
+
+                void* Allocate(size_t size, size_t alignment)
+                {
+                    if (liveAllocations.load(std::memory_order_acquire) == 0)
+                        offset = 0;
+
+                    size_t start = AlignUp(offset + sizeof(PayloadHeader), alignment);
+                    if (start + size > JOB_FRAME_ARENA_SIZE)
+                        return nullptr;
+
+                    offset = start + size;
+                    liveAllocations.fetch_add(1, std::memory_order_relaxed);
+
+                    PayloadHeader* header = reinterpret_cast<PayloadHeader*>(data + start) - 1;
+                    header->arena = this;
+                    header->block = nullptr;
+                    return data + start;
+                }
+            };
+
+            struct ThreadData
+            {
+                WorkStealingQueue<JOB_POOL_SIZE> queue;
+                JobPool pool;
+                FrameArena arena;
+                uint32_t randomSeed = 0;
+            };
+
             uint32_t numThreads = 0;
-            ThreadSafeRingBuffer<std::function<void()>, 256> jobPool;
+            std::vector<std::thread> workers;
+            std::vector<std::unique_ptr<ThreadData>> threadData; // [0] is the thread that called OnInit, [1..numThreads] are workers
+
+            // Jobs created from threads that are not owned by the job system (audio, loaders, ...)
+            std::mutex externalMutex;
+            std::deque<Job*> externalQueue;
+            std::atomic<uint32_t> externalQueued { 0 };
+            JobPool externalPool;
+            FrameArena externalArena;
+
+            // Long running jobs, only picked up by workers once they run out of frame work
+            std::mutex backgroundMutex;
+            std::deque<Job*> backgroundQueue;
+            std::atomic<uint32_t> backgroundQueued { 0 };
+            std::atomic<int32_t> backgroundJobs { 0 }; // queued or executing
+
             std::condition_variable wakeCondition;
             std::mutex wakeMutex;
-            uint64_t currentLabel = 0;
-            std::atomic<uint64_t> finishedLabel;
+            std::atomic<uint32_t> sleepingThreads { 0 };
+            std::atomic<int32_t> queuedJobs { 0 };
+            std::atomic<int64_t> pendingJobs { 0 };
+            std::atomic<bool> running { false };
 
-            void OnInit()
+            thread_local uint32_t threadIndex = INVALID_THREAD_INDEX;
+
+            _FORCE_INLINE_ uint32_t NextRandom(uint32_t& state)
+            {
+                // xorshift32
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                return state;
+            }
+
+            void* Internal::AllocatePayloadMemory(size_t size, size_t alignment)
+            {
+                alignment = Maths::Max(alignment, alignof(PayloadHeader));
+
+                void* data = nullptr;
+                if (threadIndex != INVALID_THREAD_INDEX)
+                {
+                    data = threadData[threadIndex]->arena.Allocate(size, alignment);
+                }
+                else
+                {
+                    std::lock_guard<std::mutex> lock(externalMutex);
+                    data = externalArena.Allocate(size, alignment);
+                }
+
+                if (data)
+                    return data;
+
+                // The ring is full of payloads of unfinished jobs
+                uint8_t* block = static_cast<uint8_t*>(::operator new(sizeof(PayloadHeader) + size + alignment));
+                data = block + AlignUp(reinterpret_cast<uintptr_t>(block) + sizeof(PayloadHeader), alignment) - reinterpret_cast<uintptr_t>(block);
+
+                PayloadHeader* header = static_cast<PayloadHeader*>(data) - 1;
+                header->arena = nullptr;
+                header->block = block;
+                return data;
+            }
+
+            void Internal::ReleasePayloadMemory(void* data)
+            {
+                PayloadHeader* header = static_cast<PayloadHeader*>(data) - 1;
+                if (header->arena)
+                    header->arena->liveAllocations.fetch_sub(1, std::memory_order_release);
+                else
+                    ::operator delete(header->block);
+            }
+
+            void Finish(Job* job)
+            {
+                const int32_t unfinished = job->unfinishedJobs.fetch_sub(1) - 1;
+                if (unfinished == 0)
+                {
+                    // Children may reference the payload, so it lives until the whole subtree is done
+                    if (job->destructor)
+                        job->destructor(job->payload);
+
+                    Job* parent = job->parent;
+                    job->generation.fetch_add(1, std::memory_order_release);
+
+                    if (parent)
+                        Finish(parent);
+                }
+            }
+
+            void ExecuteJob(Job* job)
+            {
+                if (job->function)
+                    job->function(job->payload);
+
+                Finish(job);
+                pendingJobs.fetch_sub(1);
+            }
+
+            Job* GetBackgroundJob()
+            {
+                if (backgroundQueued.load() == 0)
+                    return nullptr;
+
+                std::lock_guard<std::mutex> lock(backgroundMutex);
+                if (backgroundQueue.empty())
+                    return nullptr;
+
+                Job* job = backgroundQueue.front();
+                backgroundQueue.pop_front();
+                backgroundQueued.fetch_sub(1);
+                return job;
+            }
+
+            void ExecuteBackgroundJob(Job* job)
+            {
+                if (job->function)
+                    job->function(job->payload);
+
+                Finish(job);
+                backgroundJobs.fetch_sub(1);
+            }
+
+            void PushJob(Job* job)
+            {
+                bool pushed = false;
+                if (threadIndex != INVALID_THREAD_INDEX)
+                {
+                    pushed = threadData[threadIndex]->queue.Push(job);
+                }
+                else
+                {
+                    std::lock_guard<std::mutex> lock(externalMutex);
+                    externalQueue.push_back(job);
+                    externalQueued.fetch_add(1);
+                    pushed = true;
+                }
+
+                if (!pushed)
+                {
+                    // Queue is full, caller executes the job itself
+                    ExecuteJob(job);
+                    return;
+                }
+
+                queuedJobs.fetch_add(1);
+
+                // Only take the lock when there is somebody to wake up
+                if (sleepingThreads.load() > 0)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(wakeMutex);
+                    }
+                    wakeCondition.notify_one();
+                }
+            }
+
+            Job* GetJob()
+            {
+                Job* job = nullptr;
+
+                if (threadIndex != INVALID_THREAD_INDEX)
+                {
+                    job = threadData[threadIndex]->queue.Pop();
+                    if (job)
+                    {
+                        queuedJobs.fetch_sub(1);
+                        return job;
+                    }
+                }
+
+                if (externalQueued.load() > 0)
+                {
+                    std::lock_guard<std::mutex> lock(externalMutex);
+                    if (!externalQueue.empty())
+                    {
+                        job = externalQueue.front();
+                        externalQueue.pop_front();
+                        externalQueued.fetch_sub(1);
+                        queuedJobs.fetch_sub(1);
+                        return job;
+                    }
+                }
+
+                // Try to steal from another thread, starting at a random victim
+                const uint32_t queueCount = static_cast<uint32_t>(threadData.size());
+                if (queueCount == 0)
+                    return nullptr;
+
+                static thread_local uint32_t externalSeed = 0x9E3779B9;
+                uint32_t& seed = threadIndex != INVALID_THREAD_INDEX ? threadData[threadIndex]->randomSeed : externalSeed;
+                const uint32_t start = NextRandom(seed) % queueCount;
+
+                for (uint32_t i = 0; i < queueCount; ++i)
+                {
+                    const uint32_t victim = (start + i) % queueCount;
+                    if (victim == threadIndex)
+                        continue;
+
+                    job = threadData[victim]->queue.Steal();
+                    if (job)
+                    {
+                        queuedJobs.fetch_sub(1);
+                        return job;
+                    }
+                }
+
+                return nullptr;
+            }
+
+            // Returns the next job slot that is not in flight, or nullptr if every slot is
+            Job* FindFreeJob(JobPool& pool)
+            {
+                for (uint32_t i = 0; i < JOB_POOL_SIZE; ++i)
+                {
+                    Job* job = &pool.jobs[pool.allocated++ & JOB_POOL_MASK];
+                    if ((job->generation.load(std::memory_order_acquire) & 1) == 0)
+                        return job;
+                }
+
+                return nullptr;
+            }
+
+            Job* Internal::AllocateJob(Job* parent)
+            {
+                Job* job = nullptr;
+                while (!job)
+                {
+                    if (threadIndex != INVALID_THREAD_INDEX)
+                    {
+                        job = FindFreeJob(threadData[threadIndex]->pool);
+                    }
+                    else
+                    {
+                        std::lock_guard<std::mutex> lock(externalMutex);
+                        job = FindFreeJob(externalPool);
+                    }
+
+                    if (!job)
+                    {
+                        // Every slot is still in flight, help out until one is released
+                        Job* other = GetJob();
+                        if (other)
+                            ExecuteJob(other);
+                        else
+                            std::this_thread::yield();
+                    }
+                }
+
+                if (parent)
+                    parent->unfinishedJobs.fetch_add(1);
+
+                // Marks the slot in use. Handles to its previous job no longer match, so they read as
+                // completed even once unfinishedJobs is set again.
+                job->generation.fetch_add(1);
+                job->function = nullptr;
+                job->destructor = nullptr;
+                job->parent = parent;
+                job->unfinishedJobs.store(1);
+                return job;
+            }
+
+            void WorkerLoop(uint32_t index)
             {
-                finishedLabel.store(0);
+                threadIndex = index;
 
+                while (running.load(std::memory_order_relaxed))
+                {
+                    Job* job = GetJob();
+                    if (job)
+                    {
+                        ExecuteJob(job);
+                        continue;
+                    }
+
+                    job = GetBackgroundJob();
+                    if (job)
+                    {
+                        ExecuteBackgroundJob(job);
+                        continue;
+                    }
+
+                    // no job, put thread to sleep until something is queued
+                    std::unique_lock<std::mutex> lock(wakeMutex);
+                    sleepingThreads.fetch_add(1);
+                    wakeCondition.wait(lock, [] { return queuedJobs.load() > 0 || backgroundQueued.load() > 0 || !running.load(); });
+                    sleepingThreads.fetch_sub(1);
+                }
+            }
+
+            void OnInit()
+            {
                 // Retrieve the number of hardware threads in this System:
                 auto numCores = std::thread::hardware_concurrency();
 
-                // Calculate the actual number of worker threads we want:
-                numThreads = Lumos::Maths::Max(1U, numCores);
+                // Calculate the actual number of worker threads we want. The calling thread also executes jobs while waiting.
+                numThreads = numCores > 1 ? numCores - 1 : 1U;
 
-                for (uint32_t threadID = 0; threadID < numThreads; ++threadID)
+                threadData.resize(numThreads + 1);
+                for (uint32_t i = 0; i < numThreads + 1; ++i)
                 {
-                    std::thread worker([] {
-
-                        std::function<void()> job;
+                    threadData[i] = std::make_unique<ThreadData>();
+                    threadData[i]->randomSeed = 0x9E3779B9 ^ (i * 0x85EBCA6B + 1);
+                }
 
-                        while (true)
-                        {
-                            if (jobPool.pop_front(job))
-                            {
-                                job(); // execute job
-                                finishedLabel.fetch_add(1); // update worker label state
-                            }
-                            else
-                            {
-                                // no job, put thread to sleep
-                                std::unique_lock<std::mutex> lock(wakeMutex);
-                                wakeCondition.wait(lock);
-                            }
-                        }
+                threadIndex = 0;
+                running.store(true);
 
-                    });
+                for (uint32_t threadID = 0; threadID < numThreads; ++threadID)
+                {
+                    workers.emplace_back(WorkerLoop, threadID + 1);
 
         #ifdef LUMOS_PLATFORM_WINDOWS
                     // Do Windows-specific thread setup:
-                    HANDLE handle = (HANDLE)worker.native_handle();
+                    HANDLE handle = (HANDLE)workers.back().native_handle();
 
                     // Put each thread on to dedicated core
-                    DWORD_PTR affinityMask = 1ull << threadID; 
+                    DWORD_PTR affinityMask = 1ull << (threadID + 1);
                     DWORD_PTR affinity_result = SetThreadAffinityMask(handle, affinityMask);
                     LUMOS_ASSERT(affinity_result > 0,"");
                     // Name the thread:
@@ -118,18 +478,37 @@ namespace Lumos
                     HRESULT hr = SetThreadDescription(handle, wss.str().c_str());
                     LUMOS_ASSERT(SUCCEEDED(hr),"");
         #endif // LUMOS_PLATFORM_WINDOWS
-
-                    worker.detach();
                 }
 
                 LUMOS_LOG_INFO("Initialised JobSystem with [{0} cores] [{1} threads]" ,numCores, numThreads);
             }
 
-            // This little function will not let the System to be deadlocked while the main thread is waiting for something
-            _FORCE_INLINE_ void poll()
+            void OnShutdown()
             {
-                wakeCondition.notify_one(); // wake one worker thread
-                std::this_thread::yield(); // allow this thread to be rescheduled
+                Wait();
+
+                // Finish outstanding background work, helping out with whatever is still queued
+                while (backgroundJobs.load() > 0)
+                {
+                    Job* job = GetBackgroundJob();
+                    if (job)
+                        ExecuteBackgroundJob(job);
+                    else
+                        std::this_thread::yield();
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(wakeMutex);
+                    running.store(false);
+                }
+                wakeCondition.notify_all();
+
+                for (auto& worker : workers)
+                    worker.join();
+
+                workers.clear();
+                threadData.clear();
+                threadIndex = INVALID_THREAD_INDEX;
             }
 
             uint32_t GetThreadCount()
@@ -137,68 +516,74 @@ namespace Lumos
                 return numThreads;
             }
 
-            void Execute(const std::function<void()>& job)
+            JobHandle CreateJob()
             {
-                // The main thread label state is updated:
-                currentLabel += 1;
-
-                // Try to push a new job until it is pushed successfully:
-                while (!jobPool.push_back(job)) { poll(); }
+                return Internal::MakeHandle(Internal::AllocateJob(nullptr));
+            }
 
-                wakeCondition.notify_one(); // wake one thread
+            void Run(JobHandle handle)
+            {
+                pendingJobs.fetch_add(1);
+                PushJob(handle.job);
             }
 
-            void Dispatch(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job)
+            void RunBackground(JobHandle handle)
             {
-                if (jobCount == 0 || groupSize == 0)
+                backgroundJobs.fetch_add(1);
                 {
-                    return;
+                    std::lock_guard<std::mutex> lock(backgroundMutex);
+                    backgroundQueue.push_back(handle.job);
+                    backgroundQueued.fetch_add(1);
                 }
 
-                // Calculate the amount of job groups to dispatch (overestimate, or "ceil"):
-                const uint32_t groupCount = (jobCount + groupSize - 1) / groupSize;
-
-                // The main thread label state is updated:
-                currentLabel += groupCount;
-
-                for (uint32_t groupIndex = 0; groupIndex < groupCount; ++groupIndex)
+                if (sleepingThreads.load() > 0)
                 {
-                    // For each group, generate one real job:
-                    const auto& jobGroup = [jobCount, groupSize, job, groupIndex]() {
-
-                        // Calculate the current group's offset into the jobs:
-                        const uint32_t groupJobOffset = groupIndex * groupSize;
-                        const uint32_t groupJobEnd = Lumos::Maths::Min(groupJobOffset + groupSize, jobCount);
-
-                        JobDispatchArgs args;
-                        args.groupIndex = groupIndex;
+                    {
+                        std::lock_guard<std::mutex> lock(wakeMutex);
+                    }
+                    wakeCondition.notify_one();
+                }
+            }
 
-                        // Inside the group, loop through all job indices and execute job for each index:
-                        for (uint32_t i = groupJobOffset; i < groupJobEnd; ++i)
-                        {
-                            args.jobIndex = i;
-                            job(args);
-                        }
-                    };
+            bool IsCompleted(JobHandle handle)
+            {
+                if (!handle.IsValid())
+                    return true;
 
-                    // Try to push a new job until it is pushed successfully:
-                    while (!jobPool.push_back(jobGroup)) { poll(); }
+                // A reused slot bumps the generation before it is marked unfinished, so reading the generation
+                // after unfinishedJobs catches a handle whose slot was taken by another job
+                const int32_t unfinished = handle.job->unfinishedJobs.load();
+                return unfinished <= 0 || handle.job->generation.load() != handle.generation;
+            }
 
-                    wakeCondition.notify_one(); // wake one thread
+            void Wait(JobHandle handle)
+            {
+                while (!IsCompleted(handle))
+                {
+                    Job* job = GetJob();
+                    if (job)
+                        ExecuteJob(job);
+                    else
+                        std::this_thread::yield();
                 }
-
-
             }
 
             bool IsBusy()
             {
-                // Whenever the main thread label is not reached by the workers, it indicates that some worker is still alive
-                return finishedLabel.load() < currentLabel;
+                // Jobs that have been run but not yet executed
+                return pendingJobs.load() > 0;
             }
 
             void Wait()
             {
-                while (IsBusy()) { poll(); }
+                while (IsBusy())
+                {
+                    Job* job = GetJob();
+                    if (job)
+                        ExecuteJob(job);
+                    else
+                        std::this_thread::yield();
+                }
             }
         }
     }
@@ -1,34 +1,230 @@
 #pragma once
 
+#include <atomic>
+#include <new>
+#include <type_traits>
+
+#define JOB_PAYLOAD_SIZE 96
+
 struct JobDispatchArgs
 {
 	uint32_t jobIndex;
 	uint32_t groupIndex;
 };
 
-namespace Lumos 
+namespace Lumos
 {
-    namespace System 
+    namespace System
     {
         namespace JobSystem
         {
+            // Jobs are pooled per thread and store their callable inline, so creating and running
+            // a job never touches the heap. Callables larger than JOB_PAYLOAD_SIZE are placed in a
+            // per-thread payload ring instead, or on the heap if the ring is full.
+            struct alignas(64) Job
+            {
+                void (*function)(void* payload) = nullptr;
+                void (*destructor)(void* payload) = nullptr;
+                Job* parent = nullptr;
+                std::atomic<int32_t> unfinishedJobs { 0 };
+                std::atomic<uint32_t> generation { 0 }; // Odd while the slot is in use, bumped on allocation and once finished
+                alignas(16) unsigned char payload[JOB_PAYLOAD_SIZE];
+            };
+
+            // Lightweight reference to a job. Once the job has completed its slot can be recycled, the
+            // generation tells the handle apart from the slot's next job so it still reads as completed.
+            struct JobHandle
+            {
+                Job* job = nullptr;
+                uint32_t generation = 0;
+
+                bool IsValid() const { return job != nullptr; }
+            };
+
+            namespace Internal
+            {
+                Job* AllocateJob(Job* parent);
+
+                inline JobHandle MakeHandle(Job* job)
+                {
+                    return { job, job->generation.load(std::memory_order_relaxed) };
+                }
+
+                // Memory for a payload that doesn't fit inside its job. Comes from the calling thread's ring, which
+                // only wraps once every payload in it has been released, otherwise from the heap.
+                void* AllocatePayloadMemory(size_t size, size_t alignment);
+                void ReleasePayloadMemory(void* data);
+
+                // Construct a copy of data inside the job, destroyed once the job and all of its children finish
+                template <typename T, typename... Args>
+                T* Emplace(Job* job, Args&&... args)
+                {
+                    if constexpr (sizeof(T) <= JOB_PAYLOAD_SIZE && alignof(T) <= 16)
+                    {
+                        T* data = new (job->payload) T(std::forward<Args>(args)...);
+                        if (!std::is_trivially_destructible<T>::value)
+                            job->destructor = [](void* payload) { static_cast<T*>(payload)->~T(); };
+                        return data;
+                    }
+                    else
+                    {
+                        T* data = new (AllocatePayloadMemory(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+                        new (job->payload) T*(data);
+                        job->destructor = [](void* payload) {
+                            T* data = *static_cast<T**>(payload);
+                            data->~T();
+                            ReleasePayloadMemory(data);
+                        };
+                        return data;
+                    }
+                }
+
+                template <typename T>
+                T* GetPayload(void* payload)
+                {
+                    if constexpr (sizeof(T) <= JOB_PAYLOAD_SIZE && alignof(T) <= 16)
+                        return static_cast<T*>(payload);
+                    else
+                        return *static_cast<T**>(payload);
+                }
+
+                template <typename F>
+                void SetFunction(Job* job, F&& func)
+                {
+                    using Functor = typename std::decay<F>::type;
+                    Emplace<Functor>(job, std::forward<F>(func));
+                    job->function = [](void* payload) { (*GetPayload<Functor>(payload))(); };
+                }
+            }
+
             void OnInit();
+            void OnShutdown();
 
             uint32_t GetThreadCount();
 
+            // Create an empty job without scheduling it. Useful as a parent to group other jobs.
+            JobHandle CreateJob();
+
+            // Create a job without scheduling it. Children can be attached before calling Run.
+            template <typename F>
+            JobHandle CreateJob(F&& job)
+            {
+                JobHandle handle = CreateJob();
+                Internal::SetFunction(handle.job, std::forward<F>(job));
+                return handle;
+            }
+
+            // Create a job that has to finish before its parent is considered complete.
+            template <typename F>
+            JobHandle CreateChildJob(JobHandle parent, F&& job)
+            {
+                JobHandle handle = Internal::MakeHandle(Internal::AllocateJob(parent.job));
+                Internal::SetFunction(handle.job, std::forward<F>(job));
+                return handle;
+            }
+
+            // Push a created job onto the calling thread's queue. Idle threads will steal it.
+            void Run(JobHandle handle);
+
+            // True once the job and all of its children have executed
+            bool IsCompleted(JobHandle handle);
+
+            // Wait for a single job (and its children). The waiting thread executes queued jobs meanwhile.
+            void Wait(JobHandle handle);
+
             // Add a job to execute asynchronously. Any idle thread will execute this job.
-            void Execute(const std::function<void()>& job);
+            template <typename F>
+            JobHandle Execute(F&& job)
+            {
+                JobHandle handle = CreateJob(std::forward<F>(job));
+                Run(handle);
+                return handle;
+            }
+
+            // Queue a created job for worker threads only. Threads waiting on other jobs never pick it up and
+            // Wait()/IsBusy() ignore it, so long running work like file loading can't stall a frame.
+            void RunBackground(JobHandle handle);
+
+            // Add a long running job to execute asynchronously on a worker thread. See RunBackground.
+            // The job can run for a long time, so its captures have to fit inside the job itself instead of
+            // holding on to the calling thread's payload ring.
+            template <typename F>
+            JobHandle ExecuteBackground(F&& job)
+            {
+                using Functor = typename std::decay<F>::type;
+                static_assert(sizeof(Functor) <= JOB_PAYLOAD_SIZE && alignof(Functor) <= 16, "Background job captures must fit in JOB_PAYLOAD_SIZE");
+
+                JobHandle handle = CreateJob(std::forward<F>(job));
+                RunBackground(handle);
+                return handle;
+            }
 
             // Divide a job onto multiple jobs and execute in parallel.
             //	jobCount	: how many jobs to generate for this task.
             //	groupSize	: how many jobs to execute per thread. Jobs inside a group execute serially. It might be worth to increase for small jobs
             //	func		: receives a JobDispatchArgs as parameter
-            void Dispatch(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job);
+            // Returns a handle to a parent job that completes once every group has executed.
+            // The function is copied once into the parent job, groups only reference it.
+            template <typename F>
+            JobHandle Dispatch(uint32_t jobCount, uint32_t groupSize, F&& func)
+            {
+                using Functor = typename std::decay<F>::type;
+
+                struct DispatchGroup
+                {
+                    const Functor* function;
+                    uint32_t jobCount;
+                    uint32_t groupSize;
+                    uint32_t groupIndex;
+                };
+
+                if (jobCount == 0 || groupSize == 0)
+                {
+                    return {};
+                }
+
+                // Calculate the amount of job groups to dispatch (overestimate, or "ceil"):
+                const uint32_t groupCount = (jobCount + groupSize - 1) / groupSize;
+
+                // The root owns the function and is only destroyed after every group has finished
+                JobHandle root = CreateJob();
+                const Functor* function = Internal::Emplace<Functor>(root.job, std::forward<F>(func));
+
+                for (uint32_t groupIndex = 0; groupIndex < groupCount; ++groupIndex)
+                {
+                    // For each group, generate one real job:
+                    Job* group = Internal::AllocateJob(root.job);
+                    Internal::Emplace<DispatchGroup>(group, DispatchGroup { function, jobCount, groupSize, groupIndex });
+                    group->function = [](void* payload) {
+                        const DispatchGroup& data = *static_cast<DispatchGroup*>(payload);
+
+                        // Calculate the current group's offset into the jobs:
+                        const uint32_t groupJobOffset = data.groupIndex * data.groupSize;
+                        const uint32_t groupJobEnd = groupJobOffset + data.groupSize < data.jobCount ? groupJobOffset + data.groupSize : data.jobCount;
+
+                        JobDispatchArgs args;
+                        args.groupIndex = data.groupIndex;
+
+                        // Inside the group, loop through all job indices and execute job for each index:
+                        for (uint32_t i = groupJobOffset; i < groupJobEnd; ++i)
+                        {
+                            args.jobIndex = i;
+                            (*data.function)(args);
+                        }
+                    };
+
+                    Run(Internal::MakeHandle(group));
+                }
+
+                Run(root);
+                return root;
+            }
 
             // Check if any threads are working currently or not
             bool IsBusy();
 
-            // Wait until all threads become idle
+            // Wait until all threads become idle. The calling thread helps execute queued jobs.
+            // Never call this from inside a job, the calling job itself counts as busy. Use Wait(handle) instead.
             void Wait();
         }
     }
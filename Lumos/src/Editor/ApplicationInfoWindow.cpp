@@ -9,6 +9,7 @@
 #include "Graphics/Layers/LayerStack.h"
 #include "Graphics/RenderManager.h"
 #include "Graphics/GBuffer.h"
+#include "Utilities/AssetStreamer.h"
 #include "ImGui/ImGuiHelpers.h"
 #include <imgui/imgui.h>
 
@@ -31,6 +32,10 @@ namespace Lumos
 
 				if(ImGui::TreeNode("Systems"))
 				{
+					bool parallelUpdate = systems->GetParallelUpdate();
+					if(ImGui::Checkbox("Parallel Update", &parallelUpdate))
+						systems->SetParallelUpdate(parallelUpdate);
+
 					systems->OnImGui();
 					ImGui::TreePop();
 				}
@@ -42,6 +47,12 @@ namespace Lumos
 					ImGui::TreePop();
 				}
 
+				if(ImGui::TreeNode("Asset Streaming"))
+				{
+					Application::Get().GetAssetStreamer()->OnImGui();
+					ImGui::TreePop();
+				}
+
 				ImGui::NewLine();
 				ImGui::Text("FPS : %5.2i", Engine::Get().Statistics().FramesPerSecond);
 				ImGui::Text("UPS : %5.2i", Engine::Get().Statistics().UpdatesPerSecond);
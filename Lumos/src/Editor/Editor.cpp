@@ -1195,7 +1195,7 @@ namespace Lumos
 				{
 					if(mesh->GetActive())
 					{
-						auto& worldTransform = trans.GetWorldMatrix();
+						auto& worldTransform = trans.GetWorldMatrix3x4();
 						auto bbCopy = mesh->GetBoundingBox()->Transformed(worldTransform);
 						DebugRenderer::DebugDraw(bbCopy, Maths::Vector4(0.1f, 0.9f, 0.1f, 0.4f), true);
 					}
@@ -1212,11 +1212,11 @@ namespace Lumos
 				const auto& [sprite, trans] = group.get<Graphics::Sprite, Maths::Transform>(entity);
                 
 				{
-					auto& worldTransform = trans.GetWorldMatrix();
+					auto& worldTransform = trans.GetWorldMatrix3x4();
                     
 					auto bb =
 						Maths::BoundingBox(Maths::Rect(sprite.GetPosition(), sprite.GetPosition() + sprite.GetScale()));
-					bb.Transform(trans.GetWorldMatrix());
+					bb.Transform(worldTransform);
 					DebugRenderer::DebugDraw(bb, Maths::Vector4(0.1f, 0.9f, 0.1f, 0.4f), true);
 				}
 			}
@@ -1248,7 +1248,7 @@ namespace Lumos
 				{
 					if(mesh->GetActive())
 					{
-						auto& worldTransform = transform->GetWorldMatrix();
+						auto& worldTransform = transform->GetWorldMatrix3x4();
 						auto bbCopy = mesh->GetBoundingBox()->Transformed(worldTransform);
 						DebugRenderer::DebugDraw(bbCopy, Maths::Vector4(0.1f, 0.9f, 0.1f, 0.4f), true);
 					}
@@ -1259,7 +1259,7 @@ namespace Lumos
 			if(transform && sprite)
 			{
 				{
-					auto& worldTransform = transform->GetWorldMatrix();
+					auto& worldTransform = transform->GetWorldMatrix3x4();
                     
 					auto bb = Maths::BoundingBox(
                                                  Maths::Rect(sprite->GetPosition(), sprite->GetPosition() + sprite->GetScale()));
@@ -1272,7 +1272,7 @@ namespace Lumos
 			if(transform && animSprite)
 			{
 				{
-					auto& worldTransform = transform->GetWorldMatrix();
+					auto& worldTransform = transform->GetWorldMatrix3x4();
                     
 					auto bb = Maths::BoundingBox(Maths::Rect(animSprite->GetPosition(), animSprite->GetPosition() + animSprite->GetScale()));
 					bb.Transform(worldTransform);
@@ -1322,7 +1322,7 @@ namespace Lumos
 			{
 				if(mesh->GetActive())
 				{
-					auto& worldTransform = trans.GetWorldMatrix();
+					auto& worldTransform = trans.GetWorldMatrix3x4();
                     
 					auto bbCopy = mesh->GetBoundingBox()->Transformed(worldTransform);
 					float dist = ray.HitDistance(bbCopy);
@@ -1368,9 +1368,9 @@ namespace Lumos
 		{
 			const auto& [sprite, trans] = spriteGroup.get<Graphics::Sprite, Maths::Transform>(entity);
             
-			auto& worldTransform = trans.GetWorldMatrix();
+			auto& worldTransform = trans.GetWorldMatrix3x4();
 			auto bb = Maths::BoundingBox(Maths::Rect(sprite.GetPosition(), sprite.GetPosition() + sprite.GetScale()));
-			bb.Transform(trans.GetWorldMatrix());
+			bb.Transform(worldTransform);
 			float dist = ray.HitDistance(bb);
             
 			if(dist < Maths::M_INFINITY)
@@ -1389,9 +1389,9 @@ namespace Lumos
 		{
 			const auto& [sprite, trans] = animSpriteGroup.get<Graphics::AnimatedSprite, Maths::Transform>(entity);
             
-			auto& worldTransform = trans.GetWorldMatrix();
+			auto& worldTransform = trans.GetWorldMatrix3x4();
 			auto bb = Maths::BoundingBox(Maths::Rect(sprite.GetPosition(), sprite.GetPosition() + sprite.GetScale()));
-			bb.Transform(trans.GetWorldMatrix());
+			bb.Transform(worldTransform);
 			float dist = ray.HitDistance(bb);
             
 			if(dist < Maths::M_INFINITY)
@@ -1498,7 +1498,7 @@ namespace Lumos
             .ToMatrix4();
 		m_PreviewRenderer->Begin();
 		m_PreviewRenderer->BeginScene(proj, view);
-		m_PreviewRenderer->SubmitMesh(m_PreviewSphere.get(), nullptr, Maths::Matrix4(), Maths::Matrix4());
+		m_PreviewRenderer->SubmitMesh(m_PreviewSphere.get(), nullptr, Maths::Matrix3x4(), Maths::Matrix4());
         m_PreviewRenderer->SetSystemUniforms(m_PreviewRenderer->GetShader().get());
 		m_PreviewRenderer->Present();
 		m_PreviewRenderer->End();
@@ -284,6 +284,7 @@ namespace MM
 		auto friction = phys.GetRigidBody()->GetFriction();
 		auto isStatic = phys.GetRigidBody()->GetIsStatic();
 		auto isRest = phys.GetRigidBody()->GetIsAtRest();
+		auto isContinuous = phys.GetRigidBody()->GetContinuousCollision();
 		auto mass = 1.0f / phys.GetRigidBody()->GetInverseMass();
 		auto velocity = phys.GetRigidBody()->GetLinearVelocity();
 		auto elasticity = phys.GetRigidBody()->GetElasticity();
@@ -400,6 +401,16 @@ namespace MM
 		ImGui::PopItemWidth();
 		ImGui::NextColumn();
 
+		ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted("Continuous Collision");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		if(ImGui::Checkbox("##Continuous Collision", &isContinuous))
+			phys.GetRigidBody()->SetContinuousCollision(isContinuous);
+
+		ImGui::PopItemWidth();
+		ImGui::NextColumn();
+
 		ImGui::Columns(1);
 		ImGui::Separator();
 		ImGui::PopStyleVar();
@@ -106,6 +106,7 @@ namespace Lumos
 
 			virtual const std::string& GetTitleInternal() const = 0;
 			virtual void DrawIndexedInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, u32 start) const = 0;
+			virtual void DrawIndexedInstancedInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, u32 instanceCount, u32 start) const = 0;
 			virtual void DrawInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, DataType datayType, void* indices) const = 0;
 			virtual Graphics::Swapchain* GetSwapchainInternal() const = 0;
 
@@ -129,6 +130,11 @@ namespace Lumos
 			{
 				s_Instance->DrawIndexedInternal(commandBuffer, type, count, start);
 			}
+			// Draws instanceCount copies of the bound mesh, shaders pick their per instance data with gl_InstanceIndex
+			_FORCE_INLINE_ static void DrawIndexedInstanced(CommandBuffer* commandBuffer, DrawType type, u32 count, u32 instanceCount, u32 start = 0)
+			{
+				s_Instance->DrawIndexedInstancedInternal(commandBuffer, type, count, instanceCount, start);
+			}
 			_FORCE_INLINE_ static const std::string& GetTitle()
 			{
 				return s_Instance->GetTitleInternal();
@@ -14,6 +14,8 @@ namespace Lumos
 			virtual void Init(uint32_t size, const void* data) = 0;
 			virtual void SetData(uint32_t size, const void* data) = 0;
 			virtual void SetDynamicData(uint32_t size, uint32_t typeSize, const void* data) = 0;
+			// Copies size bytes from data to offset in the buffer, leaving the rest of it untouched
+			virtual void SetDynamicDataRange(uint32_t offset, uint32_t size, uint32_t typeSize, const void* data) = 0;
 
 			virtual u8* GetBuffer() const = 0;
             
@@ -137,6 +137,7 @@ namespace Lumos
 
 			static void InitDefaultTexture();
 			static void ReleaseDefaultTexture();
+			static const Ref<Texture2D>& GetDefaultTexture() { return s_DefaultTexture; }
 
 			template<typename Archive>
 			void save(Archive& archive) const
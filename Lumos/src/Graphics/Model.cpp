@@ -3,6 +3,7 @@
 #include "Mesh.h"
 
 #include "Core/VFS.h"
+#include "Core/Application.h"
 
 namespace Lumos::Graphics
 {
@@ -29,25 +30,68 @@ namespace Lumos::Graphics
 
     void Model::LoadModel(const std::string& path)
 	{
-		std::string physicalPath;
-		if(!Lumos::VFS::Get()->ResolvePhysicalPath(path, physicalPath))
+		LUMOS_PROFILE_FUNCTION();
+		Ref<ModelSource> source = Decode(path);
+		if(source)
 		{
+			source->Build(*this);
 			LUMOS_LOG_INFO("Loaded Model - {0}", path);
 		}
+	}
 
-		std::string resolvedPath = physicalPath;
+	Ref<ModelSource> Model::Decode(const std::string& path)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		std::string physicalPath;
+		if(!Lumos::VFS::Get()->ResolvePhysicalPath(path, physicalPath))
+		{
+			LUMOS_LOG_ERROR("Failed to find Model - {0}", path);
+			return nullptr;
+		}
 
 		const std::string fileExtension = StringUtilities::GetFilePathExtension(path);
 
+		Ref<ModelSource> source;
 		if(fileExtension == "obj")
-			LoadOBJ(resolvedPath);
+			source = CreateOBJSource();
 		else if(fileExtension == "gltf" || fileExtension == "glb")
-			LoadGLTF(resolvedPath);
+			source = CreateGLTFSource();
 		else if(fileExtension == "fbx" || fileExtension == "FBX")
-		    LoadFBX(resolvedPath);
+			source = CreateFBXSource();
 		else
+		{
 			LUMOS_LOG_ERROR("Unsupported File Type : {0}", fileExtension);
+			return nullptr;
+		}
+
+		if(!source->Decode(physicalPath))
+			return nullptr;
+
+		return source;
+	}
+
+	void Model::LoadModelStreamed(const std::string& path)
+	{
+		AssetStreamer* streamer = Application::Get().GetAssetStreamer();
+		if(!streamer || streamer->IsSynchronous())
+		{
+			LoadModel(path);
+			return;
+		}
+
+		m_Meshes.clear();
+		m_StreamedModel = streamer->LoadModel(path);
+	}
+
+	bool Model::ResolveStreamedLoad()
+	{
+		if(!m_StreamedModel || m_StreamedModel->IsLoading())
+			return false;
+
+		if(m_StreamedModel->IsReady())
+			m_Meshes = m_StreamedModel->Get()->GetMeshes();
 
-		LUMOS_LOG_INFO("Loaded Model - {0}", resolvedPath);
+		m_StreamedModel.reset();
+		return true;
 	}
-}
\ No newline at end of file
+}
@@ -3,12 +3,25 @@
 #include "MeshFactory.h"
 #include "Mesh.h"
 #include "Material.h"
+#include "Utilities/AssetStreamer.h"
 #include <cereal/cereal.hpp>
 
 namespace Lumos
 {
     namespace Graphics
     {
+        class Model;
+
+        // Contents of a model file, parsed along with the images it references but without any GPU resources.
+        // Decode is safe to run on any thread, Build creates the meshes and materials on the render thread.
+        class ModelSource
+        {
+        public:
+            virtual ~ModelSource() = default;
+            virtual bool Decode(const std::string& path) = 0;
+            virtual void Build(Model& model) = 0;
+        };
+
         class Model
         {
         public:
@@ -50,7 +63,7 @@ namespace Lumos
                 }
                 else
                 {
-                    LoadModel(m_FilePath);
+                    LoadModelStreamed(m_FilePath);
                 }
             }
 
@@ -62,12 +75,24 @@ namespace Lumos
             PrimitiveType m_PrimitiveType;
             std::vector<Ref<Mesh>> m_Meshes;
             std::string m_FilePath;
+            Ref<StreamedAsset<Model>> m_StreamedModel;
 
-            void LoadOBJ(const std::string& path);
-		    void LoadGLTF(const std::string& path);
-		    void LoadFBX(const std::string& path);
+            static Ref<ModelSource> CreateOBJSource();
+            static Ref<ModelSource> CreateGLTFSource();
+            static Ref<ModelSource> CreateFBXSource();
         public:
         	void LoadModel(const std::string& path);
+
+            // Reads and parses a model file without creating GPU resources, nullptr if it can't be loaded
+            static Ref<ModelSource> Decode(const std::string& path);
+
+            // Loads the file on the asset streamer, the model stays empty until its meshes arrive
+            void LoadModelStreamed(const std::string& path);
+
+            // Takes the meshes of a finished streamed load, returns false while it is still loading
+            bool ResolveStreamedLoad();
+            bool IsStreaming() const { return m_StreamedModel != nullptr; }
+            const Ref<StreamedAsset<Model>>& GetStreamedModel() const { return m_StreamedModel; }
         };
     }
 }
@@ -9,6 +9,7 @@
 
 #include "Maths/Transform.h"
 #include "Core/Application.h"
+#include "Utilities/LoadImage.h"
 
 #include <OpenFBX/ofbx.h>
 
@@ -16,8 +17,6 @@ const u32 MAX_PATH_LENGTH = 260;
 
 namespace Lumos::Graphics
 {
-	std::string m_FBXModelDirectory;
-	
 	enum class Orientation
 	{
 		Y_UP,
@@ -132,35 +131,89 @@ namespace Lumos::Graphics
 		return Maths::Quaternion(float(quat.x), float(quat.y), float(quat.z), float(quat.w));
 	}
 	
-	void Model::LoadFBX(const std::string& path)
+	static std::string GetTexturePath(const ofbx::Texture* texture, const std::string& directory)
+	{
+		ofbx::DataView filename = texture->getRelativeFileName();
+		if(filename == "")
+			filename = texture->getFileName();
+		
+		char filePath[MAX_PATH_LENGTH];
+		filename.toString(filePath);
+		
+		std::string stringFilepath = std::string(filePath);
+		return directory + "/" + StringUtilities::BackSlashesToSlashes(stringFilepath);
+	}
+	
+	class FBXSource : public ModelSource
+	{
+	public:
+		~FBXSource()
+		{
+			if(m_Scene)
+				m_Scene->destroy();
+		}
+		
+		bool Decode(const std::string& path) override;
+		void Build(Model& model) override;
+		
+	private:
+		ofbx::IScene* m_Scene = nullptr;
+		std::string m_FBXModelDirectory;
+	};
+	
+	bool FBXSource::Decode(const std::string& path)
 	{
+		LUMOS_PROFILE_FUNCTION();
 		std::string err;
 		std::string pathCopy = path;
 		pathCopy = StringUtilities::BackSlashesToSlashes(pathCopy);
 		m_FBXModelDirectory = pathCopy.substr(0, pathCopy.find_last_of('/'));
 		
-		std::string name = m_FBXModelDirectory.substr(m_FBXModelDirectory.find_last_of('/') + 1);
-		
-		std::string ext = StringUtilities::GetFilePathExtension(path);
 		i64 size = FileSystem::GetFileSize(path);
 		auto data = FileSystem::ReadFile(path);
 		
 		if(data == nullptr)
 		{
-			LUMOS_LOG_WARN("Failed to load fbx file"); return;
+			LUMOS_LOG_WARN("Failed to load fbx file"); return false;
 		}
 		const bool ignoreGeometry = false;
 		const u64 flags = ignoreGeometry ? (u64)ofbx::LoadFlags::IGNORE_GEOMETRY : (u64)ofbx::LoadFlags::TRIANGULATE;
 		
-		ofbx::IScene* scene = ofbx::load(data, u32(size), flags);
+		m_Scene = ofbx::load(data, u32(size), flags);
 		
 		err = ofbx::getError();
 		
-		if(!err.empty() || !scene)
+		if(!err.empty() || !m_Scene)
 		{
 			LUMOS_LOG_CRITICAL(err);
+			return false;
 		}
 		
+		// Decode every texture the materials reference here, so Build only has to upload them
+		const ofbx::Texture::TextureType textureTypes[] = {ofbx::Texture::TextureType::DIFFUSE, ofbx::Texture::TextureType::NORMAL, ofbx::Texture::TextureType::SPECULAR, ofbx::Texture::TextureType::SHININESS, ofbx::Texture::TextureType::EMISSIVE, ofbx::Texture::TextureType::REFLECTION};
+		for(int i = 0; i < m_Scene->getMeshCount(); ++i)
+		{
+			const ofbx::Mesh* fbx_mesh = m_Scene->getMesh(i);
+			const ofbx::Material* material = fbx_mesh->getMaterialCount() > 0 ? fbx_mesh->getMaterial(0) : nullptr;
+			if(!material)
+				continue;
+			
+			for(auto type : textureTypes)
+			{
+				const ofbx::Texture* texture = material->getTexture(type);
+				if(texture)
+					PreloadImageFromFile(GetTexturePath(texture, m_FBXModelDirectory));
+			}
+		}
+		
+		return true;
+	}
+	
+	void FBXSource::Build(Model& model)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		const ofbx::IScene* scene = m_Scene;
+		
 		const ofbx::GlobalSettings* settings = scene->getGlobalSettings();
 		switch(settings->UpAxis)
 		{
@@ -369,7 +422,7 @@ namespace Lumos::Graphics
 				if(material)
 					mesh->SetMaterial(pbrMaterial);
 				
-				m_Meshes.push_back(mesh);
+				model.AddMesh(mesh);
 				
 				auto transform = Maths::Transform();
 				
@@ -394,7 +447,7 @@ namespace Lumos::Graphics
 				if(material)
 					mesh->SetMaterial(pbrMaterial);
 				
-				m_Meshes.push_back(mesh);
+				model.AddMesh(mesh);
 				auto transform = Maths::Transform();
 				
 				auto object = fbx_mesh;
@@ -419,4 +472,8 @@ namespace Lumos::Graphics
 		}
 	}
 	
+	Ref<ModelSource> Model::CreateFBXSource()
+	{
+		return CreateRef<FBXSource>();
+	}
 }
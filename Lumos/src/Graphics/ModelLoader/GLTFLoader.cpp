@@ -456,15 +456,26 @@ namespace Lumos::Graphics
 		}
 	}
 
-	void Model::LoadGLTF(const std::string& path)
+	class GLTFSource : public ModelSource
 	{
-		tinygltf::Model model;
+	public:
+		bool Decode(const std::string& path) override;
+		void Build(Model& model) override;
+
+	private:
+		tinygltf::Model m_Model;
+	};
+
+	bool GLTFSource::Decode(const std::string& path)
+	{
+		LUMOS_PROFILE_FUNCTION();
 		tinygltf::TinyGLTF loader;
 		std::string err;
 		std::string warn;
 
 		std::string ext = StringUtilities::GetFilePathExtension(path);
 
+		// Images are decoded here too, Build only uploads them
 		loader.SetImageLoader(tinygltf::LoadImageData, nullptr);
 		loader.SetImageWriter(tinygltf::WriteImageData, nullptr);
 
@@ -472,11 +483,11 @@ namespace Lumos::Graphics
 
 		if(ext == "glb") // assume binary glTF.
 		{
-			ret = tinygltf::TinyGLTF().LoadBinaryFromFile(&model, &err, &warn, path);
+			ret = loader.LoadBinaryFromFile(&m_Model, &err, &warn, path);
 		}
 		else // assume ascii glTF.
 		{
-			ret = tinygltf::TinyGLTF().LoadASCIIFromFile(&model, &err, &warn, path);
+			ret = loader.LoadASCIIFromFile(&m_Model, &err, &warn, path);
 		}
 
 		if(!err.empty())
@@ -494,15 +505,24 @@ namespace Lumos::Graphics
 			LUMOS_LOG_ERROR("Failed to parse glTF");
 		}
 
-		auto LoadedMaterials = LoadMaterials(model);
+		return ret;
+	}
 
-		std::string name = path.substr(path.find_last_of('/') + 1);
+	void GLTFSource::Build(Model& model)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		auto LoadedMaterials = LoadMaterials(m_Model);
 
 		auto meshes = std::vector<std::vector<Graphics::Mesh*>>();
-		const tinygltf::Scene& gltfScene = model.scenes[Lumos::Maths::Max(0, model.defaultScene)];
+		const tinygltf::Scene& gltfScene = m_Model.scenes[Lumos::Maths::Max(0, m_Model.defaultScene)];
 		for(size_t i = 0; i < gltfScene.nodes.size(); i++)
 		{
-			LoadNode(this, gltfScene.nodes[i], Maths::Matrix4(), model, LoadedMaterials, meshes);
+			LoadNode(&model, gltfScene.nodes[i], Maths::Matrix4(), m_Model, LoadedMaterials, meshes);
 		}
 	}
+
+	Ref<ModelSource> Model::CreateGLTFSource()
+	{
+		return CreateRef<GLTFSource>();
+	}
 }
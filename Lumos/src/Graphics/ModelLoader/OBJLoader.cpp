@@ -5,17 +5,15 @@
 #include "Maths/Transform.h"
 #include "Graphics/API/Texture.h"
 #include "Maths/Maths.h"
+#include "Utilities/LoadImage.h"
 
 #include "Core/Application.h"
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tinyobjloader/tiny_obj_loader.h>
 
-namespace Lumos
+namespace Lumos::Graphics
 {
-	std::string m_Directory;
-	std::vector<Ref<Graphics::Texture2D>> m_Textures;
-
 	Ref<Graphics::Texture2D> LoadMaterialTextures(const std::string& typeName, std::vector<Ref<Graphics::Texture2D>>& textures_loaded, const std::string& name, const std::string& directory, Graphics::TextureParameters format)
 	{
 		for(u32 j = 0; j < textures_loaded.size(); j++)
@@ -35,27 +33,61 @@ namespace Lumos
 		}
 	}
 
-	void Graphics::Model::LoadOBJ(const std::string& path)
+	class OBJSource : public Graphics::ModelSource
+	{
+	public:
+		bool Decode(const std::string& path) override;
+		void Build(Graphics::Model& model) override;
+
+	private:
+		tinyobj::attrib_t m_Attrib;
+		std::vector<tinyobj::shape_t> m_Shapes;
+		std::vector<tinyobj::material_t> m_Materials;
+		std::string m_Directory;
+	};
+
+	bool OBJSource::Decode(const std::string& path)
 	{
+		LUMOS_PROFILE_FUNCTION();
 		std::string resolvedPath = path;
-		tinyobj::attrib_t attrib;
 		std::string error;
 
-		std::vector<tinyobj::shape_t> shapes;
-		std::vector<tinyobj::material_t> materials;
-
 		m_Directory = resolvedPath.substr(0, resolvedPath.find_last_of('/'));
 
-		std::string name = m_Directory.substr(m_Directory.find_last_of('/') + 1);
-
 		bool ok = tinyobj::LoadObj(
-			&attrib, &shapes, &materials, &error, (resolvedPath).c_str(), (m_Directory + "/").c_str());
+			&m_Attrib, &m_Shapes, &m_Materials, &error, (resolvedPath).c_str(), (m_Directory + "/").c_str());
 
 		if(!ok)
 		{
 			LUMOS_LOG_CRITICAL(error);
+			return false;
 		}
 
+		// Decode the textures of every material in use here, so Build only has to upload them
+		for(const auto& shape : m_Shapes)
+		{
+			if(shape.mesh.material_ids.empty() || shape.mesh.material_ids[0] < 0)
+				continue;
+
+			const tinyobj::material_t& material = m_Materials[shape.mesh.material_ids[0]];
+			for(const std::string* texName : {&material.diffuse_texname, &material.bump_texname, &material.roughness_texname, &material.metallic_texname, &material.specular_highlight_texname})
+			{
+				if(texName->length() > 0)
+					PreloadImageFromFile(m_Directory + "/" + *texName);
+			}
+		}
+
+		return true;
+	}
+
+	void OBJSource::Build(Graphics::Model& model)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		std::vector<Ref<Graphics::Texture2D>> loadedTextures;
+		auto& attrib = m_Attrib;
+		auto& shapes = m_Shapes;
+		auto& materials = m_Materials;
+
 		bool singleMesh = shapes.size() == 1;
 
 		for(const auto& shape : shapes)
@@ -139,35 +171,35 @@ namespace Lumos
 
 				if(mp->diffuse_texname.length() > 0)
 				{
-					Ref<Graphics::Texture2D> texture = LoadMaterialTextures("Albedo", m_Textures, mp->diffuse_texname, m_Directory, Graphics::TextureParameters(Graphics::TextureFilter::NEAREST, Graphics::TextureFilter::NEAREST, mp->diffuse_texopt.clamp ? Graphics::TextureWrap::CLAMP_TO_EDGE : Graphics::TextureWrap::REPEAT));
+					Ref<Graphics::Texture2D> texture = LoadMaterialTextures("Albedo", loadedTextures, mp->diffuse_texname, m_Directory, Graphics::TextureParameters(Graphics::TextureFilter::NEAREST, Graphics::TextureFilter::NEAREST, mp->diffuse_texopt.clamp ? Graphics::TextureWrap::CLAMP_TO_EDGE : Graphics::TextureWrap::REPEAT));
 					if(texture)
 						textures.albedo = texture;
 				}
 
 				if(mp->bump_texname.length() > 0)
 				{
-					Ref<Graphics::Texture2D> texture = LoadMaterialTextures("Normal", m_Textures, mp->bump_texname, m_Directory, Graphics::TextureParameters(Graphics::TextureFilter::NEAREST, Graphics::TextureFilter::NEAREST, mp->bump_texopt.clamp ? Graphics::TextureWrap::CLAMP_TO_EDGE : Graphics::TextureWrap::REPEAT));
+					Ref<Graphics::Texture2D> texture = LoadMaterialTextures("Normal", loadedTextures, mp->bump_texname, m_Directory, Graphics::TextureParameters(Graphics::TextureFilter::NEAREST, Graphics::TextureFilter::NEAREST, mp->bump_texopt.clamp ? Graphics::TextureWrap::CLAMP_TO_EDGE : Graphics::TextureWrap::REPEAT));
 					if(texture)
 						textures.normal = texture; //pbrMaterial->SetNormalMap(texture);
 				}
 
 				if(mp->roughness_texname.length() > 0)
 				{
-					Ref<Graphics::Texture2D> texture = LoadMaterialTextures("Roughness", m_Textures, mp->roughness_texname.c_str(), m_Directory, Graphics::TextureParameters(Graphics::TextureFilter::NEAREST, Graphics::TextureFilter::NEAREST, mp->roughness_texopt.clamp ? Graphics::TextureWrap::CLAMP_TO_EDGE : Graphics::TextureWrap::REPEAT));
+					Ref<Graphics::Texture2D> texture = LoadMaterialTextures("Roughness", loadedTextures, mp->roughness_texname.c_str(), m_Directory, Graphics::TextureParameters(Graphics::TextureFilter::NEAREST, Graphics::TextureFilter::NEAREST, mp->roughness_texopt.clamp ? Graphics::TextureWrap::CLAMP_TO_EDGE : Graphics::TextureWrap::REPEAT));
 					if(texture)
 						textures.roughness = texture;
 				}
 
 				if(mp->metallic_texname.length() > 0)
 				{
-					Ref<Graphics::Texture2D> texture = LoadMaterialTextures("Metallic", m_Textures, mp->metallic_texname, m_Directory, Graphics::TextureParameters(Graphics::TextureFilter::NEAREST, Graphics::TextureFilter::NEAREST, mp->metallic_texopt.clamp ? Graphics::TextureWrap::CLAMP_TO_EDGE : Graphics::TextureWrap::REPEAT));
+					Ref<Graphics::Texture2D> texture = LoadMaterialTextures("Metallic", loadedTextures, mp->metallic_texname, m_Directory, Graphics::TextureParameters(Graphics::TextureFilter::NEAREST, Graphics::TextureFilter::NEAREST, mp->metallic_texopt.clamp ? Graphics::TextureWrap::CLAMP_TO_EDGE : Graphics::TextureWrap::REPEAT));
 					if(texture)
 						textures.metallic = texture;
 				}
 
 				if(mp->specular_highlight_texname.length() > 0)
 				{
-					Ref<Graphics::Texture2D> texture = LoadMaterialTextures("Metallic", m_Textures, mp->specular_highlight_texname, m_Directory, Graphics::TextureParameters(Graphics::TextureFilter::NEAREST, Graphics::TextureFilter::NEAREST, mp->specular_texopt.clamp ? Graphics::TextureWrap::CLAMP_TO_EDGE : Graphics::TextureWrap::REPEAT));
+					Ref<Graphics::Texture2D> texture = LoadMaterialTextures("Metallic", loadedTextures, mp->specular_highlight_texname, m_Directory, Graphics::TextureParameters(Graphics::TextureFilter::NEAREST, Graphics::TextureFilter::NEAREST, mp->specular_texopt.clamp ? Graphics::TextureWrap::CLAMP_TO_EDGE : Graphics::TextureWrap::REPEAT));
 					if(texture)
 						textures.metallic = texture;
 				}
@@ -183,13 +215,18 @@ namespace Lumos
 
 			auto mesh = CreateRef<Graphics::Mesh>(vb, ib, boundingBox);
 			mesh->SetMaterial(pbrMaterial);
-			m_Meshes.push_back(mesh);
+			model.AddMesh(mesh);
 			
-			m_Textures.clear();
+			loadedTextures.clear();
 
 			delete[] vertices;
 			delete[] indices;
 		}
 	}
 
+	Ref<Graphics::ModelSource> Graphics::Model::CreateOBJSource()
+	{
+		return CreateRef<OBJSource>();
+	}
+
 }
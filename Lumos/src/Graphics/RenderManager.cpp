@@ -1,6 +1,12 @@
 #include "Precompiled.h"
 #include "RenderManager.h"
 #include "GBuffer.h"
+#include "UniformArena.h"
+#include "VisibilityCuller.h"
+#include "API/Renderer.h"
+#include "API/Swapchain.h"
+#include "Maths/Matrix3x4.h"
+#include "Scene/Scene.h"
 
 namespace Lumos
 {
@@ -11,9 +17,26 @@ namespace Lumos
 			SetScreenBufferSize(width, height);
 
 			m_GBuffer = new GBuffer(width, height);
+
+			// Model matrices for the 3D renderers, the regions grow past this if a frame needs more
+			m_UniformArena = new UniformArena(Renderer::GetSwapchain()->GetSwapchainBufferCount(), MAX_OBJECTS * sizeof(Maths::Matrix3x4), MAX_INSTANCES_PER_DRAW * sizeof(Maths::Matrix3x4));
+			m_VisibilityCuller = new VisibilityCuller();
 			Reset();
 		}
-		RenderManager::~RenderManager() { delete m_GBuffer; }
+		RenderManager::~RenderManager()
+		{
+			delete m_VisibilityCuller;
+			delete m_UniformArena;
+			delete m_GBuffer;
+		}
+
+		void RenderManager::BeginFrame(Scene* scene)
+		{
+			m_UniformArena->BeginFrame(Renderer::GetSwapchain()->GetCurrentBufferId());
+
+			if(scene)
+				m_VisibilityCuller->Update(scene->GetRegistry());
+		}
 
 		void RenderManager::OnResize(u32 width, u32 height)
 		{
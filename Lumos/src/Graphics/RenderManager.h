@@ -2,6 +2,8 @@
 
 namespace Lumos
 {
+	class Scene;
+
 	namespace Graphics
 	{
 		class Texture;
@@ -9,6 +11,8 @@ namespace Lumos
 		class GBuffer;
 		class ShadowRenderer;
 		class SkyboxRenderer;
+		class UniformArena;
+		class VisibilityCuller;
 
 		class LUMOS_EXPORT RenderManager
 		{
@@ -20,6 +24,7 @@ namespace Lumos
 			RenderManager& operator=(RenderManager const&) = delete;
 
 			void Reset();
+			void BeginFrame(Scene* scene);
 			void OnResize(u32 width, u32 height);
 
 			bool GetReflectSkyBox() const { return m_ReflectSkyBox; };
@@ -27,6 +32,8 @@ namespace Lumos
 			u32 GetNumShadowMaps() const { return m_NumShadowMaps; };
 			TextureDepthArray* GetShadowTexture() const { return m_ShadowTexture; };
 			GBuffer* GetGBuffer() const { return m_GBuffer; }
+			UniformArena* GetUniformArena() const { return m_UniformArena; }
+			VisibilityCuller* GetVisibilityCuller() const { return m_VisibilityCuller; }
 
 			void SetReflectSkyBox(bool reflect) { m_ReflectSkyBox = reflect; }
 			void SetUseShadowMap(bool shadow) { m_UseShadowMap = shadow; }
@@ -47,6 +54,8 @@ namespace Lumos
 			Texture* m_ScreenTexture = nullptr;
 
 			GBuffer* m_GBuffer = nullptr;
+			UniformArena* m_UniformArena = nullptr;
+			VisibilityCuller* m_VisibilityCuller = nullptr;
 
 			ShadowRenderer* m_ShadowRenderer = nullptr;
 
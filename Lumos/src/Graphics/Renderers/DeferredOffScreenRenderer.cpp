@@ -9,6 +9,8 @@
  
 
 #include "Graphics/RenderManager.h"
+#include "Graphics/UniformArena.h"
+#include "Graphics/VisibilityCuller.h"
 #include "Graphics/Camera/Camera.h"
 #include "Graphics/Mesh.h"
 #include "Graphics/Model.h"
@@ -56,7 +58,6 @@ namespace Lumos
 		DeferredOffScreenRenderer::~DeferredOffScreenRenderer()
 		{
 			delete m_UniformBuffer;
-			delete m_ModelUniformBuffer;
 			delete m_DeferredCommandBuffers;
 			delete m_DefaultMaterial;
 
@@ -64,8 +65,6 @@ namespace Lumos
 
 			m_Framebuffers.clear();
 			m_CommandBuffers.clear();
-
-			Memory::AlignedFree(m_UBODataDynamic.model);
 		}
 
 		void DeferredOffScreenRenderer::Init()
@@ -84,16 +83,7 @@ namespace Lumos
 			properties.usingMetallicMap = 0.0f;
 			m_DefaultMaterial->SetMaterialProperites(properties);
 
-			const size_t minUboAlignment = size_t(Graphics::Renderer::GetCapabilities().UniformBufferOffsetAlignment);
-
-			m_DynamicAlignment = sizeof(Lumos::Maths::Matrix4);
-			if(minUboAlignment > 0)
-			{
-				m_DynamicAlignment = (m_DynamicAlignment + minUboAlignment - 1) & ~(minUboAlignment - 1);
-			}
-
 			m_UniformBuffer = nullptr;
-			m_ModelUniformBuffer = nullptr;
 
 			m_CommandQueue.reserve(1000);
 
@@ -191,51 +181,34 @@ namespace Lumos
 			memcpy(m_VSSystemUniformBuffer + m_VSSystemUniformBufferOffsets[VSSystemUniformIndex_ProjectionViewMatrix], &projView, sizeof(Maths::Matrix4));
 
 			m_Frustum = m_Camera->GetFrustum(view);
+			m_CameraPosition = m_CameraTransform->GetWorldPosition();
 			
 			
 			auto& registry = scene->GetRegistry();
-			auto group = registry.group<Model>(entt::get<Maths::Transform>);
-			
-			for(auto entity : group)
+			auto& culler = *Application::Get().GetRenderManager()->GetVisibilityCuller();
+
+			for(u32 index : culler.Cull(m_Frustum))
 			{
-				const auto& [model, trans] = group.get<Model, Maths::Transform>(entity);
-				
-                const auto& meshes = model.GetMeshes();
-                
-                for(auto mesh : meshes)
-                {
-                    if(mesh->GetActive())
-                    {
-                        auto& worldTransform = trans.GetWorldMatrix();
-						
-                        auto bb = mesh->GetBoundingBox();
-                        auto bbCopy = bb->Transformed(worldTransform);
-                        auto inside = m_Frustum.IsInsideFast(bbCopy);
-						
-                        if(inside == Maths::Intersection::OUTSIDE)
-                            continue;
-						
-                        auto meshPtr = mesh;
-                        auto material = meshPtr->GetMaterial();
-                        if(material)
-                        {
-                            if(material->GetDescriptorSet() == nullptr || material->GetPipeline() != m_Pipeline.get() || material->GetTexturesUpdated())
-                            {
-                                material->CreateDescriptorSet(m_Pipeline.get(), 1);
-                                material->SetTexturesUpdated(false);
-                            }
-                        }
-						
-                        auto textureMatrixTransform = registry.try_get<TextureMatrixComponent>(entity);
-                        Maths::Matrix4 textureMatrix;
-                        if(textureMatrixTransform)
-                            textureMatrix = textureMatrixTransform->GetMatrix();
-                        else
-                            textureMatrix = Maths::Matrix4();
-						
-                        SubmitMesh(meshPtr.get(), material.get(), worldTransform, textureMatrix);
-                    }
-                }
+				const auto& renderable = culler.GetRenderable(index);
+
+				auto material = renderable.mesh->GetMaterial();
+				if(material)
+				{
+					if(material->GetDescriptorSet() == nullptr || material->GetPipeline() != m_Pipeline.get() || material->GetTexturesUpdated())
+					{
+						material->CreateDescriptorSet(m_Pipeline.get(), 1);
+						material->SetTexturesUpdated(false);
+					}
+				}
+
+				auto textureMatrixTransform = registry.try_get<TextureMatrixComponent>(renderable.entity);
+				Maths::Matrix4 textureMatrix;
+				if(textureMatrixTransform)
+					textureMatrix = textureMatrixTransform->GetMatrix();
+				else
+					textureMatrix = Maths::Matrix4();
+
+				SubmitMesh(renderable.mesh, material.get(), renderable.worldTransform, textureMatrix);
 			}
 		}
 
@@ -245,7 +218,7 @@ namespace Lumos
 			m_CommandQueue.push_back(command);
 		}
 
-		void DeferredOffScreenRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix)
+		void DeferredOffScreenRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix3x4& transform, const Maths::Matrix4& textureMatrix)
 		{
 			LUMOS_PROFILE_FUNCTION();
 			RenderCommand command;
@@ -253,6 +226,11 @@ namespace Lumos
 			command.material = material;
 			command.transform = transform;
 			command.textureMatrix = textureMatrix;
+
+			const Material* drawMaterial = material ? material : m_DefaultMaterial;
+			const float depth = (transform.Translation() - m_CameraPosition).LengthSquared();
+			command.sortKey = MakeRenderSortKey(m_Pipeline.get(), drawMaterial->GetDescriptorSet(), mesh, depth);
+
 			Submit(command);
 		}
 
@@ -273,16 +251,14 @@ namespace Lumos
 			LUMOS_PROFILE_FUNCTION();
 			m_UniformBuffer->SetData(m_VSSystemUniformBufferSize, *&m_VSSystemUniformBuffer);
 
-			int index = 0;
+			UniformArena* arena = Application::Get().GetRenderManager()->GetUniformArena();
+			SortRenderCommands(m_CommandQueue, m_DrawOrder);
+			BuildRenderBatches(m_CommandQueue, m_DrawOrder, true, arena, m_Batches);
+			arena->Upload();
 
-			for(auto& command : m_CommandQueue)
-			{
-				Maths::Matrix4* modelMat = reinterpret_cast<Maths::Matrix4*>((reinterpret_cast<uint64_t>(m_UBODataDynamic.model) + (index * m_DynamicAlignment)));
-				command.transform = command.transform;
-				*modelMat = command.transform;
-				index++;
-			}
-			m_ModelUniformBuffer->SetDynamicData(static_cast<uint32_t>(index * m_DynamicAlignment), sizeof(Maths::Matrix4), &*m_UBODataDynamic.model);
+			// Building the batches can grow the arena
+			if(m_ArenaVersion != arena->GetVersion())
+				CreateBuffer();
 		}
 
 		void DeferredOffScreenRenderer::Present()
@@ -290,23 +266,20 @@ namespace Lumos
 			LUMOS_PROFILE_FUNCTION();
 			m_Pipeline->Bind(m_DeferredCommandBuffers);
 
-			for(u32 i = 0; i < static_cast<u32>(m_CommandQueue.size()); i++)
+			// Commands in a batch share their mesh and material, so the first one stands in for all of them
+			for(auto& batch : m_Batches)
 			{
-				auto command = m_CommandQueue[i];
+				const RenderCommand& command = m_CommandQueue[m_DrawOrder[batch.first]];
 				Mesh* mesh = command.mesh;
 
-				uint32_t dynamicOffset = i * static_cast<uint32_t>(m_DynamicAlignment);
-
-				std::vector<Graphics::DescriptorSet*> descriptorSets = {m_Pipeline->GetDescriptorSet(), command.material ? command.material->GetDescriptorSet() : m_DefaultMaterial->GetDescriptorSet()};
-                
                 m_CurrentDescriptorSets[0] = m_Pipeline->GetDescriptorSet();
                 m_CurrentDescriptorSets[1] = command.material ? command.material->GetDescriptorSet() : m_DefaultMaterial->GetDescriptorSet();
 
 				mesh->GetVertexBuffer()->Bind(m_DeferredCommandBuffers, m_Pipeline.get());
 				mesh->GetIndexBuffer()->Bind(m_DeferredCommandBuffers);
 
-				Renderer::BindDescriptorSets(m_Pipeline.get(), m_DeferredCommandBuffers, dynamicOffset, m_CurrentDescriptorSets);
-				Renderer::DrawIndexed(m_DeferredCommandBuffers, DrawType::TRIANGLE, mesh->GetIndexBuffer()->GetCount());
+				Renderer::BindDescriptorSets(m_Pipeline.get(), m_DeferredCommandBuffers, batch.dynamicOffset, m_CurrentDescriptorSets);
+				Renderer::DrawIndexedInstanced(m_DeferredCommandBuffers, DrawType::TRIANGLE, mesh->GetIndexBuffer()->GetCount(), batch.instanceCount);
 
 				mesh->GetVertexBuffer()->Unbind();
 				mesh->GetIndexBuffer()->Unbind();
@@ -392,14 +365,9 @@ namespace Lumos
 				m_UniformBuffer->Init(bufferSize, nullptr);
 			}
 
-			if(m_ModelUniformBuffer == nullptr)
-			{
-				m_ModelUniformBuffer = Graphics::UniformBuffer::Create();
-
-				uint32_t bufferSize2 = static_cast<uint32_t>(MAX_OBJECTS * m_DynamicAlignment);
-				m_UBODataDynamic.model = static_cast<Maths::Matrix4*>(Memory::AlignedAlloc(bufferSize2, m_DynamicAlignment));
-				m_ModelUniformBuffer->Init(bufferSize2, nullptr);
-			}
+			// Model matrices live in the shared arena, its buffer changes when it grows
+			UniformArena* arena = Application::Get().GetRenderManager()->GetUniformArena();
+			m_ArenaVersion = arena->GetVersion();
 
 			std::vector<Graphics::BufferInfo> bufferInfos;
 
@@ -414,9 +382,9 @@ namespace Lumos
 			bufferInfo.name = "UniformBufferObject";
 
 			Graphics::BufferInfo bufferInfo2 = {};
-			bufferInfo2.buffer = m_ModelUniformBuffer;
+			bufferInfo2.buffer = arena->GetBuffer();
 			bufferInfo2.offset = 0;
-			bufferInfo2.size = sizeof(Maths::Matrix4);
+			bufferInfo2.size = arena->GetBindRange();
 			bufferInfo2.type = Graphics::DescriptorType::UNIFORM_BUFFER_DYNAMIC;
 			bufferInfo2.binding = 1;
 			bufferInfo2.shaderType = ShaderType::VERTEX;
@@ -471,6 +439,8 @@ namespace Lumos
 		void DeferredOffScreenRenderer::OnImGui()
 		{
 			ImGui::TextUnformatted("Deferred Offscreen Renderer");
+			Application::Get().GetRenderManager()->GetUniformArena()->OnImGui();
+			Application::Get().GetRenderManager()->GetVisibilityCuller()->OnImGui();
 		}
 	}
 }
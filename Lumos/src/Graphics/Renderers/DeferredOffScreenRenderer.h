@@ -32,7 +32,7 @@ namespace Lumos
 			void Begin() override;
 			void BeginScene(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransforms) override;
 			void Submit(const RenderCommand& command) override;
-			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix) override;
+			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix3x4& transform, const Maths::Matrix4& textureMatrix) override;
 			void EndScene() override;
 			void End() override;
 			void Present() override;
@@ -61,19 +61,15 @@ namespace Lumos
 			Material* m_DefaultMaterial;
 
 			UniformBuffer* m_UniformBuffer;
-			UniformBuffer* m_ModelUniformBuffer;
 
 			CommandBuffer* m_DeferredCommandBuffers;
 
-			struct UniformBufferModel
-			{
-				Maths::Matrix4* model;
-			};
-
-			UniformBufferModel m_UBODataDynamic;
-
-			size_t m_DynamicAlignment;
 			int m_CommandBufferIndex = 0;
+
+			std::vector<u32> m_DrawOrder;
+			std::vector<RenderBatch> m_Batches;
+			u32 m_ArenaVersion = 0;
+			Maths::Vector3 m_CameraPosition;
 		};
 	}
 }
@@ -273,7 +273,7 @@ namespace Lumos
 			m_CommandQueue.push_back(command);
 		}
 
-		void DeferredRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix)
+		void DeferredRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix3x4& transform, const Maths::Matrix4& textureMatrix)
 		{
 			LUMOS_PROFILE_FUNCTION();
 			RenderCommand command;
@@ -24,8 +24,12 @@
 
 #include "Core/Application.h"
 #include "Graphics/RenderManager.h"
+#include "Graphics/UniformArena.h"
+#include "Graphics/VisibilityCuller.h"
 #include "Graphics/Camera/Camera.h"
 
+#include <imgui/imgui.h>
+
 namespace Lumos
 {
 	namespace Graphics
@@ -42,10 +46,6 @@ namespace Lumos
 			delete m_DefaultTexture;
 			delete m_UniformBuffer;
 
-			Memory::AlignedFree(m_UBODataDynamic.model);
-
-			delete m_ModelUniformBuffer;
-
 			delete[] m_VSSystemUniformBuffer;
 			delete[] m_PSSystemUniformBuffer;
 
@@ -122,7 +122,6 @@ namespace Lumos
 
 			m_RenderPass = Ref<Graphics::RenderPass>(Graphics::RenderPass::Create());
 			m_UniformBuffer = Graphics::UniformBuffer::Create();
-			m_ModelUniformBuffer = Graphics::UniformBuffer::Create();
 
 			Graphics::RenderpassInfo renderpassCI{};
 
@@ -164,40 +163,7 @@ namespace Lumos
 			uint32_t bufferSize = static_cast<uint32_t>(sizeof(UniformBufferObject));
 			m_UniformBuffer->Init(bufferSize, nullptr);
 
-			const size_t minUboAlignment = Graphics::GraphicsContext::GetContext()->GetMinUniformBufferOffsetAlignment();
-
-			m_DynamicAlignment = sizeof(Lumos::Maths::Matrix4);
-			if(minUboAlignment > 0)
-			{
-				m_DynamicAlignment = (m_DynamicAlignment + minUboAlignment - 1) & ~(minUboAlignment - 1);
-			}
-
-			uint32_t bufferSize2 = static_cast<uint32_t>(MAX_OBJECTS * m_DynamicAlignment);
-
-			m_UBODataDynamic.model = static_cast<Maths::Matrix4*>(Memory::AlignedAlloc(bufferSize2, m_DynamicAlignment));
-
-			m_ModelUniformBuffer->Init(bufferSize2, nullptr);
-
-			std::vector<Graphics::BufferInfo> bufferInfos;
-
-			Graphics::BufferInfo bufferInfo = {};
-			bufferInfo.buffer = m_UniformBuffer;
-			bufferInfo.offset = 0;
-			bufferInfo.size = sizeof(UniformBufferObject);
-			bufferInfo.type = Graphics::DescriptorType::UNIFORM_BUFFER;
-			bufferInfo.binding = 0;
-
-			Graphics::BufferInfo bufferInfo2 = {};
-			bufferInfo2.buffer = m_ModelUniformBuffer;
-			bufferInfo2.offset = 0;
-			bufferInfo2.size = sizeof(UniformBufferModel);
-			bufferInfo2.type = Graphics::DescriptorType::UNIFORM_BUFFER_DYNAMIC;
-			bufferInfo2.binding = 1;
-
-			bufferInfos.push_back(bufferInfo);
-			bufferInfos.push_back(bufferInfo2);
-
-			m_Pipeline->GetDescriptorSet()->Update(bufferInfos);
+			UpdateBufferInfos();
 
 			m_ClearColour = Maths::Vector4(0.4f, 0.4f, 0.4f, 1.0f);
 
@@ -258,61 +224,47 @@ namespace Lumos
 			if(!m_Camera || !m_CameraTransform)
 				return;
 
+			m_CameraPosition = m_CameraTransform->GetWorldPosition();
+
 			auto proj = m_Camera->GetProjectionMatrix();
 
 			memcpy(m_VSSystemUniformBuffer + m_VSSystemUniformBufferOffsets[VSSystemUniformIndex_ProjectionMatrix], &proj, sizeof(Maths::Matrix4));
 
-            m_CommandQueue.clear();
-
-            auto group = registry.group<Model>(entt::get<Maths::Transform>);
-
-            for(auto entity : group)
-            {
-                const auto& [model, trans] = group.get<Model, Maths::Transform>(entity);
-
-                const auto& meshes = model.GetMeshes();
-                
-                for(auto mesh : meshes)
-                {
-                    if(mesh->GetActive())
-                    {
-                        auto& worldTransform = trans.GetWorldMatrix();
-
-                        auto bb = mesh->GetBoundingBox();
-                        auto bbCopy = bb->Transformed(worldTransform);
-                        auto inside = m_Frustum.IsInsideFast(bbCopy);
-
-                        if(inside == Maths::Intersection::OUTSIDE)
-                            continue;
-
-                        auto meshPtr = mesh;
-                        auto material = meshPtr->GetMaterial();
-                        if(material)
-                        {
-                            if(material->GetDescriptorSet() == nullptr || material->GetPipeline() != m_Pipeline.get() || material->GetTexturesUpdated())
-                            {
-                                material->CreateDescriptorSet(m_Pipeline.get(), 1);
-                                material->SetTexturesUpdated(false);
-                            }
-                        }
-
-                        auto textureMatrixTransform = registry.try_get<TextureMatrixComponent>(entity);
-                        Maths::Matrix4 textureMatrix;
-                        if(textureMatrixTransform)
-                            textureMatrix = textureMatrixTransform->GetMatrix();
-                        else
-                            textureMatrix = Maths::Matrix4();
-
-                        SubmitMesh(meshPtr.get(), material.get(), worldTransform, textureMatrix);
-                    }
-                }
-            }
+			m_Frustum = m_Camera->GetFrustum(m_CameraTransform->GetWorldMatrix().Inverse());
+			m_CommandQueue.clear();
+
+			auto& culler = *Application::Get().GetRenderManager()->GetVisibilityCuller();
+
+			for(u32 index : culler.Cull(m_Frustum))
+			{
+				const auto& renderable = culler.GetRenderable(index);
+
+				auto material = renderable.mesh->GetMaterial();
+				if(material)
+				{
+					if(material->GetDescriptorSet() == nullptr || material->GetPipeline() != m_Pipeline.get() || material->GetTexturesUpdated())
+					{
+						material->CreateDescriptorSet(m_Pipeline.get(), 1);
+						material->SetTexturesUpdated(false);
+					}
+				}
+
+				auto textureMatrixTransform = registry.try_get<TextureMatrixComponent>(renderable.entity);
+				Maths::Matrix4 textureMatrix;
+				if(textureMatrixTransform)
+					textureMatrix = textureMatrixTransform->GetMatrix();
+				else
+					textureMatrix = Maths::Matrix4();
+
+				SubmitMesh(renderable.mesh, material.get(), renderable.worldTransform, textureMatrix);
+			}
 		}
 
 		void ForwardRenderer::BeginScene(const Maths::Matrix4& proj, const Maths::Matrix4& view)
 		{
 			memcpy(m_VSSystemUniformBuffer + m_VSSystemUniformBufferOffsets[VSSystemUniformIndex_ProjectionMatrix], &proj, sizeof(Maths::Matrix4));
 			memcpy(m_VSSystemUniformBuffer + m_VSSystemUniformBufferOffsets[VSSystemUniformIndex_ViewMatrix], &view, sizeof(Maths::Matrix4));
+			m_CameraPosition = view.Inverse().Translation();
 		}
 
 		void ForwardRenderer::Submit(const RenderCommand& command)
@@ -320,13 +272,18 @@ namespace Lumos
 			m_CommandQueue.push_back(command);
 		}
 
-		void ForwardRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix)
+		void ForwardRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix3x4& transform, const Maths::Matrix4& textureMatrix)
 		{
 			RenderCommand command;
 			command.mesh = mesh;
 			command.transform = transform;
 			command.textureMatrix = textureMatrix;
 			command.material = material;
+
+			// Every forward draw binds the renderer's own texture set
+			const float depth = (transform.Translation() - m_CameraPosition).LengthSquared();
+			command.sortKey = MakeRenderSortKey(m_Pipeline.get(), m_DescriptorSet.get(), mesh, depth);
+
 			Submit(command);
 		}
 
@@ -343,50 +300,134 @@ namespace Lumos
 				m_CommandBuffers[m_CurrentBufferID]->Execute(true);
 		}
 
-		void ForwardRenderer::SetSystemUniforms(Shader* shader) const
+		void ForwardRenderer::UpdateBufferInfos()
 		{
-			m_UniformBuffer->SetData(sizeof(UniformBufferObject), *&m_VSSystemUniformBuffer);
+			UniformArena* arena = Application::Get().GetRenderManager()->GetUniformArena();
 
-			int index = 0;
+			std::vector<Graphics::BufferInfo> bufferInfos;
 
-			for(auto& command : m_CommandQueue)
-			{
-				Maths::Matrix4* modelMat = reinterpret_cast<Maths::Matrix4*>((reinterpret_cast<uint64_t>(m_UBODataDynamic.model) + (index * m_DynamicAlignment)));
-				*modelMat = command.transform;
-				index++;
-			}
+			Graphics::BufferInfo bufferInfo = {};
+			bufferInfo.buffer = m_UniformBuffer;
+			bufferInfo.offset = 0;
+			bufferInfo.size = sizeof(UniformBufferObject);
+			bufferInfo.type = Graphics::DescriptorType::UNIFORM_BUFFER;
+			bufferInfo.binding = 0;
+
+			Graphics::BufferInfo bufferInfo2 = {};
+			bufferInfo2.buffer = arena->GetBuffer();
+			bufferInfo2.offset = 0;
+			bufferInfo2.size = arena->GetBindRange();
+			bufferInfo2.type = Graphics::DescriptorType::UNIFORM_BUFFER_DYNAMIC;
+			bufferInfo2.binding = 1;
+
+			bufferInfos.push_back(bufferInfo);
+			bufferInfos.push_back(bufferInfo2);
+
+			m_Pipeline->GetDescriptorSet()->Update(bufferInfos);
+			m_ArenaVersion = arena->GetVersion();
+		}
+
+		void ForwardRenderer::SetSystemUniforms(Shader* shader)
+		{
+			SortRenderCommands(m_CommandQueue, m_DrawOrder);
 
-			m_ModelUniformBuffer->SetDynamicData(static_cast<uint32_t>(index * m_DynamicAlignment), sizeof(Maths::Matrix4), &*m_UBODataDynamic.model);
+			m_UniformBuffer->SetData(sizeof(UniformBufferObject), *&m_VSSystemUniformBuffer);
+
+			// Every forward draw uses the same texture set, only the mesh splits a batch
+			UniformArena* arena = Application::Get().GetRenderManager()->GetUniformArena();
+			BuildRenderBatches(m_CommandQueue, m_DrawOrder, false, arena, m_Batches);
+			arena->Upload();
+
+			// Building the batches can grow the arena
+			if(m_ArenaVersion != arena->GetVersion())
+				UpdateBufferInfos();
 		}
 
 		void ForwardRenderer::Present()
 		{
-			int index = 0;
+			LUMOS_ASSERT(m_DrawOrder.size() == m_CommandQueue.size(), "SetSystemUniforms must be called after the last command is submitted");
 
-			for(auto& command : m_CommandQueue)
-			{
-				Mesh* mesh = command.mesh;
+			m_RenderStats = {};
 
-				Graphics::CommandBuffer* currentCMDBuffer = m_CommandBuffers[m_CurrentBufferID];
+			Graphics::CommandBuffer* currentCMDBuffer = m_CommandBuffers[m_CurrentBufferID];
+			Graphics::Pipeline* boundPipeline = nullptr;
+			Mesh* boundMesh = nullptr;
 
-				m_Pipeline->Bind(currentCMDBuffer);
+			for(auto& batch : m_Batches)
+			{
+				Mesh* mesh = m_CommandQueue[m_DrawOrder[batch.first]].mesh;
 
-				uint32_t dynamicOffset = index * static_cast<uint32_t>(m_DynamicAlignment);
+				if(boundPipeline != m_Pipeline.get())
+				{
+					m_Pipeline->Bind(currentCMDBuffer);
+					boundPipeline = m_Pipeline.get();
+					m_RenderStats.pipelineBinds++;
+				}
 
                 m_CurrentDescriptorSets[0] = m_Pipeline->GetDescriptorSet();
                 m_CurrentDescriptorSets[1] = m_DescriptorSet.get();
-				
-				mesh->GetVertexBuffer()->Bind(currentCMDBuffer, m_Pipeline.get());
-				mesh->GetIndexBuffer()->Bind(currentCMDBuffer);
 
-				Renderer::BindDescriptorSets(m_Pipeline.get(), currentCMDBuffer, dynamicOffset, m_CurrentDescriptorSets);
-				Renderer::DrawIndexed(currentCMDBuffer, DrawType::TRIANGLE, mesh->GetIndexBuffer()->GetCount());
+				// Sorting puts draws of the same mesh next to each other, its buffers stay bound between them
+				if(mesh != boundMesh)
+				{
+					if(boundMesh)
+					{
+						boundMesh->GetVertexBuffer()->Unbind();
+						boundMesh->GetIndexBuffer()->Unbind();
+					}
+
+					mesh->GetVertexBuffer()->Bind(currentCMDBuffer, m_Pipeline.get());
+					mesh->GetIndexBuffer()->Bind(currentCMDBuffer);
+					boundMesh = mesh;
+					m_RenderStats.vertexBufferBinds++;
+					m_RenderStats.indexBufferBinds++;
+				}
 
-				mesh->GetVertexBuffer()->Unbind();
-				mesh->GetIndexBuffer()->Unbind();
+				// The model matrix offset changes every batch, so the sets are always rebound
+				Renderer::BindDescriptorSets(m_Pipeline.get(), currentCMDBuffer, batch.dynamicOffset, m_CurrentDescriptorSets);
+				Renderer::DrawIndexedInstanced(currentCMDBuffer, DrawType::TRIANGLE, mesh->GetIndexBuffer()->GetCount(), batch.instanceCount);
+				m_RenderStats.descriptorSetBinds++;
+				m_RenderStats.drawCalls++;
+				m_RenderStats.instances += batch.instanceCount;
+			}
 
-				index++;
+			if(boundMesh)
+			{
+				boundMesh->GetVertexBuffer()->Unbind();
+				boundMesh->GetIndexBuffer()->Unbind();
+			}
+		}
+
+		void ForwardRenderer::OnImGui()
+		{
+			ImGui::TextUnformatted("Forward Renderer");
+
+			ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(2, 2));
+			ImGui::Columns(2);
+			ImGui::Separator();
+
+			const std::pair<const char*, u32> stats[] = {
+				{"Draw Calls", m_RenderStats.drawCalls},
+				{"Instances", m_RenderStats.instances},
+				{"Pipeline Binds", m_RenderStats.pipelineBinds},
+				{"Vertex Buffer Binds", m_RenderStats.vertexBufferBinds},
+				{"Index Buffer Binds", m_RenderStats.indexBufferBinds},
+				{"Descriptor Set Binds", m_RenderStats.descriptorSetBinds}};
+
+			for(auto& stat : stats)
+			{
+				ImGui::AlignTextToFramePadding();
+				ImGui::TextUnformatted(stat.first);
+				ImGui::NextColumn();
+				ImGui::PushItemWidth(-1);
+				ImGui::Text("%u", stat.second);
+				ImGui::PopItemWidth();
+				ImGui::NextColumn();
 			}
+
+			ImGui::Columns(1);
+			ImGui::Separator();
+			ImGui::PopStyleVar();
 		}
 
 		void ForwardRenderer::OnResize(u32 width, u32 height)
@@ -25,11 +25,12 @@ namespace Lumos
 
 			void BeginScene(const Maths::Matrix4& proj, const Maths::Matrix4& view);
 			void Submit(const RenderCommand& command) override;
-			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix) override;
+			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix3x4& transform, const Maths::Matrix4& textureMatrix) override;
 			void EndScene() override;
 			void End() override;
 			void Present() override;
 			void OnResize(u32 width, u32 height) override;
+			void OnImGui() override;
             void PresentToScreen() override {}
             void SetRenderTarget(Texture* texture, bool rebuildFramebuffer) override;
 
@@ -42,27 +43,44 @@ namespace Lumos
 				Lumos::Maths::Matrix4 view;
 			};
 
-			struct UniformBufferModel
+			// Binds and draws recorded by the last Present, counted by the renderer so they don't depend on the backend
+			struct RenderStats
 			{
-				Lumos::Maths::Matrix4* model;
+				u32 drawCalls = 0;
+				u32 instances = 0;
+				u32 pipelineBinds = 0;
+				u32 vertexBufferBinds = 0;
+				u32 indexBufferBinds = 0;
+				u32 descriptorSetBinds = 0;
 			};
 
-			void SetSystemUniforms(Shader* shader) const;
+			// Sorts and batches the queued commands, the draw order is fixed from here on as model matrices are laid out in it
+			void SetSystemUniforms(Shader* shader);
+
+			const RenderStats& GetRenderStats() const
+			{
+				return m_RenderStats;
+			}
 
 		private:
+			// Points the pipeline's descriptor set at the system uniforms and the uniform arena's current buffer
+			void UpdateBufferInfos();
+
 			Texture2D* m_DefaultTexture;
 
 			UniformBuffer* m_UniformBuffer;
-			UniformBuffer* m_ModelUniformBuffer;
 
 			std::vector<Lumos::Graphics::CommandBuffer*> m_CommandBuffers;
 			std::vector<Framebuffer*> m_Framebuffers;
 
-			size_t m_DynamicAlignment;
-			UniformBufferModel m_UBODataDynamic;
-
 			u32 m_CurrentBufferID = 0;
 			bool m_DepthTest = false;
+
+			std::vector<u32> m_DrawOrder; // Indices into m_CommandQueue sorted by their key
+			std::vector<RenderBatch> m_Batches;
+			u32 m_ArenaVersion = 0;
+			Maths::Vector3 m_CameraPosition;
+			RenderStats m_RenderStats;
 		};
 	}
 }
@@ -22,7 +22,7 @@ namespace Lumos
 
 			void Begin() override;
 			void Submit(const RenderCommand& command) override{};
-			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix) override{};
+			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix3x4& transform, const Maths::Matrix4& textureMatrix) override{};
 			void EndScene() override{};
 			void End() override;
 			void Present() override{};
@@ -34,7 +34,7 @@ namespace Lumos
 			virtual void Begin() = 0;
 			virtual void BeginScene(Scene* scene, Camera* overrideCamera, Maths::Transform* overrideCameraTransform) = 0;
 			virtual void Submit(const RenderCommand& command) {};
-			virtual void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix) {};
+			virtual void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix3x4& transform, const Maths::Matrix4& textureMatrix) {};
 			virtual void EndScene() = 0;
 			virtual void End() = 0;
 			virtual void Present() = 0;
@@ -0,0 +1,72 @@
+#include "Precompiled.h"
+#include "RenderCommand.h"
+#include "Graphics/UniformArena.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		// The instanced shaders declare the model matrices as a mat3x4 array with a 48 byte stride, each column holds one Matrix3x4 row
+		static_assert(sizeof(Maths::Matrix3x4) == 48, "Model matrices must be tightly packed 3x4 rows");
+
+		void SortRenderCommands(const std::vector<RenderCommand>& commands, std::vector<u32>& out_drawOrder)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			out_drawOrder.resize(commands.size());
+			for(u32 i = 0; i < static_cast<u32>(out_drawOrder.size()); i++)
+				out_drawOrder[i] = i;
+
+			std::sort(out_drawOrder.begin(), out_drawOrder.end(), [&commands](u32 a, u32 b)
+			{
+				const u64 keyA = commands[a].sortKey;
+				const u64 keyB = commands[b].sortKey;
+				return keyA < keyB || (keyA == keyB && a < b);
+			});
+		}
+
+		void BuildRenderBatches(const std::vector<RenderCommand>& commands, const std::vector<u32>& drawOrder, bool batchByMaterial, UniformArena* arena, std::vector<RenderBatch>& out_batches)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			out_batches.clear();
+
+			const u32 count = static_cast<u32>(drawOrder.size());
+			u32 i = 0;
+
+			while(i < count)
+			{
+				const RenderCommand& first = commands[drawOrder[i]];
+
+				u32 end = i + 1;
+				while(end < count && end - i < MAX_INSTANCES_PER_DRAW)
+				{
+					const RenderCommand& command = commands[drawOrder[end]];
+					if(command.mesh != first.mesh || (batchByMaterial && command.material != first.material))
+						break;
+					end++;
+				}
+
+				RenderBatch batch;
+				batch.first = i;
+				batch.instanceCount = end - i;
+				out_batches.push_back(batch);
+
+				i = end;
+			}
+
+			// Every run is known before allocating, so the arena only grows before any of them is written
+			arena->Reserve(count * sizeof(Maths::Matrix3x4), static_cast<u32>(out_batches.size()));
+
+			for(auto& batch : out_batches)
+			{
+				u8* data = arena->Allocate(batch.instanceCount * sizeof(Maths::Matrix3x4), &batch.dynamicOffset);
+				LUMOS_ASSERT(data, "Uniform arena allocation failed after reserving");
+
+				for(u32 j = batch.first; j < batch.first + batch.instanceCount; j++)
+				{
+					memcpy(data, &commands[drawOrder[j]].transform, sizeof(Maths::Matrix3x4));
+					data += sizeof(Maths::Matrix3x4);
+				}
+			}
+		}
+	}
+}
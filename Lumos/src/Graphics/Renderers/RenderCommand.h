@@ -9,6 +9,7 @@ namespace Lumos
 	namespace Graphics
 	{
 		class Material;
+		class UniformArena;
 		
 		struct LUMOS_EXPORT RendererUniform
 		{
@@ -20,9 +21,67 @@ namespace Lumos
 		{
 			Mesh* mesh = nullptr;
 			Material* material = nullptr;
-			Maths::Matrix4 transform;
+			Maths::Matrix3x4 transform;
 			Maths::Matrix4 textureMatrix;
 			std::vector<RendererUniform> uniforms;
+			u64 sortKey = 0; // See MakeRenderSortKey, commands without one are drawn first
 		};
+
+		// Bits given to each part of a sort key, from most to least significant
+		enum RenderSortKeyBits : u32
+		{
+			RenderSortKeyBits_Pipeline = 8,
+			RenderSortKeyBits_DescriptorSet = 16,
+			RenderSortKeyBits_Mesh = 20,
+			RenderSortKeyBits_Depth = 20
+		};
+
+		static_assert(RenderSortKeyBits_Pipeline + RenderSortKeyBits_DescriptorSet + RenderSortKeyBits_Mesh + RenderSortKeyBits_Depth == 64, "Render sort key must use all 64 bits");
+
+		namespace Internal
+		{
+			_FORCE_INLINE_ u64 HashSortKeyPointer(const void* pointer, u32 bits)
+			{
+				u64 hash = static_cast<u64>(reinterpret_cast<uintptr_t>(pointer));
+				hash ^= hash >> 33;
+				hash *= 0xff51afd7ed558ccdULL;
+				hash ^= hash >> 33;
+				return hash & ((1ULL << bits) - 1);
+			}
+		}
+
+		// Sorting by the key groups commands by pipeline, then descriptor set, then mesh, drawing each group front
+		// to back. Pointers are hashed into their bits, so equal keys don't guarantee equal state and redundant
+		// binds still have to be detected by comparing the objects.
+		_FORCE_INLINE_ u64 MakeRenderSortKey(const void* pipeline, const void* descriptorSet, const void* mesh, float depth)
+		{
+			// The bit pattern of a non negative float increases with its value
+			u32 depthBits = 0;
+			if(depth > 0.0f)
+				memcpy(&depthBits, &depth, sizeof(float));
+
+			u64 key = Internal::HashSortKeyPointer(pipeline, RenderSortKeyBits_Pipeline);
+			key = (key << RenderSortKeyBits_DescriptorSet) | Internal::HashSortKeyPointer(descriptorSet, RenderSortKeyBits_DescriptorSet);
+			key = (key << RenderSortKeyBits_Mesh) | Internal::HashSortKeyPointer(mesh, RenderSortKeyBits_Mesh);
+			key = (key << RenderSortKeyBits_Depth) | (depthBits >> (32 - RenderSortKeyBits_Depth));
+			return key;
+		}
+
+		// Consecutive commands in draw order drawn by one instanced call. Their model matrices are packed
+		// contiguously at dynamicOffset in the uniform arena and read by the shader with gl_InstanceIndex.
+		struct LUMOS_EXPORT RenderBatch
+		{
+			u32 first = 0; // Position of the first command in the draw order
+			u32 instanceCount = 0;
+			u32 dynamicOffset = 0;
+		};
+
+		// Command indices ordered by sort key, ties keep their submission order so the draw order is stable between frames
+		LUMOS_EXPORT void SortRenderCommands(const std::vector<RenderCommand>& commands, std::vector<u32>& out_drawOrder);
+
+		// Splits the sorted commands into runs sharing a mesh, and a material if batchByMaterial, of at most MAX_INSTANCES_PER_DRAW
+		// and allocates each run's transforms from the arena, which grows first if they don't all fit. Check the arena's
+		// version afterwards, descriptor sets binding it may need updating.
+		LUMOS_EXPORT void BuildRenderBatches(const std::vector<RenderCommand>& commands, const std::vector<u32>& drawOrder, bool batchByMaterial, UniformArena* arena, std::vector<RenderBatch>& out_batches);
 	}
 }
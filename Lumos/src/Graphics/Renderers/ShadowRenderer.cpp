@@ -14,6 +14,10 @@
 #include "Graphics/Model.h"
 #include "Graphics/Camera/Camera.h"
 #include "Graphics/Light.h"
+#include "Graphics/RenderManager.h"
+#include "Graphics/UniformArena.h"
+#include "Graphics/VisibilityCuller.h"
+#include "Core/Application.h"
 #include "Maths/Transform.h"
 
 #include "Scene/Scene.h"
@@ -44,7 +48,6 @@ namespace Lumos
 			, m_ShadowMapSize(shadowMapSize)
 			, m_ShadowMapsInvalidated(true)
 			, m_UniformBuffer(nullptr)
-			, m_ModelUniformBuffer(nullptr)
 		{
 			m_Shader = Ref<Graphics::Shader>(Shader::CreateFromFile("Shadow", "/CoreShaders/"));
 			if(texture == nullptr)
@@ -76,10 +79,7 @@ namespace Lumos
             m_PushConstants.clear();
 
 			delete m_UniformBuffer;
-			delete m_ModelUniformBuffer;
 			delete m_CommandBuffer;
-
-			Memory::AlignedFree(uboDataDynamic.model);
 		}
 
 		void ShadowRenderer::Init()
@@ -90,14 +90,6 @@ namespace Lumos
 			memset(m_VSSystemUniformBuffer, 0, m_VSSystemUniformBufferSize);
 			m_VSSystemUniformBufferOffsets.resize(VSSystemUniformIndex_Size);
 
-			const size_t minUboAlignment = size_t(Graphics::Renderer::GetCapabilities().UniformBufferOffsetAlignment);
-
-			m_DynamicAlignment = sizeof(Lumos::Maths::Matrix4);
-			if(minUboAlignment > 0)
-			{
-				m_DynamicAlignment = (m_DynamicAlignment + minUboAlignment - 1) & ~(minUboAlignment - 1);
-			}
-
 			auto pushConstant = Graphics::PushConstant();
             pushConstant.type = Graphics::PushConstantDataType::UINT;
             pushConstant.size = sizeof(i32);
@@ -162,30 +154,24 @@ namespace Lumos
 		void ShadowRenderer::Present()
 		{
 			LUMOS_PROFILE_FUNCTION();
-			int index = 0;
-
 			m_RenderPass->BeginRenderpass(m_CommandBuffer, Maths::Vector4(0.0f), m_ShadowFramebuffer[m_Layer], Graphics::INLINE, m_ShadowMapSize, m_ShadowMapSize);
 
 			m_Pipeline->Bind(m_CommandBuffer);
 
-			for(auto& command : m_CommandQueue)
+			for(auto& batch : m_Batches)
 			{
-				Mesh* mesh = command.mesh;
-
-				const uint32_t dynamicOffset = index * static_cast<uint32_t>(m_DynamicAlignment);
+				Mesh* mesh = m_CommandQueue[m_DrawOrder[batch.first]].mesh;
 
                 m_CurrentDescriptorSets[0] = m_Pipeline->GetDescriptorSet();
 
 				mesh->GetVertexBuffer()->Bind(m_CommandBuffer, m_Pipeline.get());
 				mesh->GetIndexBuffer()->Bind(m_CommandBuffer);
                 
-				Renderer::BindDescriptorSets(m_Pipeline.get(), m_CommandBuffer, dynamicOffset, m_CurrentDescriptorSets);
-				Renderer::DrawIndexed(m_CommandBuffer, DrawType::TRIANGLE, mesh->GetIndexBuffer()->GetCount());
+				Renderer::BindDescriptorSets(m_Pipeline.get(), m_CommandBuffer, batch.dynamicOffset, m_CurrentDescriptorSets);
+				Renderer::DrawIndexedInstanced(m_CommandBuffer, DrawType::TRIANGLE, mesh->GetIndexBuffer()->GetCount(), batch.instanceCount);
 
 				mesh->GetVertexBuffer()->Unbind();
 				mesh->GetIndexBuffer()->Unbind();
-
-				index++;
 			}
 
 			m_RenderPass->EndRenderpass(m_CommandBuffer);
@@ -218,39 +204,32 @@ namespace Lumos
 
 			Begin();
 
-			auto& registry = scene->GetRegistry();
+			auto& culler = *Application::Get().GetRenderManager()->GetVisibilityCuller();
 
-			auto group = registry.group<Model>(entt::get<Maths::Transform>);
+			// Every cascade binds the same descriptor set, so the arena can't be recreated once the first one is recorded.
+			// Culling results are cached, the cascades reuse them below.
+			u32 cascadeDraws = 0;
+			for(u32 i = 0; i < m_ShadowMapNum; ++i)
+			{
+				Maths::Frustum f;
+				f.Define(m_ShadowProjView[i]);
+				cascadeDraws += static_cast<u32>(culler.Cull(f).size());
+			}
+			Application::Get().GetRenderManager()->GetUniformArena()->Reserve(cascadeDraws * sizeof(Maths::Matrix3x4), cascadeDraws);
 
 			for(u32 i = 0; i < m_ShadowMapNum; ++i)
 			{
 				LUMOS_PROFILE_SCOPE("ShadowRenderer::RenderScene Per Shadow Map");
 				m_Layer = i;
+				m_CommandQueue.clear();
 
 				Maths::Frustum f;
 				f.Define(m_ShadowProjView[i]);
 
-				for(auto entity : group)
+				for(u32 index : culler.Cull(f))
 				{
-					const auto& [model, trans] = group.get<Model, Maths::Transform>(entity);
-                    const auto& meshes = model.GetMeshes();
-                                   
-                   for(auto mesh : meshes)
-                   {
-                        if(mesh->GetActive())
-                        {
-                            auto& worldTransform = trans.GetWorldMatrix();
-
-                            auto bb = mesh->GetBoundingBox();
-                            auto bbCopy = bb->Transformed(worldTransform);
-                            auto inside = f.IsInsideFast(bbCopy);
-
-                            if(inside == Maths::Intersection::OUTSIDE)
-                                continue;
-
-                            SubmitMesh(mesh.get(), nullptr, worldTransform, Maths::Matrix4());
-                        }
-                   }
+					const auto& renderable = culler.GetRenderable(index);
+					SubmitMesh(renderable.mesh, nullptr, renderable.worldTransform, Maths::Matrix4());
 				}
 
 				SetSystemUniforms(m_Shader.get());
@@ -489,13 +468,9 @@ namespace Lumos
 				m_UniformBuffer->Init(bufferSize, nullptr);
 			}
 
-			if(m_ModelUniformBuffer == nullptr)
-			{
-				m_ModelUniformBuffer = Graphics::UniformBuffer::Create();
-				const uint32_t bufferSize2 = static_cast<uint32_t>(MAX_OBJECTS * m_DynamicAlignment);
-				uboDataDynamic.model = static_cast<Maths::Matrix4*>(Memory::AlignedAlloc(bufferSize2, m_DynamicAlignment));
-				m_ModelUniformBuffer->Init(bufferSize2, nullptr);
-			}
+			// Model matrices live in the shared arena, its buffer changes when it grows
+			UniformArena* arena = Application::Get().GetRenderManager()->GetUniformArena();
+			m_ArenaVersion = arena->GetVersion();
 
 			std::vector<Graphics::BufferInfo> bufferInfos;
 
@@ -510,10 +485,10 @@ namespace Lumos
 			bufferInfo.systemUniforms = false;
 
 			Graphics::BufferInfo bufferInfo2 = {};
-			bufferInfo2.buffer = m_ModelUniformBuffer;
+			bufferInfo2.buffer = arena->GetBuffer();
 			bufferInfo2.offset = 0;
 			bufferInfo2.name = "UniformBufferObject2";
-			bufferInfo2.size = sizeof(Maths::Matrix4);
+			bufferInfo2.size = arena->GetBindRange();
 			bufferInfo2.type = Graphics::DescriptorType::UNIFORM_BUFFER_DYNAMIC;
 			bufferInfo2.binding = 1;
 			bufferInfo2.shaderType = ShaderType::VERTEX;
@@ -530,15 +505,15 @@ namespace Lumos
 			LUMOS_PROFILE_FUNCTION();
 			m_UniformBuffer->SetData(sizeof(UniformBufferObject), *&m_VSSystemUniformBuffer);
 
-			int index = 0;
+			// Each cascade allocates its own matrices, the arena only resets at the start of a frame
+			UniformArena* arena = Application::Get().GetRenderManager()->GetUniformArena();
+			SortRenderCommands(m_CommandQueue, m_DrawOrder);
+			BuildRenderBatches(m_CommandQueue, m_DrawOrder, false, arena, m_Batches);
+			arena->Upload();
 
-			for(auto& command : m_CommandQueue)
-			{
-				Maths::Matrix4* modelMat = reinterpret_cast<Maths::Matrix4*>((reinterpret_cast<uint64_t>(uboDataDynamic.model) + (index * m_DynamicAlignment)));
-				*modelMat = command.transform;
-				index++;
-			}
-			m_ModelUniformBuffer->SetDynamicData(static_cast<uint32_t>(index * m_DynamicAlignment), sizeof(Maths::Matrix4), &*uboDataDynamic.model);
+			// Only the first cascade can see a new buffer, RenderScene reserves for all of them up front
+			if(m_ArenaVersion != arena->GetVersion())
+				CreateUniformBuffer();
 		}
 
 		void ShadowRenderer::Submit(const RenderCommand& command)
@@ -546,13 +521,17 @@ namespace Lumos
 			m_CommandQueue.emplace_back(command);
 		}
 
-		void ShadowRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix)
+		void ShadowRenderer::SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix3x4& transform, const Maths::Matrix4& textureMatrix)
 		{
 			LUMOS_PROFILE_FUNCTION();
 			RenderCommand command;
 			command.mesh = mesh;
 			command.transform = transform;
 			command.material = material;
+
+			// Depth only, so draws are just grouped by mesh
+			command.sortKey = MakeRenderSortKey(m_Pipeline.get(), nullptr, mesh, 0.0f);
+
 			Submit(command);
 		}
 
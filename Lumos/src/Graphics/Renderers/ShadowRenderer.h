@@ -46,7 +46,7 @@ namespace Lumos
 
 			void Begin() override;
 			void Submit(const RenderCommand& command) override;
-			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix) override;
+			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix3x4& transform, const Maths::Matrix4& textureMatrix) override;
 			void EndScene() override;
 			void End() override;
 			void Present() override;
@@ -90,11 +90,6 @@ namespace Lumos
 				Lumos::Maths::Matrix4 projView[SHADOWMAP_MAX];
 			};
 
-			struct UniformBufferModel
-			{
-				Lumos::Maths::Matrix4* model;
-			};
-
 			void CreateGraphicsPipeline(Graphics::RenderPass* renderPass);
 			void CreateFramebuffers();
 			void CreateUniformBuffer();
@@ -114,12 +109,12 @@ namespace Lumos
 			Maths::Vector4 m_SplitDepth[SHADOWMAP_MAX];
 
 			Lumos::Graphics::UniformBuffer* m_UniformBuffer;
-			Lumos::Graphics::UniformBuffer* m_ModelUniformBuffer;
 			Lumos::Graphics::CommandBuffer* m_CommandBuffer = nullptr;
 
 			u32 m_Layer = 0;
-			size_t m_DynamicAlignment = 0;
-			UniformBufferModel uboDataDynamic;
+			std::vector<u32> m_DrawOrder;
+			std::vector<RenderBatch> m_Batches;
+			u32 m_ArenaVersion = 0;
             
             std::vector<Graphics::PushConstant> m_PushConstants;
 		};
@@ -57,6 +57,30 @@ namespace Lumos
             }
         }
 
+        void Sprite::LoadTextureStreamed(const std::string& filePath)
+        {
+            AssetStreamer* streamer = Application::Get().GetAssetStreamer();
+            if(!streamer || streamer->IsSynchronous())
+            {
+                m_Texture = Ref<Graphics::Texture2D>(Graphics::Texture2D::CreateFromFile("sprite", filePath));
+                return;
+            }
+
+            m_StreamedTexture = streamer->LoadTexture2D("sprite", filePath);
+            m_Texture = m_StreamedTexture->Get();
+        }
+
+        bool Sprite::ResolveStreamedLoad()
+        {
+            if(!m_StreamedTexture || m_StreamedTexture->IsLoading())
+                return false;
+
+            // A failed load leaves the sprite untextured, as a failed synchronous load did
+            m_Texture = m_StreamedTexture->IsReady() ? m_StreamedTexture->Get() : nullptr;
+            m_StreamedTexture.reset();
+            return true;
+        }
+
 		void Sprite::OnImGui()
 		{
 			ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(2, 2));
@@ -1,6 +1,7 @@
 #pragma once
 #include "Maths/Maths.h"
 #include "Renderable2D.h"
+#include "Utilities/AssetStreamer.h"
 
 #include <cereal/cereal.hpp>
 
@@ -30,11 +31,18 @@ namespace Lumos
 			void OnImGui();
         
             void SetTextureFromFile(const std::string& filePath);
+
+            // Loads the texture on the asset streamer, the default texture is drawn until it arrives
+            void LoadTextureStreamed(const std::string& filePath);
+
+            // Takes the texture of a finished streamed load, returns false while it is still loading
+            bool ResolveStreamedLoad();
+            const Ref<StreamedAsset<Texture2D>>& GetStreamedTexture() const { return m_StreamedTexture; }
 		
 			template<typename Archive>
 			void save(Archive& archive) const
 			{
-				archive(cereal::make_nvp("TexturePath", m_Texture ? m_Texture->GetFilepath() : ""),
+				archive(cereal::make_nvp("TexturePath", m_StreamedTexture ? m_StreamedTexture->GetPath() : m_Texture ? m_Texture->GetFilepath() : ""),
 						cereal::make_nvp("Position", m_Position),
 						cereal::make_nvp("Scale", m_Scale),
 						cereal::make_nvp("Colour", m_Colour));
@@ -50,8 +58,11 @@ namespace Lumos
 					cereal::make_nvp("Colour", m_Colour));
 
                 if(!textureFilePath.empty())
-                    m_Texture = Ref<Graphics::Texture2D>(Graphics::Texture2D::CreateFromFile("sprite", textureFilePath));
+                    LoadTextureStreamed(textureFilePath);
 			}
+
+		private:
+			Ref<StreamedAsset<Texture2D>> m_StreamedTexture;
 		};
 	}
 }
@@ -0,0 +1,157 @@
+#include "Precompiled.h"
+#include "UniformArena.h"
+#include "API/UniformBuffer.h"
+#include "API/Renderer.h"
+
+#include <imgui/imgui.h>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		static u32 AlignUp(u32 value, u32 alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		UniformArena::UniformArena(u32 frameCount, u32 regionSize, u32 bindRange)
+			: m_FrameCount(Maths::Max(frameCount, 1u))
+			, m_BindRange(bindRange)
+		{
+			m_Alignment = Maths::Max(static_cast<u32>(Renderer::GetCapabilities().UniformBufferOffsetAlignment), 1u);
+			m_RegionSize = AlignUp(regionSize, m_Alignment);
+			CreateBuffer();
+		}
+
+		UniformArena::~UniformArena()
+		{
+			for(auto& retired : m_Retired)
+			{
+				delete retired.buffer;
+				delete[] retired.data;
+			}
+
+			delete m_Buffer;
+			delete[] m_Data;
+		}
+
+		void UniformArena::CreateBuffer()
+		{
+			LUMOS_PROFILE_FUNCTION();
+			// Command buffers recorded this frame may still bind the old buffer, one extra frame covers a
+			// BeginFrame that runs before the swapchain has waited on the image's last use
+			if(m_Buffer)
+				m_Retired.push_back({m_Buffer, m_Data, m_FrameCount + 1});
+
+			// The bind range past the last region keeps an allocation at its end readable
+			const u32 size = m_FrameCount * m_RegionSize + m_BindRange;
+			m_Data = new u8[size];
+			memset(m_Data, 0, size);
+
+			m_Buffer = UniformBuffer::Create();
+			m_Buffer->Init(size, nullptr);
+			m_Buffer->SetDynamicDataRange(0, 0, m_BindRange, m_Data);
+			m_Version++;
+		}
+
+		void UniformArena::BeginFrame(u32 frameIndex)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			// Buffers are retired mid frame and freed once that frame can no longer be in flight
+			for(u32 i = 0; i < static_cast<u32>(m_Retired.size());)
+			{
+				if(--m_Retired[i].framesLeft == 0)
+				{
+					delete m_Retired[i].buffer;
+					delete[] m_Retired[i].data;
+					m_Retired[i] = m_Retired.back();
+					m_Retired.pop_back();
+				}
+				else
+					i++;
+			}
+
+			m_FrameIndex = frameIndex % m_FrameCount;
+			m_Used = 0;
+			m_Uploaded = 0;
+			m_FrameTotal = 0;
+		}
+
+		void UniformArena::Reserve(u32 size, u32 allocationCount)
+		{
+			// Each allocation can be padded by up to one alignment less a byte
+			const u32 padding = allocationCount * (m_Alignment - 1);
+			if(m_Used + size + padding <= m_RegionSize)
+				return;
+
+			LUMOS_PROFILE_FUNCTION();
+			// Sized for everything this frame has allocated, so the next frames fit in one buffer again
+			const u32 required = m_FrameTotal + size + padding;
+			u32 regionSize = m_RegionSize;
+			while(regionSize < required)
+				regionSize *= 2;
+
+			LUMOS_LOG_INFO("Uniform arena regions growing from {0} to {1} bytes", m_RegionSize, regionSize);
+			m_RegionSize = AlignUp(regionSize, m_Alignment);
+			CreateBuffer();
+
+			m_Used = 0;
+			m_Uploaded = 0;
+		}
+
+		u8* UniformArena::Allocate(u32 size, u32* out_offset)
+		{
+			const u32 offset = AlignUp(m_Used, m_Alignment);
+			if(offset + size > m_RegionSize)
+				return nullptr;
+
+			m_FrameTotal += offset + size - m_Used;
+			m_HighWaterMark = Maths::Max(m_HighWaterMark, m_FrameTotal);
+			m_Used = offset + size;
+
+			*out_offset = m_FrameIndex * m_RegionSize + offset;
+			return m_Data + *out_offset;
+		}
+
+		void UniformArena::Upload()
+		{
+			LUMOS_PROFILE_FUNCTION();
+			if(m_Used == m_Uploaded)
+				return;
+
+			const u32 offset = m_FrameIndex * m_RegionSize + m_Uploaded;
+			m_Buffer->SetDynamicDataRange(offset, m_Used - m_Uploaded, m_BindRange, m_Data + offset);
+			m_Uploaded = m_Used;
+		}
+
+		void UniformArena::OnImGui()
+		{
+			ImGui::TextUnformatted("Uniform Arena");
+
+			ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(2, 2));
+			ImGui::Columns(2);
+			ImGui::Separator();
+
+			const std::pair<const char*, u32> stats[] = {
+				{"Used (bytes)", m_Used},
+				{"Region Size (bytes)", m_RegionSize},
+				{"High Water Mark (bytes)", m_HighWaterMark},
+				{"Regions", m_FrameCount}};
+
+			for(auto& stat : stats)
+			{
+				ImGui::AlignTextToFramePadding();
+				ImGui::TextUnformatted(stat.first);
+				ImGui::NextColumn();
+				ImGui::PushItemWidth(-1);
+				ImGui::Text("%u", stat.second);
+				ImGui::PopItemWidth();
+				ImGui::NextColumn();
+			}
+
+			ImGui::Columns(1);
+			ImGui::Separator();
+			ImGui::PopStyleVar();
+		}
+	}
+}
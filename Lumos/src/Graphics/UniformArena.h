@@ -0,0 +1,97 @@
+#pragma once
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		class UniformBuffer;
+
+		// Linear allocator for per draw uniform data shared by the renderers. A single dynamic uniform buffer is split
+		// into a region per swapchain image and each frame allocates from its own, so frames still in flight keep their data.
+		// Reserving more than is left of a region recreates the buffer with larger regions.
+		class LUMOS_EXPORT UniformArena
+		{
+		public:
+			UniformArena(u32 frameCount, u32 regionSize, u32 bindRange);
+			~UniformArena();
+
+			NONCOPYABLE(UniformArena)
+
+			// Starts allocating from the frame's region and frees buffers retired by frames no longer in flight
+			void BeginFrame(u32 frameIndex);
+
+			// Makes sure allocationCount allocations totalling size bytes fit in the current frame. When the region is too
+			// small the buffer is recreated and GetVersion changes, allocations made earlier in the frame stay valid in the
+			// old buffer until it is no longer in flight. Descriptor sets have to be updated after reserving, not between draws.
+			void Reserve(u32 size, u32 allocationCount);
+
+			// Aligned sub-allocation from the current frame, out_offset is the dynamic offset to bind it at.
+			// Returns nullptr when the region is full, Reserve first.
+			u8* Allocate(u32 size, u32* out_offset);
+
+			// Copies everything allocated since the last upload to the GPU
+			void Upload();
+
+			UniformBuffer* GetBuffer() const
+			{
+				return m_Buffer;
+			}
+
+			// Bytes readable from a dynamic offset, the range descriptor sets bind the buffer with
+			u32 GetBindRange() const
+			{
+				return m_BindRange;
+			}
+
+			// Changes whenever the buffer is recreated, descriptor sets using it have to be updated
+			u32 GetVersion() const
+			{
+				return m_Version;
+			}
+
+			u32 GetUsed() const
+			{
+				return m_Used;
+			}
+
+			u32 GetRegionSize() const
+			{
+				return m_RegionSize;
+			}
+
+			// Most bytes any frame has allocated, across all the buffers it used
+			u32 GetHighWaterMark() const
+			{
+				return m_HighWaterMark;
+			}
+
+			void OnImGui();
+
+		private:
+			struct RetiredBuffer
+			{
+				UniformBuffer* buffer;
+				u8* data;
+				u32 framesLeft;
+			};
+
+			void CreateBuffer();
+
+			UniformBuffer* m_Buffer = nullptr;
+			u8* m_Data = nullptr; // CPU copy of every region
+			std::vector<RetiredBuffer> m_Retired;
+
+			u32 m_FrameCount;
+			u32 m_RegionSize;
+			u32 m_BindRange;
+			u32 m_Alignment = 1;
+
+			u32 m_FrameIndex = 0;
+			u32 m_Used = 0;
+			u32 m_Uploaded = 0;
+			u32 m_FrameTotal = 0; // Bytes allocated this frame, including buffers retired during it
+			u32 m_HighWaterMark = 0;
+			u32 m_Version = 0;
+		};
+	}
+}
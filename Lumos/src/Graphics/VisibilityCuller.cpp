@@ -0,0 +1,231 @@
+#include "Precompiled.h"
+#include "VisibilityCuller.h"
+#include "Mesh.h"
+#include "Model.h"
+#include "Maths/Transform.h"
+#include "Core/JobSystem.h"
+
+#include <entt/entt.hpp>
+#include <imgui/imgui.h>
+
+#ifdef LUMOS_SSE
+#include <emmintrin.h>
+#endif
+
+// Boxes tested per job are CULL_GROUPS_PER_JOB * 4
+#define CULL_GROUPS_PER_JOB 64
+#define BOUNDS_PER_JOB 64
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		void VisibilityCuller::Update(entt::registry& registry)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			m_ResultCount = 0;
+			m_CullCount = 0;
+			m_DirtyIndices.clear();
+
+			u32 count = 0;
+
+			auto group = registry.group<Model>(entt::get<Maths::Transform>);
+
+			for(auto entity : group)
+			{
+				const auto& [model, trans] = group.get<Model, Maths::Transform>(entity);
+				const u32 worldMatrixVersion = trans.GetWorldMatrixVersion();
+
+				for(auto& mesh : model.GetMeshes())
+				{
+					if(!mesh->GetActive())
+						continue;
+
+					if(count == m_Renderables.size())
+						m_Renderables.emplace_back();
+
+					// Renderables keep their slot while the scene doesn't change, so most frames only meshes the scene graph
+					// moved are dirty
+					Renderable& renderable = m_Renderables[count];
+					if(renderable.entity != entity || renderable.mesh != mesh.get() || renderable.worldMatrixVersion != worldMatrixVersion)
+					{
+						renderable.entity = entity;
+						renderable.mesh = mesh.get();
+						renderable.worldTransform = trans.GetWorldMatrix3x4();
+						renderable.worldMatrixVersion = worldMatrixVersion;
+						m_DirtyIndices.push_back(count);
+					}
+
+					count++;
+				}
+			}
+
+			m_Renderables.resize(count);
+
+			const u32 paddedCount = (count + 3) & ~3u;
+			for(auto* array : {&m_CentreX, &m_CentreY, &m_CentreZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ})
+				array->resize(paddedCount, 0.0f);
+
+			m_UpdatedBounds = static_cast<u32>(m_DirtyIndices.size());
+
+			if(m_UpdatedBounds <= BOUNDS_PER_JOB)
+			{
+				for(u32 index : m_DirtyIndices)
+					UpdateBounds(index);
+			}
+			else
+			{
+				auto job = System::JobSystem::Dispatch(m_UpdatedBounds, BOUNDS_PER_JOB, [&](JobDispatchArgs args)
+				{
+					UpdateBounds(m_DirtyIndices[args.jobIndex]);
+				});
+				System::JobSystem::Wait(job);
+			}
+		}
+
+		void VisibilityCuller::UpdateBounds(u32 index)
+		{
+			const Renderable& renderable = m_Renderables[index];
+			const Maths::BoundingBox box = renderable.mesh->GetBoundingBox()->Transformed(renderable.worldTransform);
+
+			const Maths::Vector3 centre = box.Center();
+			const Maths::Vector3 extent = centre - box.min_;
+
+			m_CentreX[index] = centre.x;
+			m_CentreY[index] = centre.y;
+			m_CentreZ[index] = centre.z;
+			m_ExtentX[index] = extent.x;
+			m_ExtentY[index] = extent.y;
+			m_ExtentZ[index] = extent.z;
+		}
+
+		const std::vector<u32>& VisibilityCuller::Cull(const Maths::Frustum& frustum)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			for(u32 i = 0; i < m_ResultCount; i++)
+			{
+				if(memcmp(m_Results[i].planes, frustum.planes_, sizeof(frustum.planes_)) == 0)
+					return m_Results[i].visible;
+			}
+
+			if(m_ResultCount == m_Results.size())
+				m_Results.emplace_back();
+
+			CullResult& result = m_Results[m_ResultCount++];
+			memcpy(result.planes, frustum.planes_, sizeof(frustum.planes_));
+			result.visible.clear();
+
+			const u32 count = GetRenderableCount();
+			const u32 groupCount = (count + 3) / 4;
+			m_Visibility.resize(groupCount * 4);
+			m_CullCount++;
+
+			if(groupCount <= CULL_GROUPS_PER_JOB)
+			{
+				CullGroups(frustum, 0, groupCount);
+			}
+			else
+			{
+				const u32 jobCount = (groupCount + CULL_GROUPS_PER_JOB - 1) / CULL_GROUPS_PER_JOB;
+				auto job = System::JobSystem::Dispatch(jobCount, 1, [&](JobDispatchArgs args)
+				{
+					const u32 firstGroup = args.jobIndex * CULL_GROUPS_PER_JOB;
+					CullGroups(frustum, firstGroup, Maths::Min(static_cast<u32>(CULL_GROUPS_PER_JOB), groupCount - firstGroup));
+				});
+				System::JobSystem::Wait(job);
+			}
+
+			for(u32 i = 0; i < count; i++)
+			{
+				if(m_Visibility[i])
+					result.visible.push_back(i);
+			}
+
+			return result.visible;
+		}
+
+		void VisibilityCuller::CullGroups(const Maths::Frustum& frustum, u32 firstGroup, u32 groupCount)
+		{
+			// Same test as Frustum::IsInsideFast(BoundingBox), a box is outside if it is fully behind any plane.
+			// The sums are added in the same order, so both give the same result for boxes touching a plane.
+#ifdef LUMOS_SSE
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+
+			for(u32 group = firstGroup; group < firstGroup + groupCount; group++)
+			{
+				const u32 base = group * 4;
+				const __m128 cx = _mm_loadu_ps(&m_CentreX[base]);
+				const __m128 cy = _mm_loadu_ps(&m_CentreY[base]);
+				const __m128 cz = _mm_loadu_ps(&m_CentreZ[base]);
+				const __m128 ex = _mm_loadu_ps(&m_ExtentX[base]);
+				const __m128 ey = _mm_loadu_ps(&m_ExtentY[base]);
+				const __m128 ez = _mm_loadu_ps(&m_ExtentZ[base]);
+
+				__m128 outside = _mm_setzero_ps();
+
+				for(const auto& plane : frustum.planes_)
+				{
+					__m128 dist = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.normal_.x), cx), _mm_mul_ps(_mm_set1_ps(plane.normal_.y), cy));
+					dist = _mm_add_ps(_mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.normal_.z), cz)), _mm_set1_ps(plane.d_));
+
+					__m128 absDist = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.absNormal_.x), ex), _mm_mul_ps(_mm_set1_ps(plane.absNormal_.y), ey));
+					absDist = _mm_add_ps(absDist, _mm_mul_ps(_mm_set1_ps(plane.absNormal_.z), ez));
+
+					outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_xor_ps(absDist, signMask)));
+				}
+
+				const int mask = _mm_movemask_ps(outside);
+				for(u32 lane = 0; lane < 4; lane++)
+					m_Visibility[base + lane] = (mask & (1 << lane)) ? 0 : 1;
+			}
+#else
+			for(u32 i = firstGroup * 4; i < (firstGroup + groupCount) * 4; i++)
+			{
+				u8 visible = 1;
+				for(const auto& plane : frustum.planes_)
+				{
+					const float dist = plane.normal_.x * m_CentreX[i] + plane.normal_.y * m_CentreY[i] + plane.normal_.z * m_CentreZ[i] + plane.d_;
+					const float absDist = plane.absNormal_.x * m_ExtentX[i] + plane.absNormal_.y * m_ExtentY[i] + plane.absNormal_.z * m_ExtentZ[i];
+
+					if(dist < -absDist)
+					{
+						visible = 0;
+						break;
+					}
+				}
+				m_Visibility[i] = visible;
+			}
+#endif
+		}
+
+		void VisibilityCuller::OnImGui()
+		{
+			ImGui::TextUnformatted("Visibility Culling");
+
+			ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(2, 2));
+			ImGui::Columns(2);
+			ImGui::Separator();
+
+			const std::pair<const char*, u32> stats[] = {
+				{"Renderables", GetRenderableCount()},
+				{"Updated Bounds", m_UpdatedBounds},
+				{"Frustums Culled", m_CullCount},
+				{"Shared Results", m_ResultCount}};
+
+			for(auto& stat : stats)
+			{
+				ImGui::AlignTextToFramePadding();
+				ImGui::TextUnformatted(stat.first);
+				ImGui::NextColumn();
+				ImGui::PushItemWidth(-1);
+				ImGui::Text("%u", stat.second);
+				ImGui::PopItemWidth();
+				ImGui::NextColumn();
+			}
+
+			ImGui::Columns(1);
+			ImGui::Separator();
+			ImGui::PopStyleVar();
+		}
+	}
+}
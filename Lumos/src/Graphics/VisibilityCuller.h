@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Maths/Maths.h"
+#include "Maths/Frustum.h"
+
+#include <entt/entity/fwd.hpp>
+#include <deque>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		class Mesh;
+
+		// World space bounds of every active mesh in the scene, shared by the renderers. Bounds are kept in flat
+		// arrays and only recomputed when the scene graph sets a new world matrix on a mesh's transform, culling tests
+		// four boxes at a time across the job system. Results are cached per frustum so renderers viewing through the
+		// same camera share a list.
+		class LUMOS_EXPORT VisibilityCuller
+		{
+		public:
+			struct Renderable
+			{
+				entt::entity entity;
+				Mesh* mesh = nullptr;
+				Maths::Matrix3x4 worldTransform;
+				u32 worldMatrixVersion = 0; // Transform::GetWorldMatrixVersion when worldTransform was copied
+			};
+
+			VisibilityCuller() = default;
+			~VisibilityCuller() = default;
+
+			NONCOPYABLE(VisibilityCuller)
+
+			// Gathers the Model/Transform group and refreshes changed bounds. Called once a frame after the
+			// scene graph update, clears the cached cull results.
+			void Update(entt::registry& registry);
+
+			// Indices of the renderables that are at least partially inside the frustum, in renderable order.
+			// Valid until the next Update.
+			const std::vector<u32>& Cull(const Maths::Frustum& frustum);
+
+			const Renderable& GetRenderable(u32 index) const
+			{
+				return m_Renderables[index];
+			}
+
+			u32 GetRenderableCount() const
+			{
+				return static_cast<u32>(m_Renderables.size());
+			}
+
+			void OnImGui();
+
+		private:
+			struct CullResult
+			{
+				Maths::Plane planes[Maths::NUM_FRUSTUM_PLANES];
+				std::vector<u32> visible;
+			};
+
+			void UpdateBounds(u32 index);
+			void CullGroups(const Maths::Frustum& frustum, u32 firstGroup, u32 groupCount);
+
+			std::vector<Renderable> m_Renderables;
+			std::vector<u32> m_DirtyIndices;
+
+			// Box centres and half extents, padded to a multiple of four
+			std::vector<float> m_CentreX, m_CentreY, m_CentreZ;
+			std::vector<float> m_ExtentX, m_ExtentY, m_ExtentZ;
+			std::vector<u8> m_Visibility;
+
+			std::deque<CullResult> m_Results; // A deque so returned lists stay put as more are added
+			u32 m_ResultCount = 0;
+
+			u32 m_UpdatedBounds = 0;
+			u32 m_CullCount = 0;
+		};
+	}
+}
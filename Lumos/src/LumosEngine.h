@@ -21,6 +21,7 @@
 #include "Physics/LumosPhysicsEngine/Octree.h"
 #include "Physics/LumosPhysicsEngine/BruteForceBroadphase.h"
 #include "Physics/LumosPhysicsEngine/SortAndSweepBroadphase.h"
+#include "Physics/LumosPhysicsEngine/DynamicTreeBroadphase.h"
 #include "Physics/RigidBody.h"
 #include "Physics/B2PhysicsEngine/RigidBody2D.h"
 #include "Physics/LumosPhysicsEngine/RigidBody3D.h"
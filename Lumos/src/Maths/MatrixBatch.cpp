@@ -0,0 +1,146 @@
+#include "Precompiled.h"
+#include "Maths/MatrixBatch.h"
+
+#ifdef LUMOS_SSE
+#include <emmintrin.h>
+#endif
+
+#include <cstddef>
+
+namespace Lumos::Maths
+{
+	// The SSE paths load a quaternion as four floats in w, x, y, z order and a matrix as three rows of four floats
+	static_assert(offsetof(Quaternion, w) == 0 && offsetof(Quaternion, x) == sizeof(float) && offsetof(Quaternion, y) == 2 * sizeof(float) && offsetof(Quaternion, z) == 3 * sizeof(float), "ComposeTRS expects Quaternion members in w, x, y, z order");
+	static_assert(offsetof(Matrix3x4, m10_) == 4 * sizeof(float) && offsetof(Matrix3x4, m20_) == 8 * sizeof(float), "Matrix3x4 rows must be contiguous");
+
+	Matrix3x4 ComposeAffineTRS(const Vector3& translation, const Quaternion& rotation, const Vector3& scale)
+	{
+		// Same rotation as Quaternion::RotationMatrix(), with each column scaled
+		const float x2 = rotation.x + rotation.x;
+		const float y2 = rotation.y + rotation.y;
+		const float z2 = rotation.z + rotation.z;
+
+		const float xx = rotation.x * x2;
+		const float yy = rotation.y * y2;
+		const float zz = rotation.z * z2;
+		const float xy = rotation.x * y2;
+		const float xz = rotation.x * z2;
+		const float yz = rotation.y * z2;
+		const float wx = rotation.w * x2;
+		const float wy = rotation.w * y2;
+		const float wz = rotation.w * z2;
+
+		return Matrix3x4(
+			(1.0f - yy - zz) * scale.x, (xy - wz) * scale.y, (xz + wy) * scale.z, translation.x,
+			(xy + wz) * scale.x, (1.0f - xx - zz) * scale.y, (yz - wx) * scale.z, translation.y,
+			(xz - wy) * scale.x, (yz + wx) * scale.y, (1.0f - xx - yy) * scale.z, translation.z);
+	}
+
+	void ComposeTRS(const Vector3* translations, const Quaternion* rotations, const Vector3* scales, Matrix3x4* out_matrices, u32 count)
+	{
+		u32 i = 0;
+
+#ifdef LUMOS_SSE
+		const __m128 one = _mm_set1_ps(1.0f);
+
+		for(; i + 4 <= count; i += 4)
+		{
+			// Quaternions are stored w, x, y, z so the transpose gives one component of all four per register
+			__m128 w = _mm_loadu_ps(&rotations[i].w);
+			__m128 x = _mm_loadu_ps(&rotations[i + 1].w);
+			__m128 y = _mm_loadu_ps(&rotations[i + 2].w);
+			__m128 z = _mm_loadu_ps(&rotations[i + 3].w);
+			_MM_TRANSPOSE4_PS(w, x, y, z);
+
+			const __m128 x2 = _mm_add_ps(x, x);
+			const __m128 y2 = _mm_add_ps(y, y);
+			const __m128 z2 = _mm_add_ps(z, z);
+
+			const __m128 xx = _mm_mul_ps(x, x2);
+			const __m128 yy = _mm_mul_ps(y, y2);
+			const __m128 zz = _mm_mul_ps(z, z2);
+			const __m128 xy = _mm_mul_ps(x, y2);
+			const __m128 xz = _mm_mul_ps(x, z2);
+			const __m128 yz = _mm_mul_ps(y, z2);
+			const __m128 wx = _mm_mul_ps(w, x2);
+			const __m128 wy = _mm_mul_ps(w, y2);
+			const __m128 wz = _mm_mul_ps(w, z2);
+
+			const Vector3* s = &scales[i];
+			const Vector3* t = &translations[i];
+			const __m128 sx = _mm_set_ps(s[3].x, s[2].x, s[1].x, s[0].x);
+			const __m128 sy = _mm_set_ps(s[3].y, s[2].y, s[1].y, s[0].y);
+			const __m128 sz = _mm_set_ps(s[3].z, s[2].z, s[1].z, s[0].z);
+
+			// Row r of all four matrices, transposed back so each register holds one matrix row
+			__m128 r0 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx);
+			__m128 r1 = _mm_mul_ps(_mm_sub_ps(xy, wz), sy);
+			__m128 r2 = _mm_mul_ps(_mm_add_ps(xz, wy), sz);
+			__m128 r3 = _mm_set_ps(t[3].x, t[2].x, t[1].x, t[0].x);
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(&out_matrices[i].m00_, r0);
+			_mm_storeu_ps(&out_matrices[i + 1].m00_, r1);
+			_mm_storeu_ps(&out_matrices[i + 2].m00_, r2);
+			_mm_storeu_ps(&out_matrices[i + 3].m00_, r3);
+
+			r0 = _mm_mul_ps(_mm_add_ps(xy, wz), sx);
+			r1 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy);
+			r2 = _mm_mul_ps(_mm_sub_ps(yz, wx), sz);
+			r3 = _mm_set_ps(t[3].y, t[2].y, t[1].y, t[0].y);
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(&out_matrices[i].m10_, r0);
+			_mm_storeu_ps(&out_matrices[i + 1].m10_, r1);
+			_mm_storeu_ps(&out_matrices[i + 2].m10_, r2);
+			_mm_storeu_ps(&out_matrices[i + 3].m10_, r3);
+
+			r0 = _mm_mul_ps(_mm_sub_ps(xz, wy), sx);
+			r1 = _mm_mul_ps(_mm_add_ps(yz, wx), sy);
+			r2 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz);
+			r3 = _mm_set_ps(t[3].z, t[2].z, t[1].z, t[0].z);
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(&out_matrices[i].m20_, r0);
+			_mm_storeu_ps(&out_matrices[i + 1].m20_, r1);
+			_mm_storeu_ps(&out_matrices[i + 2].m20_, r2);
+			_mm_storeu_ps(&out_matrices[i + 3].m20_, r3);
+		}
+#endif
+
+		for(; i < count; i++)
+			out_matrices[i] = ComposeAffineTRS(translations[i], rotations[i], scales[i]);
+	}
+
+	void MultiplyAffine(const Matrix3x4* lhs, const Matrix3x4* rhs, Matrix3x4* out_matrices, u32 count)
+	{
+#ifdef LUMOS_SSE
+		// The implicit fourth row of rhs is (0, 0, 0, 1), so it only adds the lhs translation
+		const __m128 translationMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+		for(u32 i = 0; i < count; i++)
+		{
+			// Both inputs are fully loaded before storing, so out_matrices can alias either
+			const __m128 r0 = _mm_loadu_ps(&rhs[i].m00_);
+			const __m128 r1 = _mm_loadu_ps(&rhs[i].m10_);
+			const __m128 r2 = _mm_loadu_ps(&rhs[i].m20_);
+			const __m128 l0 = _mm_loadu_ps(&lhs[i].m00_);
+			const __m128 l1 = _mm_loadu_ps(&lhs[i].m10_);
+			const __m128 l2 = _mm_loadu_ps(&lhs[i].m20_);
+
+			// Row j of the result is l.x * r0 + l.y * r1 + l.z * r2 + (0, 0, 0, l.w)
+			__m128 row = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(l0, l0, _MM_SHUFFLE(0, 0, 0, 0)), r0), _mm_mul_ps(_mm_shuffle_ps(l0, l0, _MM_SHUFFLE(1, 1, 1, 1)), r1));
+			row = _mm_add_ps(row, _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(l0, l0, _MM_SHUFFLE(2, 2, 2, 2)), r2), _mm_and_ps(l0, translationMask)));
+			_mm_storeu_ps(&out_matrices[i].m00_, row);
+
+			row = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(l1, l1, _MM_SHUFFLE(0, 0, 0, 0)), r0), _mm_mul_ps(_mm_shuffle_ps(l1, l1, _MM_SHUFFLE(1, 1, 1, 1)), r1));
+			row = _mm_add_ps(row, _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(l1, l1, _MM_SHUFFLE(2, 2, 2, 2)), r2), _mm_and_ps(l1, translationMask)));
+			_mm_storeu_ps(&out_matrices[i].m10_, row);
+
+			row = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(l2, l2, _MM_SHUFFLE(0, 0, 0, 0)), r0), _mm_mul_ps(_mm_shuffle_ps(l2, l2, _MM_SHUFFLE(1, 1, 1, 1)), r1));
+			row = _mm_add_ps(row, _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(l2, l2, _MM_SHUFFLE(2, 2, 2, 2)), r2), _mm_and_ps(l2, translationMask)));
+			_mm_storeu_ps(&out_matrices[i].m20_, row);
+		}
+#else
+		for(u32 i = 0; i < count; i++)
+			out_matrices[i] = lhs[i] * rhs[i];
+#endif
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Maths/Matrix3x4.h"
+#include "Core/Types.h"
+
+namespace Lumos::Maths
+{
+	// Builds the affine matrix translation * rotation * scale directly, without multiplying matrices
+	Matrix3x4 ComposeAffineTRS(const Vector3& translation, const Quaternion& rotation, const Vector3& scale);
+
+	// Builds count affine matrices from arrays of translations, rotations and scales. Four matrices are built at a time with SSE.
+	void ComposeTRS(const Vector3* translations, const Quaternion* rotations, const Vector3* scales, Matrix3x4* out_matrices, u32 count);
+
+	// out_matrices[i] = lhs[i] * rhs[i] for arrays of affine matrices. out_matrices may alias lhs or rhs.
+	void MultiplyAffine(const Matrix3x4* lhs, const Matrix3x4* rhs, Matrix3x4* out_matrices, u32 count);
+}
@@ -1,6 +1,7 @@
 #include "Precompiled.h"
 #include "Transform.h"
 #include "Maths/Maths.h"
+#include "Maths/MatrixBatch.h"
 #include <imgui/imgui.h>
 
 namespace Lumos
@@ -12,8 +13,8 @@ namespace Lumos
 			m_LocalPosition		= Vector3(0.0f, 0.0f, 0.0f);
 			m_LocalOrientation	= Quaternion::EulerAnglesToQuaternion(0.0f,0.0f,0.0f);
 			m_LocalScale		= Vector3(1.0f, 1.0f, 1.0f);
-            m_LocalMatrix		= Matrix4();
-            m_WorldMatrix		= Matrix4();
+            m_LocalMatrix		= Matrix3x4();
+            m_WorldMatrix		= Matrix3x4();
 		}
 
 		Transform::Transform(const Matrix4& matrix)
@@ -21,8 +22,8 @@ namespace Lumos
             m_LocalPosition     = matrix.Translation();
             m_LocalOrientation  = matrix.Rotation();
             m_LocalScale        = matrix.Scale();
-			m_LocalMatrix		= matrix;
-			m_WorldMatrix		= matrix;
+			m_LocalMatrix		= Matrix3x4(matrix);
+			m_WorldMatrix		= Matrix3x4(matrix);
 		}
 
 		Transform::Transform(const Vector3& position) 
@@ -30,8 +31,8 @@ namespace Lumos
 			m_LocalPosition		= position;
 			m_LocalOrientation	= Quaternion::EulerAnglesToQuaternion(0.0f, 0.0f, 0.0f);
 			m_LocalScale		= Vector3(1.0f, 1.0f, 1.0f);
-			m_LocalMatrix		= Matrix4();
-			m_WorldMatrix		= Matrix4();
+			m_LocalMatrix		= Matrix3x4();
+			m_WorldMatrix		= Matrix3x4();
 			SetLocalPosition(position);
 		}
 
@@ -39,7 +40,7 @@ namespace Lumos
 
 		void Transform::UpdateMatrices() 
 		{
-			m_LocalMatrix = Matrix4::Translation(m_LocalPosition) * m_LocalOrientation.RotationMatrix4() * Matrix4::Scale(m_LocalScale);
+			m_LocalMatrix = ComposeAffineTRS(m_LocalPosition, m_LocalOrientation, m_LocalScale);
 			m_Dirty = false;
             m_HasUpdated = true;
 		}
@@ -52,15 +53,34 @@ namespace Lumos
 		}
         
         void Transform::SetWorldMatrix(const Matrix4 &mat)
+        {
+             SetWorldMatrix(Matrix3x4(mat));
+        }
+
+        void Transform::SetWorldMatrix(const Matrix3x4& mat)
         {
              if (m_Dirty)
                  UpdateMatrices();
-             m_WorldMatrix =  mat * m_LocalMatrix;
+             m_WorldMatrix = mat * m_LocalMatrix;
+             m_WorldMatrixVersion++;
+        }
+        
+        void Transform::SetComposedLocalMatrix(const Matrix3x4& localMat)
+        {
+            m_LocalMatrix = localMat;
+            m_Dirty = false;
+            m_HasUpdated = true;
+        }
+
+        void Transform::SetComposedWorldMatrix(const Matrix3x4& worldMat)
+        {
+            m_WorldMatrix = worldMat;
+            m_WorldMatrixVersion++;
         }
         
         void Transform::SetLocalTransform(const Matrix4& localMat)
         {
-            m_LocalMatrix		= localMat;
+            m_LocalMatrix		= Matrix3x4(localMat);
             m_HasUpdated		= true;
 
 			ApplyTransform();
@@ -84,20 +104,30 @@ namespace Lumos
 			m_LocalOrientation = quat;
 		}
 
-		const Matrix4& Transform::GetWorldMatrix() 
+		Matrix4 Transform::GetWorldMatrix() 
+		{
+			return GetWorldMatrix3x4().ToMatrix4();
+		}
+
+		Matrix4 Transform::GetLocalMatrix() 
+		{
+			return GetLocalMatrix3x4().ToMatrix4();
+		}
+
+		const Matrix3x4& Transform::GetWorldMatrix3x4()
 		{
 			if (m_Dirty)
 				UpdateMatrices();
 
-			return m_WorldMatrix; 
+			return m_WorldMatrix;
 		}
 
-		const Matrix4& Transform::GetLocalMatrix() 
+		const Matrix3x4& Transform::GetLocalMatrix3x4()
 		{
 			if (m_Dirty)
 				UpdateMatrices();
 
-			return m_LocalMatrix; 
+			return m_LocalMatrix;
 		}
 
 		const Vector3 Transform::GetWorldPosition() const 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Maths/Maths.h"
+#include "Maths/Matrix3x4.h"
 
 #include <cereal/cereal.hpp>
 
@@ -17,6 +18,7 @@ namespace Lumos
 			~Transform();
 
             void SetWorldMatrix(const Matrix4& mat);
+            void SetWorldMatrix(const Matrix3x4& mat);
             
             void SetLocalTransform(const Matrix4& localMat);
 
@@ -24,8 +26,12 @@ namespace Lumos
 			void SetLocalScale(const Vector3& localScale);
 			void SetLocalOrientation(const Quaternion& quat);
 
-			const Matrix4& GetWorldMatrix();
-			const Matrix4& GetLocalMatrix();
+			// Matrices are stored as 3x4 affine transforms, these expand them
+			Matrix4 GetWorldMatrix();
+			Matrix4 GetLocalMatrix();
+
+			const Matrix3x4& GetWorldMatrix3x4();
+			const Matrix3x4& GetLocalMatrix3x4();
 
 			const Vector3 GetWorldPosition() const;
 			const Quaternion GetWorldOrientation() const;
@@ -40,6 +46,17 @@ namespace Lumos
 			bool HasUpdated() const { return m_HasUpdated; }
 			void SetHasUpdated(bool set) { m_HasUpdated = set; }
 
+			// True while the local matrix is out of date with R,T and S
+			bool IsDirty() const { return m_Dirty; }
+
+			// Incremented whenever the world matrix is set, caches of it compare this instead of the matrix
+			u32 GetWorldMatrixVersion() const { return m_WorldMatrixVersion; }
+
+			// Store matrices built outside of the transform, used by the scene graph's batched update.
+			// The local matrix must have been composed from the current R,T and S.
+			void SetComposedLocalMatrix(const Matrix3x4& localMat);
+			void SetComposedWorldMatrix(const Matrix3x4& worldMat);
+
 			//Sets R,T and S vectors from Local Matrix
 			void ApplyTransform();
 
@@ -80,8 +97,8 @@ namespace Lumos
             }
 
 		protected:
-			Matrix4		m_LocalMatrix;
-			Matrix4		m_WorldMatrix;
+			Matrix3x4	m_LocalMatrix;
+			Matrix3x4	m_WorldMatrix;
 
 			Vector3		m_LocalPosition;
 			Vector3		m_LocalScale;
@@ -89,6 +106,7 @@ namespace Lumos
 
 			bool m_HasUpdated = false;
 			bool m_Dirty = false;
+			u32 m_WorldMatrixVersion = 0;
 		};
 	}
 }
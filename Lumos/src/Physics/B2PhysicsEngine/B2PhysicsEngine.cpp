@@ -3,6 +3,7 @@
 #include "RigidBody2D.h"
 
 #include "Utilities/TimeStep.h"
+#include "Core/JobSystem.h"
  
 #include "Scene/Component/Physics2DComponent.h"
 
@@ -16,15 +17,48 @@
 
 namespace Lumos
 {
+	// Transforms written back by each job in the parallel step
+	static const u32 WRITEBACK_BATCH_SIZE = 256;
+
+	static void WriteBackTransform(Physics2DComponent& phys, Maths::Transform& trans)
+	{
+		const RigidBody2D* body = phys.GetRigidBody().get();
+
+		// if (!body->GetB2Body()->IsAwake())
+		//     break;
+
+		trans.SetLocalPosition(Maths::Vector3(body->GetPosition(), 0.0f));
+		trans.SetLocalOrientation(Maths::Quaternion::EulerAnglesToQuaternion(0.0f, 0.0f, body->GetAngle() * Maths::M_RADTODEG));
+	}
+
+	// Runs the islands Box2D hands out as job system jobs, one island per job
+	class B2JobSystemExecutor : public b2TaskExecutor
+	{
+	public:
+		void Execute(int32 count, void (*task)(int32 index, void* context), void* context) override
+		{
+			auto job = System::JobSystem::Dispatch(static_cast<u32>(count), 1, [task, context](JobDispatchArgs args)
+			{
+				task(static_cast<int32>(args.jobIndex), context);
+			});
+			System::JobSystem::Wait(job);
+		}
+	};
+
 	B2PhysicsEngine::B2PhysicsEngine()
 		: m_B2DWorld(CreateUniqueRef<b2World>(b2Vec2(0.0f, -9.81f)))
 		, m_DebugDraw(CreateUniqueRef<B2DebugDraw>())
+		, m_TaskExecutor(CreateUniqueRef<B2JobSystemExecutor>())
 		, m_UpdateTimestep(1.0f / 60.f)
 		, m_UpdateAccum(0.0f)
 		, m_Listener(nullptr)
 	{
 		m_DebugName = "Box2D Physics Engine";
 		m_B2DWorld->SetDebugDraw(m_DebugDraw.get());
+		m_B2DWorld->SetTaskExecutor(m_ParallelStep ? m_TaskExecutor.get() : nullptr);
+
+		Writes<Physics2DComponent>();
+		Writes<Maths::Transform>();
 
 		uint32 flags = 0;
 		//flags += b2Draw::e_shapeBit;
@@ -55,13 +89,15 @@ namespace Lumos
 
 		if(!m_Paused)
 		{
+			u32 steps = 1;
 			if(m_MultipleUpdates)
 			{
+				steps = 0;
 				m_UpdateAccum += timeStep.GetMillis();
 				for(int i = 0; (m_UpdateAccum >= m_UpdateTimestep) && i < max_updates_per_frame; ++i)
 				{
 					m_UpdateAccum -= m_UpdateTimestep;
-					m_B2DWorld->Step(m_UpdateTimestep, 6, 2);
+					++steps;
 				}
 
 				if(m_UpdateAccum >= m_UpdateTimestep)
@@ -71,24 +107,38 @@ namespace Lumos
 					m_UpdateAccum = 0.0f;
 				}
 			}
-			else
-				m_B2DWorld->Step(m_UpdateTimestep, 6, 2);
+
+			{
+				LUMOS_PROFILE_SCOPE("B2PhysicsEngine::Step");
+				for(u32 i = 0; i < steps; ++i)
+					m_B2DWorld->Step(m_UpdateTimestep, 6, 2);
+			}
 
 			auto& registry = scene->GetRegistry();
 
 			auto group = registry.group<Physics2DComponent>(entt::get<Maths::Transform>);
+			const u32 bodyCount = static_cast<u32>(group.size());
 
-			for(auto entity : group)
+			if(m_ParallelStep && bodyCount > WRITEBACK_BATCH_SIZE)
 			{
-				const auto& [phys, trans] = group.get<Physics2DComponent, Maths::Transform>(entity);
-
-				// if (!phys.GetRigidBody()->GetB2Body()->IsAwake())
-				//     break;
-
-				trans.SetLocalPosition(Maths::Vector3(phys.GetRigidBody()->GetPosition(), 0.0f));
-				trans.SetLocalOrientation(Maths::Quaternion::EulerAnglesToQuaternion(0.0f, 0.0f, phys.GetRigidBody()->GetAngle() * Maths::M_RADTODEG));
-				trans.SetWorldMatrix(Maths::Matrix4()); // temp
-			};
+				LUMOS_PROFILE_SCOPE("B2PhysicsEngine::Parallel Write Back");
+				// Every job writes its own range of transforms, the registry itself isn't modified
+				auto job = System::JobSystem::Dispatch(bodyCount, WRITEBACK_BATCH_SIZE, [&](JobDispatchArgs args)
+				{
+					const auto entity = group[args.jobIndex];
+					const auto& [phys, trans] = group.get<Physics2DComponent, Maths::Transform>(entity);
+					WriteBackTransform(phys, trans);
+				});
+				System::JobSystem::Wait(job);
+			}
+			else
+			{
+				for(auto entity : group)
+				{
+					const auto& [phys, trans] = group.get<Physics2DComponent, Maths::Transform>(entity);
+					WriteBackTransform(phys, trans);
+				}
+			}
 		}
 	}
 
@@ -116,6 +166,16 @@ namespace Lumos
 		ImGui::PopItemWidth();
 		ImGui::NextColumn();
 
+		ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted("Parallel Step");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		bool parallelStep = m_ParallelStep;
+		if(ImGui::Checkbox("##Parallel Step", &parallelStep))
+			SetParallelStep(parallelStep);
+		ImGui::PopItemWidth();
+		ImGui::NextColumn();
+
 		ImGui::AlignTextToFramePadding();
 		ImGui::TextUnformatted("Paused");
 		ImGui::NextColumn();
@@ -144,6 +204,12 @@ namespace Lumos
 		return m_B2DWorld->CreateBody(bodyDef);
 	}
 
+	void B2PhysicsEngine::SetParallelStep(bool parallel)
+	{
+		m_ParallelStep = parallel;
+		m_B2DWorld->SetTaskExecutor(parallel ? m_TaskExecutor.get() : nullptr);
+	}
+
 	void B2PhysicsEngine::CreateFixture(b2Body* body, const b2FixtureDef* fixtureDef)
 	{
 		body->CreateFixture(fixtureDef);
@@ -8,6 +8,7 @@ class b2Body;
 struct b2BodyDef;
 struct b2FixtureDef;
 class b2ContactListener;
+class b2TaskExecutor;
 
 namespace Lumos
 {
@@ -44,6 +45,14 @@ namespace Lumos
 			return m_Paused;
 		}
 
+		// Solves Box2D's islands (bodies connected by contacts) on the job system and writes transforms
+		// back in parallel batches. Contact listener callbacks are still called from the calling thread.
+		void SetParallelStep(bool parallel);
+		bool GetParallelStep() const
+		{
+			return m_ParallelStep;
+		}
+
 		void OnDebugDraw() override;
 
 		u32 GetDebugDrawFlags();
@@ -54,10 +63,12 @@ namespace Lumos
 	private:
 		UniqueRef<b2World> m_B2DWorld;
 		UniqueRef<B2DebugDraw> m_DebugDraw;
+		UniqueRef<b2TaskExecutor> m_TaskExecutor;
 
 		float m_UpdateTimestep, m_UpdateAccum;
 		bool m_Paused = true;
 		bool m_MultipleUpdates = true;
+		bool m_ParallelStep = true;
 
 		b2ContactListener* m_Listener;
 	};
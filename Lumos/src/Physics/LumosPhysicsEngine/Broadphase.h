@@ -2,6 +2,7 @@
 
 
 #include "RigidBody3D.h"
+#include "Maths/Ray.h"
 
 namespace Lumos
 {
@@ -12,11 +13,37 @@ namespace Lumos
 		RigidBody3D* pObjectB;
 	};
 
+	// Called for every body a broadphase raycast reaches with the distance the ray is still tested to.
+	// Returns the new distance, so after a hit everything behind it is skipped.
+	typedef std::function<float(RigidBody3D* body, float maxDistance)> BroadphaseRaycastCallback;
+
 	class LUMOS_EXPORT Broadphase
 	{
 	public:
 		virtual ~Broadphase() = default;
 		virtual void FindPotentialCollisionPairs(std::vector<Ref<RigidBody3D>>& objects, std::vector<CollisionPair>& collisionPairs) = 0;
 		virtual void DebugDraw() = 0;
+
+		// Length of the step the next FindPotentialCollisionPairs call is for
+		void SetTimestep(float timestep)
+		{
+			m_Timestep = timestep;
+		}
+
+		// Scene queries against the structure built by the last FindPotentialCollisionPairs call
+		//	- Results are conservative, callers still test the bodies themselves. Both have to be safe to call
+		//    from several threads at once. Broadphases that keep no structure between steps return false.
+		virtual bool QueryAABB(const Maths::BoundingBox& aabb, std::vector<RigidBody3D*>& out_bodies) const
+		{
+			return false;
+		}
+
+		virtual bool QueryRay(const Maths::Ray& ray, float maxDistance, const BroadphaseRaycastCallback& callback) const
+		{
+			return false;
+		}
+
+	protected:
+		float m_Timestep = 1.0f / 60.0f;
 	};
 }
@@ -2,6 +2,7 @@
 #include "CapsuleCollisionShape.h"
 #include "RigidBody3D.h"
 #include "Maths/Matrix3.h"
+#include "Graphics/Renderers/DebugRenderer.h"
 
 namespace Lumos
 {
@@ -20,7 +21,7 @@ namespace Lumos
 	Maths::Matrix3 CapsuleCollisionShape::BuildInverseInertia(float invMass) const
 	{
 		Maths::Vector3 halfExtents(m_Radius, m_Radius, m_Radius);
-		halfExtents.x += m_Height / 2.0f;
+		halfExtents.y += m_Height / 2.0f;
 
 		float lx = 2.0f * (halfExtents.x);
 		float ly = 2.0f * (halfExtents.y);
@@ -49,29 +50,59 @@ namespace Lumos
 		/* There is infinite edges on a sphere so handle seperately */
 	}
 
-	void CapsuleCollisionShape::GetMinMaxVertexOnAxis(const RigidBody3D* currentObject, const Maths::Vector3& axis, Maths::Vector3* out_min, Maths::Vector3* out_max) const
+	void CapsuleCollisionShape::GetSegment(const RigidBody3D* currentObject, Maths::Vector3* out_start, Maths::Vector3* out_end) const
 	{
-		Maths::Matrix4 transform;
+		const Maths::Vector3 halfSegment(0.0f, m_Height * 0.5f, 0.0f);
 
 		if(currentObject == nullptr)
-			transform = m_LocalTransform;
-		else
-			transform = currentObject->GetWorldSpaceTransform() * m_LocalTransform;
+		{
+			*out_start = -halfSegment;
+			*out_end = halfSegment;
+			return;
+		}
 
-		Maths::Vector3 pos = transform.Translation();
+		const Maths::Matrix4& transform = currentObject->GetWorldSpaceTransform();
+		const Maths::Vector3 position = transform.Translation();
+		const Maths::Vector3 offset = transform.ToMatrix3() * halfSegment;
+
+		*out_start = position - offset;
+		*out_end = position + offset;
+	}
+
+	void CapsuleCollisionShape::GetMinMaxVertexOnAxis(const RigidBody3D* currentObject, const Maths::Vector3& axis, Maths::Vector3* out_min, Maths::Vector3* out_max) const
+	{
+		Maths::Vector3 start, end;
+		GetSegment(currentObject, &start, &end);
+
+		const bool startIsLower = axis.DotProduct(start) <= axis.DotProduct(end);
 
 		if(out_min)
-			*out_min = pos - axis * m_Radius;
+			*out_min = (startIsLower ? start : end) - axis * m_Radius;
 
 		if(out_max)
-			*out_max = pos + axis * m_Radius;
+			*out_max = (startIsLower ? end : start) + axis * m_Radius;
 	}
 
-	void CapsuleCollisionShape::GetIncidentReferencePolygon(const RigidBody3D* currentObject, const Maths::Vector3& axis, std::list<Maths::Vector3>* out_face, Maths::Vector3* out_normal, std::vector<Maths::Plane>* out_adjacent_planes) const
+	void CapsuleCollisionShape::GetIncidentReferencePolygon(const RigidBody3D* currentObject, const Maths::Vector3& axis, ManifoldPolygon* out_face, Maths::Vector3* out_normal, ManifoldPlanes* out_adjacent_planes) const
 	{
 		if(out_face)
 		{
-			out_face->push_back(currentObject->GetPosition() + axis * m_Radius);
+			Maths::Vector3 start, end;
+			GetSegment(currentObject, &start, &end);
+
+			const float startCorrelation = axis.DotProduct(start);
+			const float endCorrelation = axis.DotProduct(end);
+
+			//Lying (almost) flat against the axis, so the whole side touches. There are no faces to clip
+			//  against, the other shape becomes the reference and clips this edge.
+			const float flatTolerance = 0.05f * Maths::Max(m_Height, 0.0001f);
+			if(fabs(startCorrelation - endCorrelation) < flatTolerance)
+			{
+				out_face->Add(start + axis * m_Radius);
+				out_face->Add(end + axis * m_Radius);
+			}
+			else
+				out_face->Add((startCorrelation > endCorrelation ? start : end) + axis * m_Radius);
 		}
 
 		if(out_normal)
@@ -80,7 +111,19 @@ namespace Lumos
 		}
 	}
 
+	Maths::Vector3 CapsuleCollisionShape::GetLocalSupportPoint(const Maths::Vector3& direction) const
+	{
+		// Core is the segment, the radius is added as margin
+		return Maths::Vector3(0.0f, direction.y >= 0.0f ? m_Height * 0.5f : -m_Height * 0.5f, 0.0f);
+	}
+
 	void CapsuleCollisionShape::DebugDraw(const RigidBody3D* currentObject) const
 	{
+		Maths::Vector3 start, end;
+		GetSegment(currentObject, &start, &end);
+
+		DebugRenderer::DebugDrawSphere(m_Radius, start, Maths::Vector4(1.0f, 0.3f, 1.0f, 1.0f));
+		DebugRenderer::DebugDrawSphere(m_Radius, end, Maths::Vector4(1.0f, 0.3f, 1.0f, 1.0f));
+		DebugRenderer::DrawHairLine(start, end, Maths::Vector4(1.0f, 0.3f, 1.0f, 1.0f));
 	}
 }
@@ -19,7 +19,13 @@ namespace Lumos
 		virtual void GetEdges(const RigidBody3D* currentObject, std::vector<CollisionEdge>* out_edges) const override;
 
 		virtual void GetMinMaxVertexOnAxis(const RigidBody3D* currentObject, const Maths::Vector3& axis, Maths::Vector3* out_min, Maths::Vector3* out_max) const override;
-		virtual void GetIncidentReferencePolygon(const RigidBody3D* currentObject, const Maths::Vector3& axis, std::list<Maths::Vector3>* out_face, Maths::Vector3* out_normal, std::vector<Maths::Plane>* out_adjacent_planes) const override;
+		virtual void GetIncidentReferencePolygon(const RigidBody3D* currentObject, const Maths::Vector3& axis, ManifoldPolygon* out_face, Maths::Vector3* out_normal, ManifoldPlanes* out_adjacent_planes) const override;
+		virtual Maths::Vector3 GetLocalSupportPoint(const Maths::Vector3& direction) const override;
+
+		virtual float GetSupportMargin() const override
+		{
+			return m_Radius;
+		}
 
 		virtual void DebugDraw(const RigidBody3D* currentObject) const override;
 
@@ -40,7 +46,21 @@ namespace Lumos
 			return m_Radius;
 		}
 
+		//Get/Set length of the segment between the two hemispheres, it runs along the local Y axis
+		void SetHeight(float height)
+		{
+			m_Height = height;
+		}
+
+		float GetHeight() const
+		{
+			return m_Height;
+		}
+
 	protected:
+		// End points of the capsule's segment, in world space when currentObject is set
+		void GetSegment(const RigidBody3D* currentObject, Maths::Vector3* out_start, Maths::Vector3* out_end) const;
+
 		float m_Radius;
 		float m_Height;
 	};
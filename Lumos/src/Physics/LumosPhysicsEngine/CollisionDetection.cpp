@@ -2,20 +2,238 @@
 #include "CollisionDetection.h"
 
 #include "SphereCollisionShape.h"
+#include "Hull.h"
+#include "GJK.h"
+
+#ifdef LUMOS_SSE
+#include <emmintrin.h>
+#endif
 
 namespace Lumos
 {
-	
+	namespace
+	{
+		// World space candidate separating axes stored as separate components, padded so they can be
+		// projected four at a time. Sized for two hulls' face normals plus every edge direction pair.
+		struct CandidateAxes
+		{
+			static const u32 MaxAxes = 2 * CollisionHull::MaxAxes + CollisionHull::MaxAxes * CollisionHull::MaxAxes;
+			static const u32 Capacity = (MaxAxes + 3) & ~3u;
+
+			u32 count = 0;
+			float x[Capacity];
+			float y[Capacity];
+			float z[Capacity];
+
+			_FORCE_INLINE_ Maths::Vector3 Get(u32 index) const
+			{
+				return Maths::Vector3(x[index], y[index], z[index]);
+			}
+
+			// Zeroes the lanes after the last axis so every group of four can be projected
+			void Pad()
+			{
+				for(u32 i = count; i < ((count + 3) & ~3u); ++i)
+				{
+					x[i] = 0.0f;
+					y[i] = 0.0f;
+					z[i] = 0.0f;
+				}
+			}
+		};
+
+		void AddPossibleCollisionAxis(Maths::Vector3 axis, CandidateAxes* axes)
+		{
+			const float epsilon = 0.0001f;
+
+			if(axis.LengthSquared() < epsilon)
+				return;
+
+			axis.Normalize();
+
+			for(u32 i = 0; i < axes->count; ++i)
+			{
+				if(abs(axis.x * axes->x[i] + axis.y * axes->y[i] + axis.z * axes->z[i]) >= (1.0f - epsilon))
+					return;
+			}
+
+			const u32 index = axes->count++;
+			axes->x[index] = axis.x;
+			axes->y[index] = axis.y;
+			axes->z[index] = axis.z;
+		}
+
+		// Projects a hull placed at rotation/position onto every candidate axis, writing the interval of each
+		void ProjectHull(const CollisionHull& hull, const Maths::Matrix3& rotation, const Maths::Vector3& position, const CandidateAxes& axes, float* out_min, float* out_max)
+		{
+#ifdef LUMOS_SSE
+			const __m128 m00 = _mm_set1_ps(rotation.m00_), m01 = _mm_set1_ps(rotation.m01_), m02 = _mm_set1_ps(rotation.m02_);
+			const __m128 m10 = _mm_set1_ps(rotation.m10_), m11 = _mm_set1_ps(rotation.m11_), m12 = _mm_set1_ps(rotation.m12_);
+			const __m128 m20 = _mm_set1_ps(rotation.m20_), m21 = _mm_set1_ps(rotation.m21_), m22 = _mm_set1_ps(rotation.m22_);
+			const __m128 px = _mm_set1_ps(position.x), py = _mm_set1_ps(position.y), pz = _mm_set1_ps(position.z);
+
+			for(u32 i = 0; i < axes.count; i += 4)
+			{
+				const __m128 ax = _mm_loadu_ps(&axes.x[i]);
+				const __m128 ay = _mm_loadu_ps(&axes.y[i]);
+				const __m128 az = _mm_loadu_ps(&axes.z[i]);
+
+				// Rotate the axes into hull space instead of moving every vertex into world space
+				const __m128 lx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, ax), _mm_mul_ps(m10, ay)), _mm_mul_ps(m20, az));
+				const __m128 ly = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, ax), _mm_mul_ps(m11, ay)), _mm_mul_ps(m21, az));
+				const __m128 lz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, ax), _mm_mul_ps(m12, ay)), _mm_mul_ps(m22, az));
+
+				__m128 minProjection = _mm_set1_ps(FLT_MAX);
+				__m128 maxProjection = _mm_set1_ps(-FLT_MAX);
+
+				for(u32 v = 0; v < hull.vertexCount; ++v)
+				{
+					const __m128 projection = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(hull.vertexX[v]), lx), _mm_mul_ps(_mm_set1_ps(hull.vertexY[v]), ly)), _mm_mul_ps(_mm_set1_ps(hull.vertexZ[v]), lz));
+					minProjection = _mm_min_ps(minProjection, projection);
+					maxProjection = _mm_max_ps(maxProjection, projection);
+				}
+
+				const __m128 offset = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, ax), _mm_mul_ps(py, ay)), _mm_mul_ps(pz, az));
+				_mm_storeu_ps(&out_min[i], _mm_add_ps(minProjection, offset));
+				_mm_storeu_ps(&out_max[i], _mm_add_ps(maxProjection, offset));
+			}
+#else
+			for(u32 i = 0; i < axes.count; ++i)
+			{
+				const float ax = axes.x[i], ay = axes.y[i], az = axes.z[i];
+
+				// Rotate the axis into hull space instead of moving every vertex into world space
+				const float lx = rotation.m00_ * ax + rotation.m10_ * ay + rotation.m20_ * az;
+				const float ly = rotation.m01_ * ax + rotation.m11_ * ay + rotation.m21_ * az;
+				const float lz = rotation.m02_ * ax + rotation.m12_ * ay + rotation.m22_ * az;
+
+				float minProjection = FLT_MAX;
+				float maxProjection = -FLT_MAX;
+
+				for(u32 v = 0; v < hull.vertexCount; ++v)
+				{
+					const float projection = hull.vertexX[v] * lx + hull.vertexY[v] * ly + hull.vertexZ[v] * lz;
+					minProjection = Maths::Min(minProjection, projection);
+					maxProjection = Maths::Max(maxProjection, projection);
+				}
+
+				const float offset = position.x * ax + position.y * ay + position.z * az;
+				out_min[i] = minProjection + offset;
+				out_max[i] = maxProjection + offset;
+			}
+#endif
+		}
+
+		void ProjectSphere(const Maths::Vector3& centre, float radius, const CandidateAxes& axes, float* out_min, float* out_max)
+		{
+			for(u32 i = 0; i < axes.count; ++i)
+			{
+				const float projection = centre.x * axes.x[i] + centre.y * axes.y[i] + centre.z * axes.z[i];
+				out_min[i] = projection - radius;
+				out_max[i] = projection + radius;
+			}
+		}
+
+		// World space vertex of the hull furthest along (or against) the axis
+		Maths::Vector3 GetHullSupportVertex(const CollisionHull& hull, const Maths::Matrix3& rotation, const Maths::Vector3& position, const Maths::Vector3& axis, bool maximum)
+		{
+			const Maths::Vector3 localAxis = Maths::Matrix3::Transpose(rotation) * axis;
+
+			u32 best = 0;
+			float bestProjection = maximum ? -FLT_MAX : FLT_MAX;
+
+			for(u32 v = 0; v < hull.vertexCount; ++v)
+			{
+				const float projection = hull.vertexX[v] * localAxis.x + hull.vertexY[v] * localAxis.y + hull.vertexZ[v] * localAxis.z;
+				if(maximum ? projection > bestProjection : projection <= bestProjection)
+				{
+					bestProjection = projection;
+					best = v;
+				}
+			}
+
+			return rotation * hull.GetVertex(best) + position;
+		}
+
+		// Same overlap test as CheckCollisionAxis on precomputed intervals. Keeps the deepest
+		// (least negative) penetration, returns the index of that axis or -1 if any axis separates them.
+		int FindLeastPenetratingAxis(const CandidateAxes& axes, const float* min1, const float* max1, const float* min2, const float* max2, bool keepLastOnTie, bool* out_flipped, float* out_penetration)
+		{
+			int bestAxis = -1;
+			float bestPenetration = -FLT_MAX;
+			bool bestFlipped = false;
+
+			for(u32 i = 0; i < axes.count; ++i)
+			{
+				float penetration;
+				bool flipped;
+
+				if(min1[i] <= min2[i] && max1[i] >= min2[i])
+				{
+					penetration = min2[i] - max1[i];
+					flipped = false;
+				}
+				else if(min2[i] <= min1[i] && max2[i] > min1[i])
+				{
+					penetration = min1[i] - max2[i];
+					flipped = true;
+				}
+				else
+					return -1;
+
+				if(penetration > bestPenetration || (keepLastOnTie && penetration == bestPenetration))
+				{
+					bestAxis = static_cast<int>(i);
+					bestPenetration = penetration;
+					bestFlipped = flipped;
+				}
+			}
+
+			*out_flipped = bestFlipped;
+			*out_penetration = bestPenetration;
+			return bestAxis;
+		}
+	}
+
 	CollisionDetection::CollisionDetection()
 	{
-		//max actual size
-		unsigned int maxSize = CollisionShapeTypeMax | (CollisionShapeTypeMax >> 1);
-		m_CollisionCheckFunctions = new CollisionCheckFunc[maxSize];
-		std::fill(m_CollisionCheckFunctions, m_CollisionCheckFunctions + maxSize, &CollisionDetection::InvalidCheckCollision);
-		
-		m_CollisionCheckFunctions[CollisionSphere] = &CollisionDetection::CheckSphereCollision;
-		m_CollisionCheckFunctions[CollisionCuboid] = &CollisionDetection::CheckPolyhedronCollision;
-		m_CollisionCheckFunctions[CollisionSphere | CollisionCuboid] = &CollisionDetection::CheckPolyhedronSphereCollision;
+		for(u32 type1 = 0; type1 < CollisionShapeTypeMax; ++type1)
+		{
+			for(u32 type2 = type1; type2 < CollisionShapeTypeMax; ++type2)
+				SetConvexCollision(CollisionShapeType(type1), CollisionShapeType(type2), false);
+		}
+	}
+
+	CollisionDetection::CollisionCheckFunc CollisionDetection::GetDefaultCollisionCheck(CollisionShapeType type1, CollisionShapeType type2)
+	{
+		if(type1 < CollisionCuboid || type2 < CollisionCuboid)
+			return &CollisionDetection::InvalidCheckCollision;
+
+		// Capsules have no faces or edges for the separating axis test
+		if(type1 == CollisionCapsule || type2 == CollisionCapsule)
+			return &CollisionDetection::CheckConvexCollision;
+
+		if(type1 == CollisionSphere && type2 == CollisionSphere)
+			return &CollisionDetection::CheckSphereCollision;
+
+		if(type1 == CollisionSphere || type2 == CollisionSphere)
+			return &CollisionDetection::CheckPolyhedronSphereCollision;
+
+		return &CollisionDetection::CheckPolyhedronCollision;
+	}
+
+	void CollisionDetection::SetConvexCollision(CollisionShapeType type1, CollisionShapeType type2, bool useConvex)
+	{
+		const CollisionCheckFunc check = (useConvex && type1 >= CollisionCuboid && type2 >= CollisionCuboid) ? &CollisionDetection::CheckConvexCollision
+																											 : GetDefaultCollisionCheck(type1, type2);
+
+		m_CollisionCheckFunctions[type1][type2] = check;
+		m_CollisionCheckFunctions[type2][type1] = check;
+	}
+
+	bool CollisionDetection::UsesConvexCollision(CollisionShapeType type1, CollisionShapeType type2) const
+	{
+		return m_CollisionCheckFunctions[type1][type2] == &CollisionDetection::CheckConvexCollision;
 	}
 	
 	bool CollisionDetection::InvalidCheckCollision(const RigidBody3D* obj1, const RigidBody3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata) const
@@ -38,120 +256,146 @@ namespace Lumos
 		return true;
 	}
 	
-	void AddPossibleCollisionAxis(Maths::Vector3& axis, std::vector<Maths::Vector3>* possible_collision_axes)
+	bool CollisionDetection::CheckPolyhedronSphereCollision(const RigidBody3D* obj1, const RigidBody3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata) const
 	{
-		const float epsilon = 0.0001f;
-		
-		if(axis.LengthSquared() < epsilon)
-			return;
-		
-		axis.Normalize();
-		
-		for(const Maths::Vector3& p_axis : *possible_collision_axes)
+		const bool sphereFirst = shape1->GetType() == CollisionShapeType::CollisionSphere;
+		const RigidBody3D* complexObj = sphereFirst ? obj2 : obj1;
+		const RigidBody3D* sphereObj = sphereFirst ? obj1 : obj2;
+		const CollisionHull& hull = *(sphereFirst ? shape2 : shape1)->GetCollisionHull();
+		const float radius = static_cast<const SphereCollisionShape*>(sphereFirst ? shape1 : shape2)->GetRadius();
+
+		const Maths::Matrix4& transform = complexObj->GetWorldSpaceTransform();
+		const Maths::Matrix3 rotation = transform.ToMatrix3();
+		const Maths::Vector3 position = transform.Translation();
+		const Maths::Vector3 centre = sphereObj->GetPosition();
+
+		CandidateAxes axes;
+		for(u32 i = 0; i < hull.faceNormalCount; ++i)
+			AddPossibleCollisionAxis(rotation * hull.faceNormals[i], &axes);
+
+		// Normalised first so a centre lying right next to an edge still contributes its axis
+		Maths::Vector3 edgeAxis = centre - GetClosestPointOnEdges(centre, hull, rotation, position);
+		edgeAxis.Normalize();
+		AddPossibleCollisionAxis(edgeAxis, &axes);
+		axes.Pad();
+
+		float hullMin[CandidateAxes::Capacity], hullMax[CandidateAxes::Capacity];
+		float sphereMin[CandidateAxes::Capacity], sphereMax[CandidateAxes::Capacity];
+		ProjectHull(hull, rotation, position, axes, hullMin, hullMax);
+		ProjectSphere(centre, radius, axes, sphereMin, sphereMax);
+
+		bool flipped;
+		float penetration;
+		const int bestAxis = sphereFirst ? FindLeastPenetratingAxis(axes, sphereMin, sphereMax, hullMin, hullMax, false, &flipped, &penetration)
+										 : FindLeastPenetratingAxis(axes, hullMin, hullMax, sphereMin, sphereMax, false, &flipped, &penetration);
+		if(bestAxis < 0)
+			return false;
+
+		if(out_coldata)
 		{
-			if(abs(Maths::Vector3::Dot(axis, p_axis)) >= (1.0f - epsilon))
-				return;
+			const Maths::Vector3 axis = axes.Get(bestAxis);
+			const Maths::Vector3 support = sphereFirst ? centre + (flipped ? -axis : axis) * radius
+													   : GetHullSupportVertex(hull, rotation, position, axis, !flipped);
+
+			out_coldata->normal = flipped ? -axis : axis;
+			out_coldata->penetration = penetration;
+			out_coldata->pointOnPlane = support + out_coldata->normal * penetration;
 		}
-		
-		possible_collision_axes->push_back(axis);
+
+		return true;
 	}
 	
-	bool CollisionDetection::CheckPolyhedronSphereCollision(const RigidBody3D* obj1, const RigidBody3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata) const
+	bool CollisionDetection::CheckPolyhedronCollision(const RigidBody3D* obj1, const RigidBody3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata) const
 	{
-		const CollisionShape* complexShape;
-		const RigidBody3D* complexObj;
-		const RigidBody3D* sphereObj;
-		
-		if(obj1->GetCollisionShape()->GetType() == CollisionShapeType::CollisionSphere)
-		{
-			sphereObj = obj1;
-			complexShape = shape2;
-			complexObj = obj2;
-		}
-		else
+		const CollisionHull& hull1 = *shape1->GetCollisionHull();
+		const CollisionHull& hull2 = *shape2->GetCollisionHull();
+
+		const Maths::Matrix4& transform1 = obj1->GetWorldSpaceTransform();
+		const Maths::Matrix4& transform2 = obj2->GetWorldSpaceTransform();
+		const Maths::Matrix3 rotation1 = transform1.ToMatrix3();
+		const Maths::Matrix3 rotation2 = transform2.ToMatrix3();
+		const Maths::Vector3 position1 = transform1.Translation();
+		const Maths::Vector3 position2 = transform2.Translation();
+
+		// Face normals of both hulls and the cross products of their edge directions
+		CandidateAxes axes;
+		for(u32 i = 0; i < hull1.faceNormalCount; ++i)
+			AddPossibleCollisionAxis(rotation1 * hull1.faceNormals[i], &axes);
+		for(u32 i = 0; i < hull2.faceNormalCount; ++i)
+			AddPossibleCollisionAxis(rotation2 * hull2.faceNormals[i], &axes);
+
+		Maths::Vector3 edges2[CollisionHull::MaxAxes];
+		for(u32 j = 0; j < hull2.edgeDirectionCount; ++j)
+			edges2[j] = rotation2 * hull2.edgeDirections[j];
+
+		for(u32 i = 0; i < hull1.edgeDirectionCount; ++i)
 		{
-			sphereObj = obj2;
-			complexShape = shape1;
-			complexObj = obj1;
+			const Maths::Vector3 edge1 = rotation1 * hull1.edgeDirections[i];
+			for(u32 j = 0; j < hull2.edgeDirectionCount; ++j)
+				AddPossibleCollisionAxis(edge1.CrossProduct(edges2[j]), &axes);
 		}
-		
-		CollisionData cur_colData;
-		CollisionData best_colData;
-		best_colData.penetration = -FLT_MAX;
-		
-		std::vector<Maths::Vector3> possibleCollisionAxes;
-		complexShape->GetCollisionAxes(complexObj, &possibleCollisionAxes);
-		
-		std::vector<CollisionEdge> complex_shape_edges;
-		
-		complexShape->GetEdges(complexObj, &complex_shape_edges);
-		
-		Maths::Vector3 p = GetClosestPointOnEdges(sphereObj->GetPosition(), complex_shape_edges);
-		//NCLDebug::DrawPoint(p, 0.1f);
-		Maths::Vector3 p_t = sphereObj->GetPosition() - p;
-		p_t.Normalize();
-		AddPossibleCollisionAxis(p_t, &possibleCollisionAxes);
-		
-		for(const Maths::Vector3& axis : possibleCollisionAxes)
+
+		axes.Pad();
+
+		float min1[CandidateAxes::Capacity], max1[CandidateAxes::Capacity];
+		float min2[CandidateAxes::Capacity], max2[CandidateAxes::Capacity];
+		ProjectHull(hull1, rotation1, position1, axes, min1, max1);
+		ProjectHull(hull2, rotation2, position2, axes, min2, max2);
+
+		bool flipped;
+		float penetration;
+		const int bestAxis = FindLeastPenetratingAxis(axes, min1, max1, min2, max2, true, &flipped, &penetration);
+		if(bestAxis < 0)
+			return false;
+
+		if(out_coldata)
 		{
-			if(!CheckCollisionAxis(axis, obj1, obj2, shape1, shape2, &cur_colData))
-				return false;
-			
-			if(cur_colData.penetration > best_colData.penetration)
-				best_colData = cur_colData;
+			const Maths::Vector3 axis = axes.Get(bestAxis);
+			out_coldata->normal = flipped ? -axis : axis;
+			out_coldata->penetration = penetration;
+			out_coldata->pointOnPlane = GetHullSupportVertex(hull1, rotation1, position1, axis, !flipped) + out_coldata->normal * penetration;
 		}
-		
-		if(out_coldata)
-			*out_coldata = best_colData;
-		
+
 		return true;
 	}
 	
-	bool CollisionDetection::CheckPolyhedronCollision(const RigidBody3D* obj1, const RigidBody3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata) const
+	bool CollisionDetection::CheckConvexCollision(const RigidBody3D* obj1, const RigidBody3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata) const
 	{
-		CollisionData cur_colData;
-		CollisionData best_colData;
-		best_colData.penetration = -FLT_MAX;
-		
-		std::vector<Maths::Vector3> possibleCollisionAxes;
-		std::vector<Maths::Vector3> tempPossibleCollisionAxes;
-		shape1->GetCollisionAxes(obj1, &possibleCollisionAxes);
-		shape2->GetCollisionAxes(obj2, &tempPossibleCollisionAxes);
-		for(Maths::Vector3& temp : tempPossibleCollisionAxes)
-			AddPossibleCollisionAxis(temp, &possibleCollisionAxes);
-		
-		std::vector<CollisionEdge> shape1_edges;
-		std::vector<CollisionEdge> shape2_edges;
-		
-		shape1->GetEdges(obj1, &shape1_edges);
-		shape2->GetEdges(obj2, &shape2_edges);
-		
-		for(const CollisionEdge& edge1 : shape1_edges)
+		const ConvexProxy proxy1(shape1, obj1->GetWorldSpaceTransform());
+		const ConvexProxy proxy2(shape2, obj2->GetWorldSpaceTransform());
+		const float margin = proxy1.margin + proxy2.margin;
+
+		// Cheap distance between the cores first, EPA only runs when the cores themselves overlap
+		GJK::DistanceResult result;
+		if(!GJK::Distance(proxy1, proxy2, margin, &result))
+			return false;
+
+		Maths::Vector3 normal, surfacePoint;
+		float penetration;
+
+		if(!result.overlap && result.distance > 0.0f)
 		{
-			for(const CollisionEdge& edge2 : shape2_edges)
-			{
-				Maths::Vector3 e1 = edge1.posB - edge1.posA;
-				Maths::Vector3 e2 = edge2.posB - edge2.posA;
-				e1.Normalize();
-				e2.Normalize();
-				
-				Maths::Vector3 temp = e1.CrossProduct(e2);
-				AddPossibleCollisionAxis(temp, &possibleCollisionAxes);
-			}
+			normal = (result.pointB - result.pointA) / result.distance;
+			penetration = result.distance - margin;
+			surfacePoint = result.pointA + normal * proxy1.margin;
 		}
-		
-		for(const Maths::Vector3& axis : possibleCollisionAxes)
+		else
 		{
-			if(!CheckCollisionAxis(axis, obj1, obj2, shape1, shape2, &cur_colData))
+			Maths::Vector3 pointB;
+			float depth;
+			if(!GJK::Penetration(proxy1, proxy2, &normal, &depth, &surfacePoint, &pointB))
 				return false;
-			
-			if(cur_colData.penetration >= best_colData.penetration)
-				best_colData = cur_colData;
+
+			penetration = -depth;
 		}
-		
+
 		if(out_coldata)
-			*out_coldata = best_colData;
-		
+		{
+			out_coldata->normal = normal;
+			out_coldata->penetration = penetration;
+			out_coldata->pointOnPlane = surfacePoint + normal * penetration;
+		}
+
 		return true;
 	}
 	
@@ -198,29 +442,36 @@ namespace Lumos
 		if(!manifold)
 			return false;
 		
-		std::list<Maths::Vector3> polygon1, polygon2;
+		ManifoldPolygon polygon1, polygon2;
 		Maths::Vector3 normal1, normal2;
-		std::vector<Maths::Plane> adjPlanes1, adjPlanes2;
+		ManifoldPlanes adjPlanes1, adjPlanes2;
 		
 		shape1->GetIncidentReferencePolygon(obj1, coldata.normal, &polygon1, &normal1, &adjPlanes1);
 		shape2->GetIncidentReferencePolygon(obj2, -coldata.normal, &polygon2, &normal2, &adjPlanes2);
 		
-		if(polygon1.empty() || polygon2.empty())
+		if(polygon1.count == 0 || polygon2.count == 0)
 			return false;
-		else if(polygon1.size() == 1)
-			manifold->AddContact(polygon1.front(), polygon1.front() - coldata.normal * coldata.penetration, coldata.normal, coldata.penetration);
-		else if(polygon2.size() == 1)
-			manifold->AddContact(polygon2.front() + coldata.normal * coldata.penetration, polygon2.front(), coldata.normal, coldata.penetration);
+		else if(polygon1.count == 1)
+			manifold->AddContact(polygon1.vertices[0], polygon1.vertices[0] - coldata.normal * coldata.penetration, coldata.normal, coldata.penetration);
+		else if(polygon2.count == 1)
+			manifold->AddContact(polygon2.vertices[0] + coldata.normal * coldata.penetration, polygon2.vertices[0], coldata.normal, coldata.penetration);
+		else if(adjPlanes1.count == 0 && adjPlanes2.count == 0)
+		{
+			//Neither shape has faces to clip against (capsule against capsule), use the deepest point
+			const Maths::Vector3 pointOnA = coldata.pointOnPlane - coldata.normal * coldata.penetration;
+			manifold->AddContact(pointOnA, pointOnA - coldata.normal * coldata.penetration, coldata.normal, coldata.penetration);
+		}
 		else
 		{
 			bool flipped;
-			std::list<Maths::Vector3>* incPolygon;
-			std::vector<Maths::Plane>* refAdjPlanes;
+			ManifoldPolygon* incPolygon;
+			const ManifoldPlanes* refAdjPlanes;
 			Maths::Plane refPlane;
 			
-			if(fabs(coldata.normal.DotProduct(normal1)) > fabs(coldata.normal.DotProduct(normal2)))
+			//Only shapes with adjacent planes can be the reference, capsules always provide the incident edge
+			if(adjPlanes1.count > 0 && (adjPlanes2.count == 0 || fabs(coldata.normal.DotProduct(normal1)) > fabs(coldata.normal.DotProduct(normal2))))
 			{
-				float planeDist = -(polygon1.front().DotProduct(-normal1));
+				float planeDist = -(polygon1.vertices[0].DotProduct(-normal1));
 				refPlane = Maths::Plane(-normal1, planeDist);
 				refAdjPlanes = &adjPlanes1;
 				
@@ -230,7 +481,7 @@ namespace Lumos
 			}
 			else
 			{
-				float planeDist = -(polygon2.front().DotProduct(-normal2));
+				float planeDist = -(polygon2.vertices[0].DotProduct(-normal2));
 				refPlane = Maths::Plane(-normal2, planeDist);
 				refAdjPlanes = &adjPlanes2;
 				
@@ -239,12 +490,13 @@ namespace Lumos
 				flipped = true;
 			}
 			
-			SutherlandHodgesonClipping(*incPolygon, static_cast<int>(refAdjPlanes->size()), &(*refAdjPlanes)[0], incPolygon, false);
+			SutherlandHodgesonClipping(*incPolygon, static_cast<int>(refAdjPlanes->count), refAdjPlanes->planes, incPolygon, false);
 			
 			SutherlandHodgesonClipping(*incPolygon, 1, &refPlane, incPolygon, true);
 			
-			for(const Maths::Vector3& endPoint : *incPolygon)
+			for(u32 i = 0; i < incPolygon->count; ++i)
 			{
+				const Maths::Vector3& endPoint = incPolygon->vertices[i];
 				float contact_penetration;
 				Maths::Vector3 globalOnA, globalOnB;
 				
@@ -252,14 +504,14 @@ namespace Lumos
 				{
 					contact_penetration =
 						-(endPoint.DotProduct(coldata.normal)
-						  - (coldata.normal.DotProduct(polygon2.front())));
+						  - (coldata.normal.DotProduct(polygon2.vertices[0])));
 					
 					globalOnA = endPoint + coldata.normal * contact_penetration;
 					globalOnB = endPoint;
 				}
 				else
 				{
-					contact_penetration = endPoint.DotProduct(coldata.normal) - coldata.normal.DotProduct(polygon1.front());
+					contact_penetration = endPoint.DotProduct(coldata.normal) - coldata.normal.DotProduct(polygon1.vertices[0]);
 					
 					globalOnA = endPoint;
 					globalOnB = endPoint - coldata.normal * contact_penetration;
@@ -271,27 +523,34 @@ namespace Lumos
 		return true;
 	}
 	
-	Maths::Vector3 CollisionDetection::GetClosestPointOnEdges(const Maths::Vector3& target, const std::vector<CollisionEdge>& edges)
+	Maths::Vector3 CollisionDetection::GetClosestPointOnEdges(const Maths::Vector3& target, const CollisionHull& hull, const Maths::Matrix3& rotation, const Maths::Vector3& position)
 	{
 		Maths::Vector3 closest_point, temp_closest_point;
 		float closest_distsq = FLT_MAX;
 		
-		for(const CollisionEdge& edge : edges)
+		Maths::Vector3 vertices[CollisionHull::MaxVertices];
+		for(u32 i = 0; i < hull.vertexCount; ++i)
+			vertices[i] = rotation * hull.GetVertex(i) + position;
+		
+		for(u32 i = 0; i < hull.edgeCount; ++i)
 		{
-			Maths::Vector3 a_t = target - edge.posA;
-			Maths::Vector3 a_b = edge.posB - edge.posA;
+			const Maths::Vector3& posA = vertices[hull.edgeVertices[i][0]];
+			const Maths::Vector3& posB = vertices[hull.edgeVertices[i][1]];
+			
+			Maths::Vector3 a_t = target - posA;
+			Maths::Vector3 a_b = posB - posA;
 			
 			float magnitudeAB = a_b.DotProduct(a_b); //Magnitude of AB vector (it's length squared)
 			float ABAPproduct = a_t.DotProduct(a_b); //The DOT product of a_to_t and a_to_b
 			float distance = ABAPproduct / magnitudeAB; //The normalized "distance" from a to your closest point
 			
 			if(distance < 0.0f) //Clamp returned point to be on the line, e.g if the closest point is beyond the AB return either A or B as closest points
-				temp_closest_point = edge.posA;
+				temp_closest_point = posA;
 			
 			else if(distance > 1)
-				temp_closest_point = edge.posB;
+				temp_closest_point = posB;
 			else
-				temp_closest_point = edge.posA + a_b * distance;
+				temp_closest_point = posA + a_b * distance;
 			
 			Maths::Vector3 c_t = target - temp_closest_point;
 			float temp_distsq = c_t.DotProduct(c_t);
@@ -326,49 +585,50 @@ namespace Lumos
 		return start;
 	}
 	
-	void CollisionDetection::SutherlandHodgesonClipping(const std::list<Maths::Vector3>& input_polygon, int num_clip_planes, const Maths::Plane* clip_planes, std::list<Maths::Vector3>* out_polygon, bool removePoints) const
+	void CollisionDetection::SutherlandHodgesonClipping(const ManifoldPolygon& input_polygon, int num_clip_planes, const Maths::Plane* clip_planes, ManifoldPolygon* out_polygon, bool removePoints) const
 	{
 		if(!out_polygon)
 			return;
 		
-		std::list<Maths::Vector3> ppPolygon1, ppPolygon2;
-		std::list<Maths::Vector3>*input = &ppPolygon1, *output = &ppPolygon2;
+		ManifoldPolygon ppPolygon1, ppPolygon2;
+		ManifoldPolygon *input = &ppPolygon1, *output = &ppPolygon2;
 		
 		*output = input_polygon;
 		for(int iterations = 0; iterations < num_clip_planes; ++iterations)
 		{
-			if(output->empty())
+			if(output->count == 0)
 				break;
 			
 			const Maths::Plane& plane = clip_planes[iterations];
 			
 			std::swap(input, output);
-			output->clear();
+			output->count = 0;
 			
-			Maths::Vector3 startPoint = input->back();
-			for(const Maths::Vector3& endPoint : *input)
+			Maths::Vector3 startPoint = input->vertices[input->count - 1];
+			for(u32 i = 0; i < input->count; ++i)
 			{
+				const Maths::Vector3& endPoint = input->vertices[i];
 				bool startInPlane = plane.PointInPlane(startPoint);
 				bool endInPlane = plane.PointInPlane(endPoint);
 				
 				if(removePoints)
 				{
 					if(endInPlane)
-						output->push_back(endPoint);
+						output->Add(endPoint);
 				}
 				else
 				{
 					//if entire edge is within the clipping plane, keep it as it is
 					if(startInPlane && endInPlane)
-						output->push_back(endPoint);
+						output->Add(endPoint);
 					
 					//if edge interesects the clipping plane, cut the edge along clip plane
 					else if(startInPlane && !endInPlane)
-						output->push_back(PlaneEdgeIntersection(plane, startPoint, endPoint));
+						output->Add(PlaneEdgeIntersection(plane, startPoint, endPoint));
 					else if(!startInPlane && endInPlane)
 					{
-						output->push_back(PlaneEdgeIntersection(plane, endPoint, startPoint));
-						output->push_back(endPoint);
+						output->Add(PlaneEdgeIntersection(plane, endPoint, startPoint));
+						output->Add(endPoint);
 					}
 				}
 				
@@ -21,21 +21,23 @@ namespace Lumos
 		friend class TSingleton<CollisionDetection>;
 		typedef bool (CollisionDetection::*CollisionCheckFunc)(const RigidBody3D* obj1, const RigidBody3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata) const;
 
-		CollisionCheckFunc* m_CollisionCheckFunctions;
+		// Indexed by both shape types, so every pair of shapes gets its own entry
+		CollisionCheckFunc m_CollisionCheckFunctions[CollisionShapeTypeMax][CollisionShapeTypeMax];
 
 	public:
 		CollisionDetection();
-		~CollisionDetection()
-		{
-			if(m_CollisionCheckFunctions)
-				delete[] m_CollisionCheckFunctions;
-		}
+		~CollisionDetection() = default;
 
 		_FORCE_INLINE_ bool CheckCollision(const RigidBody3D* obj1, const RigidBody3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata = nullptr) const
 		{
-			return CALL_MEMBER_FN(*this, m_CollisionCheckFunctions[shape1->GetType() | shape2->GetType()])(obj1, obj2, shape1, shape2, out_coldata);
+			return CALL_MEMBER_FN(*this, m_CollisionCheckFunctions[shape1->GetType()][shape2->GetType()])(obj1, obj2, shape1, shape2, out_coldata);
 		}
 
+		// Routes a pair of shape types through the GJK/EPA test instead of their dedicated one, or back.
+		//	- Pairs with a capsule always use GJK/EPA. Not thread safe, change it between physics steps.
+		void SetConvexCollision(CollisionShapeType type1, CollisionShapeType type2, bool useConvex);
+		bool UsesConvexCollision(CollisionShapeType type1, CollisionShapeType type2) const;
+
 		bool BuildCollisionManifold(const RigidBody3D* obj1, const RigidBody3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, const CollisionData& coldata, Manifold* out_manifold) const;
 
 		static _FORCE_INLINE_ bool CheckSphereOverlap(const Maths::Vector3& pos1, float radius1, const Maths::Vector3& pos2, float radius2)
@@ -127,12 +129,14 @@ namespace Lumos
 	protected:
 		bool CheckPolyhedronCollision(const RigidBody3D* obj1, const RigidBody3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata = nullptr) const;
 		bool CheckPolyhedronSphereCollision(const RigidBody3D* obj1, const RigidBody3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata = nullptr) const;
+		bool CheckConvexCollision(const RigidBody3D* obj1, const RigidBody3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata = nullptr) const;
 		bool CheckSphereCollision(const RigidBody3D* obj1, const RigidBody3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata = nullptr) const;
 		bool InvalidCheckCollision(const RigidBody3D* obj1, const RigidBody3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata = nullptr) const;
 		static bool CheckCollisionAxis(const Maths::Vector3& axis, const RigidBody3D* obj1, const RigidBody3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata);
 
-		static Maths::Vector3 GetClosestPointOnEdges(const Maths::Vector3& target, const std::vector<CollisionEdge>& edges);
+		static CollisionCheckFunc GetDefaultCollisionCheck(CollisionShapeType type1, CollisionShapeType type2);
+		static Maths::Vector3 GetClosestPointOnEdges(const Maths::Vector3& target, const CollisionHull& hull, const Maths::Matrix3& rotation, const Maths::Vector3& position);
 		Maths::Vector3 PlaneEdgeIntersection(const Maths::Plane& plane, const Maths::Vector3& start, const Maths::Vector3& end) const;
-		void SutherlandHodgesonClipping(const std::list<Maths::Vector3>& input_polygon, int num_clip_planes, const Maths::Plane* clip_planes, std::list<Maths::Vector3>* out_polygon, bool removePoints) const;
+		void SutherlandHodgesonClipping(const ManifoldPolygon& input_polygon, int num_clip_planes, const Maths::Plane* clip_planes, ManifoldPolygon* out_polygon, bool removePoints) const;
 	};
 }
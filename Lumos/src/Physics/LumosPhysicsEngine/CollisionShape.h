@@ -1,12 +1,12 @@
 #pragma once
 
 #include "Maths/Maths.h"
-#include <list>
 #include <vector>
 
 namespace Lumos
 {
 	class RigidBody3D;
+	struct CollisionHull;
 
 	struct LUMOS_EXPORT CollisionEdge
 	{
@@ -20,6 +20,39 @@ namespace Lumos
 		Maths::Vector3 posB;
 	};
 
+	// Face used to build a manifold. Stored inline so clipping it doesn't touch the heap.
+	//	- Hull faces have at most 4 vertices and each clipping plane adds at most one more
+	struct LUMOS_EXPORT ManifoldPolygon
+	{
+		static const u32 MaxVertices = 16;
+
+		u32 count = 0;
+		Maths::Vector3 vertices[MaxVertices];
+
+		_FORCE_INLINE_ void Add(const Maths::Vector3& vertex)
+		{
+			LUMOS_ASSERT(count < MaxVertices, "Too many manifold polygon vertices");
+			if(count < MaxVertices)
+				vertices[count++] = vertex;
+		}
+	};
+
+	// Reference face and the faces adjacent to it, the planes a manifold polygon is clipped against
+	struct LUMOS_EXPORT ManifoldPlanes
+	{
+		static const u32 MaxPlanes = 8;
+
+		u32 count = 0;
+		Maths::Plane planes[MaxPlanes];
+
+		_FORCE_INLINE_ void Add(const Maths::Vector3& normal, float distance)
+		{
+			LUMOS_ASSERT(count < MaxPlanes, "Too many manifold clipping planes");
+			if(count < MaxPlanes)
+				planes[count++] = Maths::Plane(normal, distance);
+		}
+	};
+
 	enum CollisionShapeType : unsigned int
 	{
 		CollisionCuboid = 1,
@@ -76,9 +109,26 @@ namespace Lumos
 		//    of all adjacent faces in order to clip against.
 		virtual void GetIncidentReferencePolygon(const RigidBody3D* currentObject,
 			const Maths::Vector3& axis,
-			std::list<Maths::Vector3>* out_face,
+			ManifoldPolygon* out_face,
 			Maths::Vector3* out_normal,
-			std::vector<Maths::Plane>* out_adjacent_planes) const = 0;
+			ManifoldPlanes* out_adjacent_planes) const = 0;
+
+		// Support function used by GJK/EPA
+		//	- Returns the furthest point of the shape's core along the (body space) direction. Rounded
+		//    shapes report their core, a point for spheres and a segment for capsules, and sweep
+		//    GetSupportMargin() around it.
+		virtual Maths::Vector3 GetLocalSupportPoint(const Maths::Vector3& direction) const = 0;
+
+		virtual float GetSupportMargin() const
+		{
+			return 0.0f;
+		}
+
+		// Cached hull in body space, nullptr for shapes that aren't polyhedra
+		virtual const CollisionHull* GetCollisionHull() const
+		{
+			return nullptr;
+		}
 
 		void SetLocalTransform(const Maths::Matrix4& transform)
 		{
@@ -3,6 +3,7 @@
 
 namespace Lumos
 {
+	class RigidBody3D;
 
 	class LUMOS_EXPORT Constraint
 	{
@@ -17,10 +18,24 @@ namespace Lumos
 
 		virtual void PreSolverStep(float dt)
 		{
+			m_Timestep = dt;
 		}
 
 		virtual void DebugDraw() const
 		{
 		}
+
+		//Bodies linked by this constraint, used to build simulation islands
+		virtual RigidBody3D* GetBodyA() const
+		{
+			return nullptr;
+		}
+		virtual RigidBody3D* GetBodyB() const
+		{
+			return nullptr;
+		}
+
+	protected:
+		float m_Timestep = 1.0f / 60.0f; // Length of the step being solved, set by PreSolverStep
 	};
 }
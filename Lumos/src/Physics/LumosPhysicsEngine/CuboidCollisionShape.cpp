@@ -17,6 +17,8 @@ namespace Lumos
 		{
 			ConstructCubeHull();
 		}
+
+		UpdateCollisionHull();
 	}
 
 	CuboidCollisionShape::CuboidCollisionShape(const Maths::Vector3& halfdims)
@@ -29,12 +31,25 @@ namespace Lumos
 		{
 			ConstructCubeHull();
 		}
+
+		UpdateCollisionHull();
 	}
 
 	CuboidCollisionShape::~CuboidCollisionShape()
 	{
 	}
 
+	void CuboidCollisionShape::UpdateCollisionHull()
+	{
+		m_CubeHull->BuildCollisionHull(m_CuboidHalfDimensions, &m_CollisionHull);
+
+		// Same axes and signs as GetCollisionAxes, the sign decides which side the penetration is measured from
+		m_CollisionHull.faceNormals[0] = Maths::Vector3(1.0f, 0.0f, 0.0f);
+		m_CollisionHull.faceNormals[1] = Maths::Vector3(0.0f, 1.0f, 0.0f);
+		m_CollisionHull.faceNormals[2] = Maths::Vector3(0.0f, 0.0f, 1.0f);
+		m_CollisionHull.faceNormalCount = 3;
+	}
+
 	Maths::Matrix3 CuboidCollisionShape::BuildInverseInertia(float invMass) const
 	{
 		Maths::Matrix3 inertia;
@@ -98,7 +113,7 @@ namespace Lumos
 			*out_max = wsTransform * m_CubeHull->GetVertex(vMax).pos;
 	}
 
-	void CuboidCollisionShape::GetIncidentReferencePolygon(const RigidBody3D* currentObject, const Maths::Vector3& axis, std::list<Maths::Vector3>* out_face, Maths::Vector3* out_normal, std::vector<Maths::Plane>* out_adjacent_planes) const
+	void CuboidCollisionShape::GetIncidentReferencePolygon(const RigidBody3D* currentObject, const Maths::Vector3& axis, ManifoldPolygon* out_face, Maths::Vector3* out_normal, ManifoldPlanes* out_adjacent_planes) const
 	{
 		Maths::Matrix4 wsTransform;
 
@@ -141,7 +156,7 @@ namespace Lumos
 			for(int vertIdx : best_face->vert_ids)
 			{
 				const HullVertex& currentVert = m_CubeHull->GetVertex(vertIdx);
-				out_face->push_back(wsTransform * currentVert.pos);
+				out_face->Add(wsTransform * currentVert.pos);
 			}
 		}
 
@@ -153,7 +168,7 @@ namespace Lumos
 			planeNrml.Normalize();
 			float planeDist = -Maths::Vector3::Dot(planeNrml, wsPointOnPlane);
 
-			out_adjacent_planes->emplace_back(planeNrml, planeDist);
+			out_adjacent_planes->Add(planeNrml, planeDist);
 
 			for(int edgeIdx : best_face->edge_ids)
 			{
@@ -171,13 +186,20 @@ namespace Lumos
 						planeNrml.Normalize();
 						planeDist = -Maths::Vector3::Dot(planeNrml, wsPointOnPlane);
 
-						out_adjacent_planes->emplace_back(planeNrml, planeDist);
+						out_adjacent_planes->Add(planeNrml, planeDist);
 					}
 				}
 			}
 		}
 	}
 
+	Maths::Vector3 CuboidCollisionShape::GetLocalSupportPoint(const Maths::Vector3& direction) const
+	{
+		return Maths::Vector3(direction.x >= 0.0f ? m_CuboidHalfDimensions.x : -m_CuboidHalfDimensions.x,
+			direction.y >= 0.0f ? m_CuboidHalfDimensions.y : -m_CuboidHalfDimensions.y,
+			direction.z >= 0.0f ? m_CuboidHalfDimensions.z : -m_CuboidHalfDimensions.z);
+	}
+
 	void CuboidCollisionShape::DebugDraw(const RigidBody3D* currentObject) const
 	{
 		Maths::Matrix4 transform = currentObject->GetWorldSpaceTransform() * m_LocalTransform;
@@ -19,25 +19,34 @@ namespace Lumos
 		virtual void GetEdges(const RigidBody3D* currentObject, std::vector<CollisionEdge>* out_edges) const override;
 
 		virtual void GetMinMaxVertexOnAxis(const RigidBody3D* currentObject, const Maths::Vector3& axis, Maths::Vector3* out_min, Maths::Vector3* out_max) const override;
-		virtual void GetIncidentReferencePolygon(const RigidBody3D* currentObject, const Maths::Vector3& axis, std::list<Maths::Vector3>* out_face, Maths::Vector3* out_normal, std::vector<Maths::Plane>* out_adjacent_planes) const override;
+		virtual void GetIncidentReferencePolygon(const RigidBody3D* currentObject, const Maths::Vector3& axis, ManifoldPolygon* out_face, Maths::Vector3* out_normal, ManifoldPlanes* out_adjacent_planes) const override;
+		virtual Maths::Vector3 GetLocalSupportPoint(const Maths::Vector3& direction) const override;
 
 		virtual void DebugDraw(const RigidBody3D* currentObject) const override;
 
+		virtual const CollisionHull* GetCollisionHull() const override
+		{
+			return &m_CollisionHull;
+		}
+
 		//Set Cuboid Dimensions
 		void SetHalfWidth(float half_width)
 		{
 			m_CuboidHalfDimensions.x = fabs(half_width);
 			m_LocalTransform = Maths::Matrix4::Scale(m_CuboidHalfDimensions);
+			UpdateCollisionHull();
 		}
 		void SetHalfHeight(float half_height)
 		{
 			m_CuboidHalfDimensions.y = fabs(half_height);
 			m_LocalTransform = Maths::Matrix4::Scale(m_CuboidHalfDimensions);
+			UpdateCollisionHull();
 		}
 		void SetHalfDepth(float half_depth)
 		{
 			m_CuboidHalfDimensions.z = fabs(half_depth);
 			m_LocalTransform = Maths::Matrix4::Scale(m_CuboidHalfDimensions);
+			UpdateCollisionHull();
 		}
 
 		//Get Cuboid Dimensions
@@ -62,6 +71,7 @@ namespace Lumos
 		{
 			m_CuboidHalfDimensions = dims;
 			m_LocalTransform = Maths::Matrix4::Scale(m_CuboidHalfDimensions);
+			UpdateCollisionHull();
 		}
 
 		virtual float GetSize() const override
@@ -87,14 +97,19 @@ namespace Lumos
 			{
 				ConstructCubeHull();
 			}
+
+			UpdateCollisionHull();
 		}
 
 	protected:
 		//Constructs the static cube hull
 		static void ConstructCubeHull();
 
+		void UpdateCollisionHull();
+
 	protected:
 		Maths::Vector3 m_CuboidHalfDimensions;
+		CollisionHull m_CollisionHull;
 
 		static Ref<Hull> m_CubeHull;
 	};
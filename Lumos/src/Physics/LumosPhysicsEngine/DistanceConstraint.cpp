@@ -44,7 +44,7 @@ namespace Lumos
 		{
 			float distanceOffset = ab.Length() - m_Distance;
 			float baumgarteScalar = 0.1f;
-			b = -(baumgarteScalar / LumosPhysicsEngine::GetDeltaTime()) * distanceOffset;
+			b = -(baumgarteScalar / m_Timestep) * distanceOffset;
 		}
 
 		float jn = -(Maths::Vector3::Dot(v0 - v1, abn) + b) / constraintMass;
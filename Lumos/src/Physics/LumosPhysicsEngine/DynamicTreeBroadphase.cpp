@@ -0,0 +1,600 @@
+#include "Precompiled.h"
+#include "DynamicTreeBroadphase.h"
+#include "LumosPhysicsEngine.h"
+#include "Graphics/Renderers/DebugRenderer.h"
+
+namespace Lumos
+{
+	// Fat AABBs are extended this many steps along the body's velocity
+	static const float DISPLACEMENT_MULTIPLIER = 4.0f;
+
+	// Balancing keeps the tree shallow, so scene queries walk it with a stack that lives on the
+	// call stack and only moves to the heap for unusually deep trees
+	static const u32 INLINE_QUERY_STACK = 64;
+
+	template <typename T>
+	class QueryStack
+	{
+	public:
+		void Push(const T& value)
+		{
+			if(m_Size < INLINE_QUERY_STACK)
+				m_Inline[m_Size] = value;
+			else
+				m_Heap.push_back(value);
+			m_Size++;
+		}
+
+		T Pop()
+		{
+			m_Size--;
+			if(m_Size < INLINE_QUERY_STACK)
+				return m_Inline[m_Size];
+
+			const T value = m_Heap.back();
+			m_Heap.pop_back();
+			return value;
+		}
+
+		bool Empty() const
+		{
+			return m_Size == 0;
+		}
+
+	private:
+		T m_Inline[INLINE_QUERY_STACK];
+		std::vector<T> m_Heap;
+		u32 m_Size = 0;
+	};
+
+	static float SurfaceArea(const Maths::BoundingBox& box)
+	{
+		const Maths::Vector3 size = box.Size();
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	static Maths::BoundingBox Combine(const Maths::BoundingBox& a, const Maths::BoundingBox& b)
+	{
+		Maths::BoundingBox box(a);
+		box.Merge(b);
+		return box;
+	}
+
+	// Slab test, returns the distance the ray enters the box or FLT_MAX if it misses it within maxDistance
+	// Narrows [entry, exit] to the ray's overlap with one slab. A ray parallel to the slab would compute 0 * inf = NaN
+	// when it starts on a slab plane, so it either always or never overlaps depending on its origin.
+	static bool ClipSlab(float origin, float direction, float inverseDirection, float min, float max, float& entry, float& exit)
+	{
+		if(direction == 0.0f)
+			return origin >= min && origin <= max;
+
+		const float t1 = (min - origin) * inverseDirection;
+		const float t2 = (max - origin) * inverseDirection;
+		entry = Maths::Max(entry, Maths::Min(t1, t2));
+		exit = Maths::Min(exit, Maths::Max(t1, t2));
+		return entry <= exit;
+	}
+
+	static float RayBoxEntry(const Maths::Ray& ray, const Maths::Vector3& inverseDirection, const Maths::BoundingBox& box, float maxDistance)
+	{
+		float entry = 0.0f;
+		float exit = maxDistance;
+
+		if(!ClipSlab(ray.origin_.x, ray.direction_.x, inverseDirection.x, box.min_.x, box.max_.x, entry, exit)
+			|| !ClipSlab(ray.origin_.y, ray.direction_.y, inverseDirection.y, box.min_.y, box.max_.y, entry, exit)
+			|| !ClipSlab(ray.origin_.z, ray.direction_.z, inverseDirection.z, box.min_.z, box.max_.z, entry, exit))
+			return FLT_MAX;
+
+		return entry;
+	}
+
+	static u64 PairKey(i32 proxyA, i32 proxyB)
+	{
+		if(proxyA > proxyB)
+			std::swap(proxyA, proxyB);
+		return (static_cast<u64>(proxyA) << 32) | static_cast<u64>(static_cast<u32>(proxyB));
+	}
+
+	DynamicTreeBroadphase::DynamicTreeBroadphase(float aabbMargin)
+		: Broadphase()
+		, m_AABBMargin(aabbMargin)
+	{
+	}
+
+	DynamicTreeBroadphase::~DynamicTreeBroadphase()
+	{
+	}
+
+	void DynamicTreeBroadphase::FindPotentialCollisionPairs(std::vector<Ref<RigidBody3D>>& objects,
+		std::vector<CollisionPair>& collisionPairs)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		m_Step++;
+		m_MoveBuffer.clear();
+
+		// Create new proxies and reinsert any that left their fat AABB
+		for(const auto& physicsObject : objects)
+		{
+			if(!physicsObject || !physicsObject->GetCollisionShape())
+				continue;
+
+			RigidBody3D* body = physicsObject.get();
+			const Maths::BoundingBox aabb = body->GetWorldSpaceAABB(m_Timestep);
+
+			i32 proxyID;
+			auto it = m_Proxies.find(body);
+			if(it == m_Proxies.end())
+			{
+				proxyID = CreateProxy(aabb, body);
+				m_Proxies.emplace(body, proxyID);
+				m_MoveBuffer.push_back(proxyID);
+			}
+			else
+			{
+				proxyID = it->second;
+				if(MoveProxy(proxyID, aabb, body->GetLinearVelocity() * (m_Timestep * DISPLACEMENT_MULTIPLIER)))
+					m_MoveBuffer.push_back(proxyID);
+			}
+
+			m_Nodes[proxyID].lastStep = m_Step;
+		}
+
+		// Bodies that weren't passed in this step have been removed
+		for(auto it = m_Proxies.begin(); it != m_Proxies.end();)
+		{
+			if(m_Nodes[it->second].lastStep != m_Step)
+			{
+				DestroyProxy(it->second);
+				it = m_Proxies.erase(it);
+			}
+			else
+				++it;
+		}
+
+		// Only moved proxies can have started overlapping something
+		const size_t existingPairCount = m_Pairs.size();
+		for(i32 proxyID : m_MoveBuffer)
+		{
+			Query(m_Nodes[proxyID].aabb, [&](i32 otherID) {
+				if(otherID != proxyID)
+					m_Pairs.push_back(PairKey(proxyID, otherID));
+				return true;
+			});
+		}
+
+		if(m_Pairs.size() != existingPairCount)
+		{
+			std::sort(m_Pairs.begin(), m_Pairs.end());
+			m_Pairs.erase(std::unique(m_Pairs.begin(), m_Pairs.end()), m_Pairs.end());
+		}
+
+		// Drop pairs that no longer overlap or reference a destroyed proxy, report the rest
+		size_t pairCount = 0;
+		for(u64 pair : m_Pairs)
+		{
+			const i32 proxyA = static_cast<i32>(pair >> 32);
+			const i32 proxyB = static_cast<i32>(pair & 0xFFFFFFFF);
+			const TreeNode& nodeA = m_Nodes[proxyA];
+			const TreeNode& nodeB = m_Nodes[proxyB];
+
+			if(nodeA.height != 0 || nodeB.height != 0 || nodeA.aabb.IsInsideFast(nodeB.aabb) == Maths::OUTSIDE)
+				continue;
+
+			m_Pairs[pairCount++] = pair;
+
+			// Skip pairs of two at rest/static objects
+			if((nodeA.body->GetIsAtRest() || nodeA.body->GetIsStatic()) && (nodeB.body->GetIsAtRest() || nodeB.body->GetIsStatic()))
+				continue;
+
+			CollisionPair cp;
+			cp.pObjectA = nodeA.body;
+			cp.pObjectB = nodeB.body;
+			collisionPairs.push_back(cp);
+		}
+
+		m_Pairs.resize(pairCount);
+	}
+
+	i32 DynamicTreeBroadphase::CreateProxy(const Maths::BoundingBox& aabb, RigidBody3D* body)
+	{
+		const i32 proxyID = AllocateNode();
+		TreeNode& node = m_Nodes[proxyID];
+		node.aabb = Maths::BoundingBox(aabb.min_ - Maths::Vector3(m_AABBMargin), aabb.max_ + Maths::Vector3(m_AABBMargin));
+		node.body = body;
+		node.height = 0;
+
+		InsertLeaf(proxyID);
+		return proxyID;
+	}
+
+	void DynamicTreeBroadphase::DestroyProxy(i32 proxyID)
+	{
+		LUMOS_ASSERT(m_Nodes[proxyID].IsLeaf(), "Proxy is not a leaf");
+		RemoveLeaf(proxyID);
+		FreeNode(proxyID);
+	}
+
+	bool DynamicTreeBroadphase::MoveProxy(i32 proxyID, const Maths::BoundingBox& aabb, const Maths::Vector3& displacement)
+	{
+		TreeNode& node = m_Nodes[proxyID];
+		if(node.aabb.IsInside(aabb) == Maths::INSIDE)
+			return false;
+
+		RemoveLeaf(proxyID);
+
+		// Fatten the AABB and extend it in the direction the body is moving
+		Maths::Vector3 min = aabb.min_ - Maths::Vector3(m_AABBMargin);
+		Maths::Vector3 max = aabb.max_ + Maths::Vector3(m_AABBMargin);
+		min = min + Maths::Vector3(Maths::Min(displacement.x, 0.0f), Maths::Min(displacement.y, 0.0f), Maths::Min(displacement.z, 0.0f));
+		max = max + Maths::Vector3(Maths::Max(displacement.x, 0.0f), Maths::Max(displacement.y, 0.0f), Maths::Max(displacement.z, 0.0f));
+
+		m_Nodes[proxyID].aabb = Maths::BoundingBox(min, max);
+
+		InsertLeaf(proxyID);
+		return true;
+	}
+
+	i32 DynamicTreeBroadphase::GetHeight() const
+	{
+		return m_Root == NULL_NODE ? 0 : m_Nodes[m_Root].height;
+	}
+
+	i32 DynamicTreeBroadphase::AllocateNode()
+	{
+		if(m_FreeList == NULL_NODE)
+		{
+			m_Nodes.emplace_back();
+			return static_cast<i32>(m_Nodes.size() - 1);
+		}
+
+		const i32 nodeID = m_FreeList;
+		TreeNode& node = m_Nodes[nodeID];
+		m_FreeList = node.parent;
+		node = TreeNode();
+		return nodeID;
+	}
+
+	void DynamicTreeBroadphase::FreeNode(i32 nodeID)
+	{
+		TreeNode& node = m_Nodes[nodeID];
+		node.body = nullptr;
+		node.child1 = NULL_NODE;
+		node.child2 = NULL_NODE;
+		node.height = -1;
+		node.parent = m_FreeList;
+		m_FreeList = nodeID;
+	}
+
+	void DynamicTreeBroadphase::InsertLeaf(i32 leaf)
+	{
+		if(m_Root == NULL_NODE)
+		{
+			m_Root = leaf;
+			m_Nodes[leaf].parent = NULL_NODE;
+			return;
+		}
+
+		// Find the best sibling, descending towards the child with the lowest surface area cost
+		const Maths::BoundingBox leafAABB = m_Nodes[leaf].aabb;
+		i32 index = m_Root;
+		while(!m_Nodes[index].IsLeaf())
+		{
+			const TreeNode& node = m_Nodes[index];
+			const float area = SurfaceArea(node.aabb);
+			const float combinedArea = SurfaceArea(Combine(node.aabb, leafAABB));
+
+			// Cost of creating a new parent for this node and the new leaf
+			const float cost = 2.0f * combinedArea;
+
+			// Minimum cost of pushing the leaf further down the tree
+			const float inheritanceCost = 2.0f * (combinedArea - area);
+
+			float childCosts[2];
+			const i32 children[2] = {node.child1, node.child2};
+			for(int i = 0; i < 2; i++)
+			{
+				const TreeNode& child = m_Nodes[children[i]];
+				const float newArea = SurfaceArea(Combine(leafAABB, child.aabb));
+				childCosts[i] = (child.IsLeaf() ? newArea : newArea - SurfaceArea(child.aabb)) + inheritanceCost;
+			}
+
+			if(cost < childCosts[0] && cost < childCosts[1])
+				break;
+
+			index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+		}
+
+		const i32 sibling = index;
+
+		// Create a new parent for the sibling and the leaf
+		const i32 oldParent = m_Nodes[sibling].parent;
+		const i32 newParent = AllocateNode();
+		m_Nodes[newParent].parent = oldParent;
+		m_Nodes[newParent].aabb = Combine(leafAABB, m_Nodes[sibling].aabb);
+		m_Nodes[newParent].height = m_Nodes[sibling].height + 1;
+		m_Nodes[newParent].child1 = sibling;
+		m_Nodes[newParent].child2 = leaf;
+		m_Nodes[sibling].parent = newParent;
+		m_Nodes[leaf].parent = newParent;
+
+		if(oldParent != NULL_NODE)
+		{
+			if(m_Nodes[oldParent].child1 == sibling)
+				m_Nodes[oldParent].child1 = newParent;
+			else
+				m_Nodes[oldParent].child2 = newParent;
+		}
+		else
+			m_Root = newParent;
+
+		// Walk back up the tree fixing heights and AABBs
+		index = m_Nodes[leaf].parent;
+		while(index != NULL_NODE)
+		{
+			index = Balance(index);
+
+			TreeNode& node = m_Nodes[index];
+			node.height = 1 + Maths::Max(m_Nodes[node.child1].height, m_Nodes[node.child2].height);
+			node.aabb = Combine(m_Nodes[node.child1].aabb, m_Nodes[node.child2].aabb);
+
+			index = node.parent;
+		}
+	}
+
+	void DynamicTreeBroadphase::RemoveLeaf(i32 leaf)
+	{
+		if(leaf == m_Root)
+		{
+			m_Root = NULL_NODE;
+			return;
+		}
+
+		const i32 parent = m_Nodes[leaf].parent;
+		const i32 grandParent = m_Nodes[parent].parent;
+		const i32 sibling = m_Nodes[parent].child1 == leaf ? m_Nodes[parent].child2 : m_Nodes[parent].child1;
+
+		FreeNode(parent);
+
+		if(grandParent == NULL_NODE)
+		{
+			m_Root = sibling;
+			m_Nodes[sibling].parent = NULL_NODE;
+			return;
+		}
+
+		// Connect the sibling to the grand parent
+		if(m_Nodes[grandParent].child1 == parent)
+			m_Nodes[grandParent].child1 = sibling;
+		else
+			m_Nodes[grandParent].child2 = sibling;
+		m_Nodes[sibling].parent = grandParent;
+
+		i32 index = grandParent;
+		while(index != NULL_NODE)
+		{
+			index = Balance(index);
+
+			TreeNode& node = m_Nodes[index];
+			node.height = 1 + Maths::Max(m_Nodes[node.child1].height, m_Nodes[node.child2].height);
+			node.aabb = Combine(m_Nodes[node.child1].aabb, m_Nodes[node.child2].aabb);
+
+			index = node.parent;
+		}
+	}
+
+	// Performs a left or right rotation if node A is imbalanced. Returns the new root of the subtree.
+	i32 DynamicTreeBroadphase::Balance(i32 iA)
+	{
+		TreeNode* A = &m_Nodes[iA];
+		if(A->IsLeaf() || A->height < 2)
+			return iA;
+
+		const i32 iB = A->child1;
+		const i32 iC = A->child2;
+		TreeNode* B = &m_Nodes[iB];
+		TreeNode* C = &m_Nodes[iC];
+
+		const i32 balance = C->height - B->height;
+
+		// Rotate C up
+		if(balance > 1)
+		{
+			const i32 iF = C->child1;
+			const i32 iG = C->child2;
+			TreeNode* F = &m_Nodes[iF];
+			TreeNode* G = &m_Nodes[iG];
+
+			// Swap A and C
+			C->child1 = iA;
+			C->parent = A->parent;
+			A->parent = iC;
+
+			if(C->parent != NULL_NODE)
+			{
+				if(m_Nodes[C->parent].child1 == iA)
+					m_Nodes[C->parent].child1 = iC;
+				else
+					m_Nodes[C->parent].child2 = iC;
+			}
+			else
+				m_Root = iC;
+
+			// Rotate
+			if(F->height > G->height)
+			{
+				C->child2 = iF;
+				A->child2 = iG;
+				G->parent = iA;
+				A->aabb = Combine(B->aabb, G->aabb);
+				C->aabb = Combine(A->aabb, F->aabb);
+
+				A->height = 1 + Maths::Max(B->height, G->height);
+				C->height = 1 + Maths::Max(A->height, F->height);
+			}
+			else
+			{
+				C->child2 = iG;
+				A->child2 = iF;
+				F->parent = iA;
+				A->aabb = Combine(B->aabb, F->aabb);
+				C->aabb = Combine(A->aabb, G->aabb);
+
+				A->height = 1 + Maths::Max(B->height, F->height);
+				C->height = 1 + Maths::Max(A->height, G->height);
+			}
+
+			return iC;
+		}
+
+		// Rotate B up
+		if(balance < -1)
+		{
+			const i32 iD = B->child1;
+			const i32 iE = B->child2;
+			TreeNode* D = &m_Nodes[iD];
+			TreeNode* E = &m_Nodes[iE];
+
+			// Swap A and B
+			B->child1 = iA;
+			B->parent = A->parent;
+			A->parent = iB;
+
+			if(B->parent != NULL_NODE)
+			{
+				if(m_Nodes[B->parent].child1 == iA)
+					m_Nodes[B->parent].child1 = iB;
+				else
+					m_Nodes[B->parent].child2 = iB;
+			}
+			else
+				m_Root = iB;
+
+			// Rotate
+			if(D->height > E->height)
+			{
+				B->child2 = iD;
+				A->child1 = iE;
+				E->parent = iA;
+				A->aabb = Combine(C->aabb, E->aabb);
+				B->aabb = Combine(A->aabb, D->aabb);
+
+				A->height = 1 + Maths::Max(C->height, E->height);
+				B->height = 1 + Maths::Max(A->height, D->height);
+			}
+			else
+			{
+				B->child2 = iE;
+				A->child1 = iD;
+				D->parent = iA;
+				A->aabb = Combine(C->aabb, D->aabb);
+				B->aabb = Combine(A->aabb, E->aabb);
+
+				A->height = 1 + Maths::Max(C->height, D->height);
+				B->height = 1 + Maths::Max(A->height, E->height);
+			}
+
+			return iB;
+		}
+
+		return iA;
+	}
+
+	bool DynamicTreeBroadphase::QueryAABB(const Maths::BoundingBox& aabb, std::vector<RigidBody3D*>& out_bodies) const
+	{
+		QueryStack<i32> stack;
+		if(m_Root != NULL_NODE)
+			stack.Push(m_Root);
+
+		while(!stack.Empty())
+		{
+			const TreeNode& node = m_Nodes[stack.Pop()];
+			if(node.aabb.IsInsideFast(aabb) == Maths::OUTSIDE)
+				continue;
+
+			if(node.IsLeaf())
+				out_bodies.push_back(node.body);
+			else
+			{
+				stack.Push(node.child1);
+				stack.Push(node.child2);
+			}
+		}
+
+		return true;
+	}
+
+	bool DynamicTreeBroadphase::QueryRay(const Maths::Ray& ray, float maxDistance, const BroadphaseRaycastCallback& callback) const
+	{
+		if(m_Root == NULL_NODE)
+			return true;
+
+		// Axis parallel components divide by zero, ClipSlab never uses them
+		const Maths::Vector3 inverseDirection(1.0f / ray.direction_.x, 1.0f / ray.direction_.y, 1.0f / ray.direction_.z);
+
+		// Nodes with their entry distance, children are pushed far one first so closer bodies are reported first
+		// and their hits clip the rest of the walk
+		struct RayStackEntry
+		{
+			i32 node;
+			float entry;
+		};
+		QueryStack<RayStackEntry> stack;
+
+		const float rootEntry = RayBoxEntry(ray, inverseDirection, m_Nodes[m_Root].aabb, maxDistance);
+		if(rootEntry != FLT_MAX)
+			stack.Push({ m_Root, rootEntry });
+
+		while(!stack.Empty())
+		{
+			const RayStackEntry current = stack.Pop();
+			if(current.entry > maxDistance)
+				continue;
+
+			const TreeNode& node = m_Nodes[current.node];
+			if(node.IsLeaf())
+			{
+				maxDistance = callback(node.body, maxDistance);
+				continue;
+			}
+
+			i32 children[2] = { node.child1, node.child2 };
+			float entries[2] = { RayBoxEntry(ray, inverseDirection, m_Nodes[node.child1].aabb, maxDistance), RayBoxEntry(ray, inverseDirection, m_Nodes[node.child2].aabb, maxDistance) };
+			if(entries[0] < entries[1])
+			{
+				std::swap(children[0], children[1]);
+				std::swap(entries[0], entries[1]);
+			}
+
+			for(u32 i = 0; i < 2; ++i)
+			{
+				if(entries[i] != FLT_MAX)
+					stack.Push({ children[i], entries[i] });
+			}
+		}
+
+		return true;
+	}
+
+	void DynamicTreeBroadphase::DebugDraw()
+	{
+		DebugDrawNode(m_Root);
+	}
+
+	void DynamicTreeBroadphase::DebugDrawNode(i32 nodeID) const
+	{
+		if(nodeID == NULL_NODE)
+			return;
+
+		const TreeNode& node = m_Nodes[nodeID];
+		if(node.IsLeaf())
+		{
+			DebugRenderer::DebugDraw(node.aabb, Maths::Vector4(0.2f, 0.8f, 0.4f, 1.0f), false, 0.02f);
+		}
+		else
+		{
+			DebugRenderer::DebugDraw(node.aabb, Maths::Vector4(0.8f, 0.2f, 0.4f, 1.0f), false, 0.02f);
+			DebugDrawNode(node.child1);
+			DebugDrawNode(node.child2);
+		}
+	}
+}
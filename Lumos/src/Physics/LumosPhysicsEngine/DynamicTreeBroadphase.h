@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Broadphase.h"
+#include "Maths/Maths.h"
+
+namespace Lumos
+{
+	// Incrementally updated bounding volume hierarchy. Every rigid body owns a proxy (leaf) with a
+	// fattened AABB, which is only reinserted once the body leaves it. Only moved proxies query the
+	// tree for new pairs, so the cost scales with the number of moving bodies.
+	class LUMOS_EXPORT DynamicTreeBroadphase : public Broadphase
+	{
+	public:
+		explicit DynamicTreeBroadphase(float aabbMargin = 0.1f);
+		virtual ~DynamicTreeBroadphase();
+
+		void FindPotentialCollisionPairs(std::vector<Ref<RigidBody3D>>& objects, std::vector<CollisionPair>& collisionPairs) override;
+		void DebugDraw() override;
+
+		// Fat AABBs are extended along the bodies' velocity, so they still bound them after integration
+		bool QueryAABB(const Maths::BoundingBox& aabb, std::vector<RigidBody3D*>& out_bodies) const override;
+		bool QueryRay(const Maths::Ray& ray, float maxDistance, const BroadphaseRaycastCallback& callback) const override;
+
+		i32 CreateProxy(const Maths::BoundingBox& aabb, RigidBody3D* body);
+		void DestroyProxy(i32 proxyID);
+
+		// Returns true if the proxy had to be reinserted
+		bool MoveProxy(i32 proxyID, const Maths::BoundingBox& aabb, const Maths::Vector3& displacement);
+
+		_FORCE_INLINE_ const Maths::BoundingBox& GetFatAABB(i32 proxyID) const
+		{
+			return m_Nodes[proxyID].aabb;
+		}
+
+		_FORCE_INLINE_ RigidBody3D* GetBody(i32 proxyID) const
+		{
+			return m_Nodes[proxyID].body;
+		}
+
+		_FORCE_INLINE_ u32 GetProxyCount() const
+		{
+			return static_cast<u32>(m_Proxies.size());
+		}
+
+		i32 GetHeight() const;
+
+		// Calls callback(proxyID) for every proxy whose fat AABB overlaps aabb. Return false from the callback to stop.
+		template <typename Callback>
+		void Query(const Maths::BoundingBox& aabb, Callback&& callback)
+		{
+			m_QueryStack.clear();
+			m_QueryStack.push_back(m_Root);
+
+			while(!m_QueryStack.empty())
+			{
+				const i32 nodeID = m_QueryStack.back();
+				m_QueryStack.pop_back();
+
+				if(nodeID == NULL_NODE)
+					continue;
+
+				const TreeNode& node = m_Nodes[nodeID];
+				if(node.aabb.IsInsideFast(aabb) == Maths::OUTSIDE)
+					continue;
+
+				if(node.IsLeaf())
+				{
+					if(!callback(nodeID))
+						return;
+				}
+				else
+				{
+					m_QueryStack.push_back(node.child1);
+					m_QueryStack.push_back(node.child2);
+				}
+			}
+		}
+
+		static constexpr i32 NULL_NODE = -1;
+
+	private:
+		struct TreeNode
+		{
+			Maths::BoundingBox aabb;
+			RigidBody3D* body = nullptr;
+			i32 parent = NULL_NODE; // Next free node while in the free list
+			i32 child1 = NULL_NODE;
+			i32 child2 = NULL_NODE;
+			i32 height = -1; // 0 for leaves, -1 for free nodes
+			u32 lastStep = 0; // Last step the leaf's body was passed to FindPotentialCollisionPairs
+
+			bool IsLeaf() const
+			{
+				return child1 == NULL_NODE;
+			}
+		};
+
+		i32 AllocateNode();
+		void FreeNode(i32 nodeID);
+		void InsertLeaf(i32 leaf);
+		void RemoveLeaf(i32 leaf);
+		i32 Balance(i32 nodeID);
+		void DebugDrawNode(i32 nodeID) const;
+
+		std::vector<TreeNode> m_Nodes;
+		i32 m_Root = NULL_NODE;
+		i32 m_FreeList = NULL_NODE;
+		float m_AABBMargin;
+		u32 m_Step = 0;
+
+		std::unordered_map<RigidBody3D*, i32> m_Proxies;
+		std::vector<i32> m_MoveBuffer;
+		std::vector<u64> m_Pairs; // Sorted proxy pairs whose fat AABBs overlap, kept between steps
+		std::vector<i32> m_QueryStack;
+	};
+}
@@ -0,0 +1,615 @@
+#include "Precompiled.h"
+#include "GJK.h"
+#include "CollisionShape.h"
+
+namespace Lumos
+{
+	namespace
+	{
+		const float GJKTolerance = 1.0e-4f; // Cores closer than this are treated as intersecting
+		const float GJKRelativeTolerance = 1.0e-5f;
+		const float EPATolerance = 1.0e-4f;
+		const float RayTolerance = 1.0e-4f;
+
+		const u32 MaxPolytopeVertices = GJK::MaxEPAIterations + 4;
+		const u32 MaxPolytopeFaces = 2 * MaxPolytopeVertices;
+		const u32 MaxHorizonEdges = 3 * MaxPolytopeFaces;
+
+		struct SimplexVertex
+		{
+			Maths::Vector3 a; // Support point on a
+			Maths::Vector3 b; // Support point on b
+			Maths::Vector3 w; // a - b, a point of the Minkowski difference
+		};
+
+		struct Simplex
+		{
+			SimplexVertex vertices[4];
+			float barycentric[4];
+			u32 count = 0;
+
+			Maths::Vector3 ClosestPoint() const
+			{
+				Maths::Vector3 point(0.0f);
+				for(u32 i = 0; i < count; ++i)
+					point += vertices[i].w * barycentric[i];
+				return point;
+			}
+
+			void GetWitnessPoints(Maths::Vector3* out_pointA, Maths::Vector3* out_pointB) const
+			{
+				*out_pointA = Maths::Vector3(0.0f);
+				*out_pointB = Maths::Vector3(0.0f);
+				for(u32 i = 0; i < count; ++i)
+				{
+					*out_pointA += vertices[i].a * barycentric[i];
+					*out_pointB += vertices[i].b * barycentric[i];
+				}
+			}
+		};
+
+		SimplexVertex MakeVertex(const ConvexProxy& a, const ConvexProxy& b, const Maths::Vector3& direction, bool withMargin)
+		{
+			SimplexVertex vertex;
+			vertex.a = withMargin ? a.SupportWithMargin(direction) : a.Support(direction);
+			vertex.b = withMargin ? b.SupportWithMargin(-direction) : b.Support(-direction);
+			vertex.w = vertex.a - vertex.b;
+			return vertex;
+		}
+
+		_FORCE_INLINE_ float SafeRatio(float numerator, float denominator)
+		{
+			return denominator > 0.0f ? numerator / denominator : 0.0f;
+		}
+
+		void KeepVertex(Simplex& simplex, u32 index)
+		{
+			simplex.vertices[0] = simplex.vertices[index];
+			simplex.barycentric[0] = 1.0f;
+			simplex.count = 1;
+		}
+
+		void KeepEdge(Simplex& simplex, u32 index0, u32 index1, float t)
+		{
+			const SimplexVertex vertex0 = simplex.vertices[index0];
+			const SimplexVertex vertex1 = simplex.vertices[index1];
+			simplex.vertices[0] = vertex0;
+			simplex.vertices[1] = vertex1;
+			simplex.barycentric[0] = 1.0f - t;
+			simplex.barycentric[1] = t;
+			simplex.count = 2;
+		}
+
+		// Reduces the simplex to the feature closest to the origin, see Ericson - Real-Time Collision Detection 5.1
+		void SolveSegment(Simplex& simplex)
+		{
+			const Maths::Vector3& a = simplex.vertices[0].w;
+			const Maths::Vector3 ab = simplex.vertices[1].w - a;
+
+			const float t = SafeRatio(-a.DotProduct(ab), ab.LengthSquared());
+			if(t <= 0.0f)
+				KeepVertex(simplex, 0);
+			else if(t >= 1.0f)
+				KeepVertex(simplex, 1);
+			else
+				KeepEdge(simplex, 0, 1, t);
+		}
+
+		void SolveTriangle(Simplex& simplex)
+		{
+			const Maths::Vector3 a = simplex.vertices[0].w;
+			const Maths::Vector3 b = simplex.vertices[1].w;
+			const Maths::Vector3 c = simplex.vertices[2].w;
+			const Maths::Vector3 ab = b - a;
+			const Maths::Vector3 ac = c - a;
+
+			const float d1 = -ab.DotProduct(a);
+			const float d2 = -ac.DotProduct(a);
+			if(d1 <= 0.0f && d2 <= 0.0f)
+				return KeepVertex(simplex, 0);
+
+			const float d3 = -ab.DotProduct(b);
+			const float d4 = -ac.DotProduct(b);
+			if(d3 >= 0.0f && d4 <= d3)
+				return KeepVertex(simplex, 1);
+
+			const float vc = d1 * d4 - d3 * d2;
+			if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+				return KeepEdge(simplex, 0, 1, SafeRatio(d1, d1 - d3));
+
+			const float d5 = -ab.DotProduct(c);
+			const float d6 = -ac.DotProduct(c);
+			if(d6 >= 0.0f && d5 <= d6)
+				return KeepVertex(simplex, 2);
+
+			const float vb = d5 * d2 - d1 * d6;
+			if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+				return KeepEdge(simplex, 0, 2, SafeRatio(d2, d2 - d6));
+
+			const float va = d3 * d6 - d5 * d4;
+			if(va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+				return KeepEdge(simplex, 1, 2, SafeRatio(d4 - d3, (d4 - d3) + (d5 - d6)));
+
+			const float denominator = 1.0f / (va + vb + vc);
+			simplex.barycentric[1] = vb * denominator;
+			simplex.barycentric[2] = vc * denominator;
+			simplex.barycentric[0] = 1.0f - simplex.barycentric[1] - simplex.barycentric[2];
+			simplex.count = 3;
+		}
+
+		// True if the origin and the opposite vertex lie on different sides of the face, degenerate faces count as outside
+		bool OriginOutsideFace(const Maths::Vector3& a, const Maths::Vector3& b, const Maths::Vector3& c, const Maths::Vector3& opposite)
+		{
+			const Maths::Vector3 normal = (b - a).CrossProduct(c - a);
+			return -a.DotProduct(normal) * (opposite - a).DotProduct(normal) <= 0.0f;
+		}
+
+		void SolveTetrahedron(Simplex& simplex)
+		{
+			static const u32 Faces[4][4] = {{0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0}};
+
+			Simplex best;
+			float bestDistanceSq = FLT_MAX;
+
+			for(const u32* face : Faces)
+			{
+				const SimplexVertex* vertices = simplex.vertices;
+				if(!OriginOutsideFace(vertices[face[0]].w, vertices[face[1]].w, vertices[face[2]].w, vertices[face[3]].w))
+					continue;
+
+				Simplex triangle;
+				triangle.vertices[0] = vertices[face[0]];
+				triangle.vertices[1] = vertices[face[1]];
+				triangle.vertices[2] = vertices[face[2]];
+				triangle.count = 3;
+				SolveTriangle(triangle);
+
+				const float distanceSq = triangle.ClosestPoint().LengthSquared();
+				if(distanceSq < bestDistanceSq)
+				{
+					bestDistanceSq = distanceSq;
+					best = triangle;
+				}
+			}
+
+			// Origin is inside every face, leave the full tetrahedron
+			if(best.count > 0)
+				simplex = best;
+		}
+
+		void Solve(Simplex& simplex)
+		{
+			switch(simplex.count)
+			{
+			case 1:
+				simplex.barycentric[0] = 1.0f;
+				break;
+			case 2:
+				SolveSegment(simplex);
+				break;
+			case 3:
+				SolveTriangle(simplex);
+				break;
+			case 4:
+				SolveTetrahedron(simplex);
+				break;
+			default:
+				break;
+			}
+		}
+
+		// Converges the simplex towards the point of a - b closest to the origin. Returns false as soon as the
+		// shapes are known to be further than maxDistance apart.
+		bool RunGJK(const ConvexProxy& a, const ConvexProxy& b, bool withMargin, float maxDistance, Simplex* simplex, bool* out_overlap, u32* out_iterations)
+		{
+			Maths::Vector3 direction = b.position - a.position;
+			if(direction.LengthSquared() < GJKTolerance * GJKTolerance)
+				direction = Maths::Vector3(1.0f, 0.0f, 0.0f);
+
+			simplex->vertices[0] = MakeVertex(a, b, direction, withMargin);
+			simplex->count = 1;
+
+			*out_overlap = false;
+
+			Simplex previous;
+			float previousDistanceSq = FLT_MAX;
+
+			u32 iteration = 0;
+			for(; iteration < GJK::MaxIterations; ++iteration)
+			{
+				Solve(*simplex);
+
+				if(simplex->count == 4)
+				{
+					*out_overlap = true;
+					break;
+				}
+
+				const Maths::Vector3 closest = simplex->ClosestPoint();
+				const float distanceSq = closest.LengthSquared();
+				if(distanceSq < GJKTolerance * GJKTolerance)
+				{
+					*out_overlap = true;
+					break;
+				}
+
+				// Rounding can make a nearly flat tetrahedron drop the wrong face and cycle, keep the last simplex that made progress
+				if(distanceSq >= previousDistanceSq)
+				{
+					*simplex = previous;
+					break;
+				}
+
+				previous = *simplex;
+				previousDistanceSq = distanceSq;
+
+				const SimplexVertex vertex = MakeVertex(a, b, -closest, withMargin);
+
+				// Even the support towards the origin stays this far along closest, so that's a lower bound on the distance
+				const float separation = vertex.w.DotProduct(closest);
+				if(separation > 0.0f && separation * separation > maxDistance * maxDistance * distanceSq)
+				{
+					*out_iterations = iteration + 1;
+					return false;
+				}
+
+				// No progress towards the origin, closest is the answer
+				if(distanceSq - separation <= GJKRelativeTolerance * distanceSq)
+					break;
+
+				bool duplicate = false;
+				for(u32 i = 0; i < simplex->count; ++i)
+					duplicate |= (vertex.w - simplex->vertices[i].w).LengthSquared() < GJKTolerance * GJKTolerance;
+
+				if(duplicate)
+					break;
+
+				simplex->vertices[simplex->count++] = vertex;
+			}
+
+			if(iteration == GJK::MaxIterations)
+			{
+				Solve(*simplex);
+				*out_overlap = simplex->count == 4 || simplex->ClosestPoint().LengthSquared() < GJKTolerance * GJKTolerance;
+			}
+
+			*out_iterations = iteration;
+			return true;
+		}
+
+		// Grows a simplex that touches the origin into a tetrahedron so EPA has a volume to expand
+		bool CompleteSimplex(const ConvexProxy& a, const ConvexProxy& b, Simplex& simplex)
+		{
+			static const Maths::Vector3 Axes[6] = {
+				Maths::Vector3(1.0f, 0.0f, 0.0f), Maths::Vector3(-1.0f, 0.0f, 0.0f),
+				Maths::Vector3(0.0f, 1.0f, 0.0f), Maths::Vector3(0.0f, -1.0f, 0.0f),
+				Maths::Vector3(0.0f, 0.0f, 1.0f), Maths::Vector3(0.0f, 0.0f, -1.0f)};
+
+			const float toleranceSq = GJKTolerance * GJKTolerance;
+
+			if(simplex.count == 1)
+			{
+				for(const Maths::Vector3& axis : Axes)
+				{
+					const SimplexVertex vertex = MakeVertex(a, b, axis, true);
+					if((vertex.w - simplex.vertices[0].w).LengthSquared() > toleranceSq)
+					{
+						simplex.vertices[simplex.count++] = vertex;
+						break;
+					}
+				}
+			}
+
+			if(simplex.count == 2)
+			{
+				const Maths::Vector3 edge = simplex.vertices[1].w - simplex.vertices[0].w;
+
+				// Search perpendicular to the edge, starting from the axis it is least aligned with
+				const Maths::Vector3 absEdge(fabs(edge.x), fabs(edge.y), fabs(edge.z));
+				const Maths::Vector3& axis = absEdge.x < absEdge.y ? (absEdge.x < absEdge.z ? Axes[0] : Axes[4]) : (absEdge.y < absEdge.z ? Axes[2] : Axes[4]);
+				const Maths::Vector3 perpendicular1 = edge.CrossProduct(axis).Normalized();
+				const Maths::Vector3 perpendicular2 = edge.CrossProduct(perpendicular1).Normalized();
+				const Maths::Vector3 directions[4] = {perpendicular1, perpendicular2, -perpendicular1, -perpendicular2};
+
+				for(const Maths::Vector3& direction : directions)
+				{
+					const SimplexVertex vertex = MakeVertex(a, b, direction, true);
+					if(edge.CrossProduct(vertex.w - simplex.vertices[0].w).LengthSquared() > toleranceSq)
+					{
+						simplex.vertices[simplex.count++] = vertex;
+						break;
+					}
+				}
+			}
+
+			if(simplex.count == 3)
+			{
+				const Maths::Vector3& origin = simplex.vertices[0].w;
+				const Maths::Vector3 normal = (simplex.vertices[1].w - origin).CrossProduct(simplex.vertices[2].w - origin).Normalized();
+
+				SimplexVertex vertex = MakeVertex(a, b, normal, true);
+				if(fabs((vertex.w - origin).DotProduct(normal)) < GJKTolerance)
+					vertex = MakeVertex(a, b, -normal, true);
+
+				if(fabs((vertex.w - origin).DotProduct(normal)) >= GJKTolerance)
+					simplex.vertices[simplex.count++] = vertex;
+			}
+
+			return simplex.count == 4;
+		}
+
+		struct PolytopeFace
+		{
+			u32 indices[3];
+			Maths::Vector3 normal;
+			float distance;
+		};
+
+		struct PolytopeEdge
+		{
+			u32 start;
+			u32 end;
+		};
+
+		void BuildFace(const SimplexVertex* vertices, u32 index0, u32 index1, u32 index2, PolytopeFace* out_face)
+		{
+			out_face->indices[0] = index0;
+			out_face->indices[1] = index1;
+			out_face->indices[2] = index2;
+
+			const Maths::Vector3& a = vertices[index0].w;
+			const Maths::Vector3 normal = (vertices[index1].w - a).CrossProduct(vertices[index2].w - a);
+			const float lengthSq = normal.LengthSquared();
+
+			if(lengthSq < GJKTolerance * GJKTolerance * GJKTolerance * GJKTolerance)
+			{
+				// Sliver faces are kept to close the polytope but are never expanded
+				out_face->normal = Maths::Vector3(0.0f);
+				out_face->distance = FLT_MAX;
+				return;
+			}
+
+			out_face->normal = normal / sqrtf(lengthSq);
+			out_face->distance = out_face->normal.DotProduct(a);
+		}
+
+		// Edges shared by two removed faces cancel out, the ones left form the horizon
+		void AddHorizonEdge(PolytopeEdge* edges, u32* edgeCount, u32 start, u32 end)
+		{
+			for(u32 i = 0; i < *edgeCount; ++i)
+			{
+				if(edges[i].start == end && edges[i].end == start)
+				{
+					edges[i] = edges[--(*edgeCount)];
+					return;
+				}
+			}
+
+			if(*edgeCount < MaxHorizonEdges)
+				edges[(*edgeCount)++] = {start, end};
+		}
+
+		u32 FindClosestFace(const PolytopeFace* faces, u32 faceCount)
+		{
+			u32 closest = 0;
+			for(u32 i = 1; i < faceCount; ++i)
+			{
+				if(faces[i].distance < faces[closest].distance)
+					closest = i;
+			}
+			return closest;
+		}
+	}
+
+	ConvexProxy::ConvexProxy(const CollisionShape* collisionShape, const Maths::Matrix4& transform)
+		: shape(collisionShape)
+		, rotation(transform.ToMatrix3())
+		, position(transform.Translation())
+		, margin(collisionShape->GetSupportMargin())
+	{
+		inverseRotation = Maths::Matrix3::Transpose(rotation);
+	}
+
+	ConvexProxy::ConvexProxy(const Maths::Vector3& centre, float radius)
+		: shape(nullptr)
+		, rotation(Maths::Matrix3::IDENTITY)
+		, inverseRotation(Maths::Matrix3::IDENTITY)
+		, position(centre)
+		, margin(radius)
+	{
+	}
+
+	Maths::Vector3 ConvexProxy::Support(const Maths::Vector3& direction) const
+	{
+		if(!shape)
+			return position;
+
+		return rotation * shape->GetLocalSupportPoint(inverseRotation * direction) + position;
+	}
+
+	Maths::Vector3 ConvexProxy::SupportWithMargin(const Maths::Vector3& direction) const
+	{
+		const Maths::Vector3 support = Support(direction);
+		const float lengthSq = direction.LengthSquared();
+
+		if(margin <= 0.0f || lengthSq <= 0.0f)
+			return support;
+
+		return support + direction * (margin / sqrtf(lengthSq));
+	}
+
+	bool GJK::Distance(const ConvexProxy& a, const ConvexProxy& b, float maxDistance, DistanceResult* out_result)
+	{
+		Simplex simplex;
+		bool overlap;
+
+		if(!RunGJK(a, b, false, maxDistance, &simplex, &overlap, &out_result->iterations))
+			return false;
+
+		out_result->overlap = overlap;
+		if(overlap)
+		{
+			out_result->distance = 0.0f;
+			return true;
+		}
+
+		simplex.GetWitnessPoints(&out_result->pointA, &out_result->pointB);
+		out_result->distance = (out_result->pointB - out_result->pointA).Length();
+
+		return out_result->distance <= maxDistance;
+	}
+
+	bool GJK::Penetration(const ConvexProxy& a, const ConvexProxy& b, Maths::Vector3* out_normal, float* out_depth, Maths::Vector3* out_pointA, Maths::Vector3* out_pointB)
+	{
+		Simplex simplex;
+		bool overlap;
+		u32 iterations;
+
+		if(!RunGJK(a, b, true, 0.0f, &simplex, &overlap, &iterations) || !overlap)
+			return false;
+
+		if(!CompleteSimplex(a, b, simplex))
+			return false;
+
+		SimplexVertex vertices[MaxPolytopeVertices];
+		PolytopeFace faces[MaxPolytopeFaces];
+		PolytopeEdge edges[MaxHorizonEdges];
+
+		u32 vertexCount = 4;
+		u32 faceCount = 0;
+		for(u32 i = 0; i < 4; ++i)
+			vertices[i] = simplex.vertices[i];
+
+		// Wind every face of the starting tetrahedron so its normal points away from the opposite vertex
+		static const u32 TetrahedronFaces[4][4] = {{0, 1, 2, 3}, {0, 3, 1, 2}, {0, 2, 3, 1}, {1, 3, 2, 0}};
+		for(const u32* face : TetrahedronFaces)
+		{
+			const Maths::Vector3 toOpposite = vertices[face[3]].w - vertices[face[0]].w;
+			const Maths::Vector3 normal = (vertices[face[1]].w - vertices[face[0]].w).CrossProduct(vertices[face[2]].w - vertices[face[0]].w);
+
+			if(normal.DotProduct(toOpposite) > 0.0f)
+				BuildFace(vertices, face[0], face[2], face[1], &faces[faceCount++]);
+			else
+				BuildFace(vertices, face[0], face[1], face[2], &faces[faceCount++]);
+		}
+
+		for(u32 iteration = 0; iteration < MaxEPAIterations; ++iteration)
+		{
+			const PolytopeFace& closest = faces[FindClosestFace(faces, faceCount)];
+			if(closest.distance == FLT_MAX)
+				break;
+
+			const SimplexVertex vertex = MakeVertex(a, b, closest.normal, true);
+
+			// The closest face already lies on the boundary of a - b
+			if(vertex.w.DotProduct(closest.normal) - closest.distance < EPATolerance)
+				break;
+
+			if(vertexCount == MaxPolytopeVertices)
+				break;
+
+			const u32 newIndex = vertexCount++;
+			vertices[newIndex] = vertex;
+
+			// Remove every face the new vertex can see and keep the boundary of the hole
+			u32 edgeCount = 0;
+			for(u32 i = 0; i < faceCount;)
+			{
+				const PolytopeFace& face = faces[i];
+				if(face.normal.DotProduct(vertex.w - vertices[face.indices[0]].w) > 0.0f)
+				{
+					AddHorizonEdge(edges, &edgeCount, face.indices[0], face.indices[1]);
+					AddHorizonEdge(edges, &edgeCount, face.indices[1], face.indices[2]);
+					AddHorizonEdge(edges, &edgeCount, face.indices[2], face.indices[0]);
+					faces[i] = faces[--faceCount];
+				}
+				else
+					++i;
+			}
+
+			if(faceCount + edgeCount > MaxPolytopeFaces)
+				break;
+
+			for(u32 i = 0; i < edgeCount; ++i)
+				BuildFace(vertices, edges[i].start, edges[i].end, newIndex, &faces[faceCount++]);
+		}
+
+		if(faceCount == 0)
+			return false;
+
+		const PolytopeFace& face = faces[FindClosestFace(faces, faceCount)];
+		if(face.distance == FLT_MAX)
+			return false;
+
+		// Barycentric coordinates of the origin projected onto the closest face give the witness points
+		const SimplexVertex& v0 = vertices[face.indices[0]];
+		const SimplexVertex& v1 = vertices[face.indices[1]];
+		const SimplexVertex& v2 = vertices[face.indices[2]];
+
+		const Maths::Vector3 edge0 = v1.w - v0.w;
+		const Maths::Vector3 edge1 = v2.w - v0.w;
+		const Maths::Vector3 toPoint = face.normal * face.distance - v0.w;
+
+		const float d00 = edge0.DotProduct(edge0);
+		const float d01 = edge0.DotProduct(edge1);
+		const float d11 = edge1.DotProduct(edge1);
+		const float d20 = toPoint.DotProduct(edge0);
+		const float d21 = toPoint.DotProduct(edge1);
+		const float denominator = d00 * d11 - d01 * d01;
+
+		float u = 1.0f, v = 0.0f, w = 0.0f;
+		if(fabs(denominator) > 0.0f)
+		{
+			v = (d11 * d20 - d01 * d21) / denominator;
+			w = (d00 * d21 - d01 * d20) / denominator;
+			u = 1.0f - v - w;
+		}
+
+		*out_normal = face.normal;
+		*out_depth = Maths::Max(face.distance, 0.0f);
+		*out_pointA = v0.a * u + v1.a * v + v2.a * w;
+		*out_pointB = v0.b * u + v1.b * v + v2.b * w;
+
+		return true;
+	}
+
+	bool GJK::RayCast(const ConvexProxy& shape, const Maths::Vector3& origin, const Maths::Vector3& direction, float maxDistance, float* out_distance, Maths::Vector3* out_normal)
+	{
+		float distance = 0.0f;
+		Maths::Vector3 normal = -direction;
+
+		for(u32 iteration = 0; iteration < MaxIterations; ++iteration)
+		{
+			// Cores further apart than the rest of the ray plus the margin can't be reached
+			DistanceResult result;
+			if(!Distance(shape, ConvexProxy(origin + direction * distance), (maxDistance - distance) + shape.margin, &result))
+				return false;
+
+			// Thin gaps leave the closest points too close together for a stable normal, keep the last one
+			if(!result.overlap && result.distance > RayTolerance)
+				normal = (result.pointB - result.pointA) / result.distance;
+
+			const float gap = result.overlap ? 0.0f : result.distance - shape.margin;
+			const float approach = -direction.DotProduct(normal);
+
+			// Stepping by the gap over how fast the ray closes it can't overshoot the surface, so the last small step is still taken
+			if(gap <= RayTolerance)
+			{
+				if(gap > 0.0f && approach > 0.0f)
+					distance = Maths::Min(distance + gap / approach, maxDistance);
+				break;
+			}
+
+			if(approach <= 0.0f)
+				return false;
+
+			distance += gap / approach;
+			if(distance > maxDistance)
+				return false;
+		}
+
+		*out_distance = distance;
+		*out_normal = normal;
+		return true;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Maths/Maths.h"
+
+namespace Lumos
+{
+	class CollisionShape;
+
+	// A collision shape placed in world space for GJK/EPA queries. Supports come from the shape's core,
+	// a sphere's core is its centre and a capsule's its segment, with the margin (their radius) swept around it.
+	struct LUMOS_EXPORT ConvexProxy
+	{
+		ConvexProxy(const CollisionShape* shape, const Maths::Matrix4& transform);
+
+		// Sphere without a collision shape, a point if radius is 0
+		explicit ConvexProxy(const Maths::Vector3& centre, float radius = 0.0f);
+
+		// Furthest point of the core along direction
+		Maths::Vector3 Support(const Maths::Vector3& direction) const;
+
+		// Furthest point of the core plus margin along direction
+		Maths::Vector3 SupportWithMargin(const Maths::Vector3& direction) const;
+
+		const CollisionShape* shape; // nullptr for a point or sphere
+		Maths::Matrix3 rotation;
+		Maths::Matrix3 inverseRotation;
+		Maths::Vector3 position;
+		float margin;
+	};
+
+	class LUMOS_EXPORT GJK
+	{
+	public:
+		struct DistanceResult
+		{
+			Maths::Vector3 pointA; // Closest point on the core of a
+			Maths::Vector3 pointB; // Closest point on the core of b
+			float distance = 0.0f;
+			u32 iterations = 0;
+			bool overlap = false; // Cores intersect, pointA/pointB and distance are meaningless
+		};
+
+		// Closest points between the cores of two convex shapes. Returns false as soon as the cores
+		// are known to be further than maxDistance apart.
+		static bool Distance(const ConvexProxy& a, const ConvexProxy& b, float maxDistance, DistanceResult* out_result);
+
+		// Expanding polytope penetration of two intersecting shapes, margins included. The normal points
+		// from a to b and depth is positive. Returns false if the shapes don't intersect.
+		static bool Penetration(const ConvexProxy& a, const ConvexProxy& b, Maths::Vector3* out_normal, float* out_depth, Maths::Vector3* out_pointA, Maths::Vector3* out_pointB);
+
+		// Conservative advancement of a ray against a shape, margin included. direction must be normalised. A ray
+		// starting inside the shape hits at distance 0.
+		static bool RayCast(const ConvexProxy& shape, const Maths::Vector3& origin, const Maths::Vector3& direction, float maxDistance, float* out_distance, Maths::Vector3* out_normal);
+
+		static const u32 MaxIterations = 32;
+		static const u32 MaxEPAIterations = 64;
+	};
+}
@@ -160,6 +160,57 @@ namespace Lumos
 		if (out_max_vert) *out_max_vert = maxVertex;
 	}
 
+	static void AddUniqueDirection(Maths::Vector3 direction, Maths::Vector3* directions, u32* count)
+	{
+		const float epsilon = 0.0001f;
+
+		if (direction.LengthSquared() < epsilon)
+			return;
+
+		direction.Normalize();
+
+		for (u32 i = 0; i < *count; ++i)
+		{
+			if (abs(Maths::Vector3::Dot(direction, directions[i])) >= (1.0f - epsilon))
+				return;
+		}
+
+		LUMOS_ASSERT(*count < CollisionHull::MaxAxes, "Too many unique hull directions");
+		directions[(*count)++] = direction;
+	}
+
+	void Hull::BuildCollisionHull(const Maths::Vector3& scale, CollisionHull* out_hull) const
+	{
+		LUMOS_ASSERT(m_Vertices.size() <= CollisionHull::MaxVertices, "Hull has too many vertices");
+		LUMOS_ASSERT(m_Edges.size() <= CollisionHull::MaxEdges, "Hull has too many edges");
+
+		out_hull->vertexCount = static_cast<u32>(m_Vertices.size());
+		for (u32 i = 0; i < out_hull->vertexCount; ++i)
+		{
+			const Maths::Vector3 pos = m_Vertices[i].pos * scale;
+			out_hull->vertexX[i] = pos.x;
+			out_hull->vertexY[i] = pos.y;
+			out_hull->vertexZ[i] = pos.z;
+		}
+
+		out_hull->edgeCount = static_cast<u32>(m_Edges.size());
+		out_hull->edgeDirectionCount = 0;
+		for (u32 i = 0; i < out_hull->edgeCount; ++i)
+		{
+			out_hull->edgeVertices[i][0] = static_cast<u8>(m_Edges[i].vStart);
+			out_hull->edgeVertices[i][1] = static_cast<u8>(m_Edges[i].vEnd);
+
+			AddUniqueDirection(out_hull->GetVertex(m_Edges[i].vEnd) - out_hull->GetVertex(m_Edges[i].vStart), out_hull->edgeDirections, &out_hull->edgeDirectionCount);
+		}
+
+		// Normals transform by the inverse transpose, which for a scale is the reciprocal scale
+		const Maths::Vector3 normalScale(1.0f / scale.x, 1.0f / scale.y, 1.0f / scale.z);
+
+		out_hull->faceNormalCount = 0;
+		for (const HullFace& face : m_Faces)
+			AddUniqueDirection(face.normal * normalScale, out_hull->faceNormals, &out_hull->faceNormalCount);
+	}
+
 	void Hull::DebugDraw(const Maths::Matrix4& transform)
 	{
         //Draw all Hull Polygons
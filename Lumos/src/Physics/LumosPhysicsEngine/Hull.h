@@ -34,6 +34,34 @@ namespace Lumos
 		std::vector<int> adjoining_face_ids;
 	};
 
+	// Flattened copy of a scaled hull used by the separating axis tests. Everything is stored
+	// inline so a collision test can walk it without touching the heap or the hull's adjacency lists.
+	struct LUMOS_EXPORT CollisionHull
+	{
+		static const u32 MaxVertices = 8;
+		static const u32 MaxEdges = 12;
+		static const u32 MaxAxes = 8;
+
+		u32 vertexCount = 0;
+		float vertexX[MaxVertices];
+		float vertexY[MaxVertices];
+		float vertexZ[MaxVertices];
+
+		u32 edgeCount = 0;
+		u8 edgeVertices[MaxEdges][2];
+
+		// Unique face normals and edge directions, no two are parallel
+		u32 faceNormalCount = 0;
+		Maths::Vector3 faceNormals[MaxAxes];
+		u32 edgeDirectionCount = 0;
+		Maths::Vector3 edgeDirections[MaxAxes];
+
+		_FORCE_INLINE_ Maths::Vector3 GetVertex(u32 index) const
+		{
+			return Maths::Vector3(vertexX[index], vertexY[index], vertexZ[index]);
+		}
+	};
+
 	class LUMOS_EXPORT Hull
 	{
 	public:
@@ -57,6 +85,9 @@ namespace Lumos
 
 		void GetMinMaxVerticesInAxis(const Maths::Vector3& local_axis, int* out_min_vert, int* out_max_vert);
 
+		// Fills out_hull with the hull scaled by scale
+		void BuildCollisionHull(const Maths::Vector3& scale, CollisionHull* out_hull) const;
+
 		void DebugDraw(const Maths::Matrix4& transform);
 
 	protected:
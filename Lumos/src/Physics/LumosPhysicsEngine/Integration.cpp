@@ -1,5 +1,10 @@
 #include "Precompiled.h"
 #include "Integration.h"
+#include "RigidBody3DStore.h"
+
+#ifdef LUMOS_SSE
+#include <emmintrin.h>
+#endif
 
 namespace Lumos
 {
@@ -56,4 +61,233 @@ namespace Lumos
 		return output;
 	}
 
+
+	namespace
+	{
+		// Lanes wrap the float operations used by the integration kernel, so the same kernel
+		// source runs on one body (ScalarLane) or four (SSELane) with identical rounding.
+		struct ScalarLane
+		{
+			using Type = float;
+			static const u32 Width = 1;
+
+			static Type Load(const float* data) { return *data; }
+			static void Store(float* data, Type value) { *data = value; }
+			static Type Set(float value) { return value; }
+			static Type Sqrt(Type value) { return sqrtf(value); }
+
+			// Returns a where condition > 0, otherwise b
+			static Type SelectPositive(Type condition, Type a, Type b) { return condition > 0.0f ? a : b; }
+		};
+
+#ifdef LUMOS_SSE
+		struct Float4
+		{
+			__m128 v;
+		};
+
+		_FORCE_INLINE_ Float4 operator+(Float4 a, Float4 b) { return { _mm_add_ps(a.v, b.v) }; }
+		_FORCE_INLINE_ Float4 operator-(Float4 a, Float4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+		_FORCE_INLINE_ Float4 operator*(Float4 a, Float4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+		_FORCE_INLINE_ Float4 operator/(Float4 a, Float4 b) { return { _mm_div_ps(a.v, b.v) }; }
+		_FORCE_INLINE_ Float4 operator-(Float4 a) { return { _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)) }; }
+
+		struct SSELane
+		{
+			using Type = Float4;
+			static const u32 Width = 4;
+
+			static Type Load(const float* data) { return { _mm_loadu_ps(data) }; }
+			static void Store(float* data, Type value) { _mm_storeu_ps(data, value.v); }
+			static Type Set(float value) { return { _mm_set1_ps(value) }; }
+			static Type Sqrt(Type value) { return { _mm_sqrt_ps(value.v) }; }
+
+			static Type SelectPositive(Type condition, Type a, Type b)
+			{
+				const __m128 mask = _mm_cmpgt_ps(condition.v, _mm_setzero_ps());
+				return { _mm_or_ps(_mm_and_ps(mask, a.v), _mm_andnot_ps(mask, b.v)) };
+			}
+		};
+#endif
+
+		struct IntegrationParameters
+		{
+			Maths::Vector3 gravity;
+			float damping;
+			float dt;
+		};
+
+		template <typename Lane, IntegrationType Mode>
+		_FORCE_INLINE_ void IntegrateLanes(RigidBody3DStore& store, u32 i, const IntegrationParameters& parameters)
+		{
+			using F = typename Lane::Type;
+
+			const F dt = Lane::Set(parameters.dt);
+			const F damping = Lane::Set(parameters.damping);
+			const F half = Lane::Set(0.5f);
+
+			F px = Lane::Load(&store.positionX[i]), py = Lane::Load(&store.positionY[i]), pz = Lane::Load(&store.positionZ[i]);
+			F vx = Lane::Load(&store.linearVelocityX[i]), vy = Lane::Load(&store.linearVelocityY[i]), vz = Lane::Load(&store.linearVelocityZ[i]);
+			F qw = Lane::Load(&store.orientationW[i]), qx = Lane::Load(&store.orientationX[i]), qy = Lane::Load(&store.orientationY[i]), qz = Lane::Load(&store.orientationZ[i]);
+			F wx = Lane::Load(&store.angularVelocityX[i]), wy = Lane::Load(&store.angularVelocityY[i]), wz = Lane::Load(&store.angularVelocityZ[i]);
+			const F invMass = Lane::Load(&store.inverseMass[i]);
+
+			// Apply gravity
+			vx = Lane::SelectPositive(invMass, vx + Lane::Set(parameters.gravity.x * parameters.dt), vx);
+			vy = Lane::SelectPositive(invMass, vy + Lane::Set(parameters.gravity.y * parameters.dt), vy);
+			vz = Lane::SelectPositive(invMass, vz + Lane::Set(parameters.gravity.z * parameters.dt), vz);
+
+			auto integrateOrientation = [&]() {
+				// q += (w * dt * 0.5) * q
+				const F hx = wx * dt * half, hy = wy * dt * half, hz = wz * dt * half;
+				const F dw = -(qx * hx) - (qy * hy) - (qz * hz);
+				const F dx = (qw * hx) + (hy * qz) - (hz * qy);
+				const F dy = (qw * hy) + (hz * qx) - (hx * qz);
+				const F dz = (qw * hz) + (hx * qy) - (hy * qx);
+				qw = qw + dw;
+				qx = qx + dx;
+				qy = qy + dy;
+				qz = qz + dz;
+
+				const F lengthSquared = qw * qw + qx * qx + qy * qy + qz * qz;
+				const F invLength = Lane::Set(1.0f) / Lane::Sqrt(lengthSquared);
+				qw = Lane::SelectPositive(lengthSquared, qw * invLength, qw);
+				qx = Lane::SelectPositive(lengthSquared, qx * invLength, qx);
+				qy = Lane::SelectPositive(lengthSquared, qy * invLength, qy);
+				qz = Lane::SelectPositive(lengthSquared, qz * invLength, qz);
+			};
+
+			auto integrateAngularVelocity = [&]() {
+				// w += invInertia * torque * dt
+				const F tx = Lane::Load(&store.torqueX[i]), ty = Lane::Load(&store.torqueY[i]), tz = Lane::Load(&store.torqueZ[i]);
+				F inertia[9];
+				for(int k = 0; k < 9; k++)
+					inertia[k] = Lane::Load(&store.inverseInertia[k][i]);
+
+				wx = wx + (inertia[0] * tx + inertia[1] * ty + inertia[2] * tz) * dt;
+				wy = wy + (inertia[3] * tx + inertia[4] * ty + inertia[5] * tz) * dt;
+				wz = wz + (inertia[6] * tx + inertia[7] * ty + inertia[8] * tz) * dt;
+
+				// Angular velocity damping
+				wx = wx * damping;
+				wy = wy * damping;
+				wz = wz * damping;
+			};
+
+			const F ax = Lane::Load(&store.forceX[i]) * invMass;
+			const F ay = Lane::Load(&store.forceY[i]) * invMass;
+			const F az = Lane::Load(&store.forceZ[i]) * invMass;
+
+			if(Mode == IntegrationType::EXPLICIT_EULER)
+			{
+				// Update position
+				px = px + vx * dt;
+				py = py + vy * dt;
+				pz = pz + vz * dt;
+
+				// Update linear velocity (v = u + at) and damp it
+				vx = (vx + ax * dt) * damping;
+				vy = (vy + ay * dt) * damping;
+				vz = (vz + az * dt) * damping;
+
+				integrateOrientation();
+				integrateAngularVelocity();
+			}
+			else if(Mode == IntegrationType::SEMI_IMPLICIT_EULER)
+			{
+				// Update linear velocity from the force accumulator (v += F / m * dt) and damp it
+				vx = (vx + ax * dt) * damping;
+				vy = (vy + ay * dt) * damping;
+				vz = (vz + az * dt) * damping;
+
+				// Update position
+				px = px + vx * dt;
+				py = py + vy * dt;
+				pz = pz + vz * dt;
+
+				integrateAngularVelocity();
+				integrateOrientation();
+			}
+			else
+			{
+				// RK2/RK4 with constant acceleration, matching Integration::RK2/RK4. Every
+				// derivative they evaluate equals the initial velocity and acceleration.
+				if(Mode == IntegrationType::RUNGE_KUTTA_2)
+				{
+					px = px + (vx + vx) * half * dt;
+					py = py + (vy + vy) * half * dt;
+					pz = pz + (vz + vz) * half * dt;
+					vx = vx + (ax + ax) * half * dt;
+					vy = vy + (ay + ay) * half * dt;
+					vz = vz + (az + az) * half * dt;
+				}
+				else
+				{
+					const F two = Lane::Set(2.0f);
+					const F six = Lane::Set(6.0f);
+					px = px + (vx + (vx + vx) * two + vx) / six * dt;
+					py = py + (vy + (vy + vy) * two + vy) / six * dt;
+					pz = pz + (vz + (vz + vz) * two + vz) / six * dt;
+					vx = vx + (ax + (ax + ax) * two + ax) / six * dt;
+					vy = vy + (ay + (ay + ay) * two + ay) / six * dt;
+					vz = vz + (az + (az + az) * two + az) / six * dt;
+				}
+
+				// Linear velocity damping
+				vx = vx * damping;
+				vy = vy * damping;
+				vz = vz * damping;
+
+				integrateAngularVelocity();
+				integrateOrientation();
+			}
+
+			Lane::Store(&store.positionX[i], px);
+			Lane::Store(&store.positionY[i], py);
+			Lane::Store(&store.positionZ[i], pz);
+			Lane::Store(&store.linearVelocityX[i], vx);
+			Lane::Store(&store.linearVelocityY[i], vy);
+			Lane::Store(&store.linearVelocityZ[i], vz);
+			Lane::Store(&store.orientationW[i], qw);
+			Lane::Store(&store.orientationX[i], qx);
+			Lane::Store(&store.orientationY[i], qy);
+			Lane::Store(&store.orientationZ[i], qz);
+			Lane::Store(&store.angularVelocityX[i], wx);
+			Lane::Store(&store.angularVelocityY[i], wy);
+			Lane::Store(&store.angularVelocityZ[i], wz);
+		}
+
+		template <IntegrationType Mode>
+		void IntegrateRange(RigidBody3DStore& store, u32 begin, u32 end, const IntegrationParameters& parameters)
+		{
+			u32 i = begin;
+#ifdef LUMOS_SSE
+			for(; i + SSELane::Width <= end; i += SSELane::Width)
+				IntegrateLanes<SSELane, Mode>(store, i, parameters);
+#endif
+			for(; i < end; ++i)
+				IntegrateLanes<ScalarLane, Mode>(store, i, parameters);
+		}
+	}
+
+	void Integration::IntegrateBodies(RigidBody3DStore& store, u32 begin, u32 end, IntegrationType type, const Maths::Vector3& gravity, float damping, float dt)
+	{
+		const IntegrationParameters parameters = { gravity, damping, dt };
+
+		switch(type)
+		{
+			case IntegrationType::EXPLICIT_EULER:
+				IntegrateRange<IntegrationType::EXPLICIT_EULER>(store, begin, end, parameters);
+				break;
+			case IntegrationType::SEMI_IMPLICIT_EULER:
+				IntegrateRange<IntegrationType::SEMI_IMPLICIT_EULER>(store, begin, end, parameters);
+				break;
+			case IntegrationType::RUNGE_KUTTA_2:
+				IntegrateRange<IntegrationType::RUNGE_KUTTA_2>(store, begin, end, parameters);
+				break;
+			case IntegrationType::RUNGE_KUTTA_4:
+				IntegrateRange<IntegrationType::RUNGE_KUTTA_4>(store, begin, end, parameters);
+				break;
+		}
+	}
 }
\ No newline at end of file
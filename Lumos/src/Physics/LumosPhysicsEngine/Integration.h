@@ -5,6 +5,15 @@
 
 namespace Lumos
 {
+	struct RigidBody3DStore;
+
+	enum class LUMOS_EXPORT IntegrationType
+	{
+		EXPLICIT_EULER = 0,
+		SEMI_IMPLICIT_EULER,
+		RUNGE_KUTTA_2,
+		RUNGE_KUTTA_4
+	};
 
 	class LUMOS_EXPORT Integration
 	{
@@ -28,5 +37,10 @@ namespace Lumos
 		static void RK4(State &state, float t, float dt);
 
 		static Derivative Evaluate(State& initial, float dt, float t, const Derivative& derivative);
+
+		// Integrates bodies [begin, end) of the store. The mode is resolved once for the whole range.
+		// With LUMOS_SSE four bodies are integrated at a time, the scalar path performs the exact
+		// same float operations so both give bit identical results.
+		static void IntegrateBodies(RigidBody3DStore& store, u32 begin, u32 end, IntegrationType type, const Maths::Vector3& gravity, float damping, float dt);
 	};
 }
@@ -1,12 +1,14 @@
 #include "Precompiled.h"
 #include "LumosPhysicsEngine.h"
 #include "CollisionDetection.h"
+#include "GJK.h"
 #include "RigidBody3D.h"
 #include "Core/OS/Window.h"
 
 #include "Integration.h"
 #include "Constraint.h"
 #include "Utilities/TimeStep.h"
+#include "Utilities/Timer.h"
 #include "Core/JobSystem.h"
  
 #include "Core/Application.h"
@@ -19,7 +21,10 @@
 namespace Lumos
 {
 	
-	float LumosPhysicsEngine::s_UpdateTimestep = 1.0f / 60.0f;
+	static std::pair<RigidBody3D*, RigidBody3D*> GetPairKey(RigidBody3D* a, RigidBody3D* b)
+	{
+		return a < b ? std::make_pair(a, b) : std::make_pair(b, a);
+	}
 	
 	LumosPhysicsEngine::LumosPhysicsEngine()
 		: m_IsPaused(true)
@@ -31,26 +36,41 @@ namespace Lumos
 	{
 		m_DebugName = "Lumos3DPhysicsEngine";
 		m_RigidBodys.reserve(100);
+
+		Writes<Physics3DComponent>();
+		Writes<Maths::Transform>();
+		Reads<SpringConstraintComponent>();
+		Reads<DistanceConstraintComponent>();
+		Reads<WeldConstraintComponent>();
 	}
 	
 	void LumosPhysicsEngine::SetDefaults()
 	{
+		WaitForPhysicsThread();
 		m_IsPaused = true;
-		s_UpdateTimestep = 1.0f / 60.f;
+		m_UpdateTimestep = 1.0f / 60.f;
+		m_FixedTimestep = 1.0f / 60.0f;
 		m_UpdateAccum = 0.0f;
 		m_Gravity = Maths::Vector3(0.0f, -9.81f, 0.0f);
 		m_DampingFactor = 0.999f;
 		m_IntegrationType = IntegrationType::RUNGE_KUTTA_4;
+		m_SolverIterations = 10;
+		m_WarmStarting = true;
+		m_ContactCache.clear();
 	}
 	
 	LumosPhysicsEngine::~LumosPhysicsEngine()
 	{
+		StopPhysicsThread();
+		
+		m_QueuedCollisionEvents.clear();
+		m_RejectedPairs.clear();
 		m_RigidBodys.clear();
 		m_Constraints.clear();
 		
-		for(Manifold* m : m_Manifolds)
-			delete m;
 		m_Manifolds.clear();
+		m_ManifoldPools.clear();
+		m_ContactCache.clear();
 		
 		CollisionDetection::Release();
 	}
@@ -58,40 +78,119 @@ namespace Lumos
 	void LumosPhysicsEngine::OnUpdate(const TimeStep& timeStep, Scene* scene)
 	{
 		LUMOS_PROFILE_FUNCTION();
-		m_RigidBodys.clear();
 		
-		if(!m_IsPaused)
+		// While paused the last step's bodies are kept, scene queries and the broadphase still reference them
+		if(m_IsPaused)
+			return;
+		
+		auto& registry = scene->GetRegistry();
+		
+		switch(m_StepMode)
 		{
-			auto& registry = scene->GetRegistry();
-			auto group = registry.group<Physics3DComponent>(entt::get<Maths::Transform>);
+		case PhysicsStepMode::Variable:
+		{
+			GatherBodies(registry);
 			
 			{
-				LUMOS_PROFILE_SCOPE("Physics::Get Rigid Bodies");
+				LUMOS_PROFILE_SCOPE("Physics::UpdatePhysics");
+				m_UpdateTimestep = timeStep.GetMillis();
+				UpdatePhysics();
+			}
 			
-			for(auto entity : group)
 			{
-				const auto& phys = group.get<Physics3DComponent>(entity);
-				
-				auto& physicsObj = phys.GetRigidBody();
-				m_RigidBodys.push_back(physicsObj);
-				};
+				LUMOS_PROFILE_SCOPE("Physics::Set Transforms");
+				auto group = registry.group<Physics3DComponent>(entt::get<Maths::Transform>);
+				for(auto entity : group)
+				{
+					const auto& [phys, trans] = group.get<Physics3DComponent, Maths::Transform>(entity);
+					
+					trans.SetLocalPosition(phys.m_RigidBody->GetPosition());
+					trans.SetLocalOrientation(phys.m_RigidBody->GetOrientation());
+				}
 			}
+			m_Constraints.clear();
+			break;
+		}
+		case PhysicsStepMode::Fixed:
+		{
+			GatherBodies(registry);
+			
+			m_UpdateAccum += timeStep.GetMillis();
+			const u32 steps = TakeFixedSteps();
 			
 			{
-				LUMOS_PROFILE_SCOPE("Physics::Get Spring Constraints");
+				LUMOS_PROFILE_SCOPE("Physics::UpdatePhysics");
+				for(u32 i = 0; i < steps; ++i)
+				{
+					UpdatePhysics();
+					PublishState();
+				}
+			}
+			
+			WriteInterpolatedTransforms(registry);
 			m_Constraints.clear();
+			break;
+		}
+		case PhysicsStepMode::FixedThreaded:
+		{
+			m_UpdateAccum += timeStep.GetMillis();
+			
+			// A frame that finds the physics thread busy only accumulates time, its steps are taken once it's done
+			if(!m_ThreadStepping.load())
+			{
+				// The bodies of the last batch are still gathered, so the queued pairs are alive
+				FireQueuedCollisionEvents();
+				GatherBodies(registry);
+				
+				const u32 steps = TakeFixedSteps();
+				if(steps > 0)
+				{
+					std::lock_guard<std::mutex> lock(m_ThreadMutex);
+					m_PendingSteps = steps;
+					m_ThreadStepping.store(true);
+					m_ThreadCondition.notify_all();
+				}
+			}
 			
+			WriteInterpolatedTransforms(registry);
+			break;
+		}
+		}
+	}
+	
+	void LumosPhysicsEngine::GatherBodies(entt::registry& registry)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		m_RigidBodys.clear();
+		m_BodyEntities.clear();
+		m_Constraints.clear();
+		
+		{
+			LUMOS_PROFILE_SCOPE("Physics::Get Rigid Bodies");
+			auto group = registry.group<Physics3DComponent>(entt::get<Maths::Transform>);
+			
+			for(auto entity : group)
+			{
+				const auto& phys = group.get<Physics3DComponent>(entity);
+				
+				m_RigidBodys.push_back(phys.m_RigidBody);
+				m_BodyEntities.push_back(entity);
+			}
+		}
+		
+		{
+			LUMOS_PROFILE_SCOPE("Physics::Get Spring Constraints");
 			auto viewSpring = registry.view<SpringConstraintComponent>();
 			
 			for(auto entity : viewSpring)
 			{
 				const auto& constraint = viewSpring.get<SpringConstraintComponent>(entity).GetConstraint();
 				m_Constraints.push_back(constraint.get());
-				}
 			}
-			
-			{
-				LUMOS_PROFILE_SCOPE("Physics::Get Distance Constraints");
+		}
+		
+		{
+			LUMOS_PROFILE_SCOPE("Physics::Get Distance Constraints");
 			auto viewDis = registry.view<DistanceConstraintComponent>();
 			
 			for(auto entity : viewDis)
@@ -99,200 +198,446 @@ namespace Lumos
 				const auto& constraint = viewDis.get<DistanceConstraintComponent>(entity).GetConstraint();
 				m_Constraints.push_back(constraint.get());
 			}
-			}
-			
-			{
-				LUMOS_PROFILE_SCOPE("Physics::Get Weld Constraints");
+		}
+		
+		{
+			LUMOS_PROFILE_SCOPE("Physics::Get Weld Constraints");
 			auto viewWeld = registry.view<WeldConstraintComponent>();
 			
 			for(auto entity : viewWeld)
 			{
 				const auto& constraint = viewWeld.get<WeldConstraintComponent>(entity).GetConstraint();
 				m_Constraints.push_back(constraint.get());
-				}
 			}
+		}
+	}
+	
+	u32 LumosPhysicsEngine::TakeFixedSteps()
+	{
+		const u32 maxUpdatesPerFrame = 5;
+		
+		u32 steps = 0;
+		while(m_UpdateAccum >= m_UpdateTimestep && steps < maxUpdatesPerFrame)
+		{
+			m_UpdateAccum -= m_UpdateTimestep;
+			++steps;
+		}
+		
+		if(m_UpdateAccum >= m_UpdateTimestep)
+		{
+			LUMOS_LOG_WARN("Physics too slow to run in real time!");
+			//Drop Time in the hope that it can continue to run in real-time
+			m_UpdateAccum = 0.0f;
+		}
+		
+		m_RequestedTime += static_cast<double>(steps) * m_UpdateTimestep;
+		return steps;
+	}
+	
+	void LumosPhysicsEngine::PublishState()
+	{
+		LUMOS_PROFILE_FUNCTION();
+		m_SimulatedTime += m_UpdateTimestep;
+		
+		const size_t count = m_RigidBodys.size();
+		m_WriteState.entities.assign(m_BodyEntities.begin(), m_BodyEntities.end());
+		m_WriteState.bodies.resize(count);
+		m_WriteState.positions.resize(count);
+		m_WriteState.orientations.resize(count);
+		m_WriteState.time = m_SimulatedTime;
+		
+		for(size_t i = 0; i < count; ++i)
+		{
+			RigidBody3D* body = m_RigidBodys[i].get();
+			m_WriteState.bodies[i] = body;
+			m_WriteState.positions[i] = body->GetPosition();
+			m_WriteState.orientations[i] = body->GetOrientation();
+		}
+		
+		std::lock_guard<std::mutex> lock(m_StateMutex);
+		std::swap(m_PreviousState, m_CurrentState);
+		std::swap(m_CurrentState, m_WriteState);
+	}
+	
+	void LumosPhysicsEngine::WriteInterpolatedTransforms(entt::registry& registry)
+	{
+		LUMOS_PROFILE_SCOPE("Physics::Set Transforms");
+		
+		// Rendering trails the simulation by a step so there are two states to blend between. Published
+		// states can lag behind while the physics thread is busy, they are then shown as they are.
+		const double renderTime = m_RequestedTime + m_UpdateAccum - m_UpdateTimestep;
+		
+		std::lock_guard<std::mutex> lock(m_StateMutex);
+		
+		const PhysicsStateBuffer& current = m_CurrentState;
+		const PhysicsStateBuffer& previous = m_PreviousState;
+		const double stateDuration = current.time - previous.time;
+		const float alpha = stateDuration > 0.0 ? static_cast<float>(Maths::Clamp((renderTime - previous.time) / stateDuration, 0.0, 1.0)) : 1.0f;
+		
+		for(size_t i = 0; i < current.entities.size(); ++i)
+		{
+			const entt::entity entity = current.entities[i];
+			if(!registry.valid(entity))
+				continue;
 			
+			auto trans = registry.try_get<Maths::Transform>(entity);
+			if(!trans)
+				continue;
+			
+			// Bodies added since the previous state snap to their current pose
+			if(i < previous.bodies.size() && previous.bodies[i] == current.bodies[i])
 			{
-				LUMOS_PROFILE_SCOPE("Physics::UpdatePhysics");
-			if(m_MultipleUpdates)
-			{
-				const int max_updates_per_frame = 5;
-				
-				m_UpdateAccum += timeStep.GetMillis();
-				for(int i = 0; (m_UpdateAccum >= s_UpdateTimestep) && i < max_updates_per_frame; ++i)
-				{
-					m_UpdateAccum -= s_UpdateTimestep;
-					UpdatePhysics(scene);
-				}
-				
-				if(m_UpdateAccum >= s_UpdateTimestep)
-				{
-					LUMOS_LOG_WARN("Physics too slow to run in real time!");
-					//Drop Time in the hope that it can continue to run in real-time
-					m_UpdateAccum = 0.0f;
-				}
+				trans->SetLocalPosition(previous.positions[i] + (current.positions[i] - previous.positions[i]) * alpha);
+				trans->SetLocalOrientation(previous.orientations[i].Nlerp(current.orientations[i], alpha, true));
 			}
 			else
 			{
-				s_UpdateTimestep = timeStep.GetMillis();
-				UpdatePhysics(scene);
-				}
+				trans->SetLocalPosition(current.positions[i]);
+				trans->SetLocalOrientation(current.orientations[i]);
 			}
+		}
+	}
+	
+	void LumosPhysicsEngine::SetStepMode(PhysicsStepMode mode)
+	{
+		if(mode == m_StepMode)
+			return;
+		
+		if(m_StepMode == PhysicsStepMode::FixedThreaded)
+		{
+			StopPhysicsThread();
+			FireQueuedCollisionEvents();
+			m_RejectedPairs.clear();
+		}
+		
+		m_StepMode = mode;
+		m_UpdateAccum = 0.0f;
+		m_RequestedTime = 0.0;
+		m_SimulatedTime = 0.0;
+		m_PreviousState = {};
+		m_CurrentState = {};
+		
+		// The variable mode overwrites the step length every frame
+		if(mode != PhysicsStepMode::Variable)
+			m_UpdateTimestep = m_FixedTimestep;
+		
+		if(mode == PhysicsStepMode::FixedThreaded)
+			StartPhysicsThread();
+	}
+	
+	void LumosPhysicsEngine::SetFixedTimestep(float timestep)
+	{
+		LUMOS_ASSERT(timestep > 0.0f, "Physics time step must be positive");
+		WaitForPhysicsThread();
+		m_FixedTimestep = timestep;
+		
+		if(m_StepMode != PhysicsStepMode::Variable)
+			m_UpdateTimestep = timestep;
+	}
+	
+	void LumosPhysicsEngine::WaitForPhysicsThread() const
+	{
+		if(!m_ThreadStepping.load() || std::this_thread::get_id() == m_PhysicsThread.get_id())
+			return;
+		
+		LUMOS_PROFILE_FUNCTION();
+		std::unique_lock<std::mutex> lock(m_ThreadMutex);
+		m_ThreadCondition.wait(lock, [this] { return !m_ThreadStepping.load(); });
+	}
+	
+	void LumosPhysicsEngine::StartPhysicsThread()
+	{
+		LUMOS_ASSERT(!m_PhysicsThread.joinable(), "Physics thread already running");
+		m_StopThread = false;
+		m_PendingSteps = 0;
+		m_PhysicsThread = std::thread([this] { PhysicsThreadLoop(); });
+	}
+	
+	void LumosPhysicsEngine::StopPhysicsThread()
+	{
+		if(!m_PhysicsThread.joinable())
+			return;
+		
+		{
+			std::lock_guard<std::mutex> lock(m_ThreadMutex);
+			m_StopThread = true;
+		}
+		m_ThreadCondition.notify_all();
+		m_PhysicsThread.join();
+	}
+	
+	void LumosPhysicsEngine::PhysicsThreadLoop()
+	{
+		std::unique_lock<std::mutex> lock(m_ThreadMutex);
+		while(true)
+		{
+			// Steps already handed over are finished before stopping, the main thread may be waiting on them
+			m_ThreadCondition.wait(lock, [this] { return m_PendingSteps > 0 || m_StopThread; });
+			if(m_PendingSteps == 0)
+				break;
 			
+			const u32 steps = m_PendingSteps;
+			lock.unlock();
+			
+			for(u32 i = 0; i < steps; ++i)
 			{
-				LUMOS_PROFILE_SCOPE("Physics::Set Transforms");
-			for(auto entity : group)
-			{
-				const auto& [phys, trans] = group.get<Physics3DComponent, Maths::Transform>(entity);
-				
-				trans.SetLocalPosition(phys.GetRigidBody()->GetPosition());
-				trans.SetLocalOrientation(phys.GetRigidBody()->GetOrientation());
-				};
+				LUMOS_PROFILE_SCOPE("Physics::UpdatePhysics");
+				UpdatePhysics();
+				PublishState();
 			}
+			
+			// Constraints are gathered again before the next steps, their components may be destroyed meanwhile
 			m_Constraints.clear();
-			}
+			
+			lock.lock();
+			m_PendingSteps = 0;
+			m_ThreadStepping.store(false);
+			m_ThreadCondition.notify_all();
+		}
 	}
 	
-	void LumosPhysicsEngine::UpdatePhysics(Scene* scene)
+	void LumosPhysicsEngine::FireQueuedCollisionEvents()
 	{
-		for(Manifold* m : m_Manifolds)
+		LUMOS_PROFILE_FUNCTION();
+		
+		// Rejections only last until the callbacks are asked again
+		m_RejectedPairs.clear();
+		
+		for(auto& event : m_QueuedCollisionEvents)
 		{
-			delete m;
+			RigidBody3D* objA = event.manifold.NodeA();
+			RigidBody3D* objB = event.manifold.NodeB();
+			
+			const bool okA = objA->FireOnCollisionEvent(objA, objB);
+			const bool okB = objB->FireOnCollisionEvent(objB, objA);
+			
+			if(!okA || !okB)
+				m_RejectedPairs.insert(GetPairKey(objA, objB));
+			else if(event.built)
+			{
+				objA->FireOnCollisionManifoldCallback(objA, objB, &event.manifold);
+				objB->FireOnCollisionManifoldCallback(objB, objA, &event.manifold);
+			}
 		}
+		
+		m_QueuedCollisionEvents.clear();
+	}
+	
+	void LumosPhysicsEngine::UpdatePhysics()
+	{
 		m_Manifolds.clear();
+		m_StepIndex++;
+		
+		const TimeStamp stepStart = Timer::Now();
 		
 		//Check for collisions
 		BroadPhaseCollisions();
+		const TimeStamp broadphaseEnd = Timer::Now();
 		NarrowPhaseCollisions();
+		const TimeStamp narrowphaseEnd = Timer::Now();
 		
 		//Solve collision constraints
+		BuildIslands();
 		SolveConstraints();
+		UpdateContactCache();
+		const TimeStamp solverEnd = Timer::Now();
 		
 		//Update movement
 		UpdateRigidBodys();
+		SolveContinuousCollisions();
+		UpdateIslandSleeping();
+		
+		// Scene queries can run on several threads and only read the cached world transforms
+		for(auto& body : m_RigidBodys)
+			body->GetWorldSpaceTransform();
+		const TimeStamp stepEnd = Timer::Now();
+		
+		m_StepStats.broadphaseMs = Timer::Duration(stepStart, broadphaseEnd, 1000.0f);
+		m_StepStats.narrowphaseMs = Timer::Duration(broadphaseEnd, narrowphaseEnd, 1000.0f);
+		m_StepStats.solverMs = Timer::Duration(narrowphaseEnd, solverEnd, 1000.0f);
+		m_StepStats.integrationMs = Timer::Duration(solverEnd, stepEnd, 1000.0f);
+		m_StepStats.totalMs = Timer::Duration(stepStart, stepEnd, 1000.0f);
+		m_StepStats.broadphasePairs = static_cast<u32>(m_BroadphaseCollisionPairs.size());
+		m_StepStats.manifolds = static_cast<u32>(m_Manifolds.size());
+		m_StepStats.contacts = 0;
+		for(Manifold* manifold : m_Manifolds)
+			m_StepStats.contacts += static_cast<u32>(manifold->GetContacts().size());
+		m_StepStats.islands = static_cast<u32>(m_Islands.size());
+		m_StepStats.awakeBodies = m_BodyStore.count;
+		m_StepStats.continuousBodies = static_cast<u32>(m_ContinuousMotions.size());
 	}
 	
 	void LumosPhysicsEngine::UpdateRigidBodys()
 	{
-		System::JobSystem::Dispatch(static_cast<u32>(m_RigidBodys.size()), 4, [&](JobDispatchArgs args) {
-										UpdateRigidBody(m_RigidBodys[args.jobIndex]);
-									});
+		LUMOS_PROFILE_FUNCTION();
+		
+		// Only awake dynamic bodies are integrated, gather them into contiguous arrays
+		m_BodyStore.Clear();
+		m_BodyStore.Reserve(static_cast<u32>(m_RigidBodys.size()));
+		m_ContinuousMotions.clear();
+		for(auto& body : m_RigidBodys)
+		{
+			if(body->GetIsStatic() || !body->IsAwake())
+				continue;
+			
+			m_BodyStore.Add(body.get());
+			
+			// Continuous collision sweeps from the pose the body starts the step in
+			if(body->GetContinuousCollision())
+			{
+				ContinuousMotion& motion = m_ContinuousMotions.emplace_back();
+				motion.body = body.get();
+				motion.startPosition = body->GetPosition();
+				motion.startOrientation = body->GetOrientation();
+			}
+		}
 		
-		System::JobSystem::Wait();
+		static const u32 BODIES_PER_JOB = 64;
+		const u32 bodyCount = m_BodyStore.count;
+		const u32 jobCount = (bodyCount + BODIES_PER_JOB - 1) / BODIES_PER_JOB;
+		
+		// The integration mode is resolved once per job range rather than per body
+		auto job = System::JobSystem::Dispatch(jobCount, 1, [&](JobDispatchArgs args) {
+			const u32 begin = args.jobIndex * BODIES_PER_JOB;
+			const u32 end = Maths::Min(begin + BODIES_PER_JOB, bodyCount);
+			Integration::IntegrateBodies(m_BodyStore, begin, end, m_IntegrationType, m_Gravity, m_DampingFactor, m_UpdateTimestep);
+			m_BodyStore.WriteBack(begin, end);
+		});
+		
+		System::JobSystem::Wait(job);
 	}
 	
-	void LumosPhysicsEngine::UpdateRigidBody(const Ref<RigidBody3D>& obj) const
+	// Bodies that moved less than this fraction of their thickness can't pass through anything the discrete narrow phase would miss
+	static const float CCD_MOTION_THRESHOLD = 0.5f;
+	// Bodies are left this fraction of the thinner body's thickness into the contact, so the next step's narrow phase picks it up
+	static const float CCD_PENETRATION_FRACTION = 0.25f;
+	static const float CCD_MAX_PENETRATION = 0.02f;
+	static const float CCD_TOLERANCE = 0.001f;
+	static const u32 CCD_MAX_ITERATIONS = 20;
+	static const u32 INVALID_MOTION = ~0u;
+	
+	// Half of the smallest extent of the body's local bounding box
+	static float GetThickness(const RigidBody3D* body)
 	{
-		LUMOS_PROFILE_FUNCTION();
-		if(!obj->GetIsStatic() && obj->IsAwake())
+		const Maths::Vector3 halfSize = body->GetLocalBoundingBox().HalfSize();
+		return Maths::Min(halfSize.x, Maths::Min(halfSize.y, halfSize.z));
+	}
+	
+	// Conservative advancement - steps along the body's motion by the distance to the other body divided by an upper
+	// bound of how fast the gap can close, so it can never step past the first contact. The other body stays at its
+	// end of step pose. Returns the fraction of the motion the body can travel, 1 if it doesn't hit anything.
+	static float ComputeTimeOfImpact(const ContinuousMotion& motion, const RigidBody3D* other, float penetration)
+	{
+		const RigidBody3D* body = motion.body;
+		const CollisionShape* shape = body->GetCollisionShape().get();
+		const CollisionShape* otherShape = other->GetCollisionShape().get();
+		
+		const Maths::Vector3 displacement = body->GetPosition() - motion.startPosition;
+		const Maths::Quaternion& endOrientation = body->GetOrientation();
+		
+		// Rotating by angle moves any point of the body by at most angle times its distance from the centre
+		const Maths::BoundingBox& bounds = body->GetLocalBoundingBox();
+		const Maths::Vector3 furthest(Maths::Max(fabsf(bounds.min_.x), fabsf(bounds.max_.x)), Maths::Max(fabsf(bounds.min_.y), fabsf(bounds.max_.y)), Maths::Max(fabsf(bounds.min_.z), fabsf(bounds.max_.z)));
+		const float angle = 2.0f * acosf(Maths::Min(1.0f, fabsf(motion.startOrientation.DotProduct(endOrientation))));
+		const float angularBound = angle * furthest.Length();
+		const float motionBound = displacement.Length() + angularBound;
+		
+		const ConvexProxy otherProxy(otherShape, other->GetWorldSpaceTransform());
+		const float margins = shape->GetSupportMargin() + otherShape->GetSupportMargin();
+		
+		Maths::Vector3 normal;
+		float t = 0.0f;
+		for(u32 iteration = 0; iteration < CCD_MAX_ITERATIONS; ++iteration)
 		{
-			const float damping = m_DampingFactor;
+			Maths::Matrix4 transform = motion.startOrientation.Nlerp(endOrientation, t, true).RotationMatrix4();
+			transform.SetTranslation(motion.startPosition + displacement * t);
 			
-			// Apply gravity
-			if(obj->m_InvMass > 0.0f)
-				obj->m_LinearVelocity += m_Gravity * s_UpdateTimestep;
+			// Further apart than the rest of the motion can cover
+			GJK::DistanceResult result;
+			if(!GJK::Distance(ConvexProxy(shape, transform), otherProxy, margins + motionBound * (1.0f - t), &result))
+				return 1.0f;
 			
-			switch(m_IntegrationType)
+			const float distance = result.overlap ? 0.0f : result.distance - margins;
+			if(distance <= CCD_TOLERANCE)
 			{
-				case IntegrationType::EXPLICIT_EULER: {
-					// Update position
-					obj->m_Position += obj->m_LinearVelocity * s_UpdateTimestep;
-					
-					// Update linear velocity (v = u + at)
-					obj->m_LinearVelocity += obj->m_Force * obj->m_InvMass * s_UpdateTimestep;
-					
-					// Linear velocity damping
-					obj->m_LinearVelocity = obj->m_LinearVelocity * damping;
-					
-					// Update orientation
-					obj->m_Orientation = obj->m_Orientation + ((obj->m_AngularVelocity * s_UpdateTimestep * 0.5f) * obj->m_Orientation);
-					obj->m_Orientation.Normalize();
-					
-					// Update angular velocity
-					obj->m_AngularVelocity += obj->m_InvInertia * obj->m_Torque * s_UpdateTimestep;
-					
-					// Angular velocity damping
-					obj->m_AngularVelocity = obj->m_AngularVelocity * damping;
-					
-					break;
-				}
-				
-				case IntegrationType::SEMI_IMPLICIT_EULER: {
-					// Update linear velocity (v = u + at)
-					obj->m_LinearVelocity += obj->m_LinearVelocity * obj->m_InvMass * s_UpdateTimestep;
-					
-					// Linear velocity damping
-					obj->m_LinearVelocity = obj->m_LinearVelocity * damping;
-					
-					// Update position
-					obj->m_Position += obj->m_LinearVelocity * s_UpdateTimestep;
-					
-					// Update angular velocity
-					obj->m_AngularVelocity += obj->m_InvInertia * obj->m_Torque * s_UpdateTimestep;
-					
-					// Angular velocity damping
-					obj->m_AngularVelocity = obj->m_AngularVelocity * damping;
-					
-					// Update orientation
-					obj->m_Orientation = obj->m_Orientation + ((obj->m_AngularVelocity * s_UpdateTimestep * 0.5f) * obj->m_Orientation);
-					obj->m_Orientation.Normalize();
-					
-					break;
-				}
+				// Already touching at the start of the step, that's the discrete narrow phase's job
+				if(iteration == 0)
+					return 1.0f;
 				
-				case IntegrationType::RUNGE_KUTTA_2: {
-					// RK2 integration for linear motion
-					Integration::State state = {obj->m_Position, obj->m_LinearVelocity, obj->m_Force * obj->m_InvMass};
-					Integration::RK2(state, 0.0f, s_UpdateTimestep);
-					
-					obj->m_Position = state.position;
-					obj->m_LinearVelocity = state.velocity;
-					
-					// Linear velocity damping
-					obj->m_LinearVelocity = obj->m_LinearVelocity * damping;
-					
-					// Update angular velocity
-					obj->m_AngularVelocity += obj->m_InvInertia * obj->m_Torque * s_UpdateTimestep;
-					
-					// Angular velocity damping
-					obj->m_AngularVelocity = obj->m_AngularVelocity * damping;
-					
-					// Update orientation
-					obj->m_Orientation = obj->m_Orientation + ((obj->m_AngularVelocity * s_UpdateTimestep * 0.5f) * obj->m_Orientation);
-					obj->m_Orientation.Normalize();
-					
-					break;
-				}
-				
-				case IntegrationType::RUNGE_KUTTA_4: {
-					// RK4 integration for linear motion
-					Integration::State state = {obj->m_Position, obj->m_LinearVelocity, obj->m_Force * obj->m_InvMass};
-					Integration::RK4(state, 0.0f, s_UpdateTimestep);
-					obj->m_Position = state.position;
-					obj->m_LinearVelocity = state.velocity;
-					
-					// Linear velocity damping
-					obj->m_LinearVelocity = obj->m_LinearVelocity * damping;
-					
-					// Update angular velocity
-					obj->m_AngularVelocity += obj->m_InvInertia * obj->m_Torque * s_UpdateTimestep;
-					
-					// Angular velocity damping
-					obj->m_AngularVelocity = obj->m_AngularVelocity * damping;
-					
-					// Update orientation
-					obj->m_Orientation = obj->m_Orientation + ((obj->m_AngularVelocity * s_UpdateTimestep * 0.5f) * obj->m_Orientation);
-					obj->m_Orientation.Normalize();
-					
-					break;
-				}
+				const float approach = displacement.DotProduct(normal);
+				return approach > Maths::M_EPSILON ? Maths::Min(1.0f, t + penetration / approach) : t;
 			}
 			
-			// Mark cached world transform and AABB as invalid
-			obj->m_wsTransformInvalidated = true;
-			obj->m_wsAabbInvalidated = true;
+			normal = (result.pointB - result.pointA) / result.distance;
+			const float closingBound = displacement.DotProduct(normal) + angularBound;
+			if(closingBound <= 0.0f)
+				return 1.0f;
 			
-			obj->RestTest();
+			t += distance / closingBound;
+			if(t >= 1.0f)
+				return 1.0f;
+		}
+		
+		// Still approaching after every iteration, t is a safe fraction to stop at
+		return t;
+	}
+	
+	void LumosPhysicsEngine::SolveContinuousCollisions()
+	{
+		LUMOS_PROFILE_FUNCTION();
+		m_StepStats.timeOfImpactHits = 0;
+		if(m_ContinuousMotions.empty())
+			return;
+		
+		// Only bodies that moved far enough this step are swept, the others keep INVALID_MOTION
+		const u32 bodyCount = static_cast<u32>(m_RigidBodys.size());
+		m_ContinuousIndices.assign(bodyCount, INVALID_MOTION);
+		for(u32 i = 0; i < static_cast<u32>(m_ContinuousMotions.size()); ++i)
+		{
+			const ContinuousMotion& motion = m_ContinuousMotions[i];
+			const u32 index = motion.body->m_SolverIndex;
+			if(index >= bodyCount || m_RigidBodys[index].get() != motion.body || !motion.body->GetCollisionShape() || motion.body->GetIsTrigger())
+				continue;
+			
+			const float threshold = CCD_MOTION_THRESHOLD * GetThickness(motion.body);
+			if((motion.body->GetPosition() - motion.startPosition).LengthSquared() > threshold * threshold)
+				m_ContinuousIndices[index] = i;
+		}
+		
+		auto getMotion = [&](RigidBody3D* body) -> ContinuousMotion* {
+			const u32 index = body->m_SolverIndex;
+			if(index >= bodyCount || m_RigidBodys[index].get() != body || m_ContinuousIndices[index] == INVALID_MOTION)
+				return nullptr;
+			
+			return &m_ContinuousMotions[m_ContinuousIndices[index]];
+		};
+		
+		// Every pose is read before any body is moved, so the result doesn't depend on pair order
+		for(const CollisionPair& pair : m_BroadphaseCollisionPairs)
+		{
+			RigidBody3D* bodies[2] = { pair.pObjectA, pair.pObjectB };
+			for(u32 i = 0; i < 2; ++i)
+			{
+				ContinuousMotion* motion = getMotion(bodies[i]);
+				RigidBody3D* other = bodies[1 - i];
+				if(!motion || !other->GetCollisionShape() || other->GetIsTrigger())
+					continue;
+				
+				const float penetration = Maths::Min(CCD_MAX_PENETRATION, CCD_PENETRATION_FRACTION * Maths::Min(GetThickness(motion->body), GetThickness(other)));
+				motion->timeOfImpact = Maths::Min(motion->timeOfImpact, ComputeTimeOfImpact(*motion, other, penetration));
+			}
+		}
+		
+		// Velocities are kept, the contact is solved like any other once the narrow phase reports it
+		for(ContinuousMotion& motion : m_ContinuousMotions)
+		{
+			if(motion.timeOfImpact >= 1.0f)
+				continue;
+			
+			RigidBody3D* body = motion.body;
+			body->SetPosition(motion.startPosition + (body->GetPosition() - motion.startPosition) * motion.timeOfImpact);
+			body->SetOrientation(motion.startOrientation.Nlerp(body->GetOrientation(), motion.timeOfImpact, true));
+			m_StepStats.timeOfImpactHits++;
 		}
 	}
 	
@@ -301,93 +646,524 @@ namespace Lumos
 		LUMOS_PROFILE_FUNCTION();
 		m_BroadphaseCollisionPairs.clear();
 		if(m_BroadphaseDetection)
+		{
+			m_BroadphaseDetection->SetTimestep(m_UpdateTimestep);
 			m_BroadphaseDetection->FindPotentialCollisionPairs(m_RigidBodys, m_BroadphaseCollisionPairs);
+		}
 	}
 	
 	void LumosPhysicsEngine::NarrowPhaseCollisions()
 	{
 		LUMOS_PROFILE_FUNCTION();
-		if(!m_BroadphaseCollisionPairs.empty())
-		{
+		if(m_BroadphaseCollisionPairs.empty())
+			return;
+
+		// World transforms are cached lazily, build them up front so the jobs below only read them
+		for(auto& body : m_RigidBodys)
+			body->GetWorldSpaceTransform();
+
+		const u32 pairCount = static_cast<u32>(m_BroadphaseCollisionPairs.size());
+		const u32 maxJobCount = (System::JobSystem::GetThreadCount() + 1) * 4;
+		const u32 pairsPerJob = (pairCount + maxJobCount - 1) / maxJobCount;
+
+		// Dispatch rounds up the pairs per group, so there can be fewer groups than maxJobCount
+		const u32 groupCount = (pairCount + pairsPerJob - 1) / pairsPerJob;
+
+		if(m_ManifoldPools.size() < groupCount)
+			m_ManifoldPools.resize(groupCount);
+
+		for(u32 poolIndex = 0; poolIndex < groupCount; ++poolIndex)
+			m_ManifoldPools[poolIndex].count = 0;
+
+		const CollisionDetection& collisionDetection = CollisionDetection::Get();
+
+		// Each job walks a contiguous range of pairs and only writes to its own pool
+		auto job = System::JobSystem::Dispatch(pairCount, pairsPerJob, [&](JobDispatchArgs args) {
+			ManifoldPool& pool = m_ManifoldPools[args.groupIndex];
+			CollisionPair& cp = m_BroadphaseCollisionPairs[args.jobIndex];
+			auto shapeA = cp.pObjectA->GetCollisionShape().get();
+			auto shapeB = cp.pObjectB->GetCollisionShape().get();
+
+			if(!shapeA || !shapeB)
+				return;
+
+			// Detects if the objects are colliding - Seperating Axis Theorem
 			CollisionData colData;
-			CollisionDetection colDetect;
-			
-			//System::JobSystem::Dispatch(static_cast<u32>(m_BroadphaseCollisionPairs.size()), 4, [&](JobDispatchArgs args)
-			for(auto& cp : m_BroadphaseCollisionPairs)
+			if(!collisionDetection.CheckCollision(cp.pObjectA, cp.pObjectB, shapeA, shapeB, &colData))
+				return;
+
+			if(pool.count == pool.manifolds.size())
 			{
-				//CollisionPair &cp = m_BroadphaseCollisionPairs[args.jobIndex];
-				auto shapeA = cp.pObjectA->GetCollisionShape();
-				auto shapeB = cp.pObjectB->GetCollisionShape();
-				
-				if(shapeA && shapeB)
+				pool.manifolds.emplace_back();
+				pool.built.push_back(0);
+			}
+
+			// Build full collision manifold that will also handle the collision
+			// response between the two objects in the solver stage
+			Manifold& manifold = pool.manifolds[pool.count];
+			manifold.Initiate(cp.pObjectA, cp.pObjectB);
+
+			// Construct contact points that form the perimeter of the collision manifold
+			pool.built[pool.count] = collisionDetection.BuildCollisionManifold(cp.pObjectA, cp.pObjectB, shapeA, shapeB, colData, &manifold);
+			pool.count++;
+		});
+
+		System::JobSystem::Wait(job);
+
+		// Pools hold contiguous pair ranges, so walking them in order matches the serial pair order.
+		// Callbacks run here as they may wake bodies or call into user code.
+		const bool queueCallbacks = m_StepMode == PhysicsStepMode::FixedThreaded;
+		for(u32 poolIndex = 0; poolIndex < groupCount; ++poolIndex)
+		{
+			ManifoldPool& pool = m_ManifoldPools[poolIndex];
+			for(u32 i = 0; i < pool.count; ++i)
+			{
+				Manifold* manifold = &pool.manifolds[i];
+				RigidBody3D* objA = manifold->NodeA();
+				RigidBody3D* objB = manifold->NodeB();
+
+				bool handleCollision;
+				if(queueCallbacks)
 				{
-					// Detects if the objects are colliding - Seperating Axis Theorem
-					if(CollisionDetection::Get().CheckCollision(cp.pObjectA, cp.pObjectB, shapeA.get(), shapeB.get(), &colData))
+					// On the physics thread the callbacks are queued for the main thread, pairs they rejected
+					// the last time they were fired stay dropped until then
+					if(objA->HasCollisionCallbacks() || objB->HasCollisionCallbacks())
+						m_QueuedCollisionEvents.push_back({ *manifold, pool.built[i] != 0 });
+
+					handleCollision = m_RejectedPairs.find(GetPairKey(objA, objB)) == m_RejectedPairs.end();
+					if(handleCollision)
 					{
-						// Check to see if any of the objects have collision callbacks that dont
-						// want the objects to physically collide
-						const bool okA = cp.pObjectA->FireOnCollisionEvent(cp.pObjectA, cp.pObjectB);
-						const bool okB = cp.pObjectB->FireOnCollisionEvent(cp.pObjectB, cp.pObjectA);
-						
-						if(okA && okB)
-						{
-							// Build full collision manifold that will also handle the collision
-							// response between the two objects in the solver stage
-							Manifold* manifold = new Manifold();
-							manifold->Initiate(cp.pObjectA, cp.pObjectB);
-							
-							// Construct contact points that form the perimeter of the collision manifold
-							if(CollisionDetection::Get().BuildCollisionManifold(cp.pObjectA, cp.pObjectB, shapeA.get(), shapeB.get(), colData, manifold))
-							{
-								// Fire callback
-								cp.pObjectA->FireOnCollisionManifoldCallback(cp.pObjectA, cp.pObjectB, manifold);
-								cp.pObjectB->FireOnCollisionManifoldCallback(cp.pObjectB, cp.pObjectA, manifold);
-								
-								// Add to list of manifolds that need solving
-								m_Manifolds.push_back(manifold);
-							}
-							else
-							{
-								delete manifold;
-							}
-						}
+						objA->WakeUp();
+						objB->WakeUp();
 					}
 				}
-			} //);
-			
-			//System::JobSystem::Wait();
+				else
+				{
+					// Check to see if any of the objects have collision callbacks that dont
+					// want the objects to physically collide
+					const bool okA = objA->FireOnCollisionEvent(objA, objB);
+					const bool okB = objB->FireOnCollisionEvent(objB, objA);
+					handleCollision = okA && okB;
+
+					// Fire callback
+					if(handleCollision && pool.built[i])
+					{
+						objA->FireOnCollisionManifoldCallback(objA, objB, manifold);
+						objB->FireOnCollisionManifoldCallback(objB, objA, manifold);
+					}
+				}
+
+				if(handleCollision && pool.built[i])
+				{
+					// Pick up the impulses this pair ended last step with
+					if(m_WarmStarting)
+					{
+						auto cached = m_ContactCache.find(GetPairKey(objA, objB));
+						if(cached != m_ContactCache.end() && cached->second.nodeA == objA)
+							manifold->RestoreImpulses(cached->second.contacts);
+					}
+
+					// Add to list of manifolds that need solving
+					m_Manifolds.push_back(manifold);
+				}
+			}
 		}
 	}
+
+	static const u32 INVALID_ISLAND = ~0u;
 	
-	void LumosPhysicsEngine::SolveConstraints()
+	static u32 FindIslandRoot(std::vector<u32>& parents, u32 index)
+	{
+		while(parents[index] != index)
+		{
+			parents[index] = parents[parents[index]];
+			index = parents[index];
+		}
+		
+		return index;
+	}
+	
+	void LumosPhysicsEngine::BuildIslands()
 	{
 		LUMOS_PROFILE_FUNCTION();
+		const u32 bodyCount = static_cast<u32>(m_RigidBodys.size());
+		
+		m_Islands.clear();
+		m_UnlinkedConstraints.clear();
+		m_IslandParents.resize(bodyCount);
+		m_IslandIDs.assign(bodyCount, INVALID_ISLAND);
+		
+		for(u32 i = 0; i < bodyCount; ++i)
+		{
+			m_IslandParents[i] = i;
+			m_RigidBodys[i]->m_SolverIndex = i;
+		}
+		
+		// Static bodies are never written to by the solver, so they don't connect islands
+		auto getBodyIndex = [&](RigidBody3D* body) -> u32 {
+			if(!body || body->GetIsStatic())
+				return INVALID_ISLAND;
+			
+			const u32 index = body->m_SolverIndex;
+			return (index < bodyCount && m_RigidBodys[index].get() == body) ? index : INVALID_ISLAND;
+		};
+		
+		// Returns one of the simulated dynamic bodies or INVALID_ISLAND. The smaller index
+		// becomes the root, keeping island order independent of pair order.
+		auto link = [&](RigidBody3D* a, RigidBody3D* b) -> u32 {
+			const u32 indexA = getBodyIndex(a);
+			const u32 indexB = getBodyIndex(b);
+			if(indexA == INVALID_ISLAND || indexB == INVALID_ISLAND)
+				return indexA == INVALID_ISLAND ? indexB : indexA;
+			
+			const u32 rootA = FindIslandRoot(m_IslandParents, indexA);
+			const u32 rootB = FindIslandRoot(m_IslandParents, indexB);
+			if(rootA != rootB)
+				m_IslandParents[Maths::Max(rootA, rootB)] = Maths::Min(rootA, rootB);
+			
+			return indexA;
+		};
+		
 		for(Manifold* m : m_Manifolds)
-			m->PreSolverStep(s_UpdateTimestep);
+			link(m->NodeA(), m->NodeB());
 		for(Constraint* c : m_Constraints)
-			c->PreSolverStep(s_UpdateTimestep);
+			link(c->GetBodyA(), c->GetBodyB());
+		
+		auto getIsland = [&](u32 bodyIndex) -> Island* {
+			if(bodyIndex == INVALID_ISLAND)
+				return nullptr;
+			
+			u32& islandID = m_IslandIDs[FindIslandRoot(m_IslandParents, bodyIndex)];
+			if(islandID == INVALID_ISLAND)
+			{
+				islandID = static_cast<u32>(m_Islands.size());
+				m_Islands.emplace_back();
+			}
+			
+			return &m_Islands[islandID];
+		};
 		
-		for(size_t i = 0; i < SOLVER_ITERATIONS; ++i)
+		// Count the size of each island, only bodies with contacts or constraints are part of one
+		u32 manifoldTotal = 0;
+		u32 constraintTotal = 0;
+		for(Manifold* m : m_Manifolds)
 		{
-			for(Manifold* m : m_Manifolds)
+			// A manifold between two static bodies can't change anything
+			if(Island* island = getIsland(link(m->NodeA(), m->NodeB())))
 			{
-				m->ApplyImpulse();
+				island->manifoldCount++;
+				manifoldTotal++;
 			}
+		}
+		// Constraints to dynamic bodies the engine isn't simulating could be shared between islands
+		auto isUnlinked = [&](Constraint* c) {
+			RigidBody3D* a = c->GetBodyA();
+			RigidBody3D* b = c->GetBodyB();
+			return (a && !a->GetIsStatic() && getBodyIndex(a) == INVALID_ISLAND) || (b && !b->GetIsStatic() && getBodyIndex(b) == INVALID_ISLAND);
+		};
+		
+		for(Constraint* c : m_Constraints)
+		{
+			Island* island = isUnlinked(c) ? nullptr : getIsland(link(c->GetBodyA(), c->GetBodyB()));
+			if(island)
+			{
+				island->constraintCount++;
+				constraintTotal++;
+			}
+			else
+				m_UnlinkedConstraints.push_back(c);
+		}
+		
+		u32 bodyTotal = 0;
+		for(u32 i = 0; i < bodyCount; ++i)
+		{
+			if(m_RigidBodys[i]->GetIsStatic())
+				continue;
 			
-			for(Constraint* c : m_Constraints)
+			const u32 islandID = m_IslandIDs[FindIslandRoot(m_IslandParents, i)];
+			if(islandID != INVALID_ISLAND)
+			{
+				m_Islands[islandID].bodyCount++;
+				bodyTotal++;
+			}
+		}
+		
+		// Convert counts to ranges, then scatter everything into place keeping the original order
+		u32 bodyStart = 0, manifoldStart = 0, constraintStart = 0;
+		for(Island& island : m_Islands)
+		{
+			island.bodyStart = bodyStart;
+			island.manifoldStart = manifoldStart;
+			island.constraintStart = constraintStart;
+			bodyStart += island.bodyCount;
+			manifoldStart += island.manifoldCount;
+			constraintStart += island.constraintCount;
+			island.bodyCount = island.manifoldCount = island.constraintCount = 0;
+		}
+		
+		m_IslandBodies.resize(bodyTotal);
+		m_IslandManifolds.resize(manifoldTotal);
+		m_IslandConstraints.resize(constraintTotal);
+		
+		for(u32 i = 0; i < bodyCount; ++i)
+		{
+			if(m_RigidBodys[i]->GetIsStatic())
+				continue;
+			
+			const u32 islandID = m_IslandIDs[FindIslandRoot(m_IslandParents, i)];
+			if(islandID != INVALID_ISLAND)
 			{
-				c->ApplyImpulse();
+				Island& island = m_Islands[islandID];
+				m_IslandBodies[island.bodyStart + island.bodyCount++] = m_RigidBodys[i].get();
 			}
 		}
+		for(Manifold* m : m_Manifolds)
+		{
+			if(Island* island = getIsland(link(m->NodeA(), m->NodeB())))
+				m_IslandManifolds[island->manifoldStart + island->manifoldCount++] = m;
+		}
+		for(Constraint* c : m_Constraints)
+		{
+			Island* island = isUnlinked(c) ? nullptr : getIsland(link(c->GetBodyA(), c->GetBodyB()));
+			if(island)
+				m_IslandConstraints[island->constraintStart + island->constraintCount++] = c;
+		}
+	}
+	
+	void LumosPhysicsEngine::SolveConstraints()
+	{
+		LUMOS_PROFILE_FUNCTION();
+		
+		// Islands don't share dynamic bodies, so each one can be solved on its own thread
+		const u32 islandCount = static_cast<u32>(m_Islands.size());
+		if(islandCount > 0)
+		{
+			const u32 groupSize = Maths::Max(1u, islandCount / ((System::JobSystem::GetThreadCount() + 1) * 4));
+			auto job = System::JobSystem::Dispatch(islandCount, groupSize, [&](JobDispatchArgs args) {
+				const Island& island = m_Islands[args.jobIndex];
+				SolveConstraintGroup(m_IslandManifolds.data() + island.manifoldStart, island.manifoldCount, m_IslandConstraints.data() + island.constraintStart, island.constraintCount);
+			});
+			
+			System::JobSystem::Wait(job);
+		}
+		
+		SolveConstraintGroup(nullptr, 0, m_UnlinkedConstraints.data(), static_cast<u32>(m_UnlinkedConstraints.size()));
+	}
+	
+	void LumosPhysicsEngine::SolveConstraintGroup(Manifold* const* manifolds, u32 manifoldCount, Constraint* const* constraints, u32 constraintCount) const
+	{
+		for(u32 i = 0; i < manifoldCount; ++i)
+			manifolds[i]->PreSolverStep(m_UpdateTimestep);
+		for(u32 i = 0; i < constraintCount; ++i)
+			constraints[i]->PreSolverStep(m_UpdateTimestep);
+		
+		// Elasticity terms above are computed from the unmodified velocities, so warm start afterwards
+		if(m_WarmStarting)
+		{
+			for(u32 i = 0; i < manifoldCount; ++i)
+				manifolds[i]->WarmStart();
+		}
+		
+		for(u32 iteration = 0; iteration < m_SolverIterations; ++iteration)
+		{
+			for(u32 i = 0; i < manifoldCount; ++i)
+				manifolds[i]->ApplyImpulse();
+			
+			for(u32 i = 0; i < constraintCount; ++i)
+				constraints[i]->ApplyImpulse();
+		}
+	}
+	
+	void LumosPhysicsEngine::UpdateIslandSleeping()
+	{
+		LUMOS_PROFILE_FUNCTION();
+		for(const Island& island : m_Islands)
+		{
+			bool islandAtRest = true;
+			for(u32 i = 0; i < island.bodyCount && islandAtRest; ++i)
+				islandAtRest = m_IslandBodies[island.bodyStart + i]->GetIsAtRest();
+			
+			// Bodies resting against something that still moves have to keep supporting it
+			if(!islandAtRest)
+			{
+				for(u32 i = 0; i < island.bodyCount; ++i)
+					m_IslandBodies[island.bodyStart + i]->WakeUp();
+			}
+		}
+	}
+	
+	void LumosPhysicsEngine::UpdateContactCache()
+	{
+		LUMOS_PROFILE_FUNCTION();
+		if(!m_WarmStarting)
+		{
+			m_ContactCache.clear();
+			return;
+		}
+		
+		for(Manifold* m : m_Manifolds)
+		{
+			// Existing entries keep their contact storage, so steady contacts don't allocate
+			ContactCacheEntry& entry = m_ContactCache[GetPairKey(m->NodeA(), m->NodeB())];
+			entry.nodeA = m->NodeA();
+			entry.lastStep = m_StepIndex;
+			entry.contacts = m->GetContacts();
+		}
+		
+		for(auto it = m_ContactCache.begin(); it != m_ContactCache.end();)
+		{
+			if(it->second.lastStep != m_StepIndex)
+				it = m_ContactCache.erase(it);
+			else
+				++it;
+		}
 	}
 	
 	void LumosPhysicsEngine::ClearConstraints()
 	{
 		//for(Constraint* c : m_Constraints)
 			//delete c;
+		WaitForPhysicsThread();
 		m_Constraints.clear();
 	}
 	
+	// Hit point and normal of the ray against the body's collision shape
+	static bool RaycastBody(RigidBody3D* body, const Maths::Ray& ray, float maxDistance, RaycastHit* out_hit)
+	{
+		const CollisionShape* shape = body->GetCollisionShape().get();
+		if(!shape)
+			return false;
+		
+		float distance;
+		Maths::Vector3 normal;
+		if(!GJK::RayCast(ConvexProxy(shape, body->GetWorldSpaceTransform()), ray.origin_, ray.direction_, maxDistance, &distance, &normal))
+			return false;
+		
+		out_hit->body = body;
+		out_hit->point = ray.origin_ + ray.direction_ * distance;
+		out_hit->normal = normal;
+		out_hit->distance = distance;
+		return true;
+	}
+	
+	static Maths::BoundingBox GetBodyBounds(const RigidBody3D* body)
+	{
+		// Built from the local box rather than GetWorldSpaceAABB, which writes its cache and is swept for continuous collision
+		return body->GetLocalBoundingBox().Transformed(body->GetWorldSpaceTransform());
+	}
+	
+	bool LumosPhysicsEngine::Raycast(const Maths::Ray& ray, float maxDistance, RaycastHit* out_hit) const
+	{
+		WaitForPhysicsThread();
+		return RaycastClosest(ray, maxDistance, out_hit);
+	}
+	
+	bool LumosPhysicsEngine::RaycastClosest(const Maths::Ray& ray, float maxDistance, RaycastHit* out_hit) const
+	{
+		RaycastHit hit;
+		hit.distance = maxDistance;
+		
+		// Every hit shortens the ray, so bodies behind it are skipped
+		auto testBody = [&](RigidBody3D* body, float distance) {
+			RaycastHit bodyHit;
+			if(RaycastBody(body, ray, distance, &bodyHit) && bodyHit.distance < hit.distance)
+				hit = bodyHit;
+			return hit.distance;
+		};
+		
+		if(!m_BroadphaseDetection || !m_BroadphaseDetection->QueryRay(ray, maxDistance, testBody))
+		{
+			for(const auto& body : m_RigidBodys)
+			{
+				if(body->GetCollisionShape() && ray.HitDistance(GetBodyBounds(body.get())) <= hit.distance)
+					testBody(body.get(), hit.distance);
+			}
+		}
+		
+		if(out_hit)
+			*out_hit = hit;
+		
+		return hit.body != nullptr;
+	}
+	
+	void LumosPhysicsEngine::RaycastBatch(const Maths::Ray* rays, u32 count, float maxDistance, RaycastHit* out_hits) const
+	{
+		LUMOS_PROFILE_FUNCTION();
+		if(count == 0)
+			return;
+		
+		WaitForPhysicsThread();
+		
+		// Bodies moved since the last step rebuild their transform lazily, do it here rather than racing in the jobs
+		for(const auto& body : m_RigidBodys)
+			body->GetWorldSpaceTransform();
+		
+		static const u32 RAYS_PER_JOB = 32;
+		auto job = System::JobSystem::Dispatch(count, RAYS_PER_JOB, [&](JobDispatchArgs args) {
+			RaycastClosest(rays[args.jobIndex], maxDistance, &out_hits[args.jobIndex]);
+		});
+		
+		System::JobSystem::Wait(job);
+	}
+	
+	void LumosPhysicsEngine::GatherQueryCandidates(const Maths::BoundingBox& aabb, std::vector<RigidBody3D*>& out_bodies) const
+	{
+		if(m_BroadphaseDetection && m_BroadphaseDetection->QueryAABB(aabb, out_bodies))
+			return;
+		
+		for(const auto& body : m_RigidBodys)
+		{
+			if(body->GetCollisionShape() && GetBodyBounds(body.get()).IsInsideFast(aabb) != Maths::OUTSIDE)
+				out_bodies.push_back(body.get());
+		}
+	}
+	
+	u32 LumosPhysicsEngine::SphereOverlap(const Maths::Vector3& centre, float radius, std::vector<RigidBody3D*>& out_bodies) const
+	{
+		WaitForPhysicsThread();
+		
+		const size_t start = out_bodies.size();
+		GatherQueryCandidates(Maths::BoundingBox(centre - Maths::Vector3(radius), centre + Maths::Vector3(radius)), out_bodies);
+		
+		// Candidates are filtered in place, keeping the ones the sphere actually reaches
+		const ConvexProxy sphere(centre, radius);
+		size_t count = start;
+		for(size_t i = start; i < out_bodies.size(); ++i)
+		{
+			RigidBody3D* body = out_bodies[i];
+			const CollisionShape* shape = body->GetCollisionShape().get();
+			if(!shape)
+				continue;
+			
+			GJK::DistanceResult result;
+			if(GJK::Distance(ConvexProxy(shape, body->GetWorldSpaceTransform()), sphere, shape->GetSupportMargin() + radius, &result))
+				out_bodies[count++] = body;
+		}
+		
+		out_bodies.resize(count);
+		return static_cast<u32>(count - start);
+	}
+	
+	u32 LumosPhysicsEngine::AABBQuery(const Maths::BoundingBox& aabb, std::vector<RigidBody3D*>& out_bodies) const
+	{
+		WaitForPhysicsThread();
+		
+		const size_t start = out_bodies.size();
+		GatherQueryCandidates(aabb, out_bodies);
+		
+		// Broadphase bounds are fattened, test the bodies' own bounds
+		size_t count = start;
+		for(size_t i = start; i < out_bodies.size(); ++i)
+		{
+			RigidBody3D* body = out_bodies[i];
+			if(GetBodyBounds(body).IsInsideFast(aabb) != Maths::OUTSIDE)
+				out_bodies[count++] = body;
+		}
+		
+		out_bodies.resize(count);
+		return static_cast<u32>(count - start);
+	}
+	
 	std::string IntegrationTypeToString(IntegrationType type)
 	{
 		switch(type)
@@ -430,6 +1206,22 @@ namespace Lumos
 		ImGui::PopItemWidth();
 		ImGui::NextColumn();
 		
+		ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted("Number Of Islands");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		ImGui::Text("%5.2i", GetNumberIslands());
+		ImGui::PopItemWidth();
+		ImGui::NextColumn();
+		
+		ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted("Step Time (ms)");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		ImGui::Text("%.3f", m_StepStats.totalMs);
+		ImGui::PopItemWidth();
+		ImGui::NextColumn();
+		
 		ImGui::AlignTextToFramePadding();
 		ImGui::TextUnformatted("Number Of Constraints");
 		ImGui::NextColumn();
@@ -442,7 +1234,9 @@ namespace Lumos
 		ImGui::TextUnformatted("Paused");
 		ImGui::NextColumn();
 		ImGui::PushItemWidth(-1);
-		ImGui::Checkbox("##Paused", &m_IsPaused);
+		bool paused = m_IsPaused;
+		if(ImGui::Checkbox("##Paused", &paused))
+			SetPaused(paused);
 		ImGui::PopItemWidth();
 		ImGui::NextColumn();
 		
@@ -462,6 +1256,24 @@ namespace Lumos
 		ImGui::PopItemWidth();
 		ImGui::NextColumn();
 		
+		ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted("Solver Iterations");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		int solverIterations = static_cast<int>(m_SolverIterations);
+		if(ImGui::DragInt("##Solver Iterations", &solverIterations, 1.0f, 1, 100))
+			m_SolverIterations = static_cast<u32>(solverIterations);
+		ImGui::PopItemWidth();
+		ImGui::NextColumn();
+		
+		ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted("Warm Starting");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		ImGui::Checkbox("##Warm Starting", &m_WarmStarting);
+		ImGui::PopItemWidth();
+		ImGui::NextColumn();
+		
 		ImGui::AlignTextToFramePadding();
 		ImGui::TextUnformatted("Integration Type");
 		ImGui::NextColumn();
@@ -490,6 +1302,36 @@ namespace Lumos
 		ImGui::PopItemWidth();
 		ImGui::NextColumn();
 		
+		ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted("Step Mode");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		const char* stepModeNames[] = { "Variable", "Fixed", "Fixed Threaded" };
+		if(ImGui::BeginMenu(stepModeNames[static_cast<int>(m_StepMode)]))
+		{
+			for(int i = 0; i < 3; ++i)
+			{
+				if(ImGui::MenuItem(stepModeNames[i], "", static_cast<int>(m_StepMode) == i, true))
+					SetStepMode(static_cast<PhysicsStepMode>(i));
+			}
+			ImGui::EndMenu();
+		}
+		ImGui::PopItemWidth();
+		ImGui::NextColumn();
+		
+		if(m_StepMode != PhysicsStepMode::Variable)
+		{
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Fixed Step Rate (Hz)");
+			ImGui::NextColumn();
+			ImGui::PushItemWidth(-1);
+			float stepRate = 1.0f / m_FixedTimestep;
+			if(ImGui::DragFloat("##Fixed Step Rate", &stepRate, 1.0f, 10.0f, 1000.0f))
+				SetFixedTimestep(1.0f / Maths::Max(stepRate, 10.0f));
+			ImGui::PopItemWidth();
+			ImGui::NextColumn();
+		}
+		
 		ImGui::Columns(1);
 		ImGui::Separator();
 		ImGui::PopStyleVar();
@@ -498,6 +1340,11 @@ namespace Lumos
 	void LumosPhysicsEngine::OnDebugDraw()
 	{
 		LUMOS_PROFILE_FUNCTION();
+		
+		// Manifolds and bodies are being written by the physics thread
+		if(m_ThreadStepping.load())
+			return;
+		
 		if(m_DebugDrawFlags & PhysicsDebugFlags::MANIFOLD)
 		{
 			for(Manifold* m : m_Manifolds)
@@ -526,7 +1373,7 @@ namespace Lumos
         {
             const auto& phys = group.get<Physics3DComponent>(entity);
             
-            auto& physicsObj = phys.GetRigidBody();
+            auto& physicsObj = phys.m_RigidBody;
             
             if(physicsObj)
             {
@@ -5,22 +5,20 @@
 #include "RigidBody3D.h"
 #include "Manifold.h"
 #include "Broadphase.h"
+#include "RigidBody3DStore.h"
+#include "Integration.h"
 #include "Scene/ISystem.h"
 #include "Scene/Scene.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
 namespace Lumos
 {
 
-#define SOLVER_ITERATIONS 50
-
-	enum class LUMOS_EXPORT IntegrationType
-	{
-		EXPLICIT_EULER = 0,
-		SEMI_IMPLICIT_EULER,
-		RUNGE_KUTTA_2,
-		RUNGE_KUTTA_4
-	};
-
 	enum PhysicsDebugFlags : u32
 	{
 		CONSTRAINT = 1,
@@ -38,6 +36,105 @@ namespace Lumos
 	class Constraint;
 	class TimeStep;
 
+	// How OnUpdate advances the simulation
+	enum class PhysicsStepMode : u8
+	{
+		Variable, // One step per frame using the frame's time step
+		Fixed, // Fixed steps on the calling thread, transforms are interpolated between the last two steps
+		FixedThreaded // Fixed steps on a dedicated physics thread, rendering never waits for a step to finish. Collision callbacks are queued and fired on the main thread.
+	};
+
+	// Body poses at the end of a fixed step, in the order of the engine's bodies at the time of the step
+	struct PhysicsStateBuffer
+	{
+		std::vector<entt::entity> entities;
+		std::vector<RigidBody3D*> bodies;
+		std::vector<Maths::Vector3> positions;
+		std::vector<Maths::Quaternion> orientations;
+		double time = 0.0; // Simulated time at the end of the step
+	};
+
+	// Manifolds written by a single narrow phase job. Pools are kept between steps so the
+	// narrow phase stops allocating once the number of contacts stabilises.
+	struct ManifoldPool
+	{
+		std::vector<Manifold> manifolds;
+		std::vector<u8> built; // BuildCollisionManifold succeeded for the manifold at the same index
+		u32 count = 0;
+	};
+
+	// Collision found by the physics thread, its callbacks are fired on the main thread at the next sync point
+	struct QueuedCollisionEvent
+	{
+		Manifold manifold; // Copy taken when the pair was detected, the pair is its A and B nodes
+		bool built = false;
+	};
+
+	// Contacts of a colliding pair from the previous step, used to warm start the solver
+	struct ContactCacheEntry
+	{
+		RigidBody3D* nodeA = nullptr; // Pairs can be reported in either order, impulses are only reused if it matches
+		u32 lastStep = 0;
+		std::vector<ContactPoint> contacts;
+	};
+
+	// Group of bodies connected through contacts or constraints. Islands don't share any
+	// dynamic bodies, so they can be solved independently. Ranges index into the engine's island arrays.
+	struct Island
+	{
+		u32 bodyStart = 0;
+		u32 bodyCount = 0;
+		u32 manifoldStart = 0;
+		u32 manifoldCount = 0;
+		u32 constraintStart = 0;
+		u32 constraintCount = 0;
+	};
+
+	// Start of step pose of a body using continuous collision detection
+	struct ContinuousMotion
+	{
+		RigidBody3D* body = nullptr;
+		Maths::Vector3 startPosition;
+		Maths::Quaternion startOrientation;
+		float timeOfImpact = 1.0f; // Fraction of the step the body travels before its first impact
+	};
+
+	// Timings and counts of the most recent physics step
+	struct PhysicsStepStats
+	{
+		float broadphaseMs = 0.0f;
+		float narrowphaseMs = 0.0f;
+		float solverMs = 0.0f; // Island building, constraint solving and contact caching
+		float integrationMs = 0.0f; // Integration, continuous collision and sleeping
+		float totalMs = 0.0f;
+
+		u32 broadphasePairs = 0;
+		u32 manifolds = 0;
+		u32 contacts = 0;
+		u32 islands = 0;
+		u32 awakeBodies = 0;
+		u32 continuousBodies = 0; // Awake bodies using continuous collision
+		u32 timeOfImpactHits = 0; // Continuous bodies moved back to their time of impact
+	};
+
+	// Closest hit of a scene raycast
+	struct RaycastHit
+	{
+		RigidBody3D* body = nullptr; // nullptr if the ray didn't hit anything
+		Maths::Vector3 point;
+		Maths::Vector3 normal;
+		float distance = 0.0f;
+	};
+
+	struct RigidBodyPairHash
+	{
+		size_t operator()(const std::pair<RigidBody3D*, RigidBody3D*>& pair) const
+		{
+			const size_t hashA = std::hash<RigidBody3D*>()(pair.first);
+			return hashA ^ (std::hash<RigidBody3D*>()(pair.second) + 0x9e3779b9 + (hashA << 6) + (hashA >> 2));
+		}
+	};
+
 	class LUMOS_EXPORT LumosPhysicsEngine : public ISystem
 	{
 	public:
@@ -63,9 +160,35 @@ namespace Lumos
 		}
 		void SetPaused(bool paused)
 		{
+			// Pausing is used before scenes are unloaded, bodies must not be stepped past it
+			WaitForPhysicsThread();
 			m_IsPaused = paused;
 		}
 
+		PhysicsStepMode GetStepMode() const
+		{
+			return m_StepMode;
+		}
+		void SetStepMode(PhysicsStepMode mode);
+
+		// Length of a step in the fixed step modes
+		float GetFixedTimestep() const
+		{
+			return m_FixedTimestep;
+		}
+		void SetFixedTimestep(float timestep);
+
+		// Blocks until the physics thread has finished the steps it was given. While the threaded step mode is
+		// used, bodies and constraints may only be used outside of the engine's update after this.
+		// Physics3DComponent::GetRigidBody and the script bindings wait here before handing out a body.
+		// Returns straight away on the physics thread itself.
+		void WaitForPhysicsThread() const;
+
+		bool IsPhysicsThreadStepping() const
+		{
+			return m_ThreadStepping.load();
+		}
+
 		const Maths::Vector3& GetGravity() const
 		{
 			return m_Gravity;
@@ -84,9 +207,10 @@ namespace Lumos
 			m_DampingFactor = d;
 		}
 
-		static float GetDeltaTime()
+		// Length of the most recent step
+		float GetDeltaTime() const
 		{
-			return s_UpdateTimestep;
+			return m_UpdateTimestep;
 		}
 
 		Ref<Broadphase> GetBroadphase() const
@@ -106,6 +230,15 @@ namespace Lumos
 		{
 			return static_cast<int>(m_RigidBodys.size());
 		}
+		int GetNumberIslands() const
+		{
+			return static_cast<int>(m_Islands.size());
+		}
+
+		const PhysicsStepStats& GetStepStats() const
+		{
+			return m_StepStats;
+		}
 
 		IntegrationType GetIntegrationType() const
 		{
@@ -116,8 +249,43 @@ namespace Lumos
 			m_IntegrationType = type;
 		}
 
+		u32 GetSolverIterations() const
+		{
+			return m_SolverIterations;
+		}
+		void SetSolverIterations(u32 iterations)
+		{
+			m_SolverIterations = iterations;
+		}
+
+		bool GetWarmStarting() const
+		{
+			return m_WarmStarting;
+		}
+		void SetWarmStarting(bool warmStarting)
+		{
+			m_WarmStarting = warmStarting;
+		}
+
 		void ClearConstraints();
 
+		//<----- SCENE QUERIES ----->
+		// Queries see the bodies as they were at the end of the last physics step and are accelerated by the
+		// broadphase when it keeps a structure between steps. Each query first waits for a step running on the
+		// physics thread. Safe to call from several threads, as long as OnUpdate doesn't start a step meanwhile.
+
+		// Closest body hit by the ray within maxDistance
+		bool Raycast(const Maths::Ray& ray, float maxDistance, RaycastHit* out_hit) const;
+
+		// Closest hit of every ray, spread over the job system. out_hits needs room for count hits.
+		void RaycastBatch(const Maths::Ray* rays, u32 count, float maxDistance, RaycastHit* out_hits) const;
+
+		// Appends the bodies whose collision shape overlaps the sphere, returns how many were added
+		u32 SphereOverlap(const Maths::Vector3& centre, float radius, std::vector<RigidBody3D*>& out_bodies) const;
+
+		// Appends the bodies whose world space AABB overlaps aabb, returns how many were added
+		u32 AABBQuery(const Maths::BoundingBox& aabb, std::vector<RigidBody3D*>& out_bodies) const;
+
 		void OnImGui() override;
 		void OnDebugDraw() override;
 
@@ -132,7 +300,26 @@ namespace Lumos
 
 	protected:
 		//The actual time-independant update function
-		void UpdatePhysics(Scene* scene);
+		void UpdatePhysics();
+
+		//Collects the bodies and constraints to simulate from the scene
+		void GatherBodies(entt::registry& registry);
+
+		//Whole fixed steps covered by the accumulated frame time, capped so a slow frame can't spiral
+		u32 TakeFixedSteps();
+
+		//Copies the body poses into a new state buffer, the oldest published state is recycled
+		void PublishState();
+
+		//Writes body poses interpolated between the last two published states into the transforms
+		void WriteInterpolatedTransforms(entt::registry& registry);
+
+		void StartPhysicsThread();
+		void StopPhysicsThread();
+		void PhysicsThreadLoop();
+
+		//Fires the callbacks of the collisions the physics thread queued, the thread must not be stepping
+		void FireQueuedCollisionEvents();
 
 		//Handles broadphase collision detection
 		void BroadPhaseCollisions();
@@ -142,10 +329,28 @@ namespace Lumos
 
 		//Updates all physics objects position, orientation, velocity etc (default method uses symplectic euler integration)
 		void UpdateRigidBodys();
-		void UpdateRigidBody(const Ref<RigidBody3D>& obj) const;
 
-		//Solves all engine constraints (constraints and manifolds)
+		//Moves bodies using continuous collision back to their first time of impact with any broadphase pair
+		void SolveContinuousCollisions();
+
+		//Groups bodies connected by manifolds or constraints into islands
+		void BuildIslands();
+
+		//Solves all engine constraints (constraints and manifolds), islands are solved in parallel
 		void SolveConstraints();
+		void SolveConstraintGroup(Manifold* const* manifolds, u32 manifoldCount, Constraint* const* constraints, u32 constraintCount) const;
+
+		//Islands only sleep once every body in them is at rest
+		void UpdateIslandSleeping();
+
+		//Stores this step's contacts and drops pairs that stopped colliding
+		void UpdateContactCache();
+
+		//Appends every body the broadphase can't rule out of aabb, tests each body's bounds if it keeps no structure
+		void GatherQueryCandidates(const Maths::BoundingBox& aabb, std::vector<RigidBody3D*>& out_bodies) const;
+
+		//Raycast without waiting for the physics thread, used by the batch jobs once it has been waited on
+		bool RaycastClosest(const Maths::Ray& ray, float maxDistance, RaycastHit* out_hit) const;
 
 	protected:
 		bool m_IsPaused;
@@ -154,18 +359,60 @@ namespace Lumos
 		float m_DampingFactor;
 
 		std::vector<Ref<RigidBody3D>> m_RigidBodys;
+		std::vector<entt::entity> m_BodyEntities; // Entity of each body in m_RigidBodys
+		RigidBody3DStore m_BodyStore; // Awake dynamic bodies gathered for integration
 		std::vector<CollisionPair> m_BroadphaseCollisionPairs;
 
 		std::vector<Constraint*> m_Constraints; // Misc constraints between pairs of objects
-		std::vector<Manifold*> m_Manifolds; // Contact constraints between pairs of objects
-		std::mutex m_ManifoldsMutex;
+		std::vector<Manifold*> m_Manifolds; // Contact constraints between pairs of objects, owned by m_ManifoldPools
+		std::vector<ManifoldPool> m_ManifoldPools; // One per narrow phase job, merged in pair order
+		std::unordered_map<std::pair<RigidBody3D*, RigidBody3D*>, ContactCacheEntry, RigidBodyPairHash> m_ContactCache;
+		u32 m_StepIndex = 0;
+		PhysicsStepStats m_StepStats;
+
+		// Island data is rebuilt every step, the vectors are kept to avoid reallocating
+		std::vector<Island> m_Islands;
+		std::vector<u32> m_IslandParents; // Union-find over m_RigidBodys
+		std::vector<u32> m_IslandIDs;
+		std::vector<RigidBody3D*> m_IslandBodies;
+		std::vector<Manifold*> m_IslandManifolds;
+		std::vector<Constraint*> m_IslandConstraints;
+		std::vector<Constraint*> m_UnlinkedConstraints; // Constraints between bodies the engine isn't simulating, solved serially
+
+		std::vector<ContinuousMotion> m_ContinuousMotions; // Awake bodies using continuous collision, gathered before integration
+		std::vector<u32> m_ContinuousIndices; // Per body index into m_ContinuousMotions
+
+		u32 m_SolverIterations = 10;
+		bool m_WarmStarting = true;
 
 		Ref<Broadphase> m_BroadphaseDetection;
 		IntegrationType m_IntegrationType;
 
 		u32 m_DebugDrawFlags = 0;
 
-		bool m_MultipleUpdates = false;
-		static float s_UpdateTimestep;
+		PhysicsStepMode m_StepMode = PhysicsStepMode::Variable;
+		float m_FixedTimestep = 1.0f / 60.0f;
+		float m_UpdateTimestep = 1.0f / 60.0f; // Length of the step being taken, the frame's time step in the variable mode
+		double m_RequestedTime = 0.0; // Simulated time of every fixed step taken so far, main thread only
+		double m_SimulatedTime = 0.0; // Simulated time of every fixed step run so far, owned by whoever steps
+
+		// Published states are swapped under m_StateMutex, m_WriteState is only touched by whoever steps
+		PhysicsStateBuffer m_PreviousState;
+		PhysicsStateBuffer m_CurrentState;
+		PhysicsStateBuffer m_WriteState;
+		std::mutex m_StateMutex;
+
+		// The physics thread owns the bodies, constraints and step data while m_ThreadStepping is set
+		std::thread m_PhysicsThread;
+		mutable std::mutex m_ThreadMutex;
+		mutable std::condition_variable m_ThreadCondition;
+		u32 m_PendingSteps = 0; // Guarded by m_ThreadMutex
+		bool m_StopThread = false; // Guarded by m_ThreadMutex
+		std::atomic<bool> m_ThreadStepping { false };
+
+		// User callbacks never run on the physics thread. It queues the collisions of bodies with callbacks and
+		// drops the pairs a callback rejected when they were last fired.
+		std::vector<QueuedCollisionEvent> m_QueuedCollisionEvents;
+		std::unordered_set<std::pair<RigidBody3D*, RigidBody3D*>, RigidBodyPairHash> m_RejectedPairs;
 	};
 }
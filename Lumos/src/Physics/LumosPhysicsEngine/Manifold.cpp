@@ -78,7 +78,7 @@ namespace Lumos
 
 				float penetrationSlop = Maths::Min(c.collisionPenetration + baumgarteSlop, 0.0f);
 
-				b = -(baumgarteScalar / LumosPhysicsEngine::GetDeltaTime()) * penetrationSlop;
+				b = -(baumgarteScalar / m_Timestep) * penetrationSlop;
 			}
 
 			float b_real = Maths::Max(b, c.elatisity_term + b * 0.2f);
@@ -128,43 +128,95 @@ namespace Lumos
 						   / frictionalMass;
 
 				// Clamp friction to never apply more force than the main collision
-				// resolution force
+				// resolution force. The accumulated impulse is a vector in the contact
+				// plane, so the clamp bounds its length rather than one direction.
 
-				float oldImpulseTangent = c.sumImpulseFriction;
-				float maxJt = frictionCoef * c.sumImpulseContact;
+				const Maths::Vector3 oldImpulseFriction = c.sumImpulseFriction;
+				const float maxJt = -frictionCoef * c.sumImpulseContact;
 
-				c.sumImpulseFriction = Maths::Min(Maths::Max(oldImpulseTangent + jt, maxJt), -maxJt);
+				Maths::Vector3 sumImpulseFriction = oldImpulseFriction + tangent * jt;
+				sumImpulseFriction = sumImpulseFriction - normal * Maths::Vector3::Dot(sumImpulseFriction, normal);
 
-				jt = c.sumImpulseFriction - oldImpulseTangent;
+				const float sumLength = sumImpulseFriction.Length();
+				if(sumLength > maxJt)
+					sumImpulseFriction = sumImpulseFriction * (maxJt / sumLength);
+
+				c.sumImpulseFriction = sumImpulseFriction;
+				const Maths::Vector3 impulse = sumImpulseFriction - oldImpulseFriction;
 
 				m_pNodeA->SetLinearVelocity(m_pNodeA->GetLinearVelocity()
-											+ tangent * (jt * m_pNodeA->GetInverseMass()));
+											+ impulse * m_pNodeA->GetInverseMass());
 				m_pNodeB->SetLinearVelocity(m_pNodeB->GetLinearVelocity()
-											- tangent * (jt * m_pNodeB->GetInverseMass()));
+											- impulse * m_pNodeB->GetInverseMass());
 
 				m_pNodeA->SetAngularVelocity(m_pNodeA->GetAngularVelocity()
 											 + m_pNodeA->GetInverseInertia()
-												   * Maths::Vector3::Cross(r1, tangent * jt));
+												   * Maths::Vector3::Cross(r1, impulse));
 				m_pNodeB->SetAngularVelocity(m_pNodeB->GetAngularVelocity()
 											 - m_pNodeB->GetInverseInertia()
-												   * Maths::Vector3::Cross(r2, tangent * jt));
+												   * Maths::Vector3::Cross(r2, impulse));
 			}
 		}
 	}
 
 	void Manifold::PreSolverStep(float dt)
 	{
+		m_Timestep = dt;
 		for(ContactPoint& contact : m_vContacts)
 		{
 			UpdateConstraint(contact);
 		}
 	}
 
+	void Manifold::RestoreImpulses(const std::vector<ContactPoint>& previousContacts)
+	{
+		for(ContactPoint& contact : m_vContacts)
+		{
+			const ContactPoint* closest = nullptr;
+			float closestDistSq = persistentThresholdSq;
+
+			for(const ContactPoint& previous : previousContacts)
+			{
+				Maths::Vector3 ab = previous.relPosA - contact.relPosA;
+				float distSq = Maths::Vector3::Dot(ab, ab);
+				if(distSq < closestDistSq)
+				{
+					closest = &previous;
+					closestDistSq = distSq;
+				}
+			}
+
+			if(closest)
+			{
+				contact.sumImpulseContact = closest->sumImpulseContact;
+				contact.sumImpulseFriction = closest->sumImpulseFriction;
+			}
+		}
+	}
+
+	void Manifold::WarmStart()
+	{
+		if(m_pNodeA->GetInverseMass() + m_pNodeB->GetInverseMass() == 0.0f)
+			return;
+
+		for(ContactPoint& contact : m_vContacts)
+		{
+			// The normal may have turned since last step, so only the part of the friction impulse in the new contact plane is kept
+			contact.sumImpulseFriction = contact.sumImpulseFriction - contact.collisionNormal * Maths::Vector3::Dot(contact.sumImpulseFriction, contact.collisionNormal);
+			const Maths::Vector3 impulse = contact.collisionNormal * contact.sumImpulseContact + contact.sumImpulseFriction;
+
+			m_pNodeA->SetLinearVelocity(m_pNodeA->GetLinearVelocity() + impulse * m_pNodeA->GetInverseMass());
+			m_pNodeB->SetLinearVelocity(m_pNodeB->GetLinearVelocity() - impulse * m_pNodeB->GetInverseMass());
+
+			m_pNodeA->SetAngularVelocity(m_pNodeA->GetAngularVelocity() + m_pNodeA->GetInverseInertia() * Maths::Vector3::Cross(contact.relPosA, impulse));
+			m_pNodeB->SetAngularVelocity(m_pNodeB->GetAngularVelocity() - m_pNodeB->GetInverseInertia() * Maths::Vector3::Cross(contact.relPosB, impulse));
+		}
+	}
+
 	void Manifold::UpdateConstraint(ContactPoint& contact)
 	{
-		//Reset total impulse forces computed this physics timestep
-		contact.sumImpulseContact = 0.0f;
-		contact.sumImpulseFriction = 0.0f;
+		// Accumulated impulses are either zero for new contacts or restored
+		// from last step by RestoreImpulses, so they are not reset here
 
 		// Compute Elasticity Term - must be computed prior to solving
 		// ANY constraints otherwise the objects velocities may have
@@ -215,7 +267,7 @@ namespace Lumos
 		contact.collisionPenetration = _penetration;
 		contact.elatisity_term = 1.0f;
 		contact.sumImpulseContact = 0.0f;
-		contact.sumImpulseFriction = 0.0f;
+		contact.sumImpulseFriction = Maths::Vector3(0.0f);
 
 		//Check to see if we already contain a contact point almost in that location
 		const float min_allowed_dist_sq = 0.2f * 0.2f;
@@ -13,11 +13,11 @@ namespace Lumos
 	struct LUMOS_EXPORT ContactPoint
 	{
 		float sumImpulseContact = 0.0f;
-		float sumImpulseFriction = 0.0f;
 		float elatisity_term = 0.0f;
 		float collisionPenetration = 0.0f;
 
 		Maths::Vector3 collisionNormal;
+		Maths::Vector3 sumImpulseFriction; //Accumulated friction impulse in the contact plane, a vector so it stays valid when the sliding direction turns
 		Maths::Vector3 relPosA; //Position relative to objectA
 		Maths::Vector3 relPosB; //Position relative to objectB
 	};
@@ -38,6 +38,12 @@ namespace Lumos
 		void ApplyImpulse();
 		void PreSolverStep(float dt);
 
+		//Copies accumulated impulses from last step's contacts that are close enough to the new ones
+		void RestoreImpulses(const std::vector<ContactPoint>& previousContacts);
+
+		//Applies the accumulated impulses up front, so the solver starts close to last step's solution
+		void WarmStart();
+
 		//Debug draws the manifold surface area
 		void DebugDraw() const;
 
@@ -51,6 +57,11 @@ namespace Lumos
 			return m_pNodeB;
 		}
 
+		const std::vector<ContactPoint>& GetContacts() const
+		{
+			return m_vContacts;
+		}
+
 	protected:
 		void SolveContactPoint(ContactPoint& c) const;
 		void UpdateConstraint(ContactPoint& c);
@@ -59,5 +70,6 @@ namespace Lumos
 		RigidBody3D* m_pNodeA;
 		RigidBody3D* m_pNodeB;
 		std::vector<ContactPoint> m_vContacts;
+		float m_Timestep = 1.0f / 60.0f; // Length of the step being solved, set by PreSolverStep
 	};
 }
@@ -36,7 +36,7 @@ namespace Lumos
 		{
 			if(physicsObject && physicsObject->GetCollisionShape())
 			{
-				m_RootNode->boundingBox.Merge(physicsObject->GetWorldSpaceAABB());
+				m_RootNode->boundingBox.Merge(physicsObject->GetWorldSpaceAABB(m_Timestep));
 				m_RootNode->physicsObjects.emplace_back(physicsObject);
 			}
 		}
@@ -45,6 +45,7 @@ namespace Lumos
 		Divide(m_RootNode, 0);
 
 		// Add collision pairs in leaf world divisions
+		m_SecondaryBroadphase->SetTimestep(m_Timestep);
 		for(auto& m_LeafNode : m_LeafNodes)
 			m_SecondaryBroadphase->FindPotentialCollisionPairs(m_LeafNode->physicsObjects, collisionPairs);
 	}
@@ -98,7 +99,7 @@ namespace Lumos
 			// Add objects inside division
 			for(auto& physicsObject : division->physicsObjects)
 			{
-				if(newNode->boundingBox.IsInsideFast(physicsObject->GetWorldSpaceAABB()))
+				if(newNode->boundingBox.IsInsideFast(physicsObject->GetWorldSpaceAABB(m_Timestep)))
 					newNode->physicsObjects.push_back(physicsObject);
 			}
 
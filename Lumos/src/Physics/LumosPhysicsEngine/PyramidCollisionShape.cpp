@@ -17,6 +17,8 @@ namespace Lumos
 		{
 			ConstructPyramidHull();
 		}
+
+		m_PyramidHull->BuildCollisionHull(m_PyramidHalfDimensions, &m_CollisionHull);
 	}
 
 	PyramidCollisionShape::PyramidCollisionShape(const Maths::Vector3& halfdims)
@@ -43,6 +45,8 @@ namespace Lumos
 		{
 			ConstructPyramidHull();
 		}
+
+		m_PyramidHull->BuildCollisionHull(m_PyramidHalfDimensions, &m_CollisionHull);
 	}
 
 	PyramidCollisionShape::~PyramidCollisionShape()
@@ -112,7 +116,7 @@ namespace Lumos
 			*out_max = wsTransform * m_PyramidHull->GetVertex(vMax).pos;
 	}
 
-	void PyramidCollisionShape::GetIncidentReferencePolygon(const RigidBody3D* currentObject, const Maths::Vector3& axis, std::list<Maths::Vector3>* out_face, Maths::Vector3* out_normal, std::vector<Maths::Plane>* out_adjacent_planes) const
+	void PyramidCollisionShape::GetIncidentReferencePolygon(const RigidBody3D* currentObject, const Maths::Vector3& axis, ManifoldPolygon* out_face, Maths::Vector3* out_normal, ManifoldPlanes* out_adjacent_planes) const
 	{
 		Maths::Matrix4 wsTransform;
 
@@ -156,7 +160,7 @@ namespace Lumos
 			for(int vertIdx : best_face->vert_ids)
 			{
 				const HullVertex& vertex = m_PyramidHull->GetVertex(vertIdx);
-				out_face->push_back(wsTransform * vertex.pos);
+				out_face->Add(wsTransform * vertex.pos);
 			}
 		}
 
@@ -168,7 +172,7 @@ namespace Lumos
 			planeNrml.Normalize();
 			float planeDist = -Maths::Vector3::Dot(planeNrml, wsPointOnPlane);
 
-			out_adjacent_planes->emplace_back(planeNrml, planeDist);
+			out_adjacent_planes->Add(planeNrml, planeDist);
 
 			for(int edgeIdx : best_face->edge_ids)
 			{
@@ -186,13 +190,31 @@ namespace Lumos
 						planeNrml.Normalize();
 						planeDist = -Maths::Vector3::Dot(planeNrml, wsPointOnPlane);
 
-						out_adjacent_planes->emplace_back(planeNrml, planeDist);
+						out_adjacent_planes->Add(planeNrml, planeDist);
 					}
 				}
 			}
 		}
 	}
 
+	Maths::Vector3 PyramidCollisionShape::GetLocalSupportPoint(const Maths::Vector3& direction) const
+	{
+		u32 best = 0;
+		float bestProjection = -FLT_MAX;
+
+		for(u32 i = 0; i < m_CollisionHull.vertexCount; ++i)
+		{
+			const float projection = m_CollisionHull.vertexX[i] * direction.x + m_CollisionHull.vertexY[i] * direction.y + m_CollisionHull.vertexZ[i] * direction.z;
+			if(projection > bestProjection)
+			{
+				bestProjection = projection;
+				best = i;
+			}
+		}
+
+		return m_CollisionHull.GetVertex(best);
+	}
+
 	void PyramidCollisionShape::DebugDraw(const RigidBody3D* currentObject) const
 	{
 		const Maths::Matrix4 transform = currentObject->GetWorldSpaceTransform() * m_LocalTransform;
@@ -21,10 +21,16 @@ namespace Lumos
 		virtual void GetEdges(const RigidBody3D* currentObject, std::vector<CollisionEdge>* out_edges) const override;
 
 		virtual void GetMinMaxVertexOnAxis(const RigidBody3D* currentObject, const Maths::Vector3& axis, Maths::Vector3* out_min, Maths::Vector3* out_max) const override;
-		virtual void GetIncidentReferencePolygon(const RigidBody3D* currentObject, const Maths::Vector3& axis, std::list<Maths::Vector3>* out_face, Maths::Vector3* out_normal, std::vector<Maths::Plane>* out_adjacent_planes) const override;
+		virtual void GetIncidentReferencePolygon(const RigidBody3D* currentObject, const Maths::Vector3& axis, ManifoldPolygon* out_face, Maths::Vector3* out_normal, ManifoldPlanes* out_adjacent_planes) const override;
+		virtual Maths::Vector3 GetLocalSupportPoint(const Maths::Vector3& direction) const override;
 
 		virtual void DebugDraw(const RigidBody3D* currentObject) const override;
 
+		virtual const CollisionHull* GetCollisionHull() const override
+		{
+			return &m_CollisionHull;
+		}
+
 		const Maths::Vector3& GetHalfDimensions() const
 		{
 			return m_PyramidHalfDimensions;
@@ -53,6 +59,8 @@ namespace Lumos
 			{
 				ConstructPyramidHull();
 			}
+
+			m_PyramidHull->BuildCollisionHull(m_PyramidHalfDimensions, &m_CollisionHull);
 		}
 
 		float GetSize() const override
@@ -91,6 +99,8 @@ namespace Lumos
 			{
 				ConstructPyramidHull();
 			}
+
+			m_PyramidHull->BuildCollisionHull(m_PyramidHalfDimensions, &m_CollisionHull);
 		}
 
 	protected:
@@ -100,6 +110,7 @@ namespace Lumos
 	protected:
 		Maths::Vector3 m_PyramidHalfDimensions;
 		Maths::Vector3 m_Normals[5];
+		CollisionHull m_CollisionHull;
 
 		static UniqueRef<Hull> m_PyramidHull;
 	};
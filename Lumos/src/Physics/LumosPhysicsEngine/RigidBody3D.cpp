@@ -37,13 +37,14 @@ namespace Lumos
 		m_AtRest = properties.AtRest;
 		m_Elasticity = properties.Elasticity;
 		m_Friction = properties.Friction;
+		m_ContinuousCollision = properties.ContinuousCollision;
 	}
 
 	RigidBody3D::~RigidBody3D()
 	{
 	}
 
-	Maths::BoundingBox RigidBody3D::GetWorldSpaceAABB()
+	Maths::BoundingBox RigidBody3D::GetWorldSpaceAABB(float sweepTimestep)
 	{
 		if(m_wsAabbInvalidated)
 		{
@@ -51,7 +52,14 @@ namespace Lumos
 			m_wsAabbInvalidated = false;
 		}
 
-		return m_wsAabb;
+		if(!m_ContinuousCollision || m_Static)
+			return m_wsAabb;
+
+		// Cover everything the body can reach this step, so the broadphase reports it for the time of impact pass
+		const Maths::Vector3 sweep = m_LinearVelocity * sweepTimestep;
+		Maths::BoundingBox swept = m_wsAabb;
+		swept.Merge(Maths::BoundingBox(m_wsAabb.min_ + sweep, m_wsAabb.max_ + sweep));
+		return swept;
 	}
 
 	void RigidBody3D::WakeUp()
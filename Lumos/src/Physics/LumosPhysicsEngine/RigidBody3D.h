@@ -8,6 +8,7 @@
 #include "Physics/LumosPhysicsEngine/PyramidCollisionShape.h"
 
 #include "Maths/Maths.h"
+#include "Scene/SceneLoadContext.h"
 #include <cereal/types/polymorphic.hpp>
 #include <cereal/cereal.hpp>
 
@@ -48,6 +49,7 @@ namespace Lumos
 		float Friction = 0.8f;
 		bool AtRest = false;
         bool isTrigger = false;
+		bool ContinuousCollision = false;
 		Ref<CollisionShape> Shape = nullptr;
 	};
 
@@ -94,7 +96,9 @@ namespace Lumos
 		}
 		const Maths::Matrix4& GetWorldSpaceTransform() const; //Built from scratch or returned from cached value
 
-		Maths::BoundingBox GetWorldSpaceAABB();
+		// Bodies using continuous collision are swept along their velocity over sweepTimestep, so the
+		// broadphase reports everything they can reach during the step
+		Maths::BoundingBox GetWorldSpaceAABB(float sweepTimestep);
 
 		void WakeUp() override;
 		void SetIsAtRest(const bool isAtRest) override;
@@ -133,6 +137,10 @@ namespace Lumos
 			if(m_Static)
 				return;
 			m_LinearVelocity = v;
+
+			// The swept AABB follows the velocity
+			if(m_ContinuousCollision)
+				m_wsAabbInvalidated = true;
 		}
 		void SetForce(const Maths::Vector3& v)
 		{
@@ -182,6 +190,11 @@ namespace Lumos
 			return handleCollision;
 		}
 
+		bool HasCollisionCallbacks() const
+		{
+			return m_OnCollisionCallback || !m_onCollisionManifoldCallbacks.empty();
+		}
+
 		void FireOnCollisionManifoldCallback(RigidBody3D* a, RigidBody3D* b, Manifold* manifold)
 		{
 			for(auto it = m_onCollisionManifoldCallbacks.begin(); it != m_onCollisionManifoldCallbacks.end(); ++it)
@@ -240,12 +253,26 @@ namespace Lumos
         bool GetIsTrigger() const { return m_Trigger; }
         void SetIsTrigger(bool trigger) { m_Trigger = trigger; }
 
+		// Continuous collision detection
+		//	- The world space AABB is swept along the body's velocity for one physics step and, after
+		//    integration, the body is only advanced up to its first time of impact with any broadphase
+		//    pair. Keeps small fast bodies from tunneling through thin ones without a smaller timestep.
+		bool GetContinuousCollision() const
+		{
+			return m_ContinuousCollision;
+		}
+		void SetContinuousCollision(bool continuous)
+		{
+			m_ContinuousCollision = continuous;
+			m_wsAabbInvalidated = true;
+		}
+
 		template<typename Archive>
 		void save(Archive& archive) const
 		{
 			auto shape = std::unique_ptr<CollisionShape>(m_CollisionShape.get());
 
-			archive(cereal::make_nvp("Position", m_Position), cereal::make_nvp("LinearVelocity", m_LinearVelocity), cereal::make_nvp("Force", m_Force), cereal::make_nvp("Mass", 1.0f / m_InvMass), cereal::make_nvp("AngularVelocity", m_AngularVelocity), cereal::make_nvp("Torque", m_Torque), cereal::make_nvp("Static", m_Static), cereal::make_nvp("Friction", m_Friction), cereal::make_nvp("Elasticity", m_Elasticity), cereal::make_nvp("CollisionShape", shape), cereal::make_nvp("Trigger", m_Trigger));
+			archive(cereal::make_nvp("Position", m_Position), cereal::make_nvp("LinearVelocity", m_LinearVelocity), cereal::make_nvp("Force", m_Force), cereal::make_nvp("Mass", 1.0f / m_InvMass), cereal::make_nvp("AngularVelocity", m_AngularVelocity), cereal::make_nvp("Torque", m_Torque), cereal::make_nvp("Static", m_Static), cereal::make_nvp("Friction", m_Friction), cereal::make_nvp("Elasticity", m_Elasticity), cereal::make_nvp("CollisionShape", shape), cereal::make_nvp("Trigger", m_Trigger), cereal::make_nvp("ContinuousCollision", m_ContinuousCollision));
 
 			shape.release();
 		}
@@ -256,6 +283,10 @@ namespace Lumos
 			auto shape = std::unique_ptr<CollisionShape>(m_CollisionShape.get());
 			archive(cereal::make_nvp("Position", m_Position), cereal::make_nvp("LinearVelocity", m_LinearVelocity), cereal::make_nvp("Force", m_Force), cereal::make_nvp("Mass", 1.0f / m_InvMass), cereal::make_nvp("AngularVelocity", m_AngularVelocity), cereal::make_nvp("Torque", m_Torque), cereal::make_nvp("Static", m_Static), cereal::make_nvp("Friction", m_Friction), cereal::make_nvp("Elasticity", m_Elasticity), cereal::make_nvp("CollisionShape", shape), cereal::make_nvp("Trigger", m_Trigger));
 
+			// Scene files before version 5 were saved without it
+			if(GetSceneLoadingVersion(archive) >= 5)
+				archive(cereal::make_nvp("ContinuousCollision", m_ContinuousCollision));
+
 			m_CollisionShape = Ref<CollisionShape>(shape.get());
 			CollisionShapeUpdated();
 			shape.release();
@@ -277,6 +308,7 @@ namespace Lumos
 		Maths::Vector3 m_Force;
 		float m_InvMass;
         bool m_Trigger = false;
+		bool m_ContinuousCollision = false;
 
 		//<----------ANGULAR-------------->
 		Maths::Quaternion m_Orientation;
@@ -288,5 +320,7 @@ namespace Lumos
 		Ref<CollisionShape> m_CollisionShape;
 		PhysicsCollisionCallback m_OnCollisionCallback;
 		std::vector<OnCollisionManifoldCallback> m_onCollisionManifoldCallbacks; //!< Collision callbacks post manifold generation
+
+		u32 m_SolverIndex = ~0u; //!< Index into the physics engine's body list for the current step, used to build islands
 	};
 }
@@ -0,0 +1,93 @@
+#include "Precompiled.h"
+#include "RigidBody3DStore.h"
+#include "RigidBody3D.h"
+
+namespace Lumos
+{
+	void RigidBody3DStore::Reserve(u32 capacity)
+	{
+		if(capacity <= bodies.size())
+			return;
+
+		bodies.resize(capacity);
+
+		for(auto* array : {&positionX, &positionY, &positionZ, &linearVelocityX, &linearVelocityY, &linearVelocityZ, &forceX, &forceY, &forceZ,
+				&orientationW, &orientationX, &orientationY, &orientationZ, &angularVelocityX, &angularVelocityY, &angularVelocityZ,
+				&torqueX, &torqueY, &torqueZ, &inverseMass})
+			array->resize(capacity);
+
+		for(auto& array : inverseInertia)
+			array.resize(capacity);
+	}
+
+	u32 RigidBody3DStore::Add(RigidBody3D* body)
+	{
+		if(count == bodies.size())
+			Reserve(Maths::Max(16u, count * 2));
+
+		const u32 index = count++;
+		bodies[index] = body;
+
+		const Maths::Vector3& position = body->GetPosition();
+		positionX[index] = position.x;
+		positionY[index] = position.y;
+		positionZ[index] = position.z;
+
+		const Maths::Vector3& linearVelocity = body->GetLinearVelocity();
+		linearVelocityX[index] = linearVelocity.x;
+		linearVelocityY[index] = linearVelocity.y;
+		linearVelocityZ[index] = linearVelocity.z;
+
+		const Maths::Vector3& force = body->GetForce();
+		forceX[index] = force.x;
+		forceY[index] = force.y;
+		forceZ[index] = force.z;
+
+		const Maths::Quaternion& orientation = body->GetOrientation();
+		orientationW[index] = orientation.w;
+		orientationX[index] = orientation.x;
+		orientationY[index] = orientation.y;
+		orientationZ[index] = orientation.z;
+
+		const Maths::Vector3& angularVelocity = body->GetAngularVelocity();
+		angularVelocityX[index] = angularVelocity.x;
+		angularVelocityY[index] = angularVelocity.y;
+		angularVelocityZ[index] = angularVelocity.z;
+
+		const Maths::Vector3& torque = body->GetTorque();
+		torqueX[index] = torque.x;
+		torqueY[index] = torque.y;
+		torqueZ[index] = torque.z;
+
+		inverseMass[index] = body->GetInverseMass();
+
+		const Maths::Matrix3& invInertia = body->GetInverseInertia();
+		inverseInertia[0][index] = invInertia.m00_;
+		inverseInertia[1][index] = invInertia.m01_;
+		inverseInertia[2][index] = invInertia.m02_;
+		inverseInertia[3][index] = invInertia.m10_;
+		inverseInertia[4][index] = invInertia.m11_;
+		inverseInertia[5][index] = invInertia.m12_;
+		inverseInertia[6][index] = invInertia.m20_;
+		inverseInertia[7][index] = invInertia.m21_;
+		inverseInertia[8][index] = invInertia.m22_;
+
+		return index;
+	}
+
+	void RigidBody3DStore::WriteBack(u32 begin, u32 end) const
+	{
+		for(u32 index = begin; index < end; ++index)
+		{
+			RigidBody3D* body = bodies[index];
+
+			// Setters also mark the cached world transform and AABB as invalid
+			body->SetPosition(Maths::Vector3(positionX[index], positionY[index], positionZ[index]));
+			body->SetOrientation(Maths::Quaternion(orientationW[index], orientationX[index], orientationY[index], orientationZ[index]));
+			body->SetLinearVelocity(Maths::Vector3(linearVelocityX[index], linearVelocityY[index], linearVelocityZ[index]));
+			body->SetAngularVelocity(Maths::Vector3(angularVelocityX[index], angularVelocityY[index], angularVelocityZ[index]));
+
+			body->RestTest();
+		}
+	}
+}
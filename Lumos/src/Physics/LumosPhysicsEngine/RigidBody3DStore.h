@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Maths/Maths.h"
+
+namespace Lumos
+{
+	class RigidBody3D;
+
+	// Hot integration state of the awake dynamic bodies, one array per component so integration
+	// kernels walk contiguous memory instead of chasing RigidBody3D pointers. Bodies are gathered
+	// at the start of integration and written back once it finishes, RigidBody3D stays the
+	// authoritative state for constraints, scripts and serialisation.
+	struct LUMOS_EXPORT RigidBody3DStore
+	{
+		void Clear()
+		{
+			count = 0;
+		}
+
+		// Makes room for capacity bodies, arrays only grow so steady state steps don't allocate
+		void Reserve(u32 capacity);
+
+		// Copies the body's state into the next slot and returns the slot index
+		u32 Add(RigidBody3D* body);
+
+		// Copies integrated position, orientation and velocities back to the bodies in [begin, end)
+		void WriteBack(u32 begin, u32 end) const;
+
+		u32 count = 0;
+
+		std::vector<RigidBody3D*> bodies;
+
+		std::vector<float> positionX, positionY, positionZ;
+		std::vector<float> linearVelocityX, linearVelocityY, linearVelocityZ;
+		std::vector<float> forceX, forceY, forceZ;
+
+		std::vector<float> orientationW, orientationX, orientationY, orientationZ;
+		std::vector<float> angularVelocityX, angularVelocityY, angularVelocityZ;
+		std::vector<float> torqueX, torqueY, torqueZ;
+
+		std::vector<float> inverseMass;
+		std::vector<float> inverseInertia[9]; // Row major
+	};
+}
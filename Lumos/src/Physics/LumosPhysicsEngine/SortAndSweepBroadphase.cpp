@@ -35,12 +35,12 @@ namespace Lumos
 	{
 		// Sort entities along axis
 		std::sort(objects.begin(), objects.end(), [this](Ref<RigidBody3D> a, Ref<RigidBody3D> b) -> bool {
-			return a->GetWorldSpaceAABB().min_[this->m_axisIndex] < b->GetWorldSpaceAABB().min_[this->m_axisIndex];
+			return a->GetWorldSpaceAABB(m_Timestep).min_[this->m_axisIndex] < b->GetWorldSpaceAABB(m_Timestep).min_[this->m_axisIndex];
 		});
 
 		for(auto it = objects.begin(); it != objects.end(); ++it)
 		{
-			float thisBoxRight = (*it)->GetWorldSpaceAABB().max_[m_axisIndex];
+			float thisBoxRight = (*it)->GetWorldSpaceAABB(m_Timestep).max_[m_axisIndex];
 
 			for(auto iit = it + 1; iit != objects.end(); ++iit)
 			{
@@ -48,7 +48,7 @@ namespace Lumos
 				if(((*it)->GetIsAtRest() || (*it)->GetIsStatic()) && ((*iit)->GetIsAtRest() || (*iit)->GetIsStatic()))
 					continue;
 
-				float testBoxLeft = (*iit)->GetWorldSpaceAABB().min_[m_axisIndex];
+				float testBoxLeft = (*iit)->GetWorldSpaceAABB(m_Timestep).min_[m_axisIndex];
 
 				// Test for overlap between the axis values of the bounding boxes
 				if(testBoxLeft < thisBoxRight)
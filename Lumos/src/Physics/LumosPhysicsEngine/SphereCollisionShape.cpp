@@ -66,11 +66,11 @@ namespace Lumos
 			*out_max = pos + axis * m_Radius;
 	}
 
-	void SphereCollisionShape::GetIncidentReferencePolygon(const RigidBody3D* currentObject, const Maths::Vector3& axis, std::list<Maths::Vector3>* out_face, Maths::Vector3* out_normal, std::vector<Maths::Plane>* out_adjacent_planes) const
+	void SphereCollisionShape::GetIncidentReferencePolygon(const RigidBody3D* currentObject, const Maths::Vector3& axis, ManifoldPolygon* out_face, Maths::Vector3* out_normal, ManifoldPlanes* out_adjacent_planes) const
 	{
 		if(out_face)
 		{
-			out_face->push_back(currentObject->GetPosition() + axis * m_Radius);
+			out_face->Add(currentObject->GetPosition() + axis * m_Radius);
 		}
 
 		if(out_normal)
@@ -79,6 +79,12 @@ namespace Lumos
 		}
 	}
 
+	Maths::Vector3 SphereCollisionShape::GetLocalSupportPoint(const Maths::Vector3& direction) const
+	{
+		// The whole sphere is margin around its centre
+		return Maths::Vector3(0.0f);
+	}
+
 	void SphereCollisionShape::DebugDraw(const RigidBody3D* currentObject) const
 	{
 		Maths::Matrix4 transform = currentObject->GetWorldSpaceTransform() * m_LocalTransform;
@@ -3,6 +3,7 @@
 #include "ALSoundNode.h"
 #include "Maths/Maths.h"
 #include "Graphics/Camera/Camera.h"
+#include "Scene/Component/SoundComponent.h"
 #include "Utilities/TimeStep.h"
 
 #include <imgui/imgui.h>
@@ -19,6 +20,9 @@ namespace Lumos
 			m_Listener = nullptr;
 
 			m_DebugName = "OpenAL Audio";
+			// The listener is taken from the camera, sound nodes owned by sound components update their sources
+			Reads<Camera>();
+			Writes<SoundComponent>();
 		}
 
 		ALManager::~ALManager()
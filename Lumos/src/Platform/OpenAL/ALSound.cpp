@@ -1,19 +1,18 @@
 #include "Precompiled.h"
 #include "ALSound.h"
 
-#include "Audio/WavLoader.h"
-#include "Audio/OggLoader.h"
-
 namespace Lumos
 {
 	ALSound::ALSound(const std::string& fileName, const std::string& format)
+		: ALSound(fileName, Sound::LoadData(fileName, format))
+	{
+	}
+
+	ALSound::ALSound(const std::string& fileName, const AudioData& data)
 		: m_Format(0)
 	{
 		m_FilePath = fileName;
-		if(format == "wav")
-			m_Data = LoadWav(fileName);
-		else if(format == "ogg")
-			m_Data = LoadOgg(fileName);
+		m_Data = data;
 
 		alGenBuffers(1, &m_Buffer);
 		alBufferData(m_Buffer, GetOALFormat(m_Data.BitRate, m_Data.Channels), m_Data.Data, m_Data.Size, static_cast<ALsizei>(m_Data.FreqRate));
@@ -59,9 +59,14 @@ namespace Lumos
         {
             m_Shader->Bind();
 
+			// Updating a binding again replaces its buffer, as vkUpdateDescriptorSets does
 			for (auto& bufferInfo : bufferInfos)
 			{
-				m_BufferInfos.push_back(bufferInfo);
+				auto existing = std::find_if(m_BufferInfos.begin(), m_BufferInfos.end(), [&bufferInfo](const BufferInfo& info) { return info.binding == bufferInfo.binding; });
+				if (existing != m_BufferInfos.end())
+					*existing = bufferInfo;
+				else
+					m_BufferInfos.push_back(bufferInfo);
 			}
         }
 
@@ -207,6 +207,11 @@ namespace Lumos
 			//GLCall(glDrawArrays(GLTools::DrawTypeToGL(type), start, count));
 		}
 
+		void GLRenderer::DrawIndexedInstancedInternal(CommandBuffer* commandBuffer, const DrawType type, u32 count, u32 instanceCount, u32 start) const
+		{
+			GLCall(glDrawElementsInstanced(GLTools::DrawTypeToGL(type), count, GLTools::DataTypeToGL(DataType::UNSIGNED_INT), nullptr, instanceCount));
+		}
+
 		void GLRenderer::BindDescriptorSetsInternal(Graphics::Pipeline* pipeline, Graphics::CommandBuffer* cmdBuffer, u32 dynamicOffset, std::vector<Graphics::DescriptorSet*>& descriptorSets)
 		{
 			for(auto descriptor : descriptorSets)
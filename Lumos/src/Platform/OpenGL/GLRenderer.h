@@ -33,6 +33,7 @@ namespace Lumos
 			void BindDescriptorSetsInternal(Graphics::Pipeline* pipeline, Graphics::CommandBuffer* cmdBuffer, u32 dynamicOffset, std::vector<Graphics::DescriptorSet*>& descriptorSets) override;
 			void DrawInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, DataType dataType, void* indices) const override;
 			void DrawIndexedInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, u32 start) const override;
+			void DrawIndexedInstancedInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, u32 instanceCount, u32 start) const override;
 			void SetRenderModeInternal(RenderMode mode);
 			void OnResize(u32 width, u32 height) override;
 			void PresentInternal() override;
@@ -50,6 +50,20 @@ namespace Lumos
 			glUnmapBuffer(GL_UNIFORM_BUFFER);
 		}
 
+		void GLUniformBuffer::SetDynamicDataRange(uint32_t offset, uint32_t size, uint32_t typeSize, const void* data)
+		{
+			m_Dynamic = true;
+			m_DynamicTypeSize = typeSize;
+
+			if(size == 0)
+				return;
+
+			glBindBuffer(GL_UNIFORM_BUFFER, m_Handle);
+			GLvoid* p = glMapBufferRange(GL_UNIFORM_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+			memcpy(p, data, size);
+			glUnmapBuffer(GL_UNIFORM_BUFFER);
+		}
+
 		void GLUniformBuffer::Bind(u32 slot, GLShader* shader, std::string& name)
 		{
 			GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, slot, m_Handle));
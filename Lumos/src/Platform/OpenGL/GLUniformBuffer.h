@@ -16,6 +16,7 @@ namespace Lumos
 			void Init(uint32_t size, const void* data) override;
 			void SetData(uint32_t size, const void* data) override;
 			void SetDynamicData(uint32_t size, uint32_t typeSize, const void* data) override;
+			void SetDynamicDataRange(uint32_t offset, uint32_t size, uint32_t typeSize, const void* data) override;
 
 			void Bind(u32 slot, GLShader* shader, std::string& name);
 
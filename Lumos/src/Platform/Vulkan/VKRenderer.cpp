@@ -157,6 +157,12 @@ namespace Lumos
 			vkCmdDrawIndexed(static_cast<VKCommandBuffer*>(commandBuffer)->GetCommandBuffer(), count, 1, 0, 0, 0);
 		}
 
+		void VKRenderer::DrawIndexedInstancedInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, u32 instanceCount, u32 start) const
+		{
+			LUMOS_PROFILE_FUNCTION();
+			vkCmdDrawIndexed(static_cast<VKCommandBuffer*>(commandBuffer)->GetCommandBuffer(), count, instanceCount, 0, 0, 0);
+		}
+
 		void VKRenderer::DrawInternal(CommandBuffer* commandBuffer, DrawType type, u32 count, DataType datayType, void* indices) const
 		{
 			LUMOS_PROFILE_FUNCTION();
@@ -42,6 +42,17 @@ namespace Lumos
 			VKBuffer::Flush(size);
 			VKBuffer::UnMap();
 		}
+
+		void VKUniformBuffer::SetDynamicDataRange(uint32_t offset, uint32_t size, uint32_t typeSize, const void* data)
+		{
+			if(size == 0)
+				return;
+
+			VKBuffer::Map();
+			memcpy(static_cast<u8*>(m_Mapped) + offset, data, size);
+			VKBuffer::Flush(size, offset);
+			VKBuffer::UnMap();
+		}
         
         void VKUniformBuffer::MakeDefault()
         {
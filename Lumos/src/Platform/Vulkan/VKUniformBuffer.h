@@ -22,6 +22,7 @@ namespace Lumos
 
 			void SetData(uint32_t size, const void* data) override;
 			void SetDynamicData(uint32_t size,  uint32_t typeSize, const void* data) override;
+			void SetDynamicDataRange(uint32_t offset, uint32_t size, uint32_t typeSize, const void* data) override;
 
 			VkBuffer* GetBuffer() { return &m_Buffer; }
 			VkDeviceMemory* GetMemory() { return &m_Memory; }
@@ -17,6 +17,19 @@ namespace Lumos
 	{
 	}
 
+	// Bodies belong to the physics thread while it steps in the threaded step mode
+	static void WaitForPhysicsThread()
+	{
+		if(auto physics = Application::Get().GetSystem<LumosPhysicsEngine>())
+			physics->WaitForPhysicsThread();
+	}
+
+	const Ref<RigidBody3D>& Physics3DComponent::GetRigidBody() const
+	{
+		WaitForPhysicsThread();
+		return m_RigidBody;
+	}
+
 	void Physics3DComponent::Init()
 	{
 	}
@@ -27,6 +40,8 @@ namespace Lumos
 
 	void Physics3DComponent::OnImGui()
 	{
+		WaitForPhysicsThread();
+
 		ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(2, 2));
 		ImGui::Columns(2);
 		ImGui::Separator();
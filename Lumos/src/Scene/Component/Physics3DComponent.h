@@ -53,6 +53,8 @@ namespace Lumos
 
 	class LUMOS_EXPORT Physics3DComponent
 	{
+		friend class LumosPhysicsEngine;
+
 	public:
 		Physics3DComponent();
 		explicit Physics3DComponent(Ref<RigidBody3D>& physics);
@@ -63,10 +65,8 @@ namespace Lumos
 		void Update();
 		void OnImGui();
 
-		const Ref<RigidBody3D>& GetRigidBody() const
-		{
-			return m_RigidBody;
-		}
+		// Waits for the physics thread first, the body belongs to it while it steps
+		const Ref<RigidBody3D>& GetRigidBody() const;
 
 		template<typename Archive>
 		void save(Archive& archive) const
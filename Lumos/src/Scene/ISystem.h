@@ -6,6 +6,14 @@ namespace Lumos
 {
 	class TimeStep;
 
+	// Component access declared by a system, used by the SystemManager to decide which systems can update in parallel
+	struct SystemComponentAccess
+	{
+		size_t typeID;
+		bool write;
+		void (*prepare)(entt::registry& registry); // Creates the component pool up front so parallel systems never mutate the registry
+	};
+
 	class LUMOS_EXPORT ISystem
 	{
 	public:
@@ -22,7 +30,46 @@ namespace Lumos
 			return m_DebugName;
 		}
 
+		_FORCE_INLINE_ const std::vector<SystemComponentAccess>& GetComponentAccess() const
+		{
+			return m_ComponentAccess;
+		}
+
+		// Two systems conflict if one writes a component the other one reads or writes. A system that hasn't
+		// declared any access could touch anything, so it conflicts with every other system.
+		bool ConflictsWith(const ISystem& other) const
+		{
+			if(m_ComponentAccess.empty() || other.m_ComponentAccess.empty())
+				return true;
+
+			for(auto& access : m_ComponentAccess)
+			{
+				for(auto& otherAccess : other.m_ComponentAccess)
+				{
+					if(access.typeID == otherAccess.typeID && (access.write || otherAccess.write))
+						return true;
+				}
+			}
+
+			return false;
+		}
+
 	protected:
+		// Declare the components OnUpdate touches so the system can update in parallel with systems it doesn't
+		// conflict with. Systems that declare nothing are treated as exclusive and never overlap another system.
+		template<typename Component>
+		void Reads()
+		{
+			m_ComponentAccess.push_back({typeid(Component).hash_code(), false, [](entt::registry& registry) { registry.prepare<Component>(); }});
+		}
+
+		template<typename Component>
+		void Writes()
+		{
+			m_ComponentAccess.push_back({typeid(Component).hash_code(), true, [](entt::registry& registry) { registry.prepare<Component>(); }});
+		}
+
 		std::string m_DebugName;
+		std::vector<SystemComponentAccess> m_ComponentAccess;
 	};
 }
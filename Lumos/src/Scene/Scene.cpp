@@ -11,6 +11,7 @@
 #include "Utilities/TimeStep.h"
 #include "Audio/AudioManager.h"
 #include "Physics/LumosPhysicsEngine/SortAndSweepBroadphase.h"
+#include "Physics/LumosPhysicsEngine/DynamicTreeBroadphase.h"
 #include "Physics/LumosPhysicsEngine/Octree.h"
 #include "Physics/LumosPhysicsEngine/LumosPhysicsEngine.h"
 #include "Physics/LumosPhysicsEngine/SphereCollisionShape.h"
@@ -28,6 +29,7 @@
 #include "Graphics/Model.h"
 #include "Graphics/Environment.h"
 #include "Scene/EntityManager.h"
+#include "Scene/SceneLoadContext.h"
 #include "Scene/Component/SoundComponent.h"
 
 #include <cereal/types/polymorphic.hpp>
@@ -75,7 +77,7 @@ namespace Lumos
 		//Default physics setup
 		Application::Get().GetSystem<LumosPhysicsEngine>()->SetDampingFactor(0.998f);
 		Application::Get().GetSystem<LumosPhysicsEngine>()->SetIntegrationType(IntegrationType::RUNGE_KUTTA_4);
-		Application::Get().GetSystem<LumosPhysicsEngine>()->SetBroadphase(Lumos::CreateRef<Octree>(5, 3, Lumos::CreateRef<SortAndSweepBroadphase>()));
+		Application::Get().GetSystem<LumosPhysicsEngine>()->SetBroadphase(Lumos::CreateRef<DynamicTreeBroadphase>());
 
 		m_SceneGraph.Init(m_EntityManager->GetRegistry());
 
@@ -226,13 +228,15 @@ namespace Lumos
 			}
 
 			std::ifstream file(path, std::ios::binary);
-			cereal::BinaryInputArchive input(file);
+			SceneLoadContext context = {};
+			SceneInputArchive<cereal::BinaryInputArchive> input(context, file);
 			input(*this);
+			context.Version = m_SceneSerialisationVersion;
 			if(m_SceneSerialisationVersion < 2)
 				entt::snapshot_loader{m_EntityManager->GetRegistry()}.entities(input).component<ALL_COMPONENTSV1>(input);
 			else if(m_SceneSerialisationVersion == 3)
 				entt::snapshot_loader{m_EntityManager->GetRegistry()}.entities(input).component<ALL_COMPONENTSV2>(input);
-			else if(m_SceneSerialisationVersion == 4)
+			else if(m_SceneSerialisationVersion >= 4)
 				entt::snapshot_loader{m_EntityManager->GetRegistry()}.entities(input).component<ALL_COMPONENTSV3>(input);
 		}
 		else
@@ -247,14 +251,16 @@ namespace Lumos
 			std::string data = FileSystem::ReadTextFile(path);
 			std::istringstream istr;
 			istr.str(data);
-			cereal::JSONInputArchive input(istr);
+			SceneLoadContext context = {};
+			SceneInputArchive<cereal::JSONInputArchive> input(context, istr);
 			input(*this);
+			context.Version = m_SceneSerialisationVersion;
 			
 			if(m_SceneSerialisationVersion < 2)
 				entt::snapshot_loader{m_EntityManager->GetRegistry()}.entities(input).component<ALL_COMPONENTSV1>(input);
 			else if(m_SceneSerialisationVersion == 3)
 				entt::snapshot_loader{m_EntityManager->GetRegistry()}.entities(input).component<ALL_COMPONENTSV2>(input);
-			else if(m_SceneSerialisationVersion == 4)
+			else if(m_SceneSerialisationVersion >= 4)
 				entt::snapshot_loader{m_EntityManager->GetRegistry()}.entities(input).component<ALL_COMPONENTSV3>(input);
 		}
         
@@ -125,7 +125,8 @@ namespace Lumos
 		template<typename Archive>
 		void save(Archive& archive) const
 		{
-			archive(cereal::make_nvp("Version", 4));
+			// 5 : RigidBody3D ContinuousCollision
+			archive(cereal::make_nvp("Version", 5));
 			archive(cereal::make_nvp("Scene Name", m_SceneName));
 		}
 		
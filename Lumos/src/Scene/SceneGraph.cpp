@@ -1,11 +1,24 @@
 #include "Precompiled.h"
 #include "SceneGraph.h"
 #include "Maths/Transform.h"
+#include "Maths/MatrixBatch.h"
+#include "Core/JobSystem.h"
 
 #include <entt/entt.hpp>
 
+#define SCENEGRAPH_NODES_PER_JOB 256
+
 namespace Lumos
 {
+	namespace
+	{
+		// Bumped whenever the flattened hierarchy needs rebuilding, starts at 1 so a new scene graph always builds
+		struct HierarchyVersion
+		{
+			u32 value = 1;
+		};
+	}
+
     Hierarchy::Hierarchy(entt::entity p) : _parent(p)
     {
         _first = entt::null;
@@ -30,29 +43,179 @@ namespace Lumos
 		registry.on_construct<Hierarchy>().connect<&Hierarchy::on_construct>();
 		registry.on_update<Hierarchy>().connect<&Hierarchy::on_update>();
 		registry.on_destroy<Hierarchy>().connect<&Hierarchy::on_destroy>();
+
+		// Adding or removing transforms also moves them in memory, so cached pointers are rebuilt too
+		registry.on_construct<Hierarchy>().connect<&SceneGraph::OnHierarchyChanged>();
+		registry.on_update<Hierarchy>().connect<&SceneGraph::OnHierarchyChanged>();
+		registry.on_destroy<Hierarchy>().connect<&SceneGraph::OnHierarchyChanged>();
+		registry.on_construct<Maths::Transform>().connect<&SceneGraph::OnHierarchyChanged>();
+		registry.on_destroy<Maths::Transform>().connect<&SceneGraph::OnHierarchyChanged>();
+	}
+
+	void SceneGraph::OnHierarchyChanged(entt::registry& registry, entt::entity entity)
+	{
+		registry.ctx_or_set<HierarchyVersion>().value++;
 	}
 
 	void SceneGraph::Update(entt::registry & registry)
-    {
+	{
 		LUMOS_PROFILE_FUNCTION();
-        auto nonHierarchyView = registry.view<Maths::Transform>(entt::exclude<Hierarchy>);
-    
-        for(auto entity : nonHierarchyView)
-        {
-            registry.get<Maths::Transform>(entity).SetWorldMatrix(Maths::Matrix4());
-        }
-    
-        auto view = registry.view<Maths::Transform, Hierarchy>();
-        for (auto entity : view)
-        {
-            const auto hierarchy = registry.try_get<Hierarchy>(entity);
-            if (hierarchy && hierarchy->parent() == entt::null)
-            {
-                //Recursively update children
-                UpdateTransform(entity, registry);
-            }
-        }
-    }
+		const u32 version = registry.ctx_or_set<HierarchyVersion>().value;
+		if(version != m_HierarchyVersion)
+		{
+			Rebuild(registry);
+			m_HierarchyVersion = version;
+			m_ForceUpdate = true;
+		}
+
+		const u32 levelCount = static_cast<u32>(m_LevelStarts.size()) - 1;
+
+		for(u32 level = 0; level < levelCount; level++)
+		{
+			const u32 first = m_LevelStarts[level];
+			const u32 last = m_LevelStarts[level + 1];
+
+			if(last - first <= SCENEGRAPH_NODES_PER_JOB)
+			{
+				UpdateNodes(first, last);
+			}
+			else
+			{
+				// Nodes only read their parents, which are all in earlier levels, so a level can be updated in parallel
+				const u32 jobCount = (last - first + SCENEGRAPH_NODES_PER_JOB - 1) / SCENEGRAPH_NODES_PER_JOB;
+				auto job = System::JobSystem::Dispatch(jobCount, 1, [&](JobDispatchArgs args)
+				{
+					const u32 begin = first + args.jobIndex * SCENEGRAPH_NODES_PER_JOB;
+					UpdateNodes(begin, Maths::Min(begin + SCENEGRAPH_NODES_PER_JOB, last));
+				});
+				System::JobSystem::Wait(job);
+			}
+		}
+
+		m_ForceUpdate = false;
+	}
+
+	void SceneGraph::Rebuild(entt::registry& registry)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		m_Transforms.clear();
+		m_Entities.clear();
+		m_Parents.clear();
+		m_LevelStarts.clear();
+		m_LevelStarts.push_back(0);
+
+		auto nonHierarchyView = registry.view<Maths::Transform>(entt::exclude<Hierarchy>);
+
+		for(auto entity : nonHierarchyView)
+			AddNode(registry, entity, -1);
+
+		auto view = registry.view<Maths::Transform, Hierarchy>();
+		for(auto entity : view)
+		{
+			if(view.get<Hierarchy>(entity).parent() == entt::null)
+				AddNode(registry, entity, -1);
+		}
+
+		// Each level holds the children of the level before it
+		u32 levelStart = 0;
+		while(levelStart < static_cast<u32>(m_Transforms.size()))
+		{
+			const u32 levelEnd = static_cast<u32>(m_Transforms.size());
+			m_LevelStarts.push_back(levelEnd);
+
+			for(u32 i = levelStart; i < levelEnd; i++)
+				AddChildren(registry, m_Entities[i], static_cast<i32>(i));
+
+			levelStart = levelEnd;
+		}
+
+		const size_t nodeCount = m_Transforms.size();
+		m_Updated.resize(nodeCount);
+		m_BatchNodes.resize(nodeCount);
+		m_BatchTranslations.resize(nodeCount);
+		m_BatchRotations.resize(nodeCount);
+		m_BatchScales.resize(nodeCount);
+		m_BatchParents.resize(nodeCount);
+		m_BatchMatrices.resize(nodeCount);
+	}
+
+	void SceneGraph::AddNode(entt::registry& registry, entt::entity entity, i32 parent)
+	{
+		m_Transforms.push_back(&registry.get<Maths::Transform>(entity));
+		m_Entities.push_back(entity);
+		m_Parents.push_back(parent);
+	}
+
+	void SceneGraph::AddChildren(entt::registry& registry, entt::entity entity, i32 parent)
+	{
+		auto hierarchyComponent = registry.try_get<Hierarchy>(entity);
+		if(!hierarchyComponent)
+			return;
+
+		entt::entity child = hierarchyComponent->first();
+		while(child != entt::null)
+		{
+			// Children of an entity without a transform are placed relative to its closest ancestor with one
+			if(registry.has<Maths::Transform>(child))
+				AddNode(registry, child, parent);
+			else
+				AddChildren(registry, child, parent);
+
+			auto childHierarchy = registry.try_get<Hierarchy>(child);
+			child = childHierarchy ? childHierarchy->next() : entt::null;
+		}
+	}
+
+	void SceneGraph::UpdateNodes(u32 first, u32 last)
+	{
+		static const Maths::Matrix3x4 identity;
+
+		// Compose the local matrices of transforms changed since the last update
+		u32 count = 0;
+		for(u32 i = first; i < last; i++)
+		{
+			Maths::Transform* transform = m_Transforms[i];
+			if(transform->IsDirty())
+			{
+				m_BatchNodes[first + count] = i;
+				m_BatchTranslations[first + count] = transform->GetLocalPosition();
+				m_BatchRotations[first + count] = transform->GetLocalOrientation();
+				m_BatchScales[first + count] = transform->GetLocalScale();
+				count++;
+			}
+		}
+
+		Maths::ComposeTRS(m_BatchTranslations.data() + first, m_BatchRotations.data() + first, m_BatchScales.data() + first, m_BatchMatrices.data() + first, count);
+		for(u32 i = first; i < first + count; i++)
+			m_Transforms[m_BatchNodes[i]]->SetComposedLocalMatrix(m_BatchMatrices[i]);
+
+		// Then the world matrices of transforms whose local matrix or parent changed
+		count = 0;
+		for(u32 i = first; i < last; i++)
+		{
+			Maths::Transform* transform = m_Transforms[i];
+			const i32 parent = m_Parents[i];
+
+			const bool update = m_ForceUpdate || transform->HasUpdated() || (parent >= 0 && m_Updated[parent]);
+			m_Updated[i] = update;
+
+			if(update)
+			{
+				m_BatchNodes[first + count] = i;
+				m_BatchParents[first + count] = parent >= 0 ? m_Transforms[parent]->GetWorldMatrix3x4() : identity;
+				m_BatchMatrices[first + count] = transform->GetLocalMatrix3x4();
+				count++;
+			}
+		}
+
+		Maths::MultiplyAffine(m_BatchParents.data() + first, m_BatchMatrices.data() + first, m_BatchMatrices.data() + first, count);
+		for(u32 i = first; i < first + count; i++)
+		{
+			Maths::Transform* transform = m_Transforms[m_BatchNodes[i]];
+			transform->SetComposedWorldMatrix(m_BatchMatrices[i]);
+			transform->SetHasUpdated(false);
+		}
+	}
 
 	void SceneGraph::UpdateTransform(entt::entity entity, entt::registry & registry)
 	{
@@ -68,12 +231,12 @@ namespace Lumos
 					auto parentTransform = registry.try_get<Maths::Transform>(hierarchyComponent->parent());
 					if (parentTransform)
 					{
-						transform->SetWorldMatrix(parentTransform->GetWorldMatrix());
+						transform->SetWorldMatrix(parentTransform->GetWorldMatrix3x4());
 					}
 				}
 				else
 					{
-					transform->SetWorldMatrix(Maths::Matrix4());
+					transform->SetWorldMatrix(Maths::Matrix3x4());
 				}
 			}
 
@@ -91,8 +254,14 @@ namespace Lumos
 	void Hierarchy::Reparent(entt::entity entity, entt::entity parent, entt::registry& registry, Hierarchy& hierarchy)
 	{
 		LUMOS_PROFILE_FUNCTION();
+		SceneGraph::OnHierarchyChanged(registry, entity);
 		Hierarchy::on_destroy(registry, entity);
 
+		// The old links would keep the entity in its previous parent's child list
+		hierarchy._parent = entt::null;
+		hierarchy._next = entt::null;
+		hierarchy._prev = entt::null;
+
         if(parent != entt::null)
         {
             hierarchy._parent = parent;
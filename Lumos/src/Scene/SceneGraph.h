@@ -5,12 +5,17 @@
 #include "Graphics/Camera/Camera2D.h"
 #include "Graphics/Camera/FPSCamera.h"
 #include "Editor/EditorCamera.h"
+#include "Maths/Matrix3x4.h"
 
 #include <entt/entity/fwd.hpp>
 #include <cereal/cereal.hpp>
 
 namespace Lumos
 {
+	namespace Maths
+	{
+		class Transform;
+	}
 
 	class DefaultCameraController
 	{
@@ -221,7 +226,35 @@ namespace Lumos
         
         void DisableOnConstruct(bool disable, entt::registry& registry);
 
+		// Updates world matrices of transforms whose local matrix changed since the last update, and their children
 		void Update(entt::registry& registry);
 		void UpdateTransform(entt::entity entity, entt::registry& registry);
+
+		// Flags the flattened hierarchy for a rebuild, called when transforms or hierarchy links change
+		static void OnHierarchyChanged(entt::registry& registry, entt::entity entity);
+
+	private:
+		void Rebuild(entt::registry& registry);
+		void AddNode(entt::registry& registry, entt::entity entity, i32 parent);
+		void AddChildren(entt::registry& registry, entt::entity entity, i32 parent);
+		void UpdateNodes(u32 first, u32 last);
+
+		// Transforms ordered by depth so parents come before their children and every depth level is contiguous
+		std::vector<Maths::Transform*> m_Transforms;
+		std::vector<entt::entity> m_Entities;
+		std::vector<i32> m_Parents; // Index into m_Transforms, -1 for roots
+		std::vector<u8> m_Updated;
+		std::vector<u32> m_LevelStarts; // First node of each depth level, ends with the node count
+
+		// Inputs and outputs of the batched matrix kernels, one per node. A job only uses the range of the nodes it updates.
+		std::vector<u32> m_BatchNodes;
+		std::vector<Maths::Vector3> m_BatchTranslations;
+		std::vector<Maths::Quaternion> m_BatchRotations;
+		std::vector<Maths::Vector3> m_BatchScales;
+		std::vector<Maths::Matrix3x4> m_BatchParents;
+		std::vector<Maths::Matrix3x4> m_BatchMatrices;
+
+		u32 m_HierarchyVersion = 0;
+		bool m_ForceUpdate = true;
 	};
 }
@@ -0,0 +1,27 @@
+#pragma once
+
+// UserDataAdapter and get_user_data are only declared with this defined
+#ifndef CEREAL_FUTURE_EXPERIMENTAL
+#define CEREAL_FUTURE_EXPERIMENTAL
+#endif
+#include <cereal/archives/adapters.hpp>
+
+namespace Lumos
+{
+	// Scene::Deserialise reads components through a cereal::UserDataAdapter holding this, so a component's load
+	// only reads the fields the scene file was saved with
+	struct SceneLoadContext
+	{
+		int Version;
+	};
+
+	template<typename Archive>
+	using SceneInputArchive = cereal::UserDataAdapter<SceneLoadContext, Archive>;
+
+	// Version of the scene file being read. The archive has to be a SceneInputArchive
+	template<typename Archive>
+	int GetSceneLoadingVersion(Archive& archive)
+	{
+		return cereal::get_user_data<SceneLoadContext>(archive).Version;
+	}
+}
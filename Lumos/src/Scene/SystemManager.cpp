@@ -0,0 +1,105 @@
+#include "Precompiled.h"
+#include "SystemManager.h"
+
+namespace Lumos
+{
+	void SystemManager::BuildSchedule()
+	{
+		LUMOS_PROFILE_FUNCTION();
+		const u32 systemCount = static_cast<u32>(m_SystemOrder.size());
+
+		m_Dependents.clear();
+		m_Dependents.resize(systemCount);
+		m_DependencyCounts.assign(systemCount, 0);
+		m_RemainingDependencies = std::vector<std::atomic<u32>>(systemCount);
+
+		// A system depends on every earlier registered system it conflicts with.
+		// Edges that are already implied by another path are skipped to keep the graph small.
+		std::vector<std::vector<bool>> reachable(systemCount, std::vector<bool>(systemCount, false));
+
+		for(u32 i = 0; i < systemCount; i++)
+		{
+			for(u32 j = i; j-- > 0;)
+			{
+				if(reachable[i][j] || !m_SystemOrder[i]->ConflictsWith(*m_SystemOrder[j]))
+					continue;
+
+				m_Dependents[j].push_back(i);
+				m_DependencyCounts[i]++;
+
+				reachable[i][j] = true;
+				for(u32 k = 0; k < j; k++)
+				{
+					if(reachable[j][k])
+						reachable[i][k] = true;
+				}
+			}
+		}
+
+		m_ScheduleDirty = false;
+	}
+
+	void SystemManager::RunSystem(System::JobSystem::JobHandle frameJob, u32 index, const TimeStep& dt, Scene* scene)
+	{
+		System::JobSystem::Run(System::JobSystem::CreateChildJob(frameJob, [this, frameJob, index, &dt, scene]() {
+			m_SystemOrder[index]->OnUpdate(dt, scene);
+
+			// Kick off dependents once all of their dependencies have finished.
+			// Dependents are stored in registration order so release order is stable.
+			for(u32 dependent : m_Dependents[index])
+			{
+				if(m_RemainingDependencies[dependent].fetch_sub(1) == 1)
+					RunSystem(frameJob, dependent, dt, scene);
+			}
+		}));
+	}
+
+	void SystemManager::OnUpdate(const TimeStep& dt, Scene* scene)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		if(m_ScheduleDirty)
+			BuildSchedule();
+
+		if(!m_ParallelUpdate || m_SystemOrder.size() < 2 || !scene)
+		{
+			for(auto& system : m_SystemOrder)
+				system->OnUpdate(dt, scene);
+			return;
+		}
+
+		// Make sure every component pool exists before systems start touching the registry from other threads
+		auto& registry = scene->GetRegistry();
+		for(auto& system : m_SystemOrder)
+		{
+			for(auto& access : system->GetComponentAccess())
+				access.prepare(registry);
+		}
+
+		const u32 systemCount = static_cast<u32>(m_SystemOrder.size());
+		for(u32 i = 0; i < systemCount; i++)
+			m_RemainingDependencies[i].store(m_DependencyCounts[i]);
+
+		auto frameJob = System::JobSystem::CreateJob();
+
+		for(u32 i = 0; i < systemCount; i++)
+		{
+			if(m_DependencyCounts[i] == 0)
+				RunSystem(frameJob, i, dt, scene);
+		}
+
+		System::JobSystem::Run(frameJob);
+		System::JobSystem::Wait(frameJob);
+	}
+
+	void SystemManager::OnImGui()
+	{
+		for(auto& system : m_SystemOrder)
+			system->OnImGui();
+	}
+
+	void SystemManager::OnDebugDraw()
+	{
+		for(auto& system : m_SystemOrder)
+			system->OnDebugDraw();
+	}
+}
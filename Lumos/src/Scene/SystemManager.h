@@ -1,5 +1,6 @@
 #pragma once
 #include "Scene/ISystem.h"
+#include "Core/JobSystem.h"
 
 namespace Lumos
 {
@@ -15,7 +16,9 @@ namespace Lumos
 
 			// Create a pointer to the system and return it so it can be used externally
 			Ref<T> system = CreateRef<T>(std::forward<Args>(args)...);
-			m_Systems.insert({typeName, std::move(system)});
+			m_Systems.insert({typeName, system});
+			m_SystemOrder.push_back(system);
+			m_ScheduleDirty = true;
 			return system;
 		}
 
@@ -28,7 +31,9 @@ namespace Lumos
 
 			// Create a pointer to the system and return it so it can be used externally
 			Ref<T> system = Ref<T>(t);
-			m_Systems.insert({typeName, std::move(system)});
+			m_Systems.insert({typeName, system});
+			m_SystemOrder.push_back(system);
+			m_ScheduleDirty = true;
 			return system;
 		}
 
@@ -37,9 +42,12 @@ namespace Lumos
 		{
 			auto typeName = typeid(T).hash_code();
 
-			if(m_Systems.find(typeName) != m_Systems.end())
+			auto it = m_Systems.find(typeName);
+			if(it != m_Systems.end())
 			{
-				m_Systems.erase(typeName);
+				m_SystemOrder.erase(std::remove(m_SystemOrder.begin(), m_SystemOrder.end(), it->second), m_SystemOrder.end());
+				m_Systems.erase(it);
+				m_ScheduleDirty = true;
 			}
 		}
 
@@ -64,26 +72,36 @@ namespace Lumos
 			return m_Systems.find(typeName) != m_Systems.end();
 		}
 
-		void OnUpdate(const TimeStep& dt, Scene* scene)
-		{
-			for(auto& system : m_Systems)
-				system.second->OnUpdate(dt, scene);
-		}
+		// Updates systems in registration order, running systems with no conflicting component access in parallel
+		void OnUpdate(const TimeStep& dt, Scene* scene);
+		void OnImGui();
+		void OnDebugDraw();
 
-		void OnImGui()
+		bool GetParallelUpdate() const
 		{
-			for(auto& system : m_Systems)
-				system.second->OnImGui();
+			return m_ParallelUpdate;
 		}
-
-		void OnDebugDraw()
+		void SetParallelUpdate(bool parallel)
 		{
-			for(auto& system : m_Systems)
-				system.second->OnDebugDraw();
+			m_ParallelUpdate = parallel;
 		}
 
 	private:
+		void BuildSchedule();
+		void RunSystem(System::JobSystem::JobHandle frameJob, u32 index, const TimeStep& dt, Scene* scene);
+
 		// Map from system type string pointer to a system pointer
 		std::unordered_map<size_t, Ref<ISystem>> m_Systems;
+
+		// Systems in registration order, conflicting systems always update in this order
+		std::vector<Ref<ISystem>> m_SystemOrder;
+
+		// Dependency graph built from the declared component access. Indices into m_SystemOrder
+		std::vector<std::vector<u32>> m_Dependents;
+		std::vector<u32> m_DependencyCounts;
+		std::vector<std::atomic<u32>> m_RemainingDependencies;
+
+		bool m_ScheduleDirty = true;
+		bool m_ParallelUpdate = true;
 	};
 }
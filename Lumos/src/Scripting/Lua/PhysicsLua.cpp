@@ -4,6 +4,7 @@
 #include "Scene/Component/Physics3DComponent.h"
 #include "Core/Application.h"
 #include "Physics/B2PhysicsEngine/B2PhysicsEngine.h"
+#include "Physics/LumosPhysicsEngine/LumosPhysicsEngine.h"
 
 #include <box2d/box2d.h>
 #include <sol/sol.hpp>
@@ -294,6 +295,62 @@ namespace Lumos
 		Application::Get().GetSystem<B2PhysicsEngine>()->SetContactListener(listener);
 	}
 
+	static sol::optional<RaycastHit> Raycast(const Maths::Vector3& origin, const Maths::Vector3& direction, float maxDistance)
+	{
+		RaycastHit hit;
+		if(!Application::Get().GetSystem<LumosPhysicsEngine>()->Raycast(Maths::Ray(origin, direction), maxDistance, &hit))
+			return sol::nullopt;
+
+		return hit;
+	}
+
+	// Takes parallel tables of origins and directions, misses come back as hits without a body
+	static sol::as_table_t<std::vector<RaycastHit>> RaycastBatch(const sol::table& origins, const sol::table& directions, float maxDistance)
+	{
+		const size_t count = Maths::Min(origins.size(), directions.size());
+
+		std::vector<Maths::Ray> rays(count);
+		for(size_t i = 0; i < count; ++i)
+			rays[i] = Maths::Ray(origins.get<Maths::Vector3>(i + 1), directions.get<Maths::Vector3>(i + 1));
+
+		std::vector<RaycastHit> hits(count);
+		Application::Get().GetSystem<LumosPhysicsEngine>()->RaycastBatch(rays.data(), static_cast<u32>(count), maxDistance, hits.data());
+		return sol::as_table(std::move(hits));
+	}
+
+	static sol::as_table_t<std::vector<RigidBody3D*>> SphereOverlap(const Maths::Vector3& centre, float radius)
+	{
+		std::vector<RigidBody3D*> bodies;
+		Application::Get().GetSystem<LumosPhysicsEngine>()->SphereOverlap(centre, radius, bodies);
+		return sol::as_table(std::move(bodies));
+	}
+
+	static sol::as_table_t<std::vector<RigidBody3D*>> AABBQuery(const Maths::Vector3& min, const Maths::Vector3& max)
+	{
+		std::vector<RigidBody3D*> bodies;
+		Application::Get().GetSystem<LumosPhysicsEngine>()->AABBQuery(Maths::BoundingBox(min, max), bodies);
+		return sol::as_table(std::move(bodies));
+	}
+
+	// Scripts can keep a body between frames, so every call waits until the physics thread is done with it
+	template<typename Class, typename Return, typename... Args>
+	static auto SyncedBodyFunction(Return (Class::*function)(Args...))
+	{
+		return [function](RigidBody3D& body, Args... args) -> std::decay_t<Return> {
+			Application::Get().GetSystem<LumosPhysicsEngine>()->WaitForPhysicsThread();
+			return (body.*function)(args...);
+		};
+	}
+
+	template<typename Class, typename Return, typename... Args>
+	static auto SyncedBodyFunction(Return (Class::*function)(Args...) const)
+	{
+		return [function](const RigidBody3D& body, Args... args) -> std::decay_t<Return> {
+			Application::Get().GetSystem<LumosPhysicsEngine>()->WaitForPhysicsThread();
+			return (body.*function)(args...);
+		};
+	}
+
 	Ref<RigidBody3D> CreateSharedPhysics3D()
 	{
 		return CreateRef<RigidBody3D>();
@@ -323,15 +380,28 @@ namespace Lumos
 		physicsObjectParameters_type["customShapePositions"] = &RigidBodyParameters::custumShapePositions;
 
 		sol::usertype<RigidBody3D> physics3D_type = state.new_usertype<RigidBody3D>("RigidBody3D", sol::constructors<RigidBody2D>());//;const RigidBodyParameters&)>());
-		physics3D_type.set_function("SetForce", &RigidBody3D::SetForce);
-		physics3D_type.set_function("SetPosition", &RigidBody3D::SetPosition);
-		physics3D_type.set_function("SetLinearVelocity", &RigidBody3D::SetLinearVelocity);
-		physics3D_type.set_function("SetOrientation", &RigidBody3D::SetOrientation);
-		physics3D_type.set_function("SetAngularVelocity", &RigidBody3D::SetAngularVelocity);
-		physics3D_type.set_function("SetFriction", &RigidBody3D::SetFriction);
-		physics3D_type.set_function("GetPosition", &RigidBody3D::GetPosition);
-		physics3D_type.set_function("GetFriction", &RigidBody3D::GetFriction);
-		physics3D_type.set_function("GetIsStatic", &RigidBody3D::GetIsStatic);
+		physics3D_type.set_function("SetForce", SyncedBodyFunction(&RigidBody3D::SetForce));
+		physics3D_type.set_function("SetPosition", SyncedBodyFunction(&RigidBody3D::SetPosition));
+		physics3D_type.set_function("SetLinearVelocity", SyncedBodyFunction(&RigidBody3D::SetLinearVelocity));
+		physics3D_type.set_function("SetOrientation", SyncedBodyFunction(&RigidBody3D::SetOrientation));
+		physics3D_type.set_function("SetAngularVelocity", SyncedBodyFunction(&RigidBody3D::SetAngularVelocity));
+		physics3D_type.set_function("SetFriction", SyncedBodyFunction(&RigidBody3D::SetFriction));
+		physics3D_type.set_function("GetPosition", SyncedBodyFunction(&RigidBody3D::GetPosition));
+		physics3D_type.set_function("GetFriction", SyncedBodyFunction(&RigidBody3D::GetFriction));
+		physics3D_type.set_function("GetIsStatic", SyncedBodyFunction(&RigidBody3D::GetIsStatic));
+		physics3D_type.set_function("GetContinuousCollision", SyncedBodyFunction(&RigidBody3D::GetContinuousCollision));
+		physics3D_type.set_function("SetContinuousCollision", SyncedBodyFunction(&RigidBody3D::SetContinuousCollision));
+
+		sol::usertype<RaycastHit> raycastHit_type = state.new_usertype<RaycastHit>("RaycastHit");
+		raycastHit_type["body"] = &RaycastHit::body;
+		raycastHit_type["point"] = &RaycastHit::point;
+		raycastHit_type["normal"] = &RaycastHit::normal;
+		raycastHit_type["distance"] = &RaycastHit::distance;
+
+		state.set_function("Raycast", &Raycast);
+		state.set_function("RaycastBatch", &RaycastBatch);
+		state.set_function("SphereOverlap", &SphereOverlap);
+		state.set_function("AABBQuery", &AABBQuery);
 
 		std::initializer_list<std::pair<sol::string_view, Shape>> shapes =
 			{
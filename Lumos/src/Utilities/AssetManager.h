@@ -2,126 +2,452 @@
 
 #include "Core/VFS.h"
 #include "Audio/Sound.h"
+#include "Core/Profiler.h"
+
+#include <mutex>
 
 namespace Lumos
 {
+	// Handle to a resource cached by a ResourceManager. Slots are reused once evicted, the generation tells
+	// a stale handle apart so it resolves to nullptr instead of whatever took its place.
+	template<typename T>
+	struct ResourceHandle
+	{
+		u32 index = ~0u;
+		u32 generation = 0;
+
+		bool IsValid() const { return index != ~0u; }
+		bool operator==(const ResourceHandle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const ResourceHandle& other) const { return !(*this == other); }
+	};
+
+	// Thread safe cache of resources of one type, keyed by their path. Without a budget, resources
+	// only held by the cache are dropped by the next Update. With one they stay loaded until the type's bytes
+	// exceed it, then the least recently used are evicted.
 	template<typename T>
 	class ResourceManager
 	{
 	public:
 		typedef T Type;
 		typedef std::string IDType;
-		typedef Ref<T> ResourceHandle;
-
-		struct Resource
-		{
-			float timeSinceReload;
-			ResourceHandle data;
-			bool onDisk;
-		};
-
-		typedef std::unordered_map<IDType, Resource> MapType;
+		typedef ResourceHandle<T> Handle;
 
 		typedef std::function<bool(const IDType&, T&)> LoadFunc;
 		typedef std::function<void(T&)> ReleaseFunc;
 		typedef std::function<bool(const IDType&, T&)> ReloadFunc;
 		typedef std::function<IDType(const T&)> GetIdFunc;
+		typedef std::function<u64(const T&)> SizeFunc;
 
-		static ResourceHandle GetResource(const IDType& name)
+		struct Statistics
 		{
-			typename MapType::iterator itr = m_nameResourceMap.find(name);
-			if(itr != m_nameResourceMap.end())
-			{
-				return itr->second.data;
-			}
+			u64 hits = 0;
+			u64 misses = 0;
+			u64 evictions = 0;
+			u64 loadFailures = 0;
+			u64 residentBytes = 0;
+			u64 budget = 0; // NoBudget unless SetBudget was called
+			u32 resources = 0;
+		};
 
-			ResourceHandle resourceData(new T);
-			if(!m_loadFunc(name, *resourceData))
-			{
-				std::cerr << "ERROR: Resource Manager could not load resource name \"" << name << "\" of type " << typeid(T).name() << std::endl;
-				return ResourceHandle(nullptr);
-			}
+		static constexpr u64 NoBudget = ~0ull;
 
-			Resource newResource;
-			newResource.data = resourceData;
-			newResource.timeSinceReload = 0;
-			newResource.onDisk = true;
-			m_nameResourceMap.emplace(name, newResource);
+		// Cached resource for name, loaded on a miss. Returns an invalid handle if loading fails.
+		static Handle Load(const IDType& name)
+		{
+			return Acquire(name, nullptr);
+		}
 
-			return resourceData;
+		// Caches data that doesn't come from a file under the id from the GetIdFunction
+		static Handle Add(const T& data)
+		{
+			return Acquire(data, nullptr);
 		}
 
-		static ResourceHandle GetResource(const T& data)
+		// Cached resource for name without loading it
+		static Handle Find(const IDType& name)
 		{
-			IDType newId = m_getIdFunc(data);
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			u32 index = FindIndex(name);
+			if(index == InvalidIndex)
+				return Handle();
 
-			typename MapType::iterator itr = m_nameResourceMap.find(newId);
-			if(itr == m_nameResourceMap.end())
-			{
-				ResourceHandle resourceData(new T);
-				*resourceData = data;
+			return { index, m_Resources[index].generation };
+		}
 
-				Resource newResource;
-				newResource.data = resourceData;
-				newResource.timeSinceReload = 0;
-				newResource.onDisk = false;
-				m_nameResourceMap.emplace(newId, newResource);
+		// nullptr once the resource has been evicted
+		static Ref<T> Get(Handle handle)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if(!IsValid(handle))
+				return Ref<T>();
 
-				return resourceData;
-			}
+			Touch(handle.index);
+			return m_Resources[handle.index].data;
+		}
 
-			return itr->second.data;
+		static bool IsResident(Handle handle)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return IsValid(handle);
+		}
+
+		// Like Get(Load(name)), but the data is taken in the same lock as the lookup, so it can't be evicted in between
+		static Ref<T> GetResource(const IDType& name)
+		{
+			Ref<T> data;
+			Acquire(name, &data);
+			return data;
+		}
+
+		static Ref<T> GetResource(const T& data)
+		{
+			Ref<T> resource;
+			Acquire(data, &resource);
+			return resource;
 		}
 
 		static void Destroy()
 		{
-			typename MapType::iterator itr = m_nameResourceMap.begin();
-			while(itr != m_nameResourceMap.end())
+			std::vector<Ref<T>> released;
 			{
-				m_releaseFunc(*(itr->second.data));
-				++itr;
+				// Slots are kept with their generation bumped, so handles from before can't resolve to later resources
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				for(u32 i = 0; i < u32(m_Resources.size()); i++)
+				{
+					auto& resource = m_Resources[i];
+					if(resource.data)
+					{
+						released.push_back(std::move(resource.data));
+						resource.data = Ref<T>();
+						resource.name.clear();
+						resource.generation++;
+						m_FreeSlots.push_back(i);
+					}
+					resource.previous = resource.next = InvalidIndex;
+				}
+
+				m_NameToSlot.clear();
+				m_Head = m_Tail = InvalidIndex;
+				m_Statistics.residentBytes = 0;
 			}
+
+			Release(released);
 		}
 
+		// Evicts resources nothing else references, least recently used first, until the budget is met.
+		// Without a budget every one of them is dropped.
 		static void Update(const float elapsedMilliseconds)
 		{
-			typename MapType::iterator itr = m_nameResourceMap.begin();
-
-			while(itr != m_nameResourceMap.end())
+			LUMOS_PROFILE_FUNCTION();
+			std::vector<Ref<T>> evicted;
 			{
-				if(itr->second.data.use_count() == 1)
-					itr = m_nameResourceMap.erase(itr);
-				else
-					++itr;
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				for(auto& resource : m_Resources)
+					resource.timeSinceReload += elapsedMilliseconds;
+
+				Trim(InvalidIndex, m_Statistics.budget == NoBudget ? 0 : m_Statistics.budget, evicted);
 			}
+
+			Release(evicted);
 		}
 
 		static bool ReloadResources()
 		{
-			typename MapType::iterator itr = m_nameResourceMap.begin();
-			while(itr != m_nameResourceMap.end())
+			// Reload functions may use the manager, so they run on a copy outside the lock. Resources that
+			// weren't loaded from a file can't be reloaded.
+			std::vector<std::pair<Handle, Ref<T>>> reload;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				for(u32 i = 0; i < u32(m_Resources.size()); i++)
+				{
+					if(m_Resources[i].data && m_Resources[i].onDisk)
+						reload.push_back({ { i, m_Resources[i].generation }, m_Resources[i].data });
+				}
+			}
+
+			for(auto& entry : reload)
 			{
-				itr->second.timeSinceReload = 0;
-				if(!m_reloadFunc(itr->first, *(itr->second.data)))
+				IDType name;
 				{
-					std::cerr << "ERROR: Resource Manager could not RE-load resource \"" << itr->first << "\" of type " << typeid(T).name() << std::endl;
-					// some can't be loaded because they weren't files but data
+					std::lock_guard<std::mutex> lock(m_Mutex);
+					if(!IsValid(entry.first))
+						continue;
+					name = m_Resources[entry.first.index].name;
+				}
+
+				if(!m_reloadFunc || !m_reloadFunc(name, *entry.second))
+					LUMOS_LOG_ERROR("Resource Manager could not reload resource {0} of type {1}", name, typeid(T).name());
+
+				const u64 size = GetSize(*entry.second);
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				if(IsValid(entry.first))
+				{
+					auto& resource = m_Resources[entry.first.index];
+					m_Statistics.residentBytes += size - resource.size;
+					resource.size = size;
+					resource.timeSinceReload = 0.0f;
 				}
-				++itr;
 			}
+
 			return true;
 		}
 
+		// Bytes of resources kept cached, resources in use are never evicted. NoBudget restores the default.
+		static void SetBudget(u64 bytes)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Statistics.budget = bytes;
+		}
+
+		static u64 GetBudget()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Statistics.budget;
+		}
+
+		static Statistics GetStatistics()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			Statistics statistics = m_Statistics;
+			statistics.resources = u32(m_Resources.size() - m_FreeSlots.size());
+			return statistics;
+		}
+
 		static LoadFunc& LoadFunction() { return m_loadFunc; }
 		static ReleaseFunc& ReleaseFunction() { return m_releaseFunc; }
 		static ReloadFunc& ReloadFunction() { return m_reloadFunc; }
+		static GetIdFunc& GetIdFunction() { return m_getIdFunc; }
 
+		// Bytes a resource holds, sizeof(T) if not set
+		static SizeFunc& SizeFunction() { return m_sizeFunc; }
 
 	private:
-		inline static MapType m_nameResourceMap = {};
-		static LoadFunc m_loadFunc;
-		static ReleaseFunc m_releaseFunc;
-		static ReloadFunc m_reloadFunc;
-		static GetIdFunc m_getIdFunc;
+		static constexpr u32 InvalidIndex = ~0u;
+
+		struct Resource
+		{
+			IDType name;
+			Ref<T> data;
+			u64 size = 0;
+			float timeSinceReload = 0.0f;
+			u32 generation = 0;
+			u32 previous = InvalidIndex; // LRU list, most recently used at m_Head
+			u32 next = InvalidIndex;
+			bool onDisk = false;
+		};
+
+		static bool IsValid(Handle handle)
+		{
+			return handle.index < m_Resources.size() && m_Resources[handle.index].generation == handle.generation && m_Resources[handle.index].data;
+		}
+
+		static u64 GetSize(const T& data)
+		{
+			return m_sizeFunc ? m_sizeFunc(data) : sizeof(T);
+		}
+
+		static u32 FindIndex(const IDType& name)
+		{
+			auto itr = m_NameToSlot.find(name);
+			return itr == m_NameToSlot.end() ? InvalidIndex : itr->second;
+		}
+
+		// Cached resource for name, loaded on a miss. out_data is set in the same lock the handle is made in.
+		static Handle Acquire(const IDType& name, Ref<T>* out_data)
+		{
+			LUMOS_PROFILE_FUNCTION();
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				u32 index = FindIndex(name);
+				if(index != InvalidIndex)
+					return Hit(index, out_data);
+
+				m_Statistics.misses++;
+			}
+
+			// Loading happens outside the lock, other threads may load the same name meanwhile
+			Ref<T> resourceData = CreateRef<T>();
+			if(!m_loadFunc || !m_loadFunc(name, *resourceData))
+			{
+				LUMOS_LOG_ERROR("Resource Manager could not load resource {0} of type {1}", name, typeid(T).name());
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Statistics.loadFailures++;
+				return Handle();
+			}
+
+			return Insert(name, resourceData, true, out_data);
+		}
+
+		static Handle Acquire(const T& data, Ref<T>* out_data)
+		{
+			const IDType name = m_getIdFunc(data);
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				u32 index = FindIndex(name);
+				if(index != InvalidIndex)
+					return Hit(index, out_data);
+
+				m_Statistics.misses++;
+			}
+
+			return Insert(name, CreateRef<T>(data), false, out_data);
+		}
+
+		// Called with m_Mutex held
+		static Handle Hit(u32 index, Ref<T>* out_data)
+		{
+			m_Statistics.hits++;
+			Touch(index);
+			if(out_data)
+				*out_data = m_Resources[index].data;
+
+			return { index, m_Resources[index].generation };
+		}
+
+		static Handle Insert(const IDType& name, const Ref<T>& data, bool onDisk, Ref<T>* out_data)
+		{
+			const u64 size = GetSize(*data);
+			std::vector<Ref<T>> evicted;
+			Handle handle;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+
+				// Another thread loaded it first, keep theirs
+				u32 index = FindIndex(name);
+				if(index != InvalidIndex)
+				{
+					Touch(index);
+					evicted.push_back(data);
+					handle = { index, m_Resources[index].generation };
+					if(out_data)
+						*out_data = m_Resources[index].data;
+				}
+				else
+				{
+					if(m_FreeSlots.empty())
+					{
+						index = u32(m_Resources.size());
+						m_Resources.emplace_back();
+					}
+					else
+					{
+						index = m_FreeSlots.back();
+						m_FreeSlots.pop_back();
+					}
+
+					auto& resource = m_Resources[index];
+					resource.name = name;
+					resource.data = data;
+					resource.size = size;
+					resource.timeSinceReload = 0.0f;
+					resource.onDisk = onDisk;
+					m_NameToSlot[name] = index;
+
+					PushFront(index);
+					m_Statistics.residentBytes += size;
+					handle = { index, resource.generation };
+					if(out_data)
+						*out_data = data;
+
+					// Without a budget nothing is evicted until the next Update
+					Trim(index, m_Statistics.budget, evicted);
+				}
+			}
+
+			// Only the cache references the losing copy, it has to be released like an evicted one
+			Release(evicted);
+			return handle;
+		}
+
+		// Called with m_Mutex held. Evicted data is returned so it is released after unlocking.
+		static void Trim(u32 keep, u64 budget, std::vector<Ref<T>>& evicted)
+		{
+			u32 index = m_Tail;
+			while(m_Statistics.residentBytes > budget && index != InvalidIndex)
+			{
+				auto& resource = m_Resources[index];
+				const u32 previous = resource.previous;
+
+				if(index != keep && resource.data.GetCounter()->GetReferenceCount() == 1)
+				{
+					Unlink(index);
+					m_NameToSlot.erase(resource.name);
+
+					m_Statistics.residentBytes -= resource.size;
+					m_Statistics.evictions++;
+					evicted.push_back(std::move(resource.data));
+
+					resource.data = Ref<T>();
+					resource.name.clear();
+					resource.generation++;
+					m_FreeSlots.push_back(index);
+				}
+
+				index = previous;
+			}
+		}
+
+		static void Release(std::vector<Ref<T>>& released)
+		{
+			if(m_releaseFunc)
+			{
+				for(auto& data : released)
+					m_releaseFunc(*data);
+			}
+			released.clear();
+		}
+
+		static void Touch(u32 index)
+		{
+			if(m_Head == index)
+				return;
+
+			Unlink(index);
+			PushFront(index);
+		}
+
+		static void PushFront(u32 index)
+		{
+			auto& resource = m_Resources[index];
+			resource.previous = InvalidIndex;
+			resource.next = m_Head;
+
+			if(m_Head != InvalidIndex)
+				m_Resources[m_Head].previous = index;
+			else
+				m_Tail = index;
+
+			m_Head = index;
+		}
+
+		static void Unlink(u32 index)
+		{
+			auto& resource = m_Resources[index];
+			if(resource.previous != InvalidIndex)
+				m_Resources[resource.previous].next = resource.next;
+			else
+				m_Head = resource.next;
+
+			if(resource.next != InvalidIndex)
+				m_Resources[resource.next].previous = resource.previous;
+			else
+				m_Tail = resource.previous;
+
+			resource.previous = resource.next = InvalidIndex;
+		}
+
+		inline static std::mutex m_Mutex;
+		inline static std::vector<Resource> m_Resources = {};
+		inline static std::vector<u32> m_FreeSlots = {};
+		inline static std::unordered_map<IDType, u32> m_NameToSlot = {};
+		inline static u32 m_Head = InvalidIndex;
+		inline static u32 m_Tail = InvalidIndex;
+		inline static Statistics m_Statistics = { 0, 0, 0, 0, 0, NoBudget, 0 };
+
+		inline static LoadFunc m_loadFunc;
+		inline static ReleaseFunc m_releaseFunc;
+		inline static ReloadFunc m_reloadFunc;
+		inline static GetIdFunc m_getIdFunc;
+		inline static SizeFunc m_sizeFunc;
 	};
 }
@@ -0,0 +1,333 @@
+#include "Precompiled.h"
+#include "AssetStreamer.h"
+#include "LoadImage.h"
+#include "Timer.h"
+
+#include "Audio/Sound.h"
+#include "Core/JobSystem.h"
+#include "Graphics/Material.h"
+#include "Graphics/Model.h"
+#include "Graphics/Sprite.h"
+#include "Scene/Scene.h"
+#include "Scene/Component/SoundComponent.h"
+
+#include <entt/entt.hpp>
+#include <imgui/imgui.h>
+
+namespace Lumos
+{
+	AssetStreamer::~AssetStreamer()
+	{
+		// Jobs still decoding reference the streamer
+		for(auto& job : m_Jobs)
+			System::JobSystem::Wait(job);
+
+		m_Uploads.clear();
+		ClearPreloadedImages();
+	}
+
+	template<typename F>
+	void AssetStreamer::StartJob(F&& job)
+	{
+		m_Pending++;
+		m_Decoding++;
+		m_Requested++;
+		const System::JobSystem::JobHandle handle = System::JobSystem::ExecuteBackground(std::forward<F>(job));
+
+		std::lock_guard<std::mutex> lock(m_UploadMutex);
+		m_Jobs.push_back(handle);
+	}
+
+	Ref<StreamedAsset<Graphics::Texture2D>> AssetStreamer::LoadTexture2D(const std::string& name, const std::string& filePath, Graphics::TextureParameters parameters, Graphics::TextureLoadOptions loadOptions)
+	{
+		struct Request
+		{
+			Ref<StreamedAsset<Graphics::Texture2D>> asset;
+			std::string name;
+			Graphics::TextureParameters parameters;
+			Graphics::TextureLoadOptions loadOptions;
+		};
+
+		auto asset = CreateRef<StreamedAsset<Graphics::Texture2D>>(filePath, Graphics::Material::GetDefaultTexture());
+		auto request = CreateRef<Request>(Request { asset, name, parameters, loadOptions });
+
+		StartJob([this, request]() {
+			u32 size = 0;
+			if(PreloadImageFromFile(request->asset->GetPath(), &size))
+			{
+				// Texture creation picks up the preloaded pixels instead of reading the file
+				auto create = [request]() {
+					auto& asset = request->asset;
+					asset->m_Resource = Ref<Graphics::Texture2D>(Graphics::Texture2D::CreateFromFile(request->name, asset->GetPath(), request->parameters, request->loadOptions));
+					asset->m_State.store(AssetState::Ready, std::memory_order_release);
+				};
+				QueueUpload({ create, request->asset.get(), size });
+			}
+			else
+			{
+				LUMOS_LOG_ERROR("Failed to stream texture {0}", request->asset->GetPath());
+				request->asset->m_State.store(AssetState::Failed, std::memory_order_release);
+				LoadFailed(request->asset.get());
+			}
+			m_Decoding--;
+		});
+
+		return asset;
+	}
+
+	Ref<StreamedAsset<Sound>> AssetStreamer::LoadSound(const std::string& filePath, const std::string& extension)
+	{
+		struct Request
+		{
+			~Request()
+			{
+				// Still owned if the sound was never created
+				delete[] data.Data;
+			}
+
+			Ref<StreamedAsset<Sound>> asset;
+			std::string extension;
+			AudioData data = {};
+		};
+
+		auto asset = CreateRef<StreamedAsset<Sound>>(filePath);
+		auto request = CreateRef<Request>();
+		request->asset = asset;
+		request->extension = extension;
+
+		StartJob([this, request]() {
+			request->data = Sound::LoadData(request->asset->GetPath(), request->extension);
+			if(request->data.Data)
+			{
+				auto create = [request]() {
+					auto& asset = request->asset;
+					asset->m_Resource = Ref<Sound>(Sound::CreateFromData(asset->GetPath(), request->data));
+					request->data.Data = nullptr;
+					asset->m_State.store(asset->m_Resource ? AssetState::Ready : AssetState::Failed, std::memory_order_release);
+				};
+				QueueUpload({ create, request->asset.get(), request->data.Size });
+			}
+			else
+			{
+				LUMOS_LOG_ERROR("Failed to stream sound {0}", request->asset->GetPath());
+				request->asset->m_State.store(AssetState::Failed, std::memory_order_release);
+				LoadFailed(request->asset.get());
+			}
+			m_Decoding--;
+		});
+
+		return asset;
+	}
+
+	Ref<StreamedAsset<Graphics::Model>> AssetStreamer::LoadModel(const std::string& filePath)
+	{
+		auto asset = CreateRef<StreamedAsset<Graphics::Model>>(filePath);
+
+		StartJob([this, asset]() {
+			Ref<Graphics::ModelSource> source = Graphics::Model::Decode(asset->GetPath());
+			if(source)
+			{
+				auto create = [asset, source]() {
+					auto model = CreateRef<Graphics::Model>();
+					source->Build(*model);
+					asset->m_Resource = model;
+					asset->m_State.store(AssetState::Ready, std::memory_order_release);
+				};
+				QueueUpload({ create, asset.get(), 0 });
+			}
+			else
+			{
+				LUMOS_LOG_WARN("Failed to stream model {0}", asset->GetPath());
+				asset->m_State.store(AssetState::Failed, std::memory_order_release);
+				LoadFailed(asset.get());
+			}
+			m_Decoding--;
+		});
+
+		return asset;
+	}
+
+	void AssetStreamer::QueueUpload(Upload&& upload)
+	{
+		std::lock_guard<std::mutex> lock(m_UploadMutex);
+		m_Uploads.push_back(std::move(upload));
+	}
+
+	void AssetStreamer::LoadFailed(const void* asset)
+	{
+		std::lock_guard<std::mutex> lock(m_UploadMutex);
+		m_FailedAssets.push_back(asset);
+		m_Failed++;
+		m_Pending--;
+	}
+
+	void AssetStreamer::Update(Scene* scene)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		Timer timer;
+		m_UploadsLastFrame = 0;
+		m_UploadedBytesLastFrame = 0;
+		m_Finished.clear();
+
+		while(m_UploadsLastFrame == 0 || timer.GetMS(1000.0f) < m_UploadBudget)
+		{
+			Upload upload;
+			{
+				std::lock_guard<std::mutex> lock(m_UploadMutex);
+				if(m_Uploads.empty())
+					break;
+
+				upload = std::move(m_Uploads.front());
+				m_Uploads.pop_front();
+			}
+
+			upload.create();
+			m_Finished.push_back(upload.asset);
+
+			m_UploadsLastFrame++;
+			m_UploadedBytesLastFrame += upload.size;
+			m_Loaded++;
+			m_Pending--;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_UploadMutex);
+			m_Finished.insert(m_Finished.end(), m_FailedAssets.begin(), m_FailedAssets.end());
+			m_FailedAssets.clear();
+
+			// Handles are only kept for the destructor to wait on
+			m_Jobs.erase(std::remove_if(m_Jobs.begin(), m_Jobs.end(), [](const System::JobSystem::JobHandle& job) { return System::JobSystem::IsCompleted(job); }), m_Jobs.end());
+		}
+
+		// Components are stored by value and don't know their entity when they request a load, so the scene is
+		// searched once for new requests. A scene made current later may hold components whose loads finished
+		// while it wasn't.
+		const u32 requested = m_Requested.load();
+		if(scene)
+		{
+			auto& registry = scene->GetRegistry();
+
+			if(scene != m_LastScene)
+				m_Requesters.clear();
+
+			if(scene != m_LastScene || requested != m_LastRequested)
+				FindRequesters(registry);
+
+			// Only the components whose loads finished this frame take their resources
+			for(const void* asset : m_Finished)
+			{
+				auto requester = m_Requesters.find(asset);
+				if(requester != m_Requesters.end())
+				{
+					Resolve(registry, requester->second);
+					m_Requesters.erase(requester);
+				}
+			}
+		}
+
+		m_LastScene = scene;
+		m_LastRequested = requested;
+	}
+
+	void AssetStreamer::FindRequesters(entt::registry& registry)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		auto models = registry.view<Graphics::Model>();
+		for(auto entity : models)
+		{
+			auto& model = models.get<Graphics::Model>(entity);
+			if(model.IsStreaming() && !model.ResolveStreamedLoad())
+				m_Requesters[model.GetStreamedModel().get()] = { entity, RequesterType::Model };
+		}
+
+		auto sprites = registry.view<Graphics::Sprite>();
+		for(auto entity : sprites)
+		{
+			auto& sprite = sprites.get<Graphics::Sprite>(entity);
+			if(sprite.GetStreamedTexture() && !sprite.ResolveStreamedLoad())
+				m_Requesters[sprite.GetStreamedTexture().get()] = { entity, RequesterType::Sprite };
+		}
+
+		auto sounds = registry.view<SoundComponent>();
+		for(auto entity : sounds)
+		{
+			SoundNode* node = sounds.get<SoundComponent>(entity).GetSoundNode();
+			if(node && node->GetStreamedSound() && !node->ResolveStreamedLoad())
+				m_Requesters[node->GetStreamedSound().get()] = { entity, RequesterType::Sound };
+		}
+	}
+
+	void AssetStreamer::Resolve(entt::registry& registry, const Requester& requester)
+	{
+		// The entity or its component may have been destroyed while loading
+		if(!registry.valid(requester.entity))
+			return;
+
+		switch(requester.type)
+		{
+		case RequesterType::Model:
+			if(auto model = registry.try_get<Graphics::Model>(requester.entity))
+				model->ResolveStreamedLoad();
+			break;
+		case RequesterType::Sprite:
+			if(auto sprite = registry.try_get<Graphics::Sprite>(requester.entity))
+				sprite->ResolveStreamedLoad();
+			break;
+		case RequesterType::Sound:
+			if(auto sound = registry.try_get<SoundComponent>(requester.entity))
+			{
+				if(SoundNode* node = sound->GetSoundNode())
+					node->ResolveStreamedLoad();
+			}
+			break;
+		}
+	}
+
+	void AssetStreamer::OnImGui()
+	{
+		ImGui::TextUnformatted("Asset Streaming");
+
+		ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(2, 2));
+		ImGui::Columns(2);
+		ImGui::Separator();
+
+		ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted("Upload Budget (ms)");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		ImGui::DragFloat("##UploadBudget", &m_UploadBudget, 0.1f, 0.0f, 16.0f);
+		ImGui::PopItemWidth();
+		ImGui::NextColumn();
+
+		ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted("Load Scenes Synchronously");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		ImGui::Checkbox("##Synchronous", &m_Synchronous);
+		ImGui::PopItemWidth();
+		ImGui::NextColumn();
+
+		const std::pair<const char*, u32> stats[] = {
+			{"Pending", m_Pending.load()},
+			{"Decoding", m_Decoding.load()},
+			{"Created Last Frame", m_UploadsLastFrame},
+			{"Uploaded Bytes Last Frame", m_UploadedBytesLastFrame},
+			{"Loaded", m_Loaded},
+			{"Failed", m_Failed.load()}};
+
+		for(auto& stat : stats)
+		{
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted(stat.first);
+			ImGui::NextColumn();
+			ImGui::PushItemWidth(-1);
+			ImGui::Text("%u", stat.second);
+			ImGui::PopItemWidth();
+			ImGui::NextColumn();
+		}
+
+		ImGui::Columns(1);
+		ImGui::Separator();
+		ImGui::PopStyleVar();
+	}
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "Graphics/API/Texture.h"
+#include "Core/JobSystem.h"
+
+#include <entt/entity/fwd.hpp>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace Lumos
+{
+	class Scene;
+	class Sound;
+
+	namespace Graphics
+	{
+		class Model;
+	}
+
+	enum class AssetState : u8
+	{
+		Loading,
+		Ready,
+		Failed
+	};
+
+	// Handle to an asset loading on the AssetStreamer. Until it is ready Get() returns the placeholder,
+	// the default white texture for textures and nullptr for sounds and models.
+	template<typename T>
+	class StreamedAsset
+	{
+		friend class AssetStreamer;
+
+	public:
+		StreamedAsset(const std::string& path, const Ref<T>& placeholder = Ref<T>())
+			: m_Path(path)
+			, m_Resource(placeholder)
+		{
+		}
+
+		AssetState GetState() const { return m_State.load(std::memory_order_acquire); }
+		bool IsReady() const { return GetState() == AssetState::Ready; }
+		bool IsLoading() const { return GetState() == AssetState::Loading; }
+
+		// The resource is swapped in on the render thread, only read it from there
+		const Ref<T>& Get() const { return m_Resource; }
+		const std::string& GetPath() const { return m_Path; }
+
+	private:
+		std::string m_Path;
+		Ref<T> m_Resource;
+		std::atomic<AssetState> m_State { AssetState::Loading };
+	};
+
+	// Loads assets without blocking the calling thread. File reads and decoding run as background jobs,
+	// the GPU and audio objects are created in Update on the render thread, a few per frame.
+	class LUMOS_EXPORT AssetStreamer
+	{
+	public:
+		AssetStreamer() = default;
+		~AssetStreamer();
+
+		Ref<StreamedAsset<Graphics::Texture2D>> LoadTexture2D(const std::string& name, const std::string& filePath, Graphics::TextureParameters parameters = Graphics::TextureParameters(), Graphics::TextureLoadOptions loadOptions = Graphics::TextureLoadOptions());
+		Ref<StreamedAsset<Sound>> LoadSound(const std::string& filePath, const std::string& extension);
+		Ref<StreamedAsset<Graphics::Model>> LoadModel(const std::string& filePath);
+
+		// Creates the resources of finished decodes, oldest first, until the upload budget is spent. At least
+		// one is created every frame. The models, sprites and sounds in scene that requested them then take them.
+		void Update(Scene* scene);
+
+		// Milliseconds per frame spent creating resources
+		void SetUploadBudget(float milliseconds) { m_UploadBudget = milliseconds; }
+		float GetUploadBudget() const { return m_UploadBudget; }
+
+		// While set, models, sprites and sounds load on the calling thread when deserialised instead of streaming,
+		// so their resources are there as soon as a scene is loaded. Off by default.
+		void SetSynchronous(bool synchronous) { m_Synchronous = synchronous; }
+		bool IsSynchronous() const { return m_Synchronous; }
+
+		// Requested assets that aren't created yet
+		u32 GetPendingCount() const { return m_Pending.load(); }
+
+		void OnImGui();
+
+	private:
+		struct Upload
+		{
+			std::function<void()> create;
+			const void* asset = nullptr;
+			u32 size = 0;
+		};
+
+		// Component that requested a streamed asset
+		enum class RequesterType : u8
+		{
+			Model,
+			Sprite,
+			Sound
+		};
+
+		struct Requester
+		{
+			entt::entity entity;
+			RequesterType type;
+		};
+
+		template<typename F>
+		void StartJob(F&& job);
+		void QueueUpload(Upload&& upload);
+		void LoadFailed(const void* asset);
+
+		// Records the entity of every component waiting on a load, components whose load already finished take it
+		void FindRequesters(entt::registry& registry);
+		void Resolve(entt::registry& registry, const Requester& requester);
+
+		std::mutex m_UploadMutex;
+		std::deque<Upload> m_Uploads;
+		std::vector<const void*> m_FailedAssets; // Guarded by m_UploadMutex
+		std::vector<System::JobSystem::JobHandle> m_Jobs; // Guarded by m_UploadMutex, completed jobs are dropped in Update
+		std::atomic<u32> m_Pending { 0 };
+		std::atomic<u32> m_Decoding { 0 };
+		std::atomic<u32> m_Failed { 0 };
+		std::atomic<u32> m_Requested { 0 };
+		float m_UploadBudget = 2.0f;
+		bool m_Synchronous = false;
+
+		// Keyed by the StreamedAsset, only touched by Update
+		std::unordered_map<const void*, Requester> m_Requesters;
+		std::vector<const void*> m_Finished;
+
+		Scene* m_LastScene = nullptr;
+		u32 m_LastRequested = 0;
+		u32 m_UploadsLastFrame = 0;
+		u32 m_UploadedBytesLastFrame = 0;
+		u32 m_Loaded = 0;
+	};
+}
@@ -13,16 +13,22 @@
 
 namespace Lumos
 {
-	u8* LoadImageFromFile(const char* filename, u32* width, u32* height, u32* bits, bool* isHDR, bool flipY)
+	struct PreloadedImage
+	{
+		u8* pixels;
+		u32 width;
+		u32 height;
+		u32 bits;
+		bool isHDR;
+	};
+
+	// Decoded images waiting for their LoadImageFromFile, keyed by physical path
+	static std::mutex s_PreloadMutex;
+	static std::unordered_map<std::string, PreloadedImage> s_PreloadedImages;
+
+	static u8* DecodeImage(const char* filename, u32* width, u32* height, u32* bits, bool* isHDR, bool flipY)
 	{
 		LUMOS_PROFILE_FUNCTION();
-		std::string filePath = std::string(filename);
-		std::string physicalPath;
-		if(!VFS::Get()->ResolvePhysicalPath(filePath, physicalPath))
-			return nullptr;
-
-		filename = physicalPath.c_str();
-
 #ifdef FREEIMAGE
 		FREE_IMAGE_FORMAT fif = FIF_UNKNOWN;
 		FIBITMAP* dib = nullptr;
@@ -83,6 +89,8 @@ namespace Lumos
 		}
 
 		LUMOS_ASSERT(pixels, "Could not load image '{0}'!", filename);
+		if(!pixels)
+			return nullptr;
 
 		//TODO support different texChannels
 		if(texChannels != 4)
@@ -104,6 +112,95 @@ namespace Lumos
 		return result;
 	}
 
+	u8* LoadImageFromFile(const char* filename, u32* width, u32* height, u32* bits, bool* isHDR, bool flipY)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		std::string filePath = std::string(filename);
+		std::string physicalPath;
+		if(!VFS::Get()->ResolvePhysicalPath(filePath, physicalPath))
+			return nullptr;
+
+		{
+			std::lock_guard<std::mutex> lock(s_PreloadMutex);
+			auto itr = s_PreloadedImages.find(physicalPath);
+			if(itr != s_PreloadedImages.end())
+			{
+				PreloadedImage image = itr->second;
+				s_PreloadedImages.erase(itr);
+
+#ifdef FREEIMAGE
+				// Preloads are decoded without flipping
+				if(flipY)
+				{
+					const u32 rowSize = image.width * (image.bits / 8);
+					std::vector<u8> row(rowSize);
+					for(u32 y = 0; y < image.height / 2; y++)
+					{
+						u8* top = image.pixels + y * rowSize;
+						u8* bottom = image.pixels + (image.height - 1 - y) * rowSize;
+						memcpy(row.data(), top, rowSize);
+						memcpy(top, bottom, rowSize);
+						memcpy(bottom, row.data(), rowSize);
+					}
+				}
+#endif
+				if(width)
+					*width = image.width;
+				if(height)
+					*height = image.height;
+				if(bits)
+					*bits = image.bits;
+				if(isHDR)
+					*isHDR = image.isHDR;
+
+				return image.pixels;
+			}
+		}
+
+		return DecodeImage(physicalPath.c_str(), width, height, bits, isHDR, flipY);
+	}
+
+	bool PreloadImageFromFile(const std::string& filename, u32* size)
+	{
+		LUMOS_PROFILE_FUNCTION();
+		std::string physicalPath;
+		if(!VFS::Get()->ResolvePhysicalPath(filename, physicalPath))
+			return false;
+
+		{
+			std::lock_guard<std::mutex> lock(s_PreloadMutex);
+			auto itr = s_PreloadedImages.find(physicalPath);
+			if(itr != s_PreloadedImages.end())
+			{
+				if(size)
+					*size = itr->second.width * itr->second.height * (itr->second.bits / 8);
+				return true;
+			}
+		}
+
+		PreloadedImage image = {};
+		image.pixels = DecodeImage(physicalPath.c_str(), &image.width, &image.height, &image.bits, &image.isHDR, false);
+		if(!image.pixels)
+			return false;
+
+		if(size)
+			*size = image.width * image.height * (image.bits / 8);
+
+		std::lock_guard<std::mutex> lock(s_PreloadMutex);
+		if(!s_PreloadedImages.emplace(physicalPath, image).second)
+			delete[] image.pixels; // Another thread preloaded it meanwhile
+
+		return true;
+	}
+
+	void ClearPreloadedImages()
+	{
+		std::lock_guard<std::mutex> lock(s_PreloadMutex);
+		for(auto& [path, image] : s_PreloadedImages)
+			delete[] image.pixels;
+		s_PreloadedImages.clear();
+	}
+
 	u8* LoadImageFromFile(const std::string& filename, u32* width, u32* height, u32* bits, bool* isHDR, bool flipY)
 	{
 		return LoadImageFromFile(filename.c_str(), width, height, bits, isHDR, flipY);
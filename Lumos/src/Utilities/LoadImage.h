@@ -5,4 +5,11 @@ namespace Lumos
 {
 	LUMOS_EXPORT u8* LoadImageFromFile(const char* filename, u32* width = nullptr, u32* height = nullptr, u32* bits = nullptr, bool* isHDR = nullptr, bool flipY = false);
 	LUMOS_EXPORT u8* LoadImageFromFile(const std::string& filename, u32* width = nullptr, u32* height = nullptr, u32* bits = nullptr, bool* isHDR = nullptr, bool flipY = false);
+
+	// Decodes an image ahead of time, safe to call from any thread. The next LoadImageFromFile of the same
+	// file takes the decoded pixels instead of reading it again. size receives the decoded size in bytes.
+	LUMOS_EXPORT bool PreloadImageFromFile(const std::string& filename, u32* size = nullptr);
+
+	// Frees preloaded images that were never loaded
+	LUMOS_EXPORT void ClearPreloadedImages();
 }
@@ -0,0 +1,136 @@
+#include <LumosEngine.h>
+#include <Utilities/AssetManager.h>
+
+#include "Test.h"
+
+using namespace Lumos;
+
+struct TestResource
+{
+	std::string name;
+	u32 loads = 0;
+};
+
+typedef ResourceManager<TestResource> TestResources;
+
+static u32 s_LoadCount = 0;
+static u32 s_ReleaseCount = 0;
+
+static void Reset(u64 budget)
+{
+	TestResources::Destroy();
+	TestResources::SetBudget(budget);
+	TestResources::SizeFunction() = [](const TestResource&) { return u64(1); };
+	TestResources::LoadFunction() = [](const std::string& name, TestResource& resource) {
+		resource.name = name;
+		resource.loads = ++s_LoadCount;
+		return name != "missing";
+	};
+	TestResources::ReleaseFunction() = [](TestResource&) { s_ReleaseCount++; };
+	s_LoadCount = 0;
+	s_ReleaseCount = 0;
+}
+
+TEST_CASE(UnreferencedResourcesDropWithoutBudget)
+{
+	Reset(TestResources::NoBudget);
+
+	Ref<TestResource> held = TestResources::GetResource("held");
+	TestResources::GetResource("dropped");
+	TestResources::Load("handle only");
+	CHECK(TestResources::GetStatistics().resources == 3);
+
+	// Nothing is evicted between updates
+	CHECK(TestResources::Find("dropped").IsValid());
+
+	TestResources::Update(0.0f);
+	CHECK(TestResources::Find("held").IsValid());
+	CHECK(!TestResources::Find("dropped").IsValid());
+	CHECK(!TestResources::Find("handle only").IsValid());
+	CHECK(TestResources::GetStatistics().resources == 1);
+	CHECK(s_ReleaseCount == 2);
+
+	// Loaded again on the next request
+	CHECK(TestResources::GetResource("dropped")->loads == 4);
+}
+
+TEST_CASE(BudgetEvictsLeastRecentlyUsed)
+{
+	Reset(2);
+	const u64 evictions = TestResources::GetStatistics().evictions;
+
+	TestResources::Handle a = TestResources::Load("a");
+	TestResources::Handle b = TestResources::Load("b");
+	TestResources::Get(a);
+	TestResources::Load("c");
+
+	// b was used least recently, a was touched after it
+	CHECK(TestResources::IsResident(a));
+	CHECK(!TestResources::IsResident(b));
+	CHECK(!TestResources::Get(b));
+	CHECK(TestResources::GetStatistics().residentBytes == 2);
+
+	// Within budget, Update keeps unreferenced resources
+	TestResources::Update(0.0f);
+	CHECK(TestResources::IsResident(a));
+	CHECK(TestResources::GetStatistics().evictions == evictions + 1);
+}
+
+TEST_CASE(StaleHandleDoesNotResolveToReusedSlot)
+{
+	Reset(1);
+
+	// Loading second evicts first, third then takes first's slot
+	TestResources::Handle first = TestResources::Load("first");
+	TestResources::Load("second");
+	TestResources::Handle third = TestResources::Load("third");
+
+	CHECK(!TestResources::IsResident(first));
+	CHECK(third.index == first.index);
+	CHECK(third.generation != first.generation);
+	CHECK(!TestResources::Get(first));
+	CHECK(TestResources::Get(third)->name == "third");
+}
+
+TEST_CASE(HandlesStayStaleAcrossDestroy)
+{
+	Reset(TestResources::NoBudget);
+
+	TestResources::Handle before = TestResources::Load("before");
+	Reset(TestResources::NoBudget);
+
+	// The slot is reused by the first load after Destroy, the old handle must not see it
+	TestResources::Handle after = TestResources::Load("after");
+	CHECK(after.index == before.index);
+	CHECK(after.generation != before.generation);
+	CHECK(!TestResources::Get(before));
+	CHECK(TestResources::Get(after)->name == "after");
+	CHECK(!TestResources::Find("before").IsValid());
+}
+
+TEST_CASE(GetResourceReturnsDataWithZeroBudget)
+{
+	Reset(0);
+	const u64 loadFailures = TestResources::GetStatistics().loadFailures;
+
+	// Every insert trims to nothing, the returned data is taken before anything else can evict it
+	for(u32 i = 0; i < 16; i++)
+	{
+		Ref<TestResource> resource = TestResources::GetResource(std::to_string(i));
+		CHECK(resource && resource->name == std::to_string(i));
+	}
+
+	CHECK(!TestResources::GetResource("missing"));
+	CHECK(TestResources::GetStatistics().loadFailures == loadFailures + 1);
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+
+	const int result = Test::Run();
+
+	TestResources::Destroy();
+	Debug::Log::OnRelease();
+	return result;
+}
@@ -0,0 +1,212 @@
+#include <LumosEngine.h>
+#include <Core/JobSystem.h>
+#include <Physics/LumosPhysicsEngine/LumosPhysicsEngine.h>
+#include <Physics/LumosPhysicsEngine/DynamicTreeBroadphase.h>
+#include <Physics/LumosPhysicsEngine/SphereCollisionShape.h>
+#include <Physics/LumosPhysicsEngine/CuboidCollisionShape.h>
+#include <Scene/Component/Physics3DComponent.h>
+
+#include "Test.h"
+
+#include <algorithm>
+
+using namespace Lumos;
+
+static Maths::BoundingBox RandomBox()
+{
+	const Maths::Vector3 centre(Test::RandomFloat(-50.0f, 50.0f), Test::RandomFloat(-50.0f, 50.0f), Test::RandomFloat(-50.0f, 50.0f));
+	const Maths::Vector3 halfSize(Test::RandomFloat(0.1f, 3.0f), Test::RandomFloat(0.1f, 3.0f), Test::RandomFloat(0.1f, 3.0f));
+	return Maths::BoundingBox(centre - halfSize, centre + halfSize);
+}
+
+static bool Overlaps(const Maths::BoundingBox& a, const Maths::BoundingBox& b)
+{
+	return a.min_.x <= b.max_.x && a.max_.x >= b.min_.x
+		&& a.min_.y <= b.max_.y && a.max_.y >= b.min_.y
+		&& a.min_.z <= b.max_.z && a.max_.z >= b.min_.z;
+}
+
+static bool Contains(const Maths::BoundingBox& outer, const Maths::BoundingBox& inner)
+{
+	return outer.min_.x <= inner.min_.x && outer.min_.y <= inner.min_.y && outer.min_.z <= inner.min_.z
+		&& outer.max_.x >= inner.max_.x && outer.max_.y >= inner.max_.y && outer.max_.z >= inner.max_.z;
+}
+
+// The tree never dereferences proxy bodies, so a tag is enough to tell them apart
+static RigidBody3D* ProxyTag(u32 index)
+{
+	return reinterpret_cast<RigidBody3D*>(static_cast<uintptr_t>(index + 1) * 16);
+}
+
+// Compares tree queries against testing every live proxy's fat AABB
+static void CheckQueries(DynamicTreeBroadphase& tree, const std::vector<i32>& proxies, u32 queryCount)
+{
+	for(u32 i = 0; i < queryCount; i++)
+	{
+		const Maths::BoundingBox query = RandomBox();
+
+		std::vector<i32> found;
+		tree.Query(query, [&](i32 proxyID) {
+			found.push_back(proxyID);
+			return true;
+		});
+
+		std::vector<i32> expected;
+		for(i32 proxyID : proxies)
+		{
+			if(proxyID != DynamicTreeBroadphase::NULL_NODE && Overlaps(tree.GetFatAABB(proxyID), query))
+				expected.push_back(proxyID);
+		}
+
+		std::sort(found.begin(), found.end());
+		std::sort(expected.begin(), expected.end());
+		CHECK(found == expected);
+
+		std::vector<RigidBody3D*> bodies;
+		tree.QueryAABB(query, bodies);
+		CHECK(bodies.size() == expected.size());
+	}
+}
+
+TEST_CASE(DynamicTreeInsertRemoveMove)
+{
+	DynamicTreeBroadphase tree(0.1f);
+
+	const u32 proxyCount = 500;
+	std::vector<i32> proxies(proxyCount);
+	std::vector<Maths::BoundingBox> boxes(proxyCount);
+
+	for(u32 i = 0; i < proxyCount; i++)
+	{
+		boxes[i] = RandomBox();
+		proxies[i] = tree.CreateProxy(boxes[i], ProxyTag(i));
+		CHECK(tree.GetBody(proxies[i]) == ProxyTag(i));
+		CHECK(Contains(tree.GetFatAABB(proxies[i]), boxes[i]));
+	}
+
+	// A balanced tree of 500 leaves is far from the 500 levels of a degenerate one
+	CHECK(tree.GetHeight() < 20);
+	CheckQueries(tree, proxies, 100);
+
+	// Small moves stay inside the fat AABB, large ones reinsert the proxy
+	for(u32 i = 0; i < proxyCount; i++)
+	{
+		const Maths::Vector3 offset = (i % 2 == 0) ? Maths::Vector3(0.05f, 0.0f, 0.0f) : Maths::Vector3(Test::RandomFloat(5.0f, 20.0f), 0.0f, 0.0f);
+		const Maths::BoundingBox moved(boxes[i].min_ + offset, boxes[i].max_ + offset);
+
+		const bool reinserted = tree.MoveProxy(proxies[i], moved, offset);
+		CHECK(reinserted == (i % 2 != 0));
+		CHECK(Contains(tree.GetFatAABB(proxies[i]), moved));
+		CHECK(tree.GetBody(proxies[i]) == ProxyTag(i));
+		boxes[i] = moved;
+	}
+
+	CHECK(tree.GetHeight() < 20);
+	CheckQueries(tree, proxies, 100);
+
+	// Remove every third proxy, then reuse the freed nodes
+	for(u32 i = 0; i < proxyCount; i += 3)
+	{
+		tree.DestroyProxy(proxies[i]);
+		proxies[i] = DynamicTreeBroadphase::NULL_NODE;
+	}
+
+	CheckQueries(tree, proxies, 100);
+
+	for(u32 i = 0; i < proxyCount; i += 3)
+	{
+		boxes[i] = RandomBox();
+		proxies[i] = tree.CreateProxy(boxes[i], ProxyTag(i));
+	}
+
+	CheckQueries(tree, proxies, 100);
+
+	for(u32 i = 0; i < proxyCount; i++)
+		tree.DestroyProxy(proxies[i]);
+
+	CHECK(tree.GetHeight() == 0);
+
+	std::vector<RigidBody3D*> bodies;
+	tree.QueryAABB(Maths::BoundingBox(Maths::Vector3(-100.0f), Maths::Vector3(100.0f)), bodies);
+	CHECK(bodies.empty());
+}
+
+static Ref<RigidBody3D> AddBody(Scene& scene, const Maths::Vector3& position, const Ref<CollisionShape>& shape)
+{
+	RigidBody3DProperties properties;
+	properties.Position = position;
+	properties.Static = true;
+	properties.Shape = shape;
+
+	Ref<RigidBody3D> body = CreateRef<RigidBody3D>(properties);
+
+	auto entity = scene.GetEntityManager()->Create();
+	entity.AddComponent<Physics3DComponent>(body);
+	return body;
+}
+
+TEST_CASE(DynamicTreeRaycastHitDistanceAndNormal)
+{
+	Scene scene("DynamicTreeRaycastHitDistanceAndNormal");
+
+	LumosPhysicsEngine physics;
+	physics.SetBroadphase(CreateRef<DynamicTreeBroadphase>());
+	physics.SetGravity(Maths::Vector3(0.0f));
+	physics.SetPaused(false);
+
+	// A sphere in front of a box on the same line, and a box off to the side
+	Ref<RigidBody3D> sphere = AddBody(scene, Maths::Vector3(0.0f, 0.0f, 10.0f), CreateRef<SphereCollisionShape>(1.0f));
+	Ref<RigidBody3D> box = AddBody(scene, Maths::Vector3(0.0f, 0.0f, 20.0f), CreateRef<CuboidCollisionShape>(Maths::Vector3(2.0f)));
+	Ref<RigidBody3D> sideBox = AddBody(scene, Maths::Vector3(10.0f, 0.0f, 0.0f), CreateRef<CuboidCollisionShape>(Maths::Vector3(1.0f, 2.0f, 3.0f)));
+
+	// Build the tree
+	TimeStep timeStep(0.0f);
+	timeStep.Update(1.0f / 60.0f);
+	physics.OnUpdate(timeStep, &scene);
+
+	RaycastHit hit;
+
+	// The sphere is hit first and hides the box behind it
+	CHECK(physics.Raycast(Maths::Ray(Maths::Vector3(0.0f), Maths::Vector3(0.0f, 0.0f, 1.0f)), 100.0f, &hit));
+	CHECK(hit.body == sphere.get());
+	CHECK(Maths::Abs(hit.distance - 9.0f) < 1e-3f);
+	CHECK(Test::NearlyEqual(hit.point, Maths::Vector3(0.0f, 0.0f, 9.0f)));
+	CHECK(Test::NearlyEqual(hit.normal, Maths::Vector3(0.0f, 0.0f, -1.0f)));
+
+	// Off centre, the sphere's normal points away from its centre
+	const float offset = 0.6f;
+	const float sphereEntry = 10.0f - Maths::Sqrt(1.0f - offset * offset);
+	CHECK(physics.Raycast(Maths::Ray(Maths::Vector3(offset, 0.0f, 0.0f), Maths::Vector3(0.0f, 0.0f, 1.0f)), 100.0f, &hit));
+	CHECK(hit.body == sphere.get());
+	CHECK(Maths::Abs(hit.distance - sphereEntry) < 1e-3f);
+	CHECK(Test::NearlyEqual(hit.normal, Maths::Vector3(offset, 0.0f, sphereEntry - 10.0f)));
+
+	// Past the sphere only the box is left
+	CHECK(physics.Raycast(Maths::Ray(Maths::Vector3(1.5f, 0.0f, 0.0f), Maths::Vector3(0.0f, 0.0f, 1.0f)), 100.0f, &hit));
+	CHECK(hit.body == box.get());
+	CHECK(Maths::Abs(hit.distance - 18.0f) < 1e-3f);
+	CHECK(Test::NearlyEqual(hit.normal, Maths::Vector3(0.0f, 0.0f, -1.0f)));
+
+	// The side box is hit on its -x face
+	CHECK(physics.Raycast(Maths::Ray(Maths::Vector3(0.0f, 1.0f, 0.0f), Maths::Vector3(1.0f, 0.0f, 0.0f)), 100.0f, &hit));
+	CHECK(hit.body == sideBox.get());
+	CHECK(Maths::Abs(hit.distance - 9.0f) < 1e-3f);
+	CHECK(Test::NearlyEqual(hit.normal, Maths::Vector3(-1.0f, 0.0f, 0.0f)));
+
+	// Out of range and missing everything
+	CHECK(!physics.Raycast(Maths::Ray(Maths::Vector3(0.0f), Maths::Vector3(0.0f, 0.0f, 1.0f)), 5.0f, &hit));
+	CHECK(hit.body == nullptr);
+	CHECK(!physics.Raycast(Maths::Ray(Maths::Vector3(0.0f), Maths::Vector3(0.0f, 1.0f, 0.0f)), 100.0f, &hit));
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+	System::JobSystem::OnInit();
+
+	const int result = Test::Run();
+
+	System::JobSystem::OnShutdown();
+	Debug::Log::OnRelease();
+	return result;
+}
@@ -0,0 +1,217 @@
+#include <LumosEngine.h>
+#include <Physics/LumosPhysicsEngine/CollisionDetection.h>
+#include <Physics/LumosPhysicsEngine/CuboidCollisionShape.h>
+#include <Physics/LumosPhysicsEngine/PyramidCollisionShape.h>
+#include <Physics/LumosPhysicsEngine/Manifold.h>
+
+#include "Test.h"
+
+using namespace Lumos;
+
+static Ref<RigidBody3D> CreateBody(const Ref<CollisionShape>& shape, const Maths::Vector3& position, const Maths::Quaternion& orientation)
+{
+	RigidBody3DProperties properties;
+	properties.Position = position;
+	properties.Orientation = orientation;
+	properties.Shape = shape;
+	return CreateRef<RigidBody3D>(properties);
+}
+
+static Maths::Quaternion RandomRotation()
+{
+	return Maths::Quaternion(Test::RandomFloat(0.0f, 360.0f), Test::RandomVector(-1.0f, 1.0f).Normalized());
+}
+
+// The separating axis test as it was before the hulls were cached and projected four axes at a time, built
+// from the shapes' own axes, edges and per axis min/max vertices
+static void AddScalarAxis(Maths::Vector3 axis, std::vector<Maths::Vector3>* axes)
+{
+	const float epsilon = 0.0001f;
+
+	if(axis.LengthSquared() < epsilon)
+		return;
+
+	axis.Normalize();
+
+	for(const Maths::Vector3& existing : *axes)
+	{
+		if(abs(Maths::Vector3::Dot(axis, existing)) >= (1.0f - epsilon))
+			return;
+	}
+
+	axes->push_back(axis);
+}
+
+static bool ScalarCheckCollisionAxis(const Maths::Vector3& axis, const RigidBody3D* obj1, const RigidBody3D* obj2, CollisionData* out_coldata)
+{
+	Maths::Vector3 min1, min2, max1, max2;
+	obj1->GetCollisionShape()->GetMinMaxVertexOnAxis(obj1, axis, &min1, &max1);
+	obj2->GetCollisionShape()->GetMinMaxVertexOnAxis(obj2, axis, &min2, &max2);
+
+	const float minCorrelation1 = axis.DotProduct(min1);
+	const float maxCorrelation1 = axis.DotProduct(max1);
+	const float minCorrelation2 = axis.DotProduct(min2);
+	const float maxCorrelation2 = axis.DotProduct(max2);
+
+	if(minCorrelation1 <= minCorrelation2 && maxCorrelation1 >= minCorrelation2)
+	{
+		out_coldata->normal = axis;
+		out_coldata->penetration = minCorrelation2 - maxCorrelation1;
+		out_coldata->pointOnPlane = max1 + out_coldata->normal * out_coldata->penetration;
+		return true;
+	}
+
+	if(minCorrelation2 <= minCorrelation1 && maxCorrelation2 > minCorrelation1)
+	{
+		out_coldata->normal = -axis;
+		out_coldata->penetration = minCorrelation1 - maxCorrelation2;
+		out_coldata->pointOnPlane = min1 + out_coldata->normal * out_coldata->penetration;
+		return true;
+	}
+
+	return false;
+}
+
+static bool ScalarCheckPolyhedronCollision(const RigidBody3D* obj1, const RigidBody3D* obj2, CollisionData* out_coldata)
+{
+	std::vector<Maths::Vector3> axes;
+	std::vector<Maths::Vector3> axes2;
+	obj1->GetCollisionShape()->GetCollisionAxes(obj1, &axes);
+	obj2->GetCollisionShape()->GetCollisionAxes(obj2, &axes2);
+	for(const Maths::Vector3& axis : axes2)
+		AddScalarAxis(axis, &axes);
+
+	std::vector<CollisionEdge> edges1;
+	std::vector<CollisionEdge> edges2;
+	obj1->GetCollisionShape()->GetEdges(obj1, &edges1);
+	obj2->GetCollisionShape()->GetEdges(obj2, &edges2);
+
+	for(const CollisionEdge& edge1 : edges1)
+	{
+		for(const CollisionEdge& edge2 : edges2)
+		{
+			Maths::Vector3 e1 = edge1.posB - edge1.posA;
+			Maths::Vector3 e2 = edge2.posB - edge2.posA;
+			e1.Normalize();
+			e2.Normalize();
+			AddScalarAxis(e1.CrossProduct(e2), &axes);
+		}
+	}
+
+	CollisionData current;
+	CollisionData best;
+	best.penetration = -FLT_MAX;
+
+	for(const Maths::Vector3& axis : axes)
+	{
+		if(!ScalarCheckCollisionAxis(axis, obj1, obj2, &current))
+			return false;
+
+		if(current.penetration >= best.penetration)
+			best = current;
+	}
+
+	*out_coldata = best;
+	return true;
+}
+
+// Places pairs of randomly sized and rotated shapes around each other and checks the cached hull test agrees
+// with the scalar one. Pairs only just touching can go either way, the test that reports the contact has to
+// give a penetration of about zero.
+static void CompareWithScalarPath(const Ref<CollisionShape>& shape1, const Ref<CollisionShape>& shape2, u32* out_hits)
+{
+	const CollisionDetection& detection = CollisionDetection::Get();
+
+	for(u32 i = 0; i < 500; i++)
+	{
+		const Ref<RigidBody3D> body1 = CreateBody(shape1, Test::RandomVector(-0.5f, 0.5f), RandomRotation());
+		const Ref<RigidBody3D> body2 = CreateBody(shape2, Test::RandomVector(-2.5f, 2.5f), RandomRotation());
+
+		CollisionData scalar;
+		CollisionData cached;
+		const bool scalarHit = ScalarCheckPolyhedronCollision(body1.get(), body2.get(), &scalar);
+		const bool cachedHit = detection.CheckCollision(body1.get(), body2.get(), shape1.get(), shape2.get(), &cached);
+
+		if(scalarHit != cachedHit)
+		{
+			CHECK((scalarHit ? scalar.penetration : cached.penetration) > -1e-4f);
+			continue;
+		}
+
+		if(!cachedHit)
+			continue;
+
+		(*out_hits)++;
+		CHECK(Test::NearlyEqual(cached.penetration, scalar.penetration, 1e-4f));
+		CHECK(Test::NearlyEqual(cached.normal, scalar.normal, 1e-3f));
+
+		// Any vertex of a face parallel to the plane can be picked, only its offset along the normal has to match
+		CHECK(Test::NearlyEqual(Maths::Vector3::Dot(cached.pointOnPlane - scalar.pointOnPlane, scalar.normal), 0.0f, 1e-3f));
+	}
+}
+
+TEST_CASE(SATMatchesScalarPathBoxBox)
+{
+	const Ref<CollisionShape> box1 = CreateRef<CuboidCollisionShape>(Maths::Vector3(1.0f, 0.5f, 1.5f));
+	const Ref<CollisionShape> box2 = CreateRef<CuboidCollisionShape>(Maths::Vector3(0.75f, 1.25f, 0.5f));
+
+	u32 hits = 0;
+	CompareWithScalarPath(box1, box2, &hits);
+
+	// Enough of the placements overlap for the comparison to mean something
+	CHECK(hits > 100);
+}
+
+TEST_CASE(SATMatchesScalarPathBoxPyramid)
+{
+	const Ref<CollisionShape> box = CreateRef<CuboidCollisionShape>(Maths::Vector3(1.0f, 0.5f, 1.5f));
+	const Ref<CollisionShape> pyramid = CreateRef<PyramidCollisionShape>(Maths::Vector3(1.0f, 1.0f, 1.0f));
+
+	u32 hits = 0;
+	CompareWithScalarPath(box, pyramid, &hits);
+	CompareWithScalarPath(pyramid, box, &hits);
+
+	CHECK(hits > 200);
+}
+
+TEST_CASE(ManifoldClipsBoxRestingOnBox)
+{
+	const Ref<CollisionShape> ground = CreateRef<CuboidCollisionShape>(Maths::Vector3(4.0f, 0.5f, 4.0f));
+	const Ref<CollisionShape> box = CreateRef<CuboidCollisionShape>(Maths::Vector3(0.5f));
+
+	// Sunk 0.1 into the ground's top face, so the whole bottom face is in contact
+	const Ref<RigidBody3D> body1 = CreateBody(ground, Maths::Vector3(0.0f), Maths::Quaternion());
+	const Ref<RigidBody3D> body2 = CreateBody(box, Maths::Vector3(0.0f, 0.9f, 0.0f), Maths::Quaternion(30.0f, Maths::Vector3(0.0f, 1.0f, 0.0f)));
+
+	const CollisionDetection& detection = CollisionDetection::Get();
+
+	CollisionData coldata;
+	CHECK(detection.CheckCollision(body1.get(), body2.get(), ground.get(), box.get(), &coldata));
+	CHECK(Test::NearlyEqual(coldata.penetration, -0.1f, 1e-4f));
+	CHECK(Test::NearlyEqual(coldata.normal, Maths::Vector3(0.0f, 1.0f, 0.0f)));
+
+	Manifold manifold;
+	manifold.Initiate(body1.get(), body2.get());
+	CHECK(detection.BuildCollisionManifold(body1.get(), body2.get(), ground.get(), box.get(), coldata, &manifold));
+
+	// One contact per corner of the box's bottom face, each between the box's bottom and the ground's top
+	const auto& contacts = manifold.GetContacts();
+	CHECK(contacts.size() == 4);
+	for(const ContactPoint& contact : contacts)
+	{
+		CHECK(Test::NearlyEqual(contact.collisionPenetration, -0.1f, 1e-4f));
+		CHECK(Test::NearlyEqual(contact.relPosA.y, 0.4f, 1e-4f));
+		CHECK(Test::NearlyEqual(contact.relPosB.y, -0.4f, 1e-4f));
+		CHECK(Test::NearlyEqual(Maths::Vector2(contact.relPosB.x, contact.relPosB.z).Length(), Maths::Sqrt(0.5f), 1e-4f));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+
+	const int result = Test::Run();
+
+	Debug::Log::OnRelease();
+	return result;
+}
@@ -0,0 +1,78 @@
+#include <LumosEngine.h>
+#include <Core/JobSystem.h>
+#include <Physics/LumosPhysicsEngine/LumosPhysicsEngine.h>
+#include <Physics/LumosPhysicsEngine/DynamicTreeBroadphase.h>
+#include <Physics/LumosPhysicsEngine/CuboidCollisionShape.h>
+#include <Scene/Component/Physics3DComponent.h>
+
+#include "Test.h"
+
+using namespace Lumos;
+
+// A 0.1 thick static slab at the origin and a 0.5 radius sphere 3 units above it, moving 10 units a step.
+// A discrete step starts above the slab and ends well below it. Returns the lowest height the sphere reached.
+static float FireAtSlab(bool continuousCollision, bool* out_hitTimeOfImpact)
+{
+	Scene scene("FireAtSlab");
+
+	LumosPhysicsEngine physics;
+	physics.SetBroadphase(CreateRef<DynamicTreeBroadphase>());
+	physics.SetGravity(Maths::Vector3(0.0f));
+	physics.SetPaused(false);
+
+	RigidBody3DProperties wallProperties;
+	wallProperties.Static = true;
+	wallProperties.Shape = CreateRef<CuboidCollisionShape>(Maths::Vector3(5.0f, 0.05f, 5.0f));
+	Ref<RigidBody3D> wall = CreateRef<RigidBody3D>(wallProperties);
+	scene.GetEntityManager()->Create().AddComponent<Physics3DComponent>(wall);
+
+	RigidBody3DProperties bulletProperties;
+	bulletProperties.Position = Maths::Vector3(0.0f, 3.0f, 0.0f);
+	bulletProperties.LinearVelocity = Maths::Vector3(0.0f, -600.0f, 0.0f);
+	bulletProperties.Shape = CreateRef<SphereCollisionShape>(0.5f);
+	bulletProperties.ContinuousCollision = continuousCollision;
+	Ref<RigidBody3D> bullet = CreateRef<RigidBody3D>(bulletProperties);
+	bullet->SetInverseInertia(bulletProperties.Shape->BuildInverseInertia(bullet->GetInverseMass()));
+	scene.GetEntityManager()->Create().AddComponent<Physics3DComponent>(bullet);
+
+	TimeStep timeStep(0.0f);
+	timeStep.Update(1.0f / 60.0f);
+
+	*out_hitTimeOfImpact = false;
+	float lowest = FLT_MAX;
+	for(u32 i = 0; i < 10; i++)
+	{
+		physics.OnUpdate(timeStep, &scene);
+		*out_hitTimeOfImpact |= physics.GetStepStats().timeOfImpactHits > 0;
+		lowest = Maths::Min(lowest, bullet->GetPosition().y);
+	}
+
+	return lowest;
+}
+
+TEST_CASE(ContinuousCollisionStopsTunneling)
+{
+	bool hitTimeOfImpact;
+	CHECK(FireAtSlab(true, &hitTimeOfImpact) > 0.0f);
+	CHECK(hitTimeOfImpact);
+}
+
+TEST_CASE(DiscreteCollisionTunnels)
+{
+	// Without continuous collision the same shot passes through, so the test above covers the sweep
+	bool hitTimeOfImpact;
+	CHECK(FireAtSlab(false, &hitTimeOfImpact) < -10.0f);
+	CHECK(!hitTimeOfImpact);
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+	System::JobSystem::OnInit();
+
+	const int result = Test::Run();
+
+	System::JobSystem::OnShutdown();
+	Debug::Log::OnRelease();
+	return result;
+}
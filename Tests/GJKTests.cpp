@@ -0,0 +1,199 @@
+#include <LumosEngine.h>
+#include <Physics/LumosPhysicsEngine/GJK.h>
+#include <Physics/LumosPhysicsEngine/SphereCollisionShape.h>
+#include <Physics/LumosPhysicsEngine/CuboidCollisionShape.h>
+#include <Physics/LumosPhysicsEngine/CapsuleCollisionShape.h>
+
+#include "Test.h"
+
+using namespace Lumos;
+
+static Maths::Matrix4 Place(const Maths::Vector3& position, const Maths::Quaternion& orientation = Maths::Quaternion())
+{
+	Maths::Matrix4 transform = orientation.RotationMatrix4();
+	transform.SetTranslation(position);
+	return transform;
+}
+
+// Gap between the surfaces of two separated shapes, negative if GJK thinks they touch or overlap
+static float SurfaceDistance(const ConvexProxy& a, const ConvexProxy& b)
+{
+	GJK::DistanceResult result;
+	if(!GJK::Distance(a, b, FLT_MAX, &result) || result.overlap)
+		return -1.0f;
+
+	return result.distance - a.margin - b.margin;
+}
+
+// Sphere radius 1, box half extents 1, capsule radius 0.5 with a segment of length 2 along y. Built on first use,
+// the cuboid shares a hull that is a static in the engine.
+static const CollisionShape* Sphere()
+{
+	static const SphereCollisionShape shape(1.0f);
+	return &shape;
+}
+
+static const CollisionShape* Box()
+{
+	static const CuboidCollisionShape shape(Maths::Vector3(1.0f));
+	return &shape;
+}
+
+static const CollisionShape* Capsule()
+{
+	static const CapsuleCollisionShape shape(0.5f, 2.0f);
+	return &shape;
+}
+
+TEST_CASE(GJKSeparatedDistance)
+{
+	// Sphere - sphere, the closest points are the cores (centres)
+	{
+		const ConvexProxy a(Sphere(), Place(Maths::Vector3(0.0f)));
+		const ConvexProxy b(Sphere(), Place(Maths::Vector3(3.0f, 0.0f, 0.0f)));
+
+		GJK::DistanceResult result;
+		CHECK(GJK::Distance(a, b, FLT_MAX, &result));
+		CHECK(!result.overlap);
+		CHECK(Test::NearlyEqual(result.distance, 3.0f, 1e-4f));
+		CHECK(Test::NearlyEqual(result.pointA, Maths::Vector3(0.0f), 1e-4f));
+		CHECK(Test::NearlyEqual(result.pointB, Maths::Vector3(3.0f, 0.0f, 0.0f), 1e-4f));
+		CHECK(Test::NearlyEqual(SurfaceDistance(a, b), 1.0f, 1e-4f));
+
+		// Cores further apart than maxDistance are rejected early
+		CHECK(!GJK::Distance(a, b, 2.0f, &result));
+	}
+
+	// Sphere - box, off the box's corner
+	{
+		const ConvexProxy box(Box(), Place(Maths::Vector3(0.0f)));
+		const ConvexProxy sphere(Sphere(), Place(Maths::Vector3(3.0f, 3.0f, 0.0f)));
+		CHECK(Test::NearlyEqual(SurfaceDistance(box, sphere), Maths::Sqrt(8.0f) - 1.0f, 1e-4f));
+
+		GJK::DistanceResult result;
+		CHECK(GJK::Distance(box, sphere, FLT_MAX, &result));
+		CHECK(Test::NearlyEqual(result.pointA.x, 1.0f, 1e-4f));
+		CHECK(Test::NearlyEqual(result.pointA.y, 1.0f, 1e-4f));
+	}
+
+	// Capsule - box, the end of the capsule's segment above the box's top face
+	{
+		const ConvexProxy box(Box(), Place(Maths::Vector3(0.0f)));
+		const ConvexProxy capsule(Capsule(), Place(Maths::Vector3(0.3f, 4.0f, -0.2f)));
+		CHECK(Test::NearlyEqual(SurfaceDistance(box, capsule), 1.5f, 1e-4f));
+	}
+
+	// Capsule - sphere, lying along x after a 90 degree turn about z
+	{
+		const ConvexProxy capsule(Capsule(), Place(Maths::Vector3(0.0f), Maths::Quaternion(90.0f, Maths::Vector3(0.0f, 0.0f, 1.0f))));
+		const ConvexProxy sphere(Sphere(), Place(Maths::Vector3(4.0f, 0.0f, 0.0f)));
+		CHECK(Test::NearlyEqual(SurfaceDistance(capsule, sphere), 1.5f, 1e-4f));
+	}
+
+	// Separated shapes have no penetration
+	{
+		const ConvexProxy a(Box(), Place(Maths::Vector3(0.0f)));
+		const ConvexProxy b(Capsule(), Place(Maths::Vector3(3.0f, 0.0f, 0.0f)));
+
+		Maths::Vector3 normal, pointA, pointB;
+		float depth;
+		CHECK(!GJK::Penetration(a, b, &normal, &depth, &pointA, &pointB));
+	}
+}
+
+TEST_CASE(GJKTouching)
+{
+	// Spheres touching, the cores are exactly the sum of the margins apart
+	{
+		const ConvexProxy a(Sphere(), Place(Maths::Vector3(0.0f)));
+		const ConvexProxy b(Sphere(), Place(Maths::Vector3(0.0f, 2.0f, 0.0f)));
+
+		GJK::DistanceResult result;
+		CHECK(GJK::Distance(a, b, a.margin + b.margin, &result));
+		CHECK(!result.overlap);
+		CHECK(Test::NearlyEqual(result.distance - a.margin - b.margin, 0.0f, 1e-4f));
+	}
+
+	// Boxes sharing a face, the cores touch so either no gap or no depth is reported
+	{
+		const ConvexProxy a(Box(), Place(Maths::Vector3(0.0f)));
+		const ConvexProxy b(Box(), Place(Maths::Vector3(2.0f, 0.5f, 0.0f)));
+
+		GJK::DistanceResult result;
+		CHECK(GJK::Distance(a, b, 1e-3f, &result));
+		CHECK(result.overlap || result.distance < 1e-4f);
+
+		Maths::Vector3 normal, pointA, pointB;
+		float depth = 0.0f;
+		if(GJK::Penetration(a, b, &normal, &depth, &pointA, &pointB))
+			CHECK(depth < 1e-3f);
+	}
+}
+
+TEST_CASE(EPAPenetrationDepthAndNormal)
+{
+	Maths::Vector3 normal, pointA, pointB;
+	float depth;
+
+	// Box - box overlapping by 0.5 along x
+	{
+		const ConvexProxy a(Box(), Place(Maths::Vector3(0.0f)));
+		const ConvexProxy b(Box(), Place(Maths::Vector3(1.5f, 0.2f, -0.1f)));
+
+		CHECK(GJK::Penetration(a, b, &normal, &depth, &pointA, &pointB));
+		CHECK(Test::NearlyEqual(depth, 0.5f, 1e-3f));
+		CHECK(Test::NearlyEqual(normal, Maths::Vector3(1.0f, 0.0f, 0.0f), 1e-3f));
+		CHECK(Test::NearlyEqual(pointA.x, 1.0f, 1e-3f));
+		CHECK(Test::NearlyEqual(pointB.x, 0.5f, 1e-3f));
+	}
+
+	// Box turned 45 degrees about z, its edge pushes sqrt(2) - 1.2 into the other box's -x face
+	{
+		const ConvexProxy a(Box(), Place(Maths::Vector3(0.0f), Maths::Quaternion(45.0f, Maths::Vector3(0.0f, 0.0f, 1.0f))));
+		const ConvexProxy b(Box(), Place(Maths::Vector3(2.2f, 0.0f, 0.0f)));
+
+		CHECK(GJK::Penetration(a, b, &normal, &depth, &pointA, &pointB));
+		CHECK(Test::NearlyEqual(depth, Maths::Sqrt(2.0f) - 1.2f, 1e-3f));
+		CHECK(Test::NearlyEqual(normal, Maths::Vector3(1.0f, 0.0f, 0.0f), 1e-3f));
+	}
+
+	// Sphere - sphere, the polytope only approximates the rounded surfaces so the tolerance is looser
+	{
+		const ConvexProxy a(Sphere(), Place(Maths::Vector3(0.0f)));
+		const ConvexProxy b(Sphere(), Place(Maths::Vector3(0.0f, 0.0f, 1.5f)));
+
+		CHECK(GJK::Penetration(a, b, &normal, &depth, &pointA, &pointB));
+		CHECK(Test::NearlyEqual(depth, 0.5f, 1e-2f));
+		CHECK(Test::NearlyEqual(normal, Maths::Vector3(0.0f, 0.0f, 1.0f), 1e-2f));
+	}
+
+	// Box - sphere, the sphere sunk 0.25 into the box's top face
+	{
+		const ConvexProxy a(Box(), Place(Maths::Vector3(0.0f)));
+		const ConvexProxy b(Sphere(), Place(Maths::Vector3(0.1f, 1.75f, 0.0f)));
+
+		CHECK(GJK::Penetration(a, b, &normal, &depth, &pointA, &pointB));
+		CHECK(Test::NearlyEqual(depth, 0.25f, 1e-2f));
+		CHECK(Test::NearlyEqual(normal, Maths::Vector3(0.0f, 1.0f, 0.0f), 1e-2f));
+	}
+
+	// Box - capsule, standing on the box with its lower cap 0.25 deep
+	{
+		const ConvexProxy a(Box(), Place(Maths::Vector3(0.0f)));
+		const ConvexProxy b(Capsule(), Place(Maths::Vector3(0.0f, 2.25f, 0.0f)));
+
+		CHECK(GJK::Penetration(a, b, &normal, &depth, &pointA, &pointB));
+		CHECK(Test::NearlyEqual(depth, 0.25f, 1e-2f));
+		CHECK(Test::NearlyEqual(normal, Maths::Vector3(0.0f, 1.0f, 0.0f), 1e-2f));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+
+	const int result = Test::Run();
+
+	Debug::Log::OnRelease();
+	return result;
+}
@@ -0,0 +1,134 @@
+#include <LumosEngine.h>
+#include <Physics/LumosPhysicsEngine/Integration.h>
+#include <Physics/LumosPhysicsEngine/RigidBody3DStore.h>
+
+#include "Test.h"
+
+#include <cstring>
+
+using namespace Lumos;
+
+// Every array of the store, so two stores can be compared bit for bit
+static std::vector<const std::vector<float>*> GetArrays(const RigidBody3DStore& store)
+{
+	std::vector<const std::vector<float>*> arrays = { &store.positionX, &store.positionY, &store.positionZ,
+		&store.linearVelocityX, &store.linearVelocityY, &store.linearVelocityZ, &store.forceX, &store.forceY, &store.forceZ,
+		&store.orientationW, &store.orientationX, &store.orientationY, &store.orientationZ,
+		&store.angularVelocityX, &store.angularVelocityY, &store.angularVelocityZ, &store.torqueX, &store.torqueY, &store.torqueZ,
+		&store.inverseMass };
+
+	for(const auto& array : store.inverseInertia)
+		arrays.push_back(&array);
+
+	return arrays;
+}
+
+static bool BitIdentical(const RigidBody3DStore& a, const RigidBody3DStore& b)
+{
+	const auto arraysA = GetArrays(a);
+	const auto arraysB = GetArrays(b);
+	for(size_t i = 0; i < arraysA.size(); i++)
+	{
+		if(std::memcmp(arraysA[i]->data(), arraysB[i]->data(), a.count * sizeof(float)) != 0)
+			return false;
+	}
+	return true;
+}
+
+// Random bodies filled straight into the store. Every fifth body has no inverse mass, the way static bodies
+// are, so both sides of the kernel's selects are taken within one group of four.
+static void FillStore(RigidBody3DStore& store, u32 count)
+{
+	store.Clear();
+	store.Reserve(count);
+	store.count = count;
+
+	for(u32 i = 0; i < count; i++)
+	{
+		const Maths::Quaternion orientation(Test::RandomFloat(0.0f, 360.0f), Test::RandomVector(-1.0f, 1.0f).Normalized());
+
+		store.positionX[i] = Test::RandomFloat(-50.0f, 50.0f);
+		store.positionY[i] = Test::RandomFloat(-50.0f, 50.0f);
+		store.positionZ[i] = Test::RandomFloat(-50.0f, 50.0f);
+		store.linearVelocityX[i] = Test::RandomFloat(-10.0f, 10.0f);
+		store.linearVelocityY[i] = Test::RandomFloat(-10.0f, 10.0f);
+		store.linearVelocityZ[i] = Test::RandomFloat(-10.0f, 10.0f);
+		store.forceX[i] = Test::RandomFloat(-20.0f, 20.0f);
+		store.forceY[i] = Test::RandomFloat(-20.0f, 20.0f);
+		store.forceZ[i] = Test::RandomFloat(-20.0f, 20.0f);
+		store.orientationW[i] = orientation.w;
+		store.orientationX[i] = orientation.x;
+		store.orientationY[i] = orientation.y;
+		store.orientationZ[i] = orientation.z;
+		store.angularVelocityX[i] = Test::RandomFloat(-5.0f, 5.0f);
+		store.angularVelocityY[i] = Test::RandomFloat(-5.0f, 5.0f);
+		store.angularVelocityZ[i] = Test::RandomFloat(-5.0f, 5.0f);
+		store.torqueX[i] = Test::RandomFloat(-5.0f, 5.0f);
+		store.torqueY[i] = Test::RandomFloat(-5.0f, 5.0f);
+		store.torqueZ[i] = Test::RandomFloat(-5.0f, 5.0f);
+		store.inverseMass[i] = (i % 5 == 4) ? 0.0f : Test::RandomFloat(0.1f, 2.0f);
+
+		for(u32 k = 0; k < 9; k++)
+			store.inverseInertia[k][i] = (k % 4 == 0) ? Test::RandomFloat(0.1f, 2.0f) : Test::RandomFloat(-0.1f, 0.1f);
+	}
+}
+
+static const IntegrationType s_Types[] = { IntegrationType::EXPLICIT_EULER, IntegrationType::SEMI_IMPLICIT_EULER, IntegrationType::RUNGE_KUTTA_2, IntegrationType::RUNGE_KUTTA_4 };
+
+// Counts that leave 0 to 3 bodies for the scalar tail after the groups of four
+static const u32 s_Counts[] = { 1, 3, 4, 5, 8, 11, 64, 67 };
+
+TEST_CASE(SSELanesMatchScalarLanes)
+{
+	const Maths::Vector3 gravity(0.0f, -9.81f, 0.0f);
+	const float damping = 0.999f;
+	const float dt = 1.0f / 60.0f;
+
+	for(IntegrationType type : s_Types)
+	{
+		for(u32 count : s_Counts)
+		{
+			RigidBody3DStore batched;
+			FillStore(batched, count);
+			RigidBody3DStore single = batched;
+
+			// One range integrates groups of four with SSE, one body at a time only ever runs the scalar lane
+			for(u32 step = 0; step < 10; step++)
+			{
+				Integration::IntegrateBodies(batched, 0, count, type, gravity, damping, dt);
+				for(u32 i = 0; i < count; i++)
+					Integration::IntegrateBodies(single, i, i + 1, type, gravity, damping, dt);
+			}
+
+			CHECK(BitIdentical(batched, single));
+		}
+	}
+}
+
+TEST_CASE(RangesIntegrateOnlyTheirBodies)
+{
+	// The physics step splits the store into ranges over several jobs, starting at any index
+	RigidBody3DStore whole;
+	FillStore(whole, 67);
+	RigidBody3DStore split = whole;
+	const RigidBody3DStore initial = whole;
+
+	Integration::IntegrateBodies(whole, 0, 67, IntegrationType::SEMI_IMPLICIT_EULER, Maths::Vector3(0.0f, -9.81f, 0.0f), 0.999f, 1.0f / 60.0f);
+
+	Integration::IntegrateBodies(split, 0, 6, IntegrationType::SEMI_IMPLICIT_EULER, Maths::Vector3(0.0f, -9.81f, 0.0f), 0.999f, 1.0f / 60.0f);
+	CHECK(std::memcmp(&split.positionX[6], &initial.positionX[6], 61 * sizeof(float)) == 0);
+
+	Integration::IntegrateBodies(split, 6, 33, IntegrationType::SEMI_IMPLICIT_EULER, Maths::Vector3(0.0f, -9.81f, 0.0f), 0.999f, 1.0f / 60.0f);
+	Integration::IntegrateBodies(split, 33, 67, IntegrationType::SEMI_IMPLICIT_EULER, Maths::Vector3(0.0f, -9.81f, 0.0f), 0.999f, 1.0f / 60.0f);
+	CHECK(BitIdentical(whole, split));
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+
+	const int result = Test::Run();
+
+	Debug::Log::OnRelease();
+	return result;
+}
@@ -0,0 +1,128 @@
+#include <LumosEngine.h>
+#include <Core/JobSystem.h>
+
+#include "Test.h"
+
+#include <atomic>
+
+using namespace Lumos;
+using namespace Lumos::System;
+
+TEST_CASE(DispatchRunsEveryIndexOnce)
+{
+	std::vector<std::atomic<uint32_t>> counts(10001);
+	for(auto& count : counts)
+		count.store(0);
+
+	JobSystem::Wait(JobSystem::Dispatch(uint32_t(counts.size()), 64, [&counts](JobDispatchArgs args) { counts[args.jobIndex]++; }));
+
+	bool once = true;
+	for(auto& count : counts)
+		once &= count.load() == 1;
+	CHECK(once);
+}
+
+TEST_CASE(ChildJobsFinishBeforeParent)
+{
+	std::atomic<uint32_t> executed { 0 };
+	JobSystem::JobHandle root = JobSystem::CreateJob();
+	for(uint32_t i = 0; i < 100; i++)
+		JobSystem::Run(JobSystem::CreateChildJob(root, [&executed]() { executed++; }));
+
+	JobSystem::Run(root);
+	JobSystem::Wait(root);
+	CHECK(executed.load() == 100);
+	CHECK(JobSystem::IsCompleted(root));
+}
+
+TEST_CASE(HandleStaysCompletedAfterSlotReuse)
+{
+	JobSystem::JobHandle held = JobSystem::Execute([]() {});
+	JobSystem::Wait(held);
+	CHECK(JobSystem::IsCompleted(held));
+
+	// Created jobs are never run, so they hold their slots until the pool wraps back to the held job's
+	std::vector<JobSystem::JobHandle> created;
+	JobSystem::JobHandle reused;
+	for(uint32_t i = 0; i < (1u << 16) && !reused.IsValid(); i++)
+	{
+		created.push_back(JobSystem::CreateJob());
+		if(created.back().job == held.job)
+			reused = created.back();
+	}
+
+	CHECK(reused.IsValid());
+	CHECK(reused.generation != held.generation);
+	CHECK(!JobSystem::IsCompleted(reused));
+	CHECK(JobSystem::IsCompleted(held));
+
+	// Would spin forever if the held handle followed the slot's new job
+	if(JobSystem::IsCompleted(held))
+		JobSystem::Wait(held);
+
+	for(auto& handle : created)
+		JobSystem::Run(handle);
+	JobSystem::Wait();
+
+	CHECK(JobSystem::IsCompleted(reused));
+}
+
+TEST_CASE(LargePayloadsSurviveRingWrap)
+{
+	// Well past the payload ring's size, all of it live until the jobs run. A payload written over
+	// by a later one runs that job twice.
+	struct LargePayload
+	{
+		uint32_t values[256];
+		uint32_t index;
+		std::atomic<uint32_t>* executed;
+
+		void operator()() const
+		{
+			for(uint32_t i = 0; i < 256; i++)
+			{
+				if(values[i] != index + i)
+					return;
+			}
+			executed[index]++;
+		}
+	};
+
+	const uint32_t jobCount = 512;
+	std::vector<std::atomic<uint32_t>> executed(jobCount);
+	for(auto& count : executed)
+		count.store(0);
+
+	std::vector<JobSystem::JobHandle> created;
+	for(uint32_t job = 0; job < jobCount; job++)
+	{
+		LargePayload payload;
+		payload.index = job;
+		payload.executed = executed.data();
+		for(uint32_t i = 0; i < 256; i++)
+			payload.values[i] = job + i;
+
+		created.push_back(JobSystem::CreateJob(payload));
+	}
+
+	for(auto& handle : created)
+		JobSystem::Run(handle);
+	JobSystem::Wait();
+
+	bool once = true;
+	for(auto& count : executed)
+		once &= count.load() == 1;
+	CHECK(once);
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+	JobSystem::OnInit();
+
+	const int result = Test::Run();
+
+	JobSystem::OnShutdown();
+	Debug::Log::OnRelease();
+	return result;
+}
@@ -0,0 +1,77 @@
+#include <LumosEngine.h>
+#include <Maths/MatrixBatch.h>
+
+#include "Test.h"
+
+using namespace Lumos;
+
+static Maths::Quaternion RandomRotation()
+{
+	return Maths::Quaternion(Test::RandomFloat(0.0f, 360.0f), Test::RandomVector(-1.0f, 1.0f).Normalized());
+}
+
+// Counts that leave 0 to 3 matrices for the scalar tail after the groups of four
+static const u32 s_Counts[] = { 1, 3, 4, 5, 8, 11, 64, 67 };
+
+TEST_CASE(ComposeTRSMatchesScalar)
+{
+	for(u32 count : s_Counts)
+	{
+		std::vector<Maths::Vector3> translations(count);
+		std::vector<Maths::Quaternion> rotations(count);
+		std::vector<Maths::Vector3> scales(count);
+		for(u32 i = 0; i < count; i++)
+		{
+			translations[i] = Test::RandomVector(-100.0f, 100.0f);
+			rotations[i] = RandomRotation();
+			scales[i] = Test::RandomVector(0.1f, 5.0f);
+		}
+
+		std::vector<Maths::Matrix3x4> matrices(count);
+		Maths::ComposeTRS(translations.data(), rotations.data(), scales.data(), matrices.data(), count);
+
+		for(u32 i = 0; i < count; i++)
+		{
+			const Maths::Matrix3x4 expected = Maths::ComposeAffineTRS(translations[i], rotations[i], scales[i]);
+			CHECK(Test::NearlyEqual(matrices[i], expected, 1e-4f));
+
+			// Both match the matrix built through the Matrix3x4 constructor
+			CHECK(Test::NearlyEqual(expected, Maths::Matrix3x4(translations[i], rotations[i], scales[i]), 1e-4f));
+		}
+	}
+}
+
+TEST_CASE(MultiplyAffineMatchesScalar)
+{
+	for(u32 count : s_Counts)
+	{
+		std::vector<Maths::Matrix3x4> lhs(count);
+		std::vector<Maths::Matrix3x4> rhs(count);
+		for(u32 i = 0; i < count; i++)
+		{
+			lhs[i] = Maths::ComposeAffineTRS(Test::RandomVector(-10.0f, 10.0f), RandomRotation(), Test::RandomVector(0.1f, 3.0f));
+			rhs[i] = Maths::ComposeAffineTRS(Test::RandomVector(-10.0f, 10.0f), RandomRotation(), Test::RandomVector(0.1f, 3.0f));
+		}
+
+		std::vector<Maths::Matrix3x4> products(count);
+		Maths::MultiplyAffine(lhs.data(), rhs.data(), products.data(), count);
+
+		for(u32 i = 0; i < count; i++)
+			CHECK(Test::NearlyEqual(products[i], lhs[i] * rhs[i], 1e-4f));
+
+		// Writing over rhs, the way the scene graph uses it
+		Maths::MultiplyAffine(lhs.data(), rhs.data(), rhs.data(), count);
+		for(u32 i = 0; i < count; i++)
+			CHECK(Test::NearlyEqual(rhs[i], products[i], 0.0f));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+
+	const int result = Test::Run();
+
+	Debug::Log::OnRelease();
+	return result;
+}
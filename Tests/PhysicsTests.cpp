@@ -0,0 +1,127 @@
+#include <LumosEngine.h>
+#include <Core/JobSystem.h>
+#include <Physics/LumosPhysicsEngine/LumosPhysicsEngine.h>
+#include <Physics/LumosPhysicsEngine/DynamicTreeBroadphase.h>
+#include <Scene/Component/Physics3DComponent.h>
+
+#include "Test.h"
+
+using namespace Lumos;
+
+static Ref<RigidBody3D> AddSphere(Scene& scene, const Maths::Vector3& position)
+{
+	RigidBody3DProperties properties;
+	properties.Position = position;
+	properties.Shape = CreateRef<SphereCollisionShape>(0.5f);
+
+	Ref<RigidBody3D> body = CreateRef<RigidBody3D>(properties);
+	body->SetInverseInertia(properties.Shape->BuildInverseInertia(body->GetInverseMass()));
+
+	auto entity = scene.GetEntityManager()->Create();
+	entity.AddComponent<Physics3DComponent>(body);
+	return body;
+}
+
+TEST_CASE(NarrowPhaseDropsLastStepsManifolds)
+{
+	Scene scene("NarrowPhaseDropsLastStepsManifolds");
+
+	LumosPhysicsEngine physics;
+	physics.SetBroadphase(CreateRef<DynamicTreeBroadphase>());
+	physics.SetGravity(Maths::Vector3(0.0f));
+	physics.SetPaused(false);
+
+	// The narrow phase splits pairs over at most (threads + 1) * 4 jobs. jobCount + 2 pairs round up to
+	// 2 pairs per job, which leaves fewer groups than jobs, and the pools past them held pairs last step.
+	const u32 jobCount = (System::JobSystem::GetThreadCount() + 1) * 4;
+	const u32 firstStepPairs = jobCount * 4;
+	const u32 secondStepPairs = jobCount + 2;
+
+	std::vector<std::pair<Ref<RigidBody3D>, Ref<RigidBody3D>>> pairs;
+	for(u32 i = 0; i < firstStepPairs; i++)
+	{
+		const Maths::Vector3 position(i * 10.0f, 0.0f, 0.0f);
+		pairs.push_back({ AddSphere(scene, position), AddSphere(scene, position + Maths::Vector3(0.8f, 0.0f, 0.0f)) });
+	}
+
+	TimeStep timeStep(0.0f);
+	timeStep.Update(1.0f / 60.0f);
+
+	physics.OnUpdate(timeStep, &scene);
+	CHECK(physics.GetStepStats().manifolds == firstStepPairs);
+
+	// Separate all but secondStepPairs of the pairs
+	for(u32 i = secondStepPairs; i < firstStepPairs; i++)
+		pairs[i].second->SetPosition(Maths::Vector3(i * 10.0f, 100.0f, 0.0f));
+
+	physics.OnUpdate(timeStep, &scene);
+	CHECK(physics.GetStepStats().broadphasePairs == secondStepPairs);
+	CHECK(physics.GetStepStats().manifolds == secondStepPairs);
+}
+
+TEST_CASE(ThreadedStepFiresCollisionCallbacksOnMainThread)
+{
+	Scene scene("ThreadedStepFiresCollisionCallbacksOnMainThread");
+
+	LumosPhysicsEngine physics;
+	physics.SetBroadphase(CreateRef<DynamicTreeBroadphase>());
+	physics.SetGravity(Maths::Vector3(0.0f));
+	physics.SetPaused(false);
+	physics.SetStepMode(PhysicsStepMode::FixedThreaded);
+
+	Ref<RigidBody3D> a = AddSphere(scene, Maths::Vector3(0.0f));
+	Ref<RigidBody3D> b = AddSphere(scene, Maths::Vector3(0.8f, 0.0f, 0.0f));
+
+	const std::thread::id mainThread = std::this_thread::get_id();
+	u32 manifoldCallbacks = 0;
+	bool onMainThread = true;
+	a->AddOnCollisionManifoldCallback([&](RigidBody3D*, RigidBody3D*, Manifold*) {
+		manifoldCallbacks++;
+		onMainThread &= std::this_thread::get_id() == mainThread;
+	});
+
+	u32 collisionCallbacks = 0;
+	PhysicsCollisionCallback rejectAll = [&](RigidBody3D*, RigidBody3D*) {
+		collisionCallbacks++;
+		onMainThread &= std::this_thread::get_id() == mainThread;
+		return false;
+	};
+
+	TimeStep timeStep(0.0f);
+	timeStep.Update(1.0f / 30.0f);
+
+	// The first frame hands its steps to the physics thread, which only queues the collisions
+	physics.OnUpdate(timeStep, &scene);
+	physics.WaitForPhysicsThread();
+	CHECK(manifoldCallbacks == 0);
+	CHECK(physics.GetStepStats().manifolds == 1);
+
+	// They're fired when the next frame syncs with the thread
+	physics.OnUpdate(timeStep, &scene);
+	CHECK(manifoldCallbacks > 0);
+	CHECK(onMainThread);
+
+	// The pair a callback rejects isn't solved by the steps after it was fired
+	physics.WaitForPhysicsThread();
+	b->SetOnCollisionCallback(rejectAll);
+	physics.OnUpdate(timeStep, &scene);
+	CHECK(collisionCallbacks > 0);
+
+	physics.WaitForPhysicsThread();
+	CHECK(physics.GetStepStats().manifolds == 0);
+
+	physics.SetStepMode(PhysicsStepMode::Variable);
+	CHECK(onMainThread);
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+	System::JobSystem::OnInit();
+
+	const int result = Test::Run();
+
+	System::JobSystem::OnShutdown();
+	Debug::Log::OnRelease();
+	return result;
+}
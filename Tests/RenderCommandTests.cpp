@@ -0,0 +1,302 @@
+#include <LumosEngine.h>
+#include <Graphics/Renderers/RenderCommand.h>
+#include <Graphics/UniformArena.h>
+#include <Graphics/API/UniformBuffer.h>
+#include <Graphics/API/Renderer.h>
+
+#include "Test.h"
+
+#include <cstring>
+
+using namespace Lumos;
+
+// Stands in for the graphics API. Instead of copying, it keeps the start of the arena's CPU copy the ranges
+// come from, so GetBuffer reads what the GPU would have been given.
+class NullUniformBuffer : public Graphics::UniformBuffer
+{
+public:
+	static void MakeDefault()
+	{
+		CreateFunc = []() -> Graphics::UniformBuffer* { return new NullUniformBuffer(); };
+		CreateDataFunc = [](uint32_t size, const void* data) -> Graphics::UniformBuffer* { return new NullUniformBuffer(); };
+	}
+
+	void Init(uint32_t size, const void* data) override { }
+	void SetData(uint32_t size, const void* data) override { }
+	void SetDynamicData(uint32_t size, uint32_t typeSize, const void* data) override { }
+
+	void SetDynamicDataRange(uint32_t offset, uint32_t size, uint32_t typeSize, const void* data) override
+	{
+		m_Data = const_cast<u8*>(static_cast<const u8*>(data)) - offset;
+	}
+
+	u8* GetBuffer() const override
+	{
+		return m_Data;
+	}
+
+private:
+	u8* m_Data = nullptr;
+};
+
+// Sorting and batching only compare the pointers, these addresses are never dereferenced
+static u8 s_Objects[1024];
+
+template<typename T>
+static T* FakeObject(u32 index)
+{
+	return reinterpret_cast<T*>(&s_Objects[index]);
+}
+
+static const u32 PipelineShift = Graphics::RenderSortKeyBits_DescriptorSet + Graphics::RenderSortKeyBits_Mesh + Graphics::RenderSortKeyBits_Depth;
+static const u32 DescriptorSetShift = Graphics::RenderSortKeyBits_Mesh + Graphics::RenderSortKeyBits_Depth;
+static const u32 MeshShift = Graphics::RenderSortKeyBits_Depth;
+
+static u64 Field(u64 key, u32 shift, u32 bits)
+{
+	return (key >> shift) & ((1ULL << bits) - 1);
+}
+
+TEST_CASE(SortKeyFieldOrder)
+{
+	const void* pipeline = FakeObject<void>(1);
+	const void* descriptorSet = FakeObject<void>(2);
+	const void* mesh = FakeObject<void>(3);
+	const u64 key = Graphics::MakeRenderSortKey(pipeline, descriptorSet, mesh, 10.0f);
+
+	// 8 bit pipeline, 16 bit descriptor set, 20 bit mesh and 20 bit depth, from most to least significant
+	CHECK(PipelineShift + Graphics::RenderSortKeyBits_Pipeline == 64);
+	CHECK(Field(key, PipelineShift, Graphics::RenderSortKeyBits_Pipeline) == Graphics::Internal::HashSortKeyPointer(pipeline, 8));
+	CHECK(Field(key, DescriptorSetShift, Graphics::RenderSortKeyBits_DescriptorSet) == Graphics::Internal::HashSortKeyPointer(descriptorSet, 16));
+	CHECK(Field(key, MeshShift, Graphics::RenderSortKeyBits_Mesh) == Graphics::Internal::HashSortKeyPointer(mesh, 20));
+
+	u32 depthBits;
+	const float depth = 10.0f;
+	std::memcpy(&depthBits, &depth, sizeof(float));
+	CHECK(Field(key, 0, Graphics::RenderSortKeyBits_Depth) == depthBits >> 12);
+
+	// Changing one input only changes its own field
+	const u64 otherPipeline = Graphics::MakeRenderSortKey(FakeObject<void>(4), descriptorSet, mesh, 10.0f);
+	const u64 otherSet = Graphics::MakeRenderSortKey(pipeline, FakeObject<void>(5), mesh, 10.0f);
+	const u64 otherMesh = Graphics::MakeRenderSortKey(pipeline, descriptorSet, FakeObject<void>(6), 10.0f);
+	const u64 otherDepth = Graphics::MakeRenderSortKey(pipeline, descriptorSet, mesh, 20.0f);
+
+	CHECK(((key ^ otherPipeline) & ((1ULL << PipelineShift) - 1)) == 0);
+	CHECK(((key ^ otherSet) & ~(((1ULL << Graphics::RenderSortKeyBits_DescriptorSet) - 1) << DescriptorSetShift)) == 0);
+	CHECK(((key ^ otherMesh) & ~(((1ULL << Graphics::RenderSortKeyBits_Mesh) - 1) << MeshShift)) == 0);
+	CHECK(((key ^ otherDepth) >> Graphics::RenderSortKeyBits_Depth) == 0);
+}
+
+TEST_CASE(SortKeyDepthIsFrontToBack)
+{
+	const void* pipeline = FakeObject<void>(1);
+	const void* descriptorSet = FakeObject<void>(2);
+	const void* mesh = FakeObject<void>(3);
+
+	// Negative depths and zero share the front of the range
+	CHECK(Graphics::MakeRenderSortKey(pipeline, descriptorSet, mesh, -5.0f) == Graphics::MakeRenderSortKey(pipeline, descriptorSet, mesh, 0.0f));
+
+	float depth = 0.0f;
+	u64 previous = Graphics::MakeRenderSortKey(pipeline, descriptorSet, mesh, depth);
+	for(u32 i = 0; i < 1000; i++)
+	{
+		depth += Test::RandomFloat(0.01f, 10.0f);
+		const u64 key = Graphics::MakeRenderSortKey(pipeline, descriptorSet, mesh, depth);
+		CHECK(key >= previous);
+		previous = key;
+	}
+
+	// Depth never outranks the state fields above it
+	const u64 nearKey = Graphics::MakeRenderSortKey(pipeline, descriptorSet, mesh, 0.0f);
+	const u64 farKey = Graphics::MakeRenderSortKey(pipeline, descriptorSet, mesh, 1.0e30f);
+	CHECK((nearKey >> Graphics::RenderSortKeyBits_Depth) == (farKey >> Graphics::RenderSortKeyBits_Depth));
+}
+
+TEST_CASE(SortIsStable)
+{
+	std::vector<Graphics::RenderCommand> commands(500);
+	for(auto& command : commands)
+		command.sortKey = static_cast<u64>(Test::RandomFloat(0.0f, 8.0f)) << 40;
+
+	std::vector<u32> drawOrder;
+	Graphics::SortRenderCommands(commands, drawOrder);
+
+	CHECK(drawOrder.size() == commands.size());
+	for(u32 i = 1; i < static_cast<u32>(drawOrder.size()); i++)
+	{
+		const u64 keyA = commands[drawOrder[i - 1]].sortKey;
+		const u64 keyB = commands[drawOrder[i]].sortKey;
+		CHECK(keyA < keyB || (keyA == keyB && drawOrder[i - 1] < drawOrder[i]));
+	}
+
+	// Sorting again gives the same order, so draws don't swap between frames
+	std::vector<u32> again;
+	Graphics::SortRenderCommands(commands, again);
+	CHECK(again == drawOrder);
+}
+
+// Commands spread over a few meshes and materials and submitted in a random order, the way a scene submits them.
+// The forward renderer keys every command with its one descriptor set, the deferred renderer with the material's.
+static std::vector<Graphics::RenderCommand> CreateCommands(u32 count, u32 meshCount, u32 materialCount, bool keyByMaterial)
+{
+	const void* pipeline = FakeObject<void>(0);
+	const void* sharedDescriptorSet = FakeObject<void>(1);
+
+	std::vector<Graphics::RenderCommand> commands(count);
+	for(u32 i = 0; i < count; i++)
+	{
+		const u32 meshIndex = static_cast<u32>(Test::RandomFloat(0.0f, static_cast<float>(meshCount)));
+		const u32 materialIndex = static_cast<u32>(Test::RandomFloat(0.0f, static_cast<float>(materialCount)));
+
+		Graphics::RenderCommand& command = commands[i];
+		command.mesh = FakeObject<Graphics::Mesh>(100 + meshIndex);
+		command.material = FakeObject<Graphics::Material>(200 + materialIndex);
+		command.transform = Maths::Matrix3x4(Maths::Matrix4::Translation(Maths::Vector3(static_cast<float>(i), 0.0f, 0.0f)));
+		command.sortKey = Graphics::MakeRenderSortKey(pipeline, keyByMaterial ? command.material : sharedDescriptorSet, command.mesh, Test::RandomFloat(1.0f, 100.0f));
+	}
+	return commands;
+}
+
+// Vertex and index buffer binds made drawing the batches when, like the forward renderer, the buffers are only
+// rebound when the mesh changes. Every batch after the first that doesn't rebind is a skipped bind.
+static u32 CountMeshBinds(const std::vector<Graphics::RenderCommand>& commands, const std::vector<u32>& drawOrder, const std::vector<Graphics::RenderBatch>& batches)
+{
+	u32 binds = 0;
+	const Graphics::Mesh* bound = nullptr;
+	for(const auto& batch : batches)
+	{
+		const Graphics::Mesh* mesh = commands[drawOrder[batch.first]].mesh;
+		if(mesh != bound)
+		{
+			bound = mesh;
+			binds++;
+		}
+	}
+	return binds;
+}
+
+static std::vector<u32> SubmissionOrder(u32 count)
+{
+	std::vector<u32> order(count);
+	for(u32 i = 0; i < count; i++)
+		order[i] = i;
+	return order;
+}
+
+TEST_CASE(ForwardBatchesShareMesh)
+{
+	const std::vector<Graphics::RenderCommand> commands = CreateCommands(1000, 4, 3, false);
+	std::vector<u32> drawOrder;
+	Graphics::SortRenderCommands(commands, drawOrder);
+
+	Graphics::UniformArena arena(3, 1024, 256);
+	arena.BeginFrame(0);
+
+	std::vector<Graphics::RenderBatch> batches;
+	Graphics::BuildRenderBatches(commands, drawOrder, false, &arena, batches);
+
+	u32 instances = 0;
+	for(u32 i = 0; i < static_cast<u32>(batches.size()); i++)
+	{
+		const Graphics::RenderBatch& batch = batches[i];
+		CHECK(batch.first == instances);
+		CHECK(batch.instanceCount > 0 && batch.instanceCount <= MAX_INSTANCES_PER_DRAW);
+		for(u32 j = batch.first; j < batch.first + batch.instanceCount; j++)
+			CHECK(commands[drawOrder[j]].mesh == commands[drawOrder[batch.first]].mesh);
+
+		// A batch only ends at a new mesh or at the instance limit, the material doesn't split forward batches
+		if(i + 1 < static_cast<u32>(batches.size()))
+			CHECK(commands[drawOrder[batches[i + 1].first]].mesh != commands[drawOrder[batch.first]].mesh || batch.instanceCount == MAX_INSTANCES_PER_DRAW);
+
+		instances += batch.instanceCount;
+	}
+	CHECK(instances == 1000);
+
+	// Sorted, each mesh is bound once and every other batch skips the bind. 1000 commands over 4 meshes need
+	// at least 4 batches, and each mesh splits at most once more at the instance limit.
+	CHECK(CountMeshBinds(commands, drawOrder, batches) == 4);
+	CHECK(batches.size() >= 4 && batches.size() <= 8);
+
+	// In submission order three in four commands change mesh, nearly every command is its own batch and bind
+	const std::vector<u32> submissionOrder = SubmissionOrder(1000);
+	Graphics::BuildRenderBatches(commands, submissionOrder, false, &arena, batches);
+	CHECK(batches.size() > 600);
+	CHECK(CountMeshBinds(commands, submissionOrder, batches) == batches.size());
+}
+
+TEST_CASE(DeferredBatchesShareMeshAndMaterial)
+{
+	const std::vector<Graphics::RenderCommand> commands = CreateCommands(1000, 4, 3, true);
+	std::vector<u32> drawOrder;
+	Graphics::SortRenderCommands(commands, drawOrder);
+
+	Graphics::UniformArena arena(3, 1024, 256);
+	arena.BeginFrame(0);
+
+	std::vector<Graphics::RenderBatch> batches;
+	Graphics::BuildRenderBatches(commands, drawOrder, true, &arena, batches);
+
+	for(const auto& batch : batches)
+	{
+		for(u32 j = batch.first; j < batch.first + batch.instanceCount; j++)
+		{
+			CHECK(commands[drawOrder[j]].mesh == commands[drawOrder[batch.first]].mesh);
+			CHECK(commands[drawOrder[j]].material == commands[drawOrder[batch.first]].material);
+		}
+	}
+
+	// Sorting by material, then mesh, gives one batch per pair, none of which reaches the instance limit
+	CHECK(batches.size() == 12);
+	CHECK(CountMeshBinds(commands, drawOrder, batches) == 12);
+
+	// Without batching by material the same order still splits at every mesh change
+	Graphics::BuildRenderBatches(commands, drawOrder, false, &arena, batches);
+	CHECK(batches.size() == 12);
+}
+
+TEST_CASE(BatchTransformsArePackedAtTheirOffsets)
+{
+	const std::vector<Graphics::RenderCommand> commands = CreateCommands(600, 2, 1, false);
+	std::vector<u32> drawOrder;
+	Graphics::SortRenderCommands(commands, drawOrder);
+
+	// Too small for the frame, so building the batches grows the arena
+	Graphics::UniformArena arena(2, 256, 256);
+	arena.BeginFrame(1);
+	const u32 version = arena.GetVersion();
+
+	std::vector<Graphics::RenderBatch> batches;
+	Graphics::BuildRenderBatches(commands, drawOrder, false, &arena, batches);
+	CHECK(arena.GetVersion() != version);
+
+	const u32 alignment = static_cast<u32>(Graphics::Renderer::GetCapabilities().UniformBufferOffsetAlignment);
+	for(const auto& batch : batches)
+	{
+		CHECK(batch.dynamicOffset % alignment == 0);
+		CHECK(batch.dynamicOffset >= arena.GetRegionSize());
+
+		// The shader reads the batch's matrices from its dynamic offset, one per instance
+		const u8* data = arena.GetBuffer()->GetBuffer() + batch.dynamicOffset;
+		for(u32 j = batch.first; j < batch.first + batch.instanceCount; j++)
+		{
+			CHECK(std::memcmp(data, &commands[drawOrder[j]].transform, sizeof(Maths::Matrix3x4)) == 0);
+			data += sizeof(Maths::Matrix3x4);
+		}
+	}
+
+	arena.Upload();
+	CHECK(arena.GetUsed() >= 600 * sizeof(Maths::Matrix3x4));
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+
+	NullUniformBuffer::MakeDefault();
+	Graphics::Renderer::GetCapabilities().UniformBufferOffsetAlignment = 256;
+
+	const int result = Test::Run();
+
+	Debug::Log::OnRelease();
+	return result;
+}
@@ -0,0 +1,181 @@
+#include <LumosEngine.h>
+#include <Core/JobSystem.h>
+#include <Scene/SceneGraph.h>
+#include <Maths/Transform.h>
+
+#include <entt/entt.hpp>
+
+#include "Test.h"
+
+using namespace Lumos;
+
+static void RandomiseTransform(Maths::Transform& transform)
+{
+	transform.SetLocalPosition(Test::RandomVector(-5.0f, 5.0f));
+	transform.SetLocalOrientation(Maths::Quaternion(Test::RandomFloat(0.0f, 360.0f), Test::RandomVector(-1.0f, 1.0f).Normalized()));
+	transform.SetLocalScale(Test::RandomVector(0.9f, 1.1f));
+}
+
+static entt::entity AddEntity(entt::registry& registry, entt::entity parent)
+{
+	const entt::entity entity = registry.create();
+	RandomiseTransform(registry.emplace<Maths::Transform>(entity));
+	if(parent != entt::null)
+		registry.emplace<Hierarchy>(entity, parent);
+	return entity;
+}
+
+// World matrix built by walking up the Hierarchy links, the way the recursive update composed it.
+// Ancestors without a transform don't move their children.
+static Maths::Matrix3x4 ExpectedWorldMatrix(entt::registry& registry, entt::entity entity)
+{
+	Maths::Matrix3x4 local;
+	if(const auto transform = registry.try_get<Maths::Transform>(entity))
+		local = Maths::Matrix3x4(transform->GetLocalPosition(), transform->GetLocalOrientation(), transform->GetLocalScale());
+
+	const auto hierarchy = registry.try_get<Hierarchy>(entity);
+	if(!hierarchy || hierarchy->parent() == entt::null)
+		return local;
+
+	return ExpectedWorldMatrix(registry, hierarchy->parent()) * local;
+}
+
+// Deep chains accumulate float error, so the tolerance is relative to the size of the values
+static bool NearlyEqualRelative(const Maths::Matrix3x4& a, const Maths::Matrix3x4& b)
+{
+	const float* dataA = a.Data();
+	const float* dataB = b.Data();
+	for(u32 i = 0; i < 12; i++)
+	{
+		if(Maths::Abs(dataA[i] - dataB[i]) > 1e-3f * Maths::Max(1.0f, Maths::Abs(dataB[i])))
+			return false;
+	}
+	return true;
+}
+
+static bool MatchesRecursive(entt::registry& registry)
+{
+	bool matches = true;
+	registry.view<Maths::Transform>().each([&](entt::entity entity, Maths::Transform& transform) {
+		matches &= NearlyEqualRelative(transform.GetWorldMatrix3x4(), ExpectedWorldMatrix(registry, entity));
+	});
+	return matches;
+}
+
+TEST_CASE(SceneGraphDeepHierarchy)
+{
+	entt::registry registry;
+	SceneGraph sceneGraph;
+	sceneGraph.Init(registry);
+
+	// A single chain, one node per level
+	entt::entity parent = entt::null;
+	std::vector<entt::entity> chain;
+	for(u32 i = 0; i < 64; i++)
+	{
+		parent = AddEntity(registry, parent);
+		chain.push_back(parent);
+	}
+
+	sceneGraph.Update(registry);
+	CHECK(MatchesRecursive(registry));
+
+	// Moving a node half way down only updates it and the nodes below it, they must all follow
+	RandomiseTransform(registry.get<Maths::Transform>(chain[32]));
+	sceneGraph.Update(registry);
+	CHECK(MatchesRecursive(registry));
+}
+
+TEST_CASE(SceneGraphWideHierarchy)
+{
+	entt::registry registry;
+	SceneGraph sceneGraph;
+	sceneGraph.Init(registry);
+
+	// Levels of 600 and 1200 nodes are split over several jobs, plus some roots without a Hierarchy
+	std::vector<entt::entity> roots;
+	for(u32 i = 0; i < 4; i++)
+		roots.push_back(AddEntity(registry, entt::null));
+
+	std::vector<entt::entity> children;
+	for(u32 i = 0; i < 600; i++)
+		children.push_back(AddEntity(registry, roots[i % 2]));
+
+	std::vector<entt::entity> grandChildren;
+	for(u32 i = 0; i < 1200; i++)
+		grandChildren.push_back(AddEntity(registry, children[i / 2]));
+
+	sceneGraph.Update(registry);
+	CHECK(MatchesRecursive(registry));
+
+	// Dirty nodes spread over the levels and jobs
+	RandomiseTransform(registry.get<Maths::Transform>(roots[1]));
+	for(u32 i = 0; i < 600; i += 37)
+		RandomiseTransform(registry.get<Maths::Transform>(children[i]));
+	for(u32 i = 0; i < 1200; i += 53)
+		RandomiseTransform(registry.get<Maths::Transform>(grandChildren[i]));
+
+	sceneGraph.Update(registry);
+	CHECK(MatchesRecursive(registry));
+
+	// An update with nothing changed leaves the matrices alone
+	sceneGraph.Update(registry);
+	CHECK(MatchesRecursive(registry));
+}
+
+TEST_CASE(SceneGraphRebuildsAfterReparent)
+{
+	entt::registry registry;
+	SceneGraph sceneGraph;
+	sceneGraph.Init(registry);
+
+	const entt::entity rootA = AddEntity(registry, entt::null);
+	const entt::entity rootB = AddEntity(registry, entt::null);
+
+	// Three siblings under rootA, the middle one has a subtree of 300 nodes
+	const entt::entity first = AddEntity(registry, rootA);
+	const entt::entity middle = AddEntity(registry, rootA);
+	const entt::entity last = AddEntity(registry, rootA);
+
+	std::vector<entt::entity> subtree;
+	for(u32 i = 0; i < 300; i++)
+		subtree.push_back(AddEntity(registry, middle));
+	AddEntity(registry, subtree[0]);
+
+	sceneGraph.Update(registry);
+	CHECK(MatchesRecursive(registry));
+
+	// Move the middle sibling and its subtree under the other root, the subtree changes depth
+	const entt::entity newParent = AddEntity(registry, rootB);
+	Hierarchy::Reparent(middle, newParent, registry, registry.get<Hierarchy>(middle));
+	CHECK(registry.get<Hierarchy>(middle).parent() == newParent);
+	CHECK(registry.get<Hierarchy>(first).next() == last);
+
+	sceneGraph.Update(registry);
+	CHECK(MatchesRecursive(registry));
+
+	// Removing a transform rebuilds too, the node's children then follow the closest ancestor with one
+	registry.remove<Maths::Transform>(newParent);
+	RandomiseTransform(registry.get<Maths::Transform>(rootB));
+	sceneGraph.Update(registry);
+	CHECK(MatchesRecursive(registry));
+
+	// And out to a root of its own
+	Hierarchy::Reparent(middle, entt::null, registry, registry.get<Hierarchy>(middle));
+	CHECK(registry.get<Hierarchy>(middle).parent() == entt::null);
+
+	sceneGraph.Update(registry);
+	CHECK(MatchesRecursive(registry));
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+	System::JobSystem::OnInit();
+
+	const int result = Test::Run();
+
+	System::JobSystem::OnShutdown();
+	Debug::Log::OnRelease();
+	return result;
+}
@@ -0,0 +1,195 @@
+#include <LumosEngine.h>
+#include <Core/JobSystem.h>
+#include <Physics/LumosPhysicsEngine/LumosPhysicsEngine.h>
+#include <Physics/LumosPhysicsEngine/DynamicTreeBroadphase.h>
+#include <Physics/LumosPhysicsEngine/BruteForceBroadphase.h>
+#include <Physics/LumosPhysicsEngine/SphereCollisionShape.h>
+#include <Physics/LumosPhysicsEngine/CuboidCollisionShape.h>
+#include <Scene/Component/Physics3DComponent.h>
+
+#include "Test.h"
+
+#include <algorithm>
+
+using namespace Lumos;
+
+static Ref<RigidBody3D> AddStaticBody(Scene& scene, const Maths::Vector3& position, const Ref<CollisionShape>& shape)
+{
+	RigidBody3DProperties properties;
+	properties.Position = position;
+	properties.Static = true;
+	properties.Shape = shape;
+
+	Ref<RigidBody3D> body = CreateRef<RigidBody3D>(properties);
+	scene.GetEntityManager()->Create().AddComponent<Physics3DComponent>(body);
+	return body;
+}
+
+// Runs one step so the engine picks up the scene's bodies and the broadphase builds its structure
+static void Step(LumosPhysicsEngine& physics, Scene& scene)
+{
+	physics.SetGravity(Maths::Vector3(0.0f));
+	physics.SetPaused(false);
+
+	TimeStep timeStep(0.0f);
+	timeStep.Update(1.0f / 60.0f);
+	physics.OnUpdate(timeStep, &scene);
+}
+
+// Index of the body a hit landed on, -1 for a miss, so hits in two scenes built the same way can be compared
+static int BodyIndex(const std::vector<Ref<RigidBody3D>>& bodies, const RaycastHit& hit)
+{
+	for(size_t i = 0; i < bodies.size(); i++)
+	{
+		if(bodies[i].get() == hit.body)
+			return static_cast<int>(i);
+	}
+	return -1;
+}
+
+TEST_CASE(RaycastMatchesWithoutTree)
+{
+	// The same bodies queried through the dynamic tree and through the brute force broadphase, which keeps
+	// no structure, so the engine tests every body's bounds
+	Scene treeScene("RaycastTree");
+	Scene bruteScene("RaycastBruteForce");
+	std::vector<Ref<RigidBody3D>> treeBodies;
+	std::vector<Ref<RigidBody3D>> bruteBodies;
+
+	for(u32 i = 0; i < 64; i++)
+	{
+		const Maths::Vector3 position = Test::RandomVector(-20.0f, 20.0f);
+		const float size = Test::RandomFloat(0.5f, 2.0f);
+		const bool sphere = i % 2 == 0;
+
+		auto shape = [&]() -> Ref<CollisionShape> {
+			if(sphere)
+				return CreateRef<SphereCollisionShape>(size);
+			return CreateRef<CuboidCollisionShape>(Maths::Vector3(size, size * 0.5f, size * 1.5f));
+		};
+
+		treeBodies.push_back(AddStaticBody(treeScene, position, shape()));
+		bruteBodies.push_back(AddStaticBody(bruteScene, position, shape()));
+	}
+
+	LumosPhysicsEngine treePhysics;
+	treePhysics.SetBroadphase(CreateRef<DynamicTreeBroadphase>());
+	Step(treePhysics, treeScene);
+
+	LumosPhysicsEngine brutePhysics;
+	brutePhysics.SetBroadphase(CreateRef<BruteForceBroadphase>());
+	Step(brutePhysics, bruteScene);
+
+	const u32 rayCount = 256;
+	std::vector<Maths::Ray> rays;
+	for(u32 i = 0; i < rayCount; i++)
+	{
+		// Aimed near a body, so most rays hit something and many pass others on the way
+		const Maths::Vector3 origin = Test::RandomVector(-30.0f, 30.0f);
+		const Maths::Vector3 target = treeBodies[i % treeBodies.size()]->GetPosition() + Test::RandomVector(-2.0f, 2.0f);
+		rays.push_back(Maths::Ray(origin, (target - origin).Normalized()));
+	}
+
+	std::vector<RaycastHit> batchHits(rayCount);
+	treePhysics.RaycastBatch(rays.data(), rayCount, 50.0f, batchHits.data());
+
+	u32 hits = 0;
+	for(u32 i = 0; i < rayCount; i++)
+	{
+		RaycastHit treeHit;
+		RaycastHit bruteHit;
+		const bool treeHasHit = treePhysics.Raycast(rays[i], 50.0f, &treeHit);
+		const bool bruteHasHit = brutePhysics.Raycast(rays[i], 50.0f, &bruteHit);
+
+		CHECK(treeHasHit == bruteHasHit);
+		CHECK(BodyIndex(treeBodies, treeHit) == BodyIndex(bruteBodies, bruteHit));
+		CHECK(Test::NearlyEqual(treeHit.distance, bruteHit.distance, 1e-3f));
+
+		// The batch runs the same query from the job system
+		CHECK(batchHits[i].body == treeHit.body);
+		CHECK(batchHits[i].distance == treeHit.distance);
+
+		hits += treeHasHit ? 1 : 0;
+	}
+
+	CHECK(hits > rayCount / 2);
+}
+
+TEST_CASE(AxisParallelRayOnBoundsHitsFace)
+{
+	// Without a margin the tree's bounds are the box's faces. A ray running along a face starts on a slab plane
+	// of the bounds and is parallel to it, which used to make the slab test compute 0 * inf and skip the box.
+	Scene scene("AxisParallelRayOnBoundsHitsFace");
+	Ref<RigidBody3D> box = AddStaticBody(scene, Maths::Vector3(0.0f), CreateRef<CuboidCollisionShape>(Maths::Vector3(1.0f)));
+
+	LumosPhysicsEngine physics;
+	physics.SetBroadphase(CreateRef<DynamicTreeBroadphase>(0.0f));
+	Step(physics, scene);
+
+	RaycastHit hit;
+
+	// Along the -x face and along the edge between the -x and +y faces
+	CHECK(physics.Raycast(Maths::Ray(Maths::Vector3(-1.0f, 0.0f, -10.0f), Maths::Vector3(0.0f, 0.0f, 1.0f)), 100.0f, &hit));
+	CHECK(hit.body == box.get());
+	CHECK(Test::NearlyEqual(hit.distance, 9.0f, 1e-3f));
+
+	CHECK(physics.Raycast(Maths::Ray(Maths::Vector3(-1.0f, 1.0f, -10.0f), Maths::Vector3(0.0f, 0.0f, 1.0f)), 100.0f, &hit));
+	CHECK(hit.body == box.get());
+	CHECK(Test::NearlyEqual(hit.distance, 9.0f, 1e-3f));
+
+	// On the plane of the -x face but beside the box
+	CHECK(!physics.Raycast(Maths::Ray(Maths::Vector3(-1.0f, 1.5f, -10.0f), Maths::Vector3(0.0f, 0.0f, 1.0f)), 100.0f, &hit));
+
+	// Starting inside the box, parallel to two of its slabs
+	CHECK(physics.Raycast(Maths::Ray(Maths::Vector3(0.5f, -0.5f, 0.0f), Maths::Vector3(0.0f, 0.0f, 1.0f)), 100.0f, &hit));
+	CHECK(hit.body == box.get());
+	CHECK(Test::NearlyEqual(hit.distance, 0.0f, 1e-3f));
+}
+
+TEST_CASE(SphereOverlapTestsShapesAndAABBQueryTestsBounds)
+{
+	Scene scene("SphereOverlapTestsShapesAndAABBQueryTestsBounds");
+	Ref<RigidBody3D> box = AddStaticBody(scene, Maths::Vector3(0.0f), CreateRef<CuboidCollisionShape>(Maths::Vector3(1.0f)));
+	Ref<RigidBody3D> sphere = AddStaticBody(scene, Maths::Vector3(10.0f, 0.0f, 0.0f), CreateRef<SphereCollisionShape>(1.0f));
+
+	LumosPhysicsEngine physics;
+	physics.SetBroadphase(CreateRef<DynamicTreeBroadphase>());
+	Step(physics, scene);
+
+	std::vector<RigidBody3D*> bodies;
+
+	// Beside the box's +x face
+	CHECK(physics.SphereOverlap(Maths::Vector3(1.5f, 0.0f, 0.0f), 0.6f, bodies) == 1);
+	CHECK(bodies.size() == 1 && bodies[0] == box.get());
+
+	// Off the box's corner, the query bounds overlap the box but the sphere doesn't reach it
+	bodies.clear();
+	const Maths::Vector3 corner(1.5f);
+	CHECK(physics.SphereOverlap(corner, 0.8f, bodies) == 0);
+	CHECK(bodies.empty());
+	CHECK(physics.AABBQuery(Maths::BoundingBox(corner - Maths::Vector3(0.8f), corner + Maths::Vector3(0.8f)), bodies) == 1);
+	CHECK(bodies.size() == 1 && bodies[0] == box.get());
+
+	// Results are appended, and a box covering both bodies finds both
+	CHECK(physics.AABBQuery(Maths::BoundingBox(Maths::Vector3(-2.0f), Maths::Vector3(12.0f, 2.0f, 2.0f)), bodies) == 2);
+	CHECK(bodies.size() == 3);
+	CHECK(std::count(bodies.begin(), bodies.end(), sphere.get()) == 1);
+
+	// Between the two bodies
+	bodies.clear();
+	CHECK(physics.SphereOverlap(Maths::Vector3(5.0f, 0.0f, 0.0f), 2.0f, bodies) == 0);
+	CHECK(physics.AABBQuery(Maths::BoundingBox(Maths::Vector3(4.0f), Maths::Vector3(6.0f)), bodies) == 0);
+	CHECK(bodies.empty());
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+	System::JobSystem::OnInit();
+
+	const int result = Test::Run();
+
+	System::JobSystem::OnShutdown();
+	Debug::Log::OnRelease();
+	return result;
+}
@@ -0,0 +1,195 @@
+#include <LumosEngine.h>
+#include <Core/JobSystem.h>
+#include <Core/OS/FileSystem.h>
+#include <Scene/Component/Physics3DComponent.h>
+#include <Scene/SceneLoadContext.h>
+
+#include <cereal/archives/json.hpp>
+#include <entt/entt.hpp>
+#include <cstdio>
+#include <sstream>
+
+#include "Test.h"
+
+using namespace Lumos;
+
+// A version 4 scene as the baseline saved it: one entity with a Physics3DComponent, whose RigidBody3D has
+// no ContinuousCollision field. The counts are the ALL_COMPONENTSV3 lists, Physics3DComponent is the ninth.
+static const char* s_Version4Scene = R"({
+    "value0": {
+        "Version": 4,
+        "Scene Name": "Version4"
+    },
+    "value1": 1,
+    "value2": 0,
+    "value3": 0,
+    "value4": 0,
+    "value5": 0,
+    "value6": 0,
+    "value7": 0,
+    "value8": 0,
+    "value9": 0,
+    "value10": 0,
+    "value11": 1,
+    "value12": 0,
+    "value13": {
+        "value0": {
+            "Position": {
+                "value0": 1.0,
+                "value1": 2.0,
+                "value2": 3.0
+            },
+            "LinearVelocity": {
+                "value0": 0.0,
+                "value1": 0.0,
+                "value2": 0.0
+            },
+            "Force": {
+                "value0": 0.0,
+                "value1": 0.0,
+                "value2": 0.0
+            },
+            "Mass": 1.0,
+            "AngularVelocity": {
+                "value0": 0.0,
+                "value1": 0.0,
+                "value2": 0.0
+            },
+            "Torque": {
+                "value0": 0.0,
+                "value1": 0.0,
+                "value2": 0.0
+            },
+            "Static": true,
+            "Friction": 0.5,
+            "Elasticity": 0.25,
+            "CollisionShape": {
+                "polymorphic_id": 2147483649,
+                "polymorphic_name": "Lumos::CuboidCollisionShape",
+                "ptr_wrapper": {
+                    "valid": 1,
+                    "data": {
+                        "value0": {
+                            "value0": 4.0,
+                            "value1": 0.5,
+                            "value2": 4.0
+                        }
+                    }
+                }
+            },
+            "Trigger": false
+        }
+    },
+    "value14": 0,
+    "value15": 0,
+    "value16": 0,
+    "value17": 0,
+    "value18": 0,
+    "value19": 0
+})";
+
+// Physics3DComponent::GetRigidBody waits on the application's physics engine, which these tests don't
+// create. The loaded body is read back through the component's own save instead.
+static Ref<RigidBody3D> LoadedRigidBody(Scene& scene)
+{
+	auto& registry = scene.GetEntityManager()->GetRegistry();
+	auto view = registry.view<Physics3DComponent>();
+	if(view.size() != 1)
+		return nullptr;
+
+	std::stringstream storage;
+	{
+		cereal::JSONOutputArchive output(storage);
+		view.get<Physics3DComponent>(view.front()).save(output);
+	}
+
+	auto body = CreateRef<RigidBody3D>();
+	SceneLoadContext context = { 5 };
+	SceneInputArchive<cereal::JSONInputArchive> input(context, storage);
+	input(*body);
+	return body;
+}
+
+TEST_CASE(LoadsVersion4SceneWithoutContinuousCollision)
+{
+	FileSystem::WriteTextFile("Version4.lsn", s_Version4Scene);
+
+	Scene scene("Version4");
+	scene.Deserialise("");
+
+	Ref<RigidBody3D> body = LoadedRigidBody(scene);
+	CHECK(body != nullptr);
+	if(body)
+	{
+		CHECK(body->GetPosition() == Maths::Vector3(1.0f, 2.0f, 3.0f));
+		CHECK(body->GetIsStatic());
+		CHECK(body->GetFriction() == 0.5f);
+		CHECK(body->GetElasticity() == 0.25f);
+		CHECK(body->GetCollisionShape() && body->GetCollisionShape()->GetType() == CollisionShapeType::CollisionCuboid);
+		CHECK(!body->GetContinuousCollision());
+	}
+
+	std::remove("Version4.lsn");
+}
+
+TEST_CASE(LoadsSavedSceneWithContinuousCollision)
+{
+	// A version 4 file that fails to load part way through mustn't change how the next scene is read
+	std::string broken = s_Version4Scene;
+	broken.replace(broken.find("Trigger"), 7, "Missing");
+	FileSystem::WriteTextFile("Broken.lsn", broken);
+	bool threw = false;
+	try
+	{
+		Scene scene("Broken");
+		scene.Deserialise("");
+	}
+	catch(const cereal::Exception&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+	std::remove("Broken.lsn");
+
+	{
+		RigidBody3DProperties properties;
+		properties.Position = Maths::Vector3(-1.0f, 0.0f, 5.0f);
+		properties.Shape = CreateRef<SphereCollisionShape>(0.5f);
+		properties.ContinuousCollision = true;
+
+		Ref<RigidBody3D> body = CreateRef<RigidBody3D>(properties);
+
+		Scene scene("Saved");
+		scene.GetEntityManager()->Create().AddComponent<Physics3DComponent>(body);
+		scene.Serialise("");
+	}
+
+	const std::string data = FileSystem::ReadTextFile("Saved.lsn");
+	CHECK(data.find("\"Version\": 5") != std::string::npos);
+
+	Scene scene("Saved");
+	scene.Deserialise("");
+
+	Ref<RigidBody3D> body = LoadedRigidBody(scene);
+	CHECK(body != nullptr);
+	if(body)
+	{
+		CHECK(body->GetPosition() == Maths::Vector3(-1.0f, 0.0f, 5.0f));
+		CHECK(body->GetCollisionShape() && body->GetCollisionShape()->GetType() == CollisionShapeType::CollisionSphere);
+		CHECK(body->GetContinuousCollision());
+	}
+
+	std::remove("Saved.lsn");
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+	System::JobSystem::OnInit();
+
+	const int result = Test::Run();
+
+	System::JobSystem::OnShutdown();
+	Debug::Log::OnRelease();
+	return result;
+}
@@ -0,0 +1,117 @@
+#include <LumosEngine.h>
+#include <Core/JobSystem.h>
+#include <Scene/SystemManager.h>
+#include <Platform/OpenAL/ALManager.h>
+#include <Physics/LumosPhysicsEngine/LumosPhysicsEngine.h>
+#include <Physics/B2PhysicsEngine/B2PhysicsEngine.h>
+#include <Scene/Component/SoundComponent.h>
+#include <Utilities/TimeStep.h>
+
+#include "Test.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace Lumos;
+
+TEST_CASE(AudioDoesNotConflictWithPhysics)
+{
+	LumosPhysicsEngine physics3D;
+	B2PhysicsEngine physics2D;
+	Audio::ALManager audio;
+
+	// Both physics engines write transforms, so they stay ordered
+	CHECK(physics3D.ConflictsWith(physics2D));
+
+	// Audio only reads the camera and updates sound components, so it runs alongside either of them
+	CHECK(!audio.ConflictsWith(physics3D));
+	CHECK(!audio.ConflictsWith(physics2D));
+}
+
+// Records whether another probe was running at the same time as its update
+struct Overlap
+{
+	std::atomic<u32> running { 0 };
+	std::atomic<u32> maxRunning { 0 };
+};
+
+// Id keeps probes touching the same component distinct types, the SystemManager holds one system per type
+template<typename Component, int Id = 0>
+class ProbeSystem : public ISystem
+{
+public:
+	ProbeSystem(Overlap& overlap, bool write)
+		: m_Overlap(overlap)
+	{
+		m_DebugName = "Probe";
+		if(write)
+			Writes<Component>();
+		else
+			Reads<Component>();
+	}
+
+	void OnInit() override {}
+	void OnImGui() override {}
+	void OnDebugDraw() override {}
+
+	void OnUpdate(const TimeStep& dt, Scene* scene) override
+	{
+		u32 running = ++m_Overlap.running;
+		u32 expected = m_Overlap.maxRunning.load();
+		while(running > expected && !m_Overlap.maxRunning.compare_exchange_weak(expected, running))
+		{
+		}
+
+		// Give a concurrent probe time to start
+		const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+		while(m_Overlap.maxRunning.load() < 2 && std::chrono::steady_clock::now() < end)
+			std::this_thread::yield();
+
+		m_Overlap.running--;
+	}
+
+private:
+	Overlap& m_Overlap;
+};
+
+TEST_CASE(DisjointSystemsUpdateConcurrently)
+{
+	Scene scene("DisjointSystemsUpdateConcurrently");
+	TimeStep timeStep(0.0f);
+
+	Overlap overlap;
+	SystemManager systems;
+	systems.RegisterSystem<ProbeSystem<Maths::Transform>>(overlap, true);
+	systems.RegisterSystem<ProbeSystem<SoundComponent>>(overlap, true);
+	systems.OnUpdate(timeStep, &scene);
+
+	CHECK(overlap.maxRunning.load() == 2);
+}
+
+TEST_CASE(ConflictingSystemsNeverOverlap)
+{
+	Scene scene("ConflictingSystemsNeverOverlap");
+	TimeStep timeStep(0.0f);
+
+	Overlap overlap;
+	SystemManager systems;
+	systems.RegisterSystem<ProbeSystem<Maths::Transform, 0>>(overlap, true);
+	systems.RegisterSystem<ProbeSystem<Maths::Transform, 1>>(overlap, false);
+	systems.OnUpdate(timeStep, &scene);
+
+	// The second system reads what the first writes
+	CHECK(overlap.maxRunning.load() == 1);
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+	System::JobSystem::OnInit();
+
+	const int result = Test::Run();
+
+	System::JobSystem::OnShutdown();
+	Debug::Log::OnRelease();
+	return result;
+}
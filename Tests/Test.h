@@ -0,0 +1,117 @@
+#pragma once
+
+#include <Maths/Maths.h>
+#include <Maths/Matrix3x4.h>
+
+#include <cstdio>
+#include <vector>
+
+// Minimal test runner for the command line test executables. Test cases register themselves with
+// TEST_CASE, CHECK reports a failed condition and carries on with the rest of the case.
+
+namespace Test
+{
+	struct Case
+	{
+		const char* name;
+		void (*function)();
+	};
+
+	inline std::vector<Case>& GetCases()
+	{
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	inline int& GetFailureCount()
+	{
+		static int failures = 0;
+		return failures;
+	}
+
+	struct Register
+	{
+		Register(const char* name, void (*function)())
+		{
+			GetCases().push_back({ name, function });
+		}
+	};
+
+	inline void Fail(const char* file, int line, const char* condition)
+	{
+		printf("\t%s(%d): CHECK(%s) failed\n", file, line, condition);
+		GetFailureCount()++;
+	}
+
+	// Returns the process exit code
+	inline int Run()
+	{
+		int failedCases = 0;
+		for(auto& testCase : GetCases())
+		{
+			const int failures = GetFailureCount();
+			testCase.function();
+
+			const bool passed = failures == GetFailureCount();
+			printf("[%s] %s\n", passed ? "PASS" : "FAIL", testCase.name);
+			failedCases += passed ? 0 : 1;
+		}
+
+		printf("%zu cases, %d failed\n", GetCases().size(), failedCases);
+		return failedCases == 0 ? 0 : 1;
+	}
+
+	// Deterministic random numbers, so a failure reproduces
+	inline u32& RandomSeed()
+	{
+		static u32 seed = 12345;
+		return seed;
+	}
+
+	inline float RandomFloat(float min, float max)
+	{
+		u32& seed = RandomSeed();
+		seed = seed * 1664525u + 1013904223u;
+		return min + (max - min) * float(seed >> 8) / float(1 << 24);
+	}
+
+	inline Lumos::Maths::Vector3 RandomVector(float min, float max)
+	{
+		return Lumos::Maths::Vector3(RandomFloat(min, max), RandomFloat(min, max), RandomFloat(min, max));
+	}
+
+	inline bool NearlyEqual(float a, float b, float tolerance)
+	{
+		return Lumos::Maths::Abs(a - b) < tolerance;
+	}
+
+	inline bool NearlyEqual(const Lumos::Maths::Vector3& a, const Lumos::Maths::Vector3& b, float tolerance = 1e-3f)
+	{
+		return (a - b).Length() < tolerance;
+	}
+
+	// Compares each element, a tolerance of 0 asks for identical matrices
+	inline bool NearlyEqual(const Lumos::Maths::Matrix3x4& a, const Lumos::Maths::Matrix3x4& b, float tolerance)
+	{
+		const float* dataA = a.Data();
+		const float* dataB = b.Data();
+		for(u32 i = 0; i < 12; i++)
+		{
+			if(Lumos::Maths::Abs(dataA[i] - dataB[i]) > tolerance)
+				return false;
+		}
+		return true;
+	}
+}
+
+#define TEST_CASE(name)                                  \
+	static void name();                                  \
+	static Test::Register name##_Register(#name, &name); \
+	static void name()
+
+#define CHECK(condition)                                    \
+	do                                                      \
+	{                                                       \
+		if(!(condition))                                    \
+			Test::Fail(__FILE__, __LINE__, #condition);     \
+	} while(false)
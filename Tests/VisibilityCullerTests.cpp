@@ -0,0 +1,156 @@
+#include <LumosEngine.h>
+#include <Core/JobSystem.h>
+#include <Graphics/VisibilityCuller.h>
+#include <Graphics/Mesh.h>
+#include <Graphics/Model.h>
+#include <Maths/Transform.h>
+#include <Maths/Frustum.h>
+
+#include <entt/entt.hpp>
+
+#include "Test.h"
+
+using namespace Lumos;
+
+// Culling only reads a mesh's bounds, so meshes without vertex or index buffers stand in for loaded ones
+static Ref<Graphics::Mesh> CreateMesh(const Maths::BoundingBox& bounds)
+{
+	Ref<Graphics::VertexBuffer> vertexBuffer;
+	Ref<Graphics::IndexBuffer> indexBuffer;
+	return CreateRef<Graphics::Mesh>(vertexBuffer, indexBuffer, CreateRef<Maths::BoundingBox>(bounds));
+}
+
+static entt::entity CreateRenderable(entt::registry& registry, const Maths::BoundingBox& bounds, const Maths::Matrix3x4& worldMatrix)
+{
+	const entt::entity entity = registry.create();
+	registry.emplace<Graphics::Model>(entity, CreateMesh(bounds), Graphics::PrimitiveType::Cube);
+	registry.emplace<Maths::Transform>(entity).SetWorldMatrix(worldMatrix);
+	return entity;
+}
+
+static Maths::Matrix3x4 RandomWorldMatrix(float range)
+{
+	const Maths::Quaternion rotation(Test::RandomFloat(0.0f, 360.0f), Test::RandomVector(-1.0f, 1.0f).Normalized());
+	return Maths::Matrix3x4(Test::RandomVector(-range, range), rotation, Test::RandomFloat(0.5f, 2.0f));
+}
+
+static Maths::Frustum RandomFrustum()
+{
+	Maths::Frustum frustum;
+	frustum.Define(Test::RandomFloat(30.0f, 90.0f), Test::RandomFloat(0.5f, 2.0f), 1.0f, 0.1f, Test::RandomFloat(20.0f, 80.0f), RandomWorldMatrix(10.0f));
+	return frustum;
+}
+
+// The renderables the frustum keeps according to Frustum::IsInsideFast on each mesh's transformed bounds
+static std::vector<u32> CullOneByOne(const Graphics::VisibilityCuller& culler, const Maths::Frustum& frustum)
+{
+	std::vector<u32> visible;
+	for(u32 i = 0; i < culler.GetRenderableCount(); i++)
+	{
+		const auto& renderable = culler.GetRenderable(i);
+		const Maths::BoundingBox box = renderable.mesh->GetBoundingBox()->Transformed(renderable.worldTransform);
+		if(frustum.IsInsideFast(box) != Maths::OUTSIDE)
+			visible.push_back(i);
+	}
+	return visible;
+}
+
+TEST_CASE(CullMatchesIsInsideFast)
+{
+	// Counts that leave 0 to 3 boxes in the last group of four, and enough boxes to cull over several jobs
+	const u32 counts[] = { 1, 2, 3, 4, 5, 7, 64, 1027 };
+
+	for(u32 count : counts)
+	{
+		entt::registry registry;
+		for(u32 i = 0; i < count; i++)
+		{
+			const Maths::Vector3 min = Test::RandomVector(-2.0f, 0.0f);
+			CreateRenderable(registry, Maths::BoundingBox(min, min + Test::RandomVector(0.1f, 3.0f)), RandomWorldMatrix(40.0f));
+		}
+
+		Graphics::VisibilityCuller culler;
+		culler.Update(registry);
+		CHECK(culler.GetRenderableCount() == count);
+
+		u32 visibleTotal = 0;
+		for(u32 i = 0; i < 20; i++)
+		{
+			const Maths::Frustum frustum = RandomFrustum();
+			const std::vector<u32>& visible = culler.Cull(frustum);
+			CHECK(visible == CullOneByOne(culler, frustum));
+			visibleTotal += static_cast<u32>(visible.size());
+		}
+
+		// Some frustums see some boxes, so the comparison isn't only of empty lists
+		if(count > 64)
+			CHECK(visibleTotal > 0 && visibleTotal < count * 20);
+	}
+}
+
+TEST_CASE(CullResultsAreSharedPerFrustum)
+{
+	entt::registry registry;
+	for(u32 i = 0; i < 16; i++)
+		CreateRenderable(registry, Maths::BoundingBox(Maths::Vector3(-1.0f), Maths::Vector3(1.0f)), RandomWorldMatrix(20.0f));
+
+	Graphics::VisibilityCuller culler;
+	culler.Update(registry);
+
+	const Maths::Frustum frustum = RandomFrustum();
+	const std::vector<u32>* first = &culler.Cull(frustum);
+	CHECK(&culler.Cull(RandomFrustum()) != first);
+	CHECK(&culler.Cull(frustum) == first);
+}
+
+TEST_CASE(BoundsRefreshWhenWorldMatrixVersionChanges)
+{
+	entt::registry registry;
+	const Maths::BoundingBox bounds(Maths::Vector3(-1.0f), Maths::Vector3(1.0f));
+	const entt::entity entity = CreateRenderable(registry, bounds, Maths::Matrix3x4(Maths::Vector3(0.0f, 0.0f, 10.0f), Maths::Quaternion(), 1.0f));
+
+	// Looking down +z from the origin
+	Maths::Frustum frustum;
+	frustum.Define(60.0f, 1.0f, 1.0f, 0.1f, 50.0f);
+
+	Graphics::VisibilityCuller culler;
+	culler.Update(registry);
+	CHECK(culler.Cull(frustum).size() == 1);
+
+	auto& transform = registry.get<Maths::Transform>(entity);
+	CHECK(culler.GetRenderable(0).worldMatrixVersion == transform.GetWorldMatrixVersion());
+
+	// The scene graph moving the mesh behind the camera sets a new world matrix, which bumps the version
+	const u32 version = transform.GetWorldMatrixVersion();
+	transform.SetWorldMatrix(Maths::Matrix3x4(Maths::Vector3(0.0f, 0.0f, -10.0f), Maths::Quaternion(), 1.0f));
+	CHECK(transform.GetWorldMatrixVersion() != version);
+
+	culler.Update(registry);
+	CHECK(culler.GetRenderable(0).worldMatrixVersion == transform.GetWorldMatrixVersion());
+	CHECK(culler.Cull(frustum).empty());
+	CHECK(culler.Cull(frustum) == CullOneByOne(culler, frustum));
+
+	// Changing the local transform alone doesn't change the world matrix version, the bounds stay as they were
+	// until the scene graph sets the new world matrix
+	transform.SetLocalPosition(Maths::Vector3(0.0f, 0.0f, 20.0f));
+	culler.Update(registry);
+	CHECK(culler.GetRenderable(0).worldMatrixVersion == transform.GetWorldMatrixVersion());
+	CHECK(culler.Cull(frustum).empty());
+
+	// The scene graph applying a parent matrix to the new local position moves it back into view
+	transform.SetWorldMatrix(Maths::Matrix3x4(Maths::Vector3(2.0f, 0.0f, 0.0f), Maths::Quaternion(), 1.0f));
+	culler.Update(registry);
+	CHECK(culler.Cull(frustum).size() == 1);
+}
+
+int main(int argc, char** argv)
+{
+	Debug::Log::OnInit();
+	System::JobSystem::OnInit();
+
+	const int result = Test::Run();
+
+	System::JobSystem::OnShutdown();
+	Debug::Log::OnRelease();
+	return result;
+}
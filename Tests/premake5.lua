@@ -0,0 +1,146 @@
+-- Command line test executables. Each one runs its test cases and returns non-zero if any check failed.
+-- SetBenchmarkSettings comes from Benchmarks/premake5.lua.
+
+project "JobSystemTests"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"Test.h",
+		"JobSystemTests.cpp"
+	}
+
+project "PhysicsTests"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"Test.h",
+		"PhysicsTests.cpp"
+	}
+
+project "ContinuousCollisionTests"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"Test.h",
+		"ContinuousCollisionTests.cpp"
+	}
+
+project "AssetManagerTests"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"Test.h",
+		"AssetManagerTests.cpp"
+	}
+
+project "BroadphaseTests"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"Test.h",
+		"BroadphaseTests.cpp"
+	}
+
+project "SceneQueryTests"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"Test.h",
+		"SceneQueryTests.cpp"
+	}
+
+project "GJKTests"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"Test.h",
+		"GJKTests.cpp"
+	}
+
+project "CollisionDetectionTests"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"Test.h",
+		"CollisionDetectionTests.cpp"
+	}
+
+project "IntegrationTests"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"Test.h",
+		"IntegrationTests.cpp"
+	}
+
+project "MatrixBatchTests"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"Test.h",
+		"MatrixBatchTests.cpp"
+	}
+
+project "SceneGraphTests"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"Test.h",
+		"SceneGraphTests.cpp"
+	}
+
+project "RenderCommandTests"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"Test.h",
+		"RenderCommandTests.cpp"
+	}
+
+project "SceneSerialisationTests"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"Test.h",
+		"SceneSerialisationTests.cpp"
+	}
+
+project "VisibilityCullerTests"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"Test.h",
+		"VisibilityCullerTests.cpp"
+	}
+
+project "SystemManagerTests"
+	SetBenchmarkSettings()
+
+	files
+	{
+		"Test.h",
+		"SystemManagerTests.cpp"
+	}
+
+	-- The OpenAL manager is only created by the engine on some platforms, link it everywhere for the test
+	filter "system:linux"
+		linkoptions
+		{
+			"../Lumos/external/OpenAL/libs/linux/libopenal.so"
+		}
+
+	filter()
@@ -62,6 +62,14 @@ workspace "Lumos"
 	include "Lumos/premake5"
 	include "Sandbox/premake5"
 
+	group "Benchmarks"
+		include "Benchmarks/premake5"
+	group ""
+
+	group "Tests"
+		include "Tests/premake5"
+	group ""
+
 	filter()
 
 newaction